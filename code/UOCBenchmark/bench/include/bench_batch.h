@@ -0,0 +1,10 @@
+#ifndef __BENCH_BATCH_H__
+#define __BENCH_BATCH_H__
+
+// Measure the sort of vaccination batch lists
+void bench_batchList_sort(void);
+
+// Measure the choice of batches for doses in a list with many exhausted batches
+void bench_batchList_inoculate(void);
+
+#endif // __BENCH_BATCH_H__
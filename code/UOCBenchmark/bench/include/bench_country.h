@@ -0,0 +1,37 @@
+#ifndef __BENCH_COUNTRY_H__
+#define __BENCH_COUNTRY_H__
+
+// Measure the time to find a country by name for growing tables
+void bench_countryTable_find(void);
+
+// Measure a full inoculation round of a country for both storages of the patient queue
+void bench_country_inoculate(void);
+
+// Measure the release of a country with its patients stored with malloc and in an arena
+void bench_country_free(void);
+
+// Measure a first dose round with scarce doses, serving the patients in arrival and in priority order
+void bench_country_inoculate_ordered(void);
+
+// Measure the load of the patients of a file into a table of countries
+void bench_countryTable_load(void);
+
+// Measure the restart from a snapshot, compared with loading the data again
+void bench_countryTable_snapshot(void);
+
+// Measure the cost of writing the doses given to a journal
+void bench_journal(void);
+
+// Measure the rounds of all the countries of a table with different numbers of threads
+void bench_countryTable_inoculate_all(void);
+
+// Measure the statistics of a table with the functions of each country and with one pass over the table
+void bench_countryTable_stats(void);
+
+// Measure the patients added by many threads to a country, through its intake or behind a global mutex
+void bench_country_intake(void);
+
+// Measure the patients made by the synthetic generator, alone and streamed into a table or a file
+void bench_generator(void);
+
+#endif // __BENCH_COUNTRY_H__
@@ -0,0 +1,16 @@
+#ifndef __BENCH_PATIENT_H__
+#define __BENCH_PATIENT_H__
+
+// Measure enqueue, scan and dequeue of patient queues for both storages
+void bench_patientQueue(void);
+
+// Measure the comparison of equal and different patient queues
+void bench_patientQueue_compare(void);
+
+// Measure the scan of the patients stored as tPatient and as compact records
+void bench_patientRecord(void);
+
+// Measure finding and removing patients by id, with and without the id index
+void bench_patientQueue_byId(void);
+
+#endif // __BENCH_PATIENT_H__
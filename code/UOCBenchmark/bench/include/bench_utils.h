@@ -0,0 +1,21 @@
+#ifndef __BENCH_UTILS_H__
+#define __BENCH_UTILS_H__
+
+#include <stdio.h>
+
+// Get the current wall-clock time in seconds
+double bench_now(void);
+
+// Print the header of a table of results
+void bench_printHeader(const char* title);
+
+// Print a row of a table of results: the operation, the size of the data and the time per operation
+void bench_printResult(const char* operation, long size, double seconds, long operations);
+
+// Export all the results printed, in JSON format. With UOC_INSTRUMENT the counters of the run are exported too
+void bench_export(FILE* fout);
+
+// Release the results kept for the export
+void bench_free(void);
+
+#endif // __BENCH_UTILS_H__
@@ -0,0 +1,24 @@
+#ifndef __BENCH_WORLD_H__
+#define __BENCH_WORLD_H__
+
+// Default size of the synthetic world
+#define BENCH_WORLD_COUNTRIES 32
+#define BENCH_WORLD_PATIENTS 1000000
+#define BENCH_WORLD_BATCHES 8
+
+// Size of the synthetic world measured by bench_world
+typedef struct {
+    unsigned int countries;
+    // Patients of all the countries
+    unsigned int patients;
+    // Batches of each vaccine of the catalogue in each country
+    unsigned int batches;
+} tBenchWorldOptions;
+
+// Get the default size of the synthetic world
+void bench_worldDefaultOptions(tBenchWorldOptions* options);
+
+// Build a synthetic world of the given size and measure the public operations on it
+void bench_world(const tBenchWorldOptions* options);
+
+#endif // __BENCH_WORLD_H__
@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "vaccine.h"
+#include "vaccinationBatch.h"
+#include "bench_utils.h"
+#include "bench_batch.h"
+
+#define NUMBER_BATCHES 1000000
+#define NUMBER_LOTS (NUMBER_BATCHES / 4)
+#define NUMBER_EMPTY_BATCHES 100000
+#define NUMBER_DOSES 1000000
+
+// Measure the sort of vaccination batch lists
+void bench_batchList_sort(void) {
+    tVaccinationBatchList list;
+    tVaccinationBatchListNode* node;
+    tVaccine vaccines[3];
+    tVaccineBatch batch;
+    double start;
+    int i;
+
+    vaccine_init(&vaccines[0], ASTRAZENECA_VAC, ADENOVIRUSES, PHASE3);
+    vaccine_init(&vaccines[1], PFIZER_VAC, RNA, PHASE3);
+    vaccine_init(&vaccines[2], MODERNA_VAC, RNA, PHASE3);
+
+    bench_printHeader("Vaccination batch lists");
+
+    vaccinationBatchList_create(&list);
+
+    start = bench_now();
+    srand(1);
+    for(i = 0; i < NUMBER_BATCHES; i++) {
+        vaccinationBatch_init(&batch, rand() % NUMBER_LOTS, &vaccines[i % 3], i);
+        vaccineBatchList_append(&list, batch);
+    }
+    bench_printResult("append", NUMBER_BATCHES, bench_now() - start, NUMBER_BATCHES);
+
+    start = bench_now();
+    vaccineBatchList_quicksort(&list);
+    bench_printResult("sort", NUMBER_BATCHES, bench_now() - start, NUMBER_BATCHES);
+
+    // After the first sort the nodes are no longer in allocation order
+    start = bench_now();
+    vaccineBatchList_quicksort(&list);
+    bench_printResult("sort (already sorted)", NUMBER_BATCHES, bench_now() - start, NUMBER_BATCHES);
+
+    for(node = list.first; node != NULL && node->next != NULL; node = node->next) {
+        if(node->e.lotID > node->next->e.lotID) {
+            printf("Unexpected sort results\n");
+            break;
+        }
+    }
+
+    vaccinationBatchList_free(&list);
+    for(i = 0; i < 3; i++) {
+        vaccine_free(&vaccines[i]);
+    }
+}
+
+// Measure the choice of batches for doses in a list with many exhausted batches
+void bench_batchList_inoculate(void) {
+    tVaccinationBatchList list;
+    tVaccine vaccines[3];
+    tVaccineBatch batch;
+    tPatient patient;
+    double start;
+    int i;
+
+    vaccine_init(&vaccines[0], ASTRAZENECA_VAC, ADENOVIRUSES, PHASE3);
+    vaccine_init(&vaccines[1], PFIZER_VAC, RNA, PHASE3);
+    vaccine_init(&vaccines[2], MODERNA_VAC, RNA, PHASE3);
+
+    vaccinationBatchList_create(&list);
+    for(i = 0; i < NUMBER_EMPTY_BATCHES; i++) {
+        vaccinationBatch_init(&batch, i, &vaccines[i % 3], 0);
+        vaccineBatchList_append(&list, batch);
+    }
+    // The doses are spread over small batches at the end of the list
+    for(i = 0; i < 2 * NUMBER_DOSES / 10; i++) {
+        vaccinationBatch_init(&batch, NUMBER_EMPTY_BATCHES + i, &vaccines[i % 3], 10);
+        vaccineBatchList_append(&list, batch);
+    }
+
+    patient_init(&patient, "Patient", 1, NULL, 0, 0, ANYONE_ELSE);
+
+    start = bench_now();
+    for(i = 0; i < NUMBER_DOSES; i++) {
+        // The same patient gets the two doses again and again
+        patient.number_doses = 0;
+        patient.vaccine = NULL;
+        vaccineBatchList_inoculate_first_vaccine(&list, &patient);
+        vaccineBatchList_inoculate_second_vaccine(&list, &patient);
+    }
+    bench_printResult("choose batch (100k exhausted batches)", NUMBER_DOSES, bench_now() - start, 2 * NUMBER_DOSES);
+
+    patient_free(&patient);
+    vaccinationBatchList_free(&list);
+    for(i = 0; i < 3; i++) {
+        vaccine_free(&vaccines[i]);
+    }
+}
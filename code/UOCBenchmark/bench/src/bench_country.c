@@ -0,0 +1,795 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "country.h"
+#include "csvLoader.h"
+#include "snapshot.h"
+#include "journal.h"
+#include "generator.h"
+#include "bench_utils.h"
+#include "bench_country.h"
+
+#define NUMBER_LOOKUPS 1000000
+#define COUNTRY_NAME_LENGTH 20
+#define NUMBER_PATIENTS 200000
+#define NUMBER_BATCHES 16
+#define PATIENT_NAME_LENGTH 20
+#define NUMBER_ARENA_PATIENTS 1000000
+#define NUMBER_SCARCE_DOSES (NUMBER_PATIENTS / 10)
+#define NUMBER_LOAD_COUNTRIES 16
+#define NUMBER_LOAD_PATIENTS 2000000
+#define LOAD_FILENAME "bench_bulk_load.csv"
+#define SNAPSHOT_FILENAME "bench_snapshot.bin"
+#define NUMBER_JOURNAL_DOSES 2000000
+#define NUMBER_FRAME_DOSES 10000
+#define JOURNAL_FILENAME "bench_journal.bin"
+#define NUMBER_ROUND_COUNTRIES 16
+#define MAX_ROUND_THREADS 8
+#define NUMBER_STATS_COUNTRIES 4096
+#define NUMBER_STATS_PATIENTS 50
+#define NUMBER_STATS_PASSES 20
+#define NUMBER_INTAKE_PATIENTS 1000000
+#define NUMBER_INTAKE_BATCH 4096
+#define NUMBER_GENERATED_PATIENTS 10000000
+#define NUMBER_GENERATED_BATCHES 10000
+#define GENERATOR_FILENAME "bench_generator.csv"
+
+// Reference implementation: find a country comparing the name with all the elements
+static tCountry* linearFind(tCountryTable* table, const char* name) {
+    unsigned int i;
+
+    for(i = 0; i < table->size; i++) {
+        if(strcmp(table->elements[i].name, name) == 0) {
+            return &(table->elements[i]);
+        }
+    }
+
+    return NULL;
+}
+
+// Measure the time to find a country by name for growing tables
+void bench_countryTable_find(void) {
+    const int sizes[] = { 10, 100, 1000, 10000 };
+    tCountryTable table;
+    tCountry country;
+    char (*names)[COUNTRY_NAME_LENGTH];
+    double start;
+    long found;
+    int size, i, j, k;
+
+    bench_printHeader("Find a country by name");
+
+    for(i = 0; i < (int)(sizeof(sizes) / sizeof(sizes[0])); i++) {
+        size = sizes[i];
+        names = malloc(size * sizeof(*names));
+        if(names == NULL) {
+            return;
+        }
+
+        countryTable_init(&table);
+        for(j = 0; j < size; j++) {
+            snprintf(names[j], COUNTRY_NAME_LENGTH, "Country_%06d", j);
+            country_init(&country, names[j], j % 2 == 0);
+            countryTable_add(&table, &country);
+            country_free(&country);
+        }
+
+        // Look up the names in a scattered order, so the cost does not depend on the position
+        found = 0;
+        k = 0;
+        start = bench_now();
+        for(j = 0; j < NUMBER_LOOKUPS; j++) {
+            k = (k + 7919) % size;
+            if(countryTable_find(&table, names[k]) != NULL) {
+                found++;
+            }
+        }
+        bench_printResult("countryTable_find", size, bench_now() - start, NUMBER_LOOKUPS);
+
+        k = 0;
+        start = bench_now();
+        for(j = 0; j < NUMBER_LOOKUPS; j++) {
+            k = (k + 7919) % size;
+            if(linearFind(&table, names[k]) != NULL) {
+                found--;
+            }
+        }
+        bench_printResult("linear scan (reference)", size, bench_now() - start, NUMBER_LOOKUPS);
+
+        if(found != 0) {
+            printf("Unexpected lookup results\n");
+        }
+
+        countryTable_free(&table);
+        free(names);
+    }
+}
+
+// Measure one country with all the patients and batches, using the given storage for the patients
+static void bench_country_inoculate_backend(tPatientQueueBackend backend, const char* label) {
+    tCountry country;
+    tVaccine vaccines[2];
+    tVaccineBatch batch;
+    tPatient patient;
+    char name[PATIENT_NAME_LENGTH];
+    char operation[64];
+    double start;
+    int i;
+
+    country_init(&country, "Country", true);
+    if(backend == PATIENT_QUEUE_CHUNKED) {
+        country_useChunks(&country);
+    }
+
+    vaccine_init(&vaccines[0], ASTRAZENECA_VAC, ADENOVIRUSES, PHASE3);
+    vaccine_init(&vaccines[1], PFIZER_VAC, RNA, PHASE3);
+
+    // Enough doses for everybody, so the first and second rounds visit all the patients
+    for(i = 0; i < NUMBER_BATCHES; i++) {
+        vaccinationBatch_init(&batch, i + 1, &vaccines[i % 2], 2 * NUMBER_PATIENTS / NUMBER_BATCHES + 1);
+        vaccineBatchList_insert(country.vbList, batch, 0);
+    }
+
+    for(i = 0; i < NUMBER_PATIENTS; i++) {
+        snprintf(name, PATIENT_NAME_LENGTH, "Patient_%07d", i + 1);
+        patient_init(&patient, name, i + 1, NULL, 0, 0, i % (ANYONE_ELSE + 1));
+        country_addPatient(&country, patient);
+        patient_free(&patient);
+    }
+
+    start = bench_now();
+    country_inoculate_first_vaccine(&country);
+    snprintf(operation, sizeof(operation), "%s: first dose round", label);
+    bench_printResult(operation, NUMBER_PATIENTS, bench_now() - start, NUMBER_PATIENTS);
+
+    start = bench_now();
+    country_inoculate_second_vaccine(&country);
+    snprintf(operation, sizeof(operation), "%s: second dose round", label);
+    bench_printResult(operation, NUMBER_PATIENTS, bench_now() - start, NUMBER_PATIENTS);
+
+    start = bench_now();
+    if(country_percentage_vaccinated(&country) < 50.0) {
+        printf("Unexpected inoculation results\n");
+    }
+    snprintf(operation, sizeof(operation), "%s: percentage vaccinated", label);
+    bench_printResult(operation, NUMBER_PATIENTS, bench_now() - start, NUMBER_PATIENTS);
+
+    country_free(&country);
+    vaccine_free(&vaccines[0]);
+    vaccine_free(&vaccines[1]);
+}
+
+// Measure a full inoculation round of a country for both storages of the patient queue
+void bench_country_inoculate(void) {
+    bench_printHeader("Inoculate the patients of a country");
+
+    bench_country_inoculate_backend(PATIENT_QUEUE_LINKED, "linked");
+    bench_country_inoculate_backend(PATIENT_QUEUE_CHUNKED, "chunked");
+}
+
+// Measure filling and releasing one country, with the patients stored with malloc or in an arena
+static void bench_country_free_storage(bool useArena, const char* label) {
+    tCountry country;
+    tPatient patient;
+    tArenaReport report;
+    char name[PATIENT_NAME_LENGTH];
+    char operation[64];
+    double start;
+    int i;
+
+    country_init(&country, "Country", true);
+    if(useArena) {
+        country_enableArena(&country);
+    }
+
+    start = bench_now();
+    for(i = 0; i < NUMBER_ARENA_PATIENTS; i++) {
+        snprintf(name, PATIENT_NAME_LENGTH, "Patient_%07d", i + 1);
+        patient_init(&patient, name, i + 1, NULL, 0, 0, i % (ANYONE_ELSE + 1));
+        country_addPatient(&country, patient);
+        patient_free(&patient);
+    }
+    snprintf(operation, sizeof(operation), "%s: add patients", label);
+    bench_printResult(operation, NUMBER_ARENA_PATIENTS, bench_now() - start, NUMBER_ARENA_PATIENTS);
+
+    if(useArena) {
+        country_memoryReport(&country, &report);
+        arena_printReport(&report);
+    }
+
+    start = bench_now();
+    country_free(&country);
+    snprintf(operation, sizeof(operation), "%s: country_free", label);
+    bench_printResult(operation, NUMBER_ARENA_PATIENTS, bench_now() - start, NUMBER_ARENA_PATIENTS);
+}
+
+// Measure the release of a country with its patients stored with malloc and in an arena
+void bench_country_free(void) {
+    bench_printHeader("Release the patients of a country");
+
+    bench_country_free_storage(false, "malloc");
+    bench_country_free_storage(true, "arena");
+}
+
+// Measure one first dose round with doses for a tenth of the patients, in arrival or in priority order
+static void bench_country_inoculate_order(bool ordered, const char* label) {
+    tCountry country;
+    tVaccine vaccine;
+    tVaccineBatch batch;
+    tPatient patient;
+    char name[PATIENT_NAME_LENGTH];
+    char operation[64];
+    double start;
+    int i;
+
+    country_init(&country, "Country", true);
+    vaccine_init(&vaccine, PFIZER_VAC, RNA, PHASE3);
+
+    vaccinationBatch_init(&batch, 1, &vaccine, NUMBER_SCARCE_DOSES);
+    vaccineBatchList_insert(country.vbList, batch, 0);
+    vaccinationBatch_free(&batch);
+
+    for(i = 0; i < NUMBER_PATIENTS; i++) {
+        snprintf(name, PATIENT_NAME_LENGTH, "Patient_%07d", i + 1);
+        patient_init(&patient, name, i + 1, NULL, 0, 0, i % (ANYONE_ELSE + 1));
+        country_addPatient(&country, patient);
+        patient_free(&patient);
+    }
+
+    start = bench_now();
+    if(ordered) {
+        country_inoculate_first_vaccine_ordered(&country);
+    } else {
+        country_inoculate_first_vaccine(&country);
+    }
+    snprintf(operation, sizeof(operation), "%s: first dose round", label);
+    bench_printResult(operation, NUMBER_PATIENTS, bench_now() - start, NUMBER_SCARCE_DOSES);
+
+    if(country_getPatientsPerDoses(country, 1) != NUMBER_SCARCE_DOSES) {
+        printf("Unexpected inoculation results\n");
+    }
+
+    country_free(&country);
+    vaccine_free(&vaccine);
+}
+
+// Measure a first dose round with scarce doses, serving the patients in arrival and in priority order
+void bench_country_inoculate_ordered(void) {
+    bench_printHeader("Inoculate scarce doses by arrival and by priority");
+
+    bench_country_inoculate_order(false, "arrival");
+    bench_country_inoculate_order(true, "priority");
+}
+
+// Load the patients of the bulk load file with one countryTable_addPatient call for each patient
+static void bench_countryTable_load_calls(void) {
+    tCountryTable table;
+    tCountry country;
+    tPatient patient;
+    char countryName[COUNTRY_NAME_LENGTH];
+    char name[PATIENT_NAME_LENGTH];
+    double start;
+    int i;
+
+    countryTable_init(&table);
+
+    start = bench_now();
+    for(i = 0; i < NUMBER_LOAD_COUNTRIES; i++) {
+        snprintf(countryName, COUNTRY_NAME_LENGTH, "Country_%02d", i);
+        country_init(&country, countryName, true);
+        countryTable_add(&table, &country);
+        country_free(&country);
+    }
+    for(i = 0; i < NUMBER_LOAD_PATIENTS; i++) {
+        snprintf(countryName, COUNTRY_NAME_LENGTH, "Country_%02d", i / (NUMBER_LOAD_PATIENTS / NUMBER_LOAD_COUNTRIES));
+        snprintf(name, PATIENT_NAME_LENGTH, "Patient_%07d", i + 1);
+        patient_init(&patient, name, i + 1, NULL, 0, i % 2, i % (ANYONE_ELSE + 1));
+        countryTable_addPatient(&table, countryName, patient);
+        patient_free(&patient);
+    }
+    bench_printResult("countryTable_addPatient calls", NUMBER_LOAD_PATIENTS, bench_now() - start, NUMBER_LOAD_PATIENTS);
+
+    countryTable_free(&table);
+}
+
+// Load the bulk load file with the CSV loader
+static void bench_countryTable_load_csv(bool useArenas, const char* label) {
+    tCountryTable table;
+    tCsvLoadOptions options;
+    tCsvLoadReport report;
+    char operation[64];
+
+    countryTable_init(&table);
+    csvLoader_defaultOptions(&options);
+    options.useArenas = useArenas;
+
+    if(csvLoader_loadFile(&table, LOAD_FILENAME, &options, &report) != OK || report.rows[CSV_PATIENT] != NUMBER_LOAD_PATIENTS) {
+        printf("Unexpected load results\n");
+    }
+    snprintf(operation, sizeof(operation), "%s: %.0f rows/s", label, csvLoader_rowsPerSecond(&report));
+    bench_printResult(operation, NUMBER_LOAD_PATIENTS, report.seconds, NUMBER_LOAD_PATIENTS);
+
+    countryTable_free(&table);
+}
+
+// Write the bulk load file: the countries come first, then the patients of each country together
+static bool bench_writeLoadFile(void) {
+    FILE* fout;
+    int i;
+
+    fout = fopen(LOAD_FILENAME, "w");
+    if(fout == NULL) {
+        printf("Cannot create %s\n", LOAD_FILENAME);
+        return false;
+    }
+    for(i = 0; i < NUMBER_LOAD_COUNTRIES; i++) {
+        fprintf(fout, "COUNTRY,Country_%02d,1\n", i);
+    }
+    for(i = 0; i < NUMBER_LOAD_PATIENTS; i++) {
+        fprintf(fout, "PATIENT,Country_%02d,%d,Patient_%07d,%d,%d,,\n", i / (NUMBER_LOAD_PATIENTS / NUMBER_LOAD_COUNTRIES),
+                i + 1, i + 1, i % (ANYONE_ELSE + 1), i % 2);
+    }
+    fclose(fout);
+
+    return true;
+}
+
+// Measure the load of the patients of a file into a table of countries
+void bench_countryTable_load(void) {
+    bench_printHeader("Bulk load of patients");
+
+    if(!bench_writeLoadFile()) {
+        return;
+    }
+
+    bench_countryTable_load_calls();
+    bench_countryTable_load_csv(false, "CSV malloc");
+    bench_countryTable_load_csv(true, "CSV arena");
+
+    remove(LOAD_FILENAME);
+}
+
+// Measure the restart from a snapshot, compared with loading the data again
+void bench_countryTable_snapshot(void) {
+    tCountryTable table;
+    tCsvLoadReport report;
+    unsigned int threads;
+    char operation[64];
+    double start;
+
+    bench_printHeader("Snapshot of a table of countries");
+
+    if(!bench_writeLoadFile()) {
+        return;
+    }
+
+    countryTable_init(&table);
+    csvLoader_loadFile(&table, LOAD_FILENAME, NULL, &report);
+    bench_printResult("rebuild from CSV", NUMBER_LOAD_PATIENTS, report.seconds, NUMBER_LOAD_PATIENTS);
+    remove(LOAD_FILENAME);
+
+    start = bench_now();
+    if(snapshot_save(&table, SNAPSHOT_FILENAME) != OK) {
+        printf("Cannot create %s\n", SNAPSHOT_FILENAME);
+    }
+    bench_printResult("snapshot_save", NUMBER_LOAD_PATIENTS, bench_now() - start, NUMBER_LOAD_PATIENTS);
+    countryTable_free(&table);
+
+    start = bench_now();
+    if(snapshot_load(&table, SNAPSHOT_FILENAME) != OK || table.size != NUMBER_LOAD_COUNTRIES) {
+        printf("Unexpected snapshot results\n");
+    }
+    bench_printResult("snapshot_load", NUMBER_LOAD_PATIENTS, bench_now() - start, NUMBER_LOAD_PATIENTS);
+    countryTable_free(&table);
+
+    for(threads = 2; threads <= MAX_ROUND_THREADS; threads *= 2) {
+        start = bench_now();
+        if(snapshot_loadParallel(&table, SNAPSHOT_FILENAME, threads) != OK || table.size != NUMBER_LOAD_COUNTRIES) {
+            printf("Unexpected snapshot results\n");
+        }
+        snprintf(operation, sizeof(operation), "snapshot_loadParallel, %u threads", threads);
+        bench_printResult(operation, NUMBER_LOAD_PATIENTS, bench_now() - start, NUMBER_LOAD_PATIENTS);
+        countryTable_free(&table);
+    }
+
+    remove(SNAPSHOT_FILENAME);
+}
+
+// Measure the doses written to a journal, committing a frame every NUMBER_FRAME_DOSES doses
+static void bench_journal_append(unsigned int syncFrames, const char* label) {
+    tJournal journal;
+    tJournalOptions options;
+    tPatient patient;
+    unsigned int country;
+    char operation[64];
+    double start;
+    int i;
+
+    journal_defaultOptions(&options);
+    options.syncFrames = syncFrames;
+    if(journal_open(&journal, JOURNAL_FILENAME, &options) != OK || journal_addCountry(&journal, "Country", &country) != OK) {
+        printf("Cannot create %s\n", JOURNAL_FILENAME);
+        return;
+    }
+
+    patient_init(&patient, "Patient", 1, PFIZER_VAC, 1, 1, ANYONE_ELSE);
+
+    start = bench_now();
+    for(i = 0; i < NUMBER_JOURNAL_DOSES; i++) {
+        patient.id = i + 1;
+        journal_appendDose(&journal, country, &patient, 1 + i % NUMBER_BATCHES);
+        if((i + 1) % NUMBER_FRAME_DOSES == 0) {
+            journal_commit(&journal);
+        }
+    }
+    journal_close(&journal);
+    snprintf(operation, sizeof(operation), "journal_appendDose, %s", label);
+    bench_printResult(operation, NUMBER_JOURNAL_DOSES, bench_now() - start, NUMBER_JOURNAL_DOSES);
+
+    patient_free(&patient);
+    remove(JOURNAL_FILENAME);
+}
+
+// Measure the first and second dose rounds of a country, with or without a journal
+static void bench_journal_inoculate(bool journaled, const char* label) {
+    tCountry country;
+    tJournal journal;
+    tJournalOptions options;
+    tVaccine vaccines[2];
+    tVaccineBatch batch;
+    tPatient patient;
+    char name[PATIENT_NAME_LENGTH];
+    char operation[64];
+    double start;
+    int i;
+
+    country_init(&country, "Country", true);
+    vaccine_init(&vaccines[0], ASTRAZENECA_VAC, ADENOVIRUSES, PHASE3);
+    vaccine_init(&vaccines[1], PFIZER_VAC, RNA, PHASE3);
+
+    // Enough doses for everybody, so both rounds give a dose to all the patients
+    for(i = 0; i < NUMBER_BATCHES; i++) {
+        vaccinationBatch_init(&batch, i + 1, &vaccines[i % 2], 2 * NUMBER_PATIENTS / NUMBER_BATCHES + 1);
+        vaccineBatchList_insert(country.vbList, batch, 0);
+    }
+
+    for(i = 0; i < NUMBER_PATIENTS; i++) {
+        snprintf(name, PATIENT_NAME_LENGTH, "Patient_%07d", i + 1);
+        patient_init(&patient, name, i + 1, NULL, 0, 0, i % (ANYONE_ELSE + 1));
+        country_addPatient(&country, patient);
+        patient_free(&patient);
+    }
+
+    if(journaled) {
+        journal_defaultOptions(&options);
+        if(journal_open(&journal, JOURNAL_FILENAME, &options) != OK || country_setJournal(&country, &journal) != OK) {
+            printf("Cannot create %s\n", JOURNAL_FILENAME);
+            journaled = false;
+        }
+    }
+
+    start = bench_now();
+    country_inoculate_first_vaccine(&country);
+    country_inoculate_second_vaccine(&country);
+    snprintf(operation, sizeof(operation), "two dose rounds, %s", label);
+    bench_printResult(operation, NUMBER_PATIENTS, bench_now() - start, 2 * NUMBER_PATIENTS);
+
+    if(journaled) {
+        country_setJournal(&country, NULL);
+        journal_close(&journal);
+        remove(JOURNAL_FILENAME);
+    }
+
+    country_free(&country);
+    vaccine_free(&vaccines[0]);
+    vaccine_free(&vaccines[1]);
+}
+
+// Measure the cost of writing the doses given to a journal
+void bench_journal(void) {
+    bench_printHeader("Inoculation journal");
+
+    bench_journal_append(1, "fsync every frame");
+    bench_journal_append(0, "fsync at close");
+    bench_journal_inoculate(false, "no journal");
+    bench_journal_inoculate(true, "journal");
+}
+
+// Fill a table with countries of very different sizes: the first one has NUMBER_PATIENTS patients, the others less.
+// Returns the number of patients
+static unsigned int bench_roundTable(tCountryTable* table) {
+    tCountry country;
+    tCountry* added;
+    tVaccine vaccines[2];
+    tVaccineBatch batch;
+    tPatient patient;
+    char name[PATIENT_NAME_LENGTH];
+    unsigned int total;
+    int i, c, patients;
+
+    vaccine_init(&vaccines[0], ASTRAZENECA_VAC, ADENOVIRUSES, PHASE3);
+    vaccine_init(&vaccines[1], PFIZER_VAC, RNA, PHASE3);
+
+    total = 0;
+    for(c = 0; c < NUMBER_ROUND_COUNTRIES; c++) {
+        snprintf(name, PATIENT_NAME_LENGTH, "Country_%02d", c);
+        country_init(&country, name, true);
+        countryTable_add(table, &country);
+        country_free(&country);
+        added = countryTable_find(table, name);
+
+        patients = NUMBER_PATIENTS / (c + 1);
+        for(i = 0; i < NUMBER_BATCHES; i++) {
+            vaccinationBatch_init(&batch, i + 1, &vaccines[i % 2], 2 * patients / NUMBER_BATCHES + 1);
+            vaccineBatchList_insert(added->vbList, batch, 0);
+        }
+        for(i = 0; i < patients; i++) {
+            snprintf(name, PATIENT_NAME_LENGTH, "Patient_%07d", i + 1);
+            patient_init(&patient, name, i + 1, NULL, 0, 0, i % (ANYONE_ELSE + 1));
+            country_addPatient(added, patient);
+            patient_free(&patient);
+        }
+        total += patients;
+    }
+
+    vaccine_free(&vaccines[0]);
+    vaccine_free(&vaccines[1]);
+
+    return total;
+}
+
+// Measure the rounds of all the countries of a table with different numbers of threads
+void bench_countryTable_inoculate_all(void) {
+    tCountryTable table;
+    unsigned int patients, threads;
+    char operation[64];
+    double start;
+
+    bench_printHeader("Inoculate all the countries of a table");
+
+    for(threads = 1; threads <= MAX_ROUND_THREADS; threads *= 2) {
+        countryTable_init(&table);
+        patients = bench_roundTable(&table);
+
+        start = bench_now();
+        if(countryTable_inoculate_all(&table, threads) != OK) {
+            printf("Unexpected inoculation results\n");
+        }
+        snprintf(operation, sizeof(operation), "countryTable_inoculate_all, %u threads", threads);
+        bench_printResult(operation, patients, bench_now() - start, patients);
+
+        countryTable_free(&table);
+    }
+}
+
+// Measure the statistics of a table with the functions of each country and with one pass over the table
+void bench_countryTable_stats(void) {
+    tCountryTable table;
+    tCountryTableStats stats;
+    tCountry country;
+    tCountry* added;
+    tVaccine vaccines[2];
+    tVaccineBatch batch;
+    tPatient patient;
+    tVaccineTec technology;
+    char name[PATIENT_NAME_LENGTH];
+    char operation[64];
+    unsigned int threads;
+    double start, coverage;
+    long count;
+    int i, c, pass;
+
+    bench_printHeader("Statistics of a table of countries");
+
+    countryTable_init(&table);
+    vaccine_init(&vaccines[0], ASTRAZENECA_VAC, ADENOVIRUSES, PHASE3);
+    vaccine_init(&vaccines[1], PFIZER_VAC, RNA, PHASE3);
+    for(c = 0; c < NUMBER_STATS_COUNTRIES; c++) {
+        snprintf(name, PATIENT_NAME_LENGTH, "Country_%05d", c);
+        country_init(&country, name, c % 3 == 0);
+        countryTable_add(&table, &country);
+        country_free(&country);
+
+        added = countryTable_find(&table, name);
+        country_addVaccine(added, vaccines[0]);
+        country_addVaccine(added, vaccines[1]);
+        for(i = 0; i < 2; i++) {
+            vaccinationBatch_init(&batch, i + 1, &vaccines[i], NUMBER_STATS_PATIENTS / 2);
+            vaccineBatchList_append(added->vbList, batch);
+        }
+        for(i = 0; i < NUMBER_STATS_PATIENTS; i++) {
+            snprintf(name, PATIENT_NAME_LENGTH, "Patient_%07d", i + 1);
+            patient_init(&patient, name, i + 1, NULL, 0, 0, i % (ANYONE_ELSE + 1));
+            country_addPatient(added, patient);
+            patient_free(&patient);
+        }
+    }
+    countryTable_inoculate_all(&table, 1);
+
+    // What a dashboard does without countryTable_stats
+    start = bench_now();
+    count = 0;
+    coverage = 0.0;
+    for(pass = 0; pass < NUMBER_STATS_PASSES; pass++) {
+        for(c = 0; c < NUMBER_STATS_COUNTRIES; c++) {
+            coverage += country_percentage_vaccinated(&table.elements[c]);
+            count += country_getPatientsPerVaccine(table.elements[c], vaccines[0]);
+            count += country_getPatientsPerVaccine(table.elements[c], vaccines[1]);
+            for(technology = NONE; technology <= RNA; technology++) {
+                count += country_getPatientsPerVaccineTechnology(table.elements[c], technology);
+            }
+        }
+    }
+    bench_printResult("loop over the countries", NUMBER_STATS_COUNTRIES, bench_now() - start, NUMBER_STATS_PASSES * NUMBER_STATS_COUNTRIES);
+
+    for(threads = 1; threads <= MAX_ROUND_THREADS; threads *= 4) {
+        start = bench_now();
+        for(pass = 0; pass < NUMBER_STATS_PASSES; pass++) {
+            if(countryTable_stats(&table, threads, &stats) != OK) {
+                printf("Unexpected statistics results\n");
+            }
+            count -= stats.total.patients;
+            countryTableStats_free(&stats);
+        }
+        snprintf(operation, sizeof(operation), "countryTable_stats, %u threads", threads);
+        bench_printResult(operation, NUMBER_STATS_COUNTRIES, bench_now() - start, NUMBER_STATS_PASSES * NUMBER_STATS_COUNTRIES);
+    }
+
+    // The results are used, so that the loops are not removed
+    if(count == 0 && coverage < 0.0) {
+        printf("Unexpected statistics results\n");
+    }
+
+    countryTable_free(&table);
+    vaccine_free(&vaccines[0]);
+    vaccine_free(&vaccines[1]);
+}
+
+// Producer of the intake benchmark
+typedef struct {
+    tCountry* country;
+    // Lock of the country, or NULL to push to its intake
+    pthread_mutex_t* lock;
+    int first;
+    int count;
+} tBenchIntakeProducer;
+
+// Add the patients of a producer to its country
+static void* bench_intakeProducer(void* arg) {
+    tBenchIntakeProducer* producer = (tBenchIntakeProducer*)arg;
+    tPatient patient;
+    char name[PATIENT_NAME_LENGTH];
+    int i;
+
+    for(i = producer->first; i < producer->first + producer->count; i++) {
+        snprintf(name, PATIENT_NAME_LENGTH, "Patient_%07d", i + 1);
+        patient_init(&patient, name, i + 1, NULL, 0, 0, i % (ANYONE_ELSE + 1));
+        if(producer->lock == NULL) {
+            patientIntake_push(producer->country->intake, &patient);
+        } else {
+            pthread_mutex_lock(producer->lock);
+            country_addPatient(producer->country, patient);
+            pthread_mutex_unlock(producer->lock);
+        }
+        patient_free(&patient);
+    }
+
+    return NULL;
+}
+
+// Measure the patients added by many threads to a country, through its intake or behind a lock
+static void bench_country_intake_producers(unsigned int count, bool useIntake) {
+    tBenchIntakeProducer producers[MAX_ROUND_THREADS];
+    pthread_t threads[MAX_ROUND_THREADS];
+    pthread_mutex_t lock;
+    tCountry country;
+    unsigned int i, drained, total;
+    char operation[64];
+    double start;
+
+    country_init(&country, "Country", true);
+    country_enableIntake(&country);
+    pthread_mutex_init(&lock, NULL);
+
+    start = bench_now();
+    for(i = 0; i < count; i++) {
+        producers[i].country = &country;
+        producers[i].lock = useIntake ? NULL : &lock;
+        producers[i].first = i * (NUMBER_INTAKE_PATIENTS / count);
+        producers[i].count = NUMBER_INTAKE_PATIENTS / count;
+        pthread_create(&threads[i], NULL, bench_intakeProducer, &producers[i]);
+    }
+
+    for(i = 0; i < count; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    snprintf(operation, sizeof(operation), "%s, %u producers", useIntake ? "intake push" : "global mutex", count);
+    bench_printResult(operation, NUMBER_INTAKE_PATIENTS, bench_now() - start, NUMBER_INTAKE_PATIENTS);
+
+    // The consumer adds the patients to the country in batches, usually while the producers push
+    if(useIntake) {
+        start = bench_now();
+        total = 0;
+        do {
+            country_drainIntake(&country, NUMBER_INTAKE_BATCH, &drained);
+            total += drained;
+        } while(drained > 0);
+        snprintf(operation, sizeof(operation), "intake drain, %u producers", count);
+        bench_printResult(operation, NUMBER_INTAKE_PATIENTS, bench_now() - start, total);
+    }
+
+    if(patientQueue_size(*country.patients) != NUMBER_INTAKE_PATIENTS) {
+        printf("Unexpected intake results\n");
+    }
+
+    pthread_mutex_destroy(&lock);
+    country_free(&country);
+}
+
+// Measure the patients added by many threads to a country, through its intake or behind a global mutex
+void bench_country_intake(void) {
+    unsigned int count;
+
+    bench_printHeader("Intake of patients from many threads");
+
+    for(count = 1; count <= MAX_ROUND_THREADS; count *= 2) {
+        bench_country_intake_producers(count, false);
+        bench_country_intake_producers(count, true);
+    }
+}
+
+// Measure the patients made by the synthetic generator, alone and streamed into a table or a file
+void bench_generator(void) {
+    tGeneratorOptions options;
+    tGenerator generator;
+    tCountryTable table;
+    tCsvLoadReport report;
+    tPatient patient;
+    unsigned long length;
+    unsigned int i, country;
+    double start;
+
+    bench_printHeader("Synthetic population generator");
+
+    generator_defaultOptions(&options);
+    if(generator_init(&generator, &options) != OK) {
+        printf("Cannot create the generator\n");
+        return;
+    }
+
+    // The lengths of the names are used, so that the loop is not removed
+    start = bench_now();
+    length = 0;
+    for(i = 0; i < NUMBER_GENERATED_PATIENTS; i++) {
+        country = generator_nextPatient(&generator, &patient);
+        length += country + (unsigned long)patient.name[0];
+    }
+    bench_printResult("generator_nextPatient", NUMBER_GENERATED_PATIENTS, bench_now() - start, NUMBER_GENERATED_PATIENTS);
+
+    countryTable_init(&table);
+    start = bench_now();
+    if(generator_fillTable(&generator, &table, NUMBER_LOAD_PATIENTS, NUMBER_GENERATED_BATCHES) != OK) {
+        printf("Unexpected generator results\n");
+    }
+    bench_printResult("generator_fillTable", NUMBER_LOAD_PATIENTS, bench_now() - start, NUMBER_LOAD_PATIENTS);
+    countryTable_free(&table);
+
+    start = bench_now();
+    if(generator_writeFile(&generator, GENERATOR_FILENAME, NUMBER_LOAD_PATIENTS, NUMBER_GENERATED_BATCHES) != OK) {
+        printf("Cannot create %s\n", GENERATOR_FILENAME);
+    }
+    bench_printResult("generator_writeFile", NUMBER_LOAD_PATIENTS, bench_now() - start, NUMBER_LOAD_PATIENTS);
+
+    // The generated file is loaded as a real one
+    countryTable_init(&table);
+    csvLoader_loadFile(&table, GENERATOR_FILENAME, NULL, &report);
+    bench_printResult("csvLoader_loadFile", NUMBER_LOAD_PATIENTS, report.seconds, NUMBER_LOAD_PATIENTS);
+    if(report.rejected != 0 || length == 0) {
+        printf("Unexpected generator results\n");
+    }
+    countryTable_free(&table);
+    remove(GENERATOR_FILENAME);
+
+    generator_free(&generator);
+}
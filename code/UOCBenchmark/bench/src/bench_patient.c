@@ -0,0 +1,301 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "patient.h"
+#include "vaccineCatalog.h"
+#include "patientRecord.h"
+#include "bench_utils.h"
+#include "bench_patient.h"
+
+#define NUMBER_PATIENTS 1000000
+#define PATIENT_NAME_LENGTH 20
+#define NUMBER_ID_LOOKUPS 1000000
+#define NUMBER_SCAN_LOOKUPS 100
+
+// Measure enqueue, scan and dequeue of one queue. The queue must be created and empty.
+static void bench_patientQueue_backend(tPatientQueue* queue, const char* label, tPatient* patients) {
+    tPatientQueueIterator it;
+    const tPatient* patientAux;
+    tPatient* dequeued;
+    tPatient patient;
+    tPatientAggregation aggregations[2];
+    unsigned int groups[PATIENT_GROUPS];
+    tVaccineId pfizerId;
+    char operation[64];
+    double start;
+    long doses;
+    int i;
+
+    start = bench_now();
+    for(i = 0; i < NUMBER_PATIENTS; i++) {
+        patientQueue_enqueue(queue, patients[i]);
+    }
+    snprintf(operation, sizeof(operation), "%s: enqueue", label);
+    bench_printResult(operation, NUMBER_PATIENTS, bench_now() - start, NUMBER_PATIENTS);
+
+    doses = 0;
+    start = bench_now();
+    patientQueue_iterator(queue, &it);
+    while((patientAux = patientQueue_next(&it)) != NULL) {
+        doses += patientAux->number_doses;
+    }
+    snprintf(operation, sizeof(operation), "%s: scan", label);
+    bench_printResult(operation, NUMBER_PATIENTS, bench_now() - start, NUMBER_PATIENTS);
+
+    // Patients per group and patients with Pfizer, in one pass
+    memset(groups, 0, sizeof(groups));
+    pfizerId = vaccineCatalog_find(PFIZER_VAC);
+    aggregations[0].predicate = NULL;
+    aggregations[0].data = NULL;
+    aggregations[0].accumulator = patient_accumulateGroup;
+    aggregations[0].result = groups;
+    aggregations[1].predicate = patient_matchesVaccine;
+    aggregations[1].data = &pfizerId;
+    aggregations[1].accumulator = NULL;
+    aggregations[1].result = NULL;
+    start = bench_now();
+    patientQueue_aggregate(queue, aggregations, 2);
+    snprintf(operation, sizeof(operation), "%s: aggregate", label);
+    bench_printResult(operation, NUMBER_PATIENTS, bench_now() - start, NUMBER_PATIENTS);
+    if(aggregations[1].count != patientQueue_countVaccine(queue, pfizerId)) {
+        printf("Unexpected aggregate results\n");
+    }
+
+    // Half of the patients are given in new memory, and the other half are moved out to the caller
+    start = bench_now();
+    for(i = 0; i < NUMBER_PATIENTS / 2 && (dequeued = patientQueue_dequeue(queue)) != NULL; i++) {
+        doses -= dequeued->number_doses;
+        patientQueue_release(queue, dequeued);
+    }
+    snprintf(operation, sizeof(operation), "%s: dequeue", label);
+    bench_printResult(operation, NUMBER_PATIENTS / 2, bench_now() - start, NUMBER_PATIENTS / 2);
+
+    start = bench_now();
+    while(patientQueue_dequeueInto(queue, &patient) == OK) {
+        doses -= patient.number_doses;
+        patient_free(&patient);
+    }
+    snprintf(operation, sizeof(operation), "%s: dequeue into", label);
+    bench_printResult(operation, NUMBER_PATIENTS - NUMBER_PATIENTS / 2, bench_now() - start, NUMBER_PATIENTS - NUMBER_PATIENTS / 2);
+
+    if(doses != 0) {
+        printf("Unexpected scan results\n");
+    }
+
+    patientQueue_free(queue);
+}
+
+// Measure enqueue, scan and dequeue of patient queues for both storages
+void bench_patientQueue(void) {
+    tPatientQueue queue;
+    tPatient* patients;
+    char name[PATIENT_NAME_LENGTH];
+    int i;
+
+    patients = malloc(NUMBER_PATIENTS * sizeof(tPatient));
+    if(patients == NULL) {
+        return;
+    }
+
+    // The patients are created once, so only the queue operations are measured
+    for(i = 0; i < NUMBER_PATIENTS; i++) {
+        snprintf(name, PATIENT_NAME_LENGTH, "Patient_%07d", i + 1);
+        patient_init(&patients[i], name, i + 1, i % 2 == 0 ? PFIZER_VAC : NULL, 1, i % 2 == 0 ? 1 : 0, i % (ANYONE_ELSE + 1));
+    }
+
+    bench_printHeader("Patient queue storages");
+
+    patientQueue_create(&queue);
+    bench_patientQueue_backend(&queue, "linked", patients);
+
+    patientQueue_createChunked(&queue);
+    bench_patientQueue_backend(&queue, "chunked", patients);
+
+    for(i = 0; i < NUMBER_PATIENTS; i++) {
+        patient_free(&patients[i]);
+    }
+    free(patients);
+}
+
+// Measure the comparison of equal and different patient queues
+void bench_patientQueue_compare(void) {
+    tPatientQueue queue1, queue2, queue3;
+    tPatient patient;
+    char name[PATIENT_NAME_LENGTH];
+    double start;
+    bool equal, different;
+    int i;
+
+    patientQueue_create(&queue1);
+    patientQueue_createChunked(&queue2);
+    patientQueue_create(&queue3);
+
+    // The third queue only differs in its last patient
+    for(i = 0; i < NUMBER_PATIENTS; i++) {
+        snprintf(name, PATIENT_NAME_LENGTH, "Patient_%07d", i + 1);
+        patient_init(&patient, name, i + 1, NULL, 0, 0, i % (ANYONE_ELSE + 1));
+        patientQueue_enqueue(&queue1, patient);
+        patientQueue_enqueue(&queue2, patient);
+        if(i == NUMBER_PATIENTS - 1) {
+            patient.id++;
+        }
+        patientQueue_enqueue(&queue3, patient);
+        patient_free(&patient);
+    }
+
+    bench_printHeader("Patient queue comparison");
+
+    start = bench_now();
+    equal = patientQueue_compare(&queue1, &queue2);
+    bench_printResult("compare equal queues", NUMBER_PATIENTS, bench_now() - start, NUMBER_PATIENTS);
+
+    start = bench_now();
+    different = patientQueue_compare(&queue1, &queue3);
+    bench_printResult("compare different queues", NUMBER_PATIENTS, bench_now() - start, 1);
+
+    if(!equal || different) {
+        printf("Unexpected compare results\n");
+    }
+
+    patientQueue_free(&queue1);
+    patientQueue_free(&queue2);
+    patientQueue_free(&queue3);
+}
+
+// Measure the scan of the patients stored as tPatient and as compact records
+void bench_patientRecord(void) {
+    tPatientQueue linked, chunked;
+    tPatientQueueIterator it;
+    tPatientRecordTable table;
+    const tPatient* patientAux;
+    tPatient patient;
+    char name[PATIENT_NAME_LENGTH];
+    unsigned int vaccinated[3];
+    double start;
+    int i;
+
+    patientQueue_create(&linked);
+    patientQueue_createChunked(&chunked);
+    patientRecordTable_init(&table);
+
+    for(i = 0; i < NUMBER_PATIENTS; i++) {
+        snprintf(name, PATIENT_NAME_LENGTH, "Patient_%07d", i + 1);
+        patient_init(&patient, name, i + 1, i % 3 == 0 ? NULL : PFIZER_VAC, 1, i % 3, i % (ANYONE_ELSE + 1));
+        patientQueue_enqueue(&linked, patient);
+        patientQueue_enqueue(&chunked, patient);
+        patientRecordTable_add(&table, &patient);
+        patient_free(&patient);
+    }
+
+    bench_printHeader("Patient record layouts");
+
+    // Count the vaccinated patients, reading all the fields needed by the rule
+    vaccinated[0] = 0;
+    start = bench_now();
+    patientQueue_iterator(&linked, &it);
+    while((patientAux = patientQueue_next(&it)) != NULL) {
+        if(patient_isVaccinated(patientAux)) {
+            vaccinated[0]++;
+        }
+    }
+    bench_printResult("linked tPatient: scan", NUMBER_PATIENTS, bench_now() - start, NUMBER_PATIENTS);
+
+    vaccinated[1] = 0;
+    start = bench_now();
+    patientQueue_iterator(&chunked, &it);
+    while((patientAux = patientQueue_next(&it)) != NULL) {
+        if(patient_isVaccinated(patientAux)) {
+            vaccinated[1]++;
+        }
+    }
+    bench_printResult("chunked tPatient: scan", NUMBER_PATIENTS, bench_now() - start, NUMBER_PATIENTS);
+
+    start = bench_now();
+    vaccinated[2] = patientRecordTable_countVaccinated(&table);
+    bench_printResult("tPatientRecord: scan", NUMBER_PATIENTS, bench_now() - start, NUMBER_PATIENTS);
+
+    if(vaccinated[0] != vaccinated[1] || vaccinated[1] != vaccinated[2]) {
+        printf("Unexpected scan results\n");
+    }
+
+    printf("Bytes per patient: tPatient node %zu + name, tPatientRecord %zu + name %.1f\n",
+           sizeof(tPatientQueueNode), sizeof(tPatientRecord), (double)table.names.size / NUMBER_PATIENTS);
+
+    patientQueue_free(&linked);
+    patientQueue_free(&chunked);
+    patientRecordTable_free(&table);
+}
+
+// Measure finding and removing patients by id, with and without the id index
+void bench_patientQueue_byId(void) {
+    tPatientQueue indexed, plain;
+    tPatient patient;
+    char name[PATIENT_NAME_LENGTH];
+    double start;
+    long found;
+    int i, k;
+
+    patientQueue_create(&indexed);
+    patientQueue_enableIdIndex(&indexed);
+    patientQueue_create(&plain);
+
+    bench_printHeader("Patients by id");
+
+    start = bench_now();
+    for(i = 0; i < NUMBER_PATIENTS; i++) {
+        snprintf(name, PATIENT_NAME_LENGTH, "Patient_%07d", i + 1);
+        patient_init(&patient, name, i + 1, NULL, 0, 0, i % (ANYONE_ELSE + 1));
+        patientQueue_enqueue(&indexed, patient);
+        patient_free(&patient);
+    }
+    bench_printResult("indexed: enqueue", NUMBER_PATIENTS, bench_now() - start, NUMBER_PATIENTS);
+
+    start = bench_now();
+    for(i = 0; i < NUMBER_PATIENTS; i++) {
+        snprintf(name, PATIENT_NAME_LENGTH, "Patient_%07d", i + 1);
+        patient_init(&patient, name, i + 1, NULL, 0, 0, i % (ANYONE_ELSE + 1));
+        patientQueue_enqueue(&plain, patient);
+        patient_free(&patient);
+    }
+    bench_printResult("plain: enqueue", NUMBER_PATIENTS, bench_now() - start, NUMBER_PATIENTS);
+
+    // Look up the ids in a scattered order, so the cost does not depend on the position
+    found = 0;
+    k = 0;
+    start = bench_now();
+    for(i = 0; i < NUMBER_ID_LOOKUPS; i++) {
+        k = (k + 7919) % NUMBER_PATIENTS;
+        if(patientQueue_findById(&indexed, k + 1) != NULL) {
+            found++;
+        }
+    }
+    bench_printResult("indexed: findById", NUMBER_PATIENTS, bench_now() - start, NUMBER_ID_LOOKUPS);
+
+    k = 0;
+    start = bench_now();
+    for(i = 0; i < NUMBER_SCAN_LOOKUPS; i++) {
+        k = (k + 7919) % NUMBER_PATIENTS;
+        if(patientQueue_findById(&plain, k + 1) != NULL) {
+            found--;
+        }
+    }
+    bench_printResult("plain: findById (walk)", NUMBER_PATIENTS, bench_now() - start, NUMBER_SCAN_LOOKUPS);
+
+    if(found != NUMBER_ID_LOOKUPS - NUMBER_SCAN_LOOKUPS) {
+        printf("Unexpected lookup results\n");
+    }
+
+    // Remove every other patient, from the middle of the queue
+    start = bench_now();
+    for(i = 0; i < NUMBER_PATIENTS; i += 2) {
+        patientQueue_removeById(&indexed, i + 1);
+    }
+    bench_printResult("indexed: removeById", NUMBER_PATIENTS, bench_now() - start, NUMBER_PATIENTS / 2);
+
+    if(patientQueue_size(indexed) != NUMBER_PATIENTS / 2) {
+        printf("Unexpected remove results\n");
+    }
+
+    patientQueue_free(&indexed);
+    patientQueue_free(&plain);
+}
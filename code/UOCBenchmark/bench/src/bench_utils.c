@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "instrument.h"
+#include "bench_utils.h"
+
+// Result of a measure, kept to be exported
+typedef struct {
+    char* section;
+    char* operation;
+    long size;
+    double seconds;
+    long operations;
+} tBenchResult;
+
+// Results measured, in the order they were printed
+static tBenchResult* results = NULL;
+static unsigned int resultsCount = 0;
+static unsigned int resultsAllocated = 0;
+
+// Title of the table being printed
+static char* section = NULL;
+
+// Copy a string, or NULL if there is no memory
+static char* bench_strdup(const char* text) {
+    char* copy;
+
+    copy = (char*)malloc(strlen(text) + 1);
+    if(copy != NULL) {
+        strcpy(copy, text);
+    }
+
+    return copy;
+}
+
+// Keep a result to be exported. Results that do not fit in memory are only printed
+static void bench_addResult(const char* operation, long size, double seconds, long operations) {
+    tBenchResult* resultsAux;
+    unsigned int allocated;
+
+    if(resultsCount == resultsAllocated) {
+        allocated = resultsAllocated == 0 ? 64 : 2 * resultsAllocated;
+        resultsAux = (tBenchResult*)realloc(results, allocated * sizeof(tBenchResult));
+        if(resultsAux == NULL) {
+            return;
+        }
+        results = resultsAux;
+        resultsAllocated = allocated;
+    }
+
+    results[resultsCount].section = bench_strdup(section != NULL ? section : "");
+    results[resultsCount].operation = bench_strdup(operation);
+    if(results[resultsCount].section == NULL || results[resultsCount].operation == NULL) {
+        free(results[resultsCount].section);
+        free(results[resultsCount].operation);
+        return;
+    }
+    results[resultsCount].size = size;
+    results[resultsCount].seconds = seconds;
+    results[resultsCount].operations = operations;
+    resultsCount++;
+}
+
+// Write a JSON string, escaping the characters that need it
+static void bench_exportString(FILE* fout, const char* text) {
+    fputc('"', fout);
+    for(; *text != '\0'; text++) {
+        if(*text == '"' || *text == '\\') {
+            fputc('\\', fout);
+        }
+        fputc(*text, fout);
+    }
+    fputc('"', fout);
+}
+
+// Get the current wall-clock time in seconds
+double bench_now(void) {
+    struct timespec ts;
+
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Print the header of a table of results
+void bench_printHeader(const char* title) {
+    printf("\n=========================================================================\n");
+    printf("\t%s\n", title);
+    printf("=========================================================================\n");
+    printf("%-40s %12s %16s\n", "Operation", "Size", "Time (ns/op)");
+
+    free(section);
+    section = bench_strdup(title);
+}
+
+// Print a row of a table of results: the operation, the size of the data and the time per operation
+void bench_printResult(const char* operation, long size, double seconds, long operations) {
+    printf("%-40s %12ld %16.2f\n", operation, size, operations > 0 ? seconds * 1e9 / (double)operations : 0.0);
+
+    bench_addResult(operation, size, seconds, operations);
+}
+
+// Export all the results printed, in JSON format. With UOC_INSTRUMENT the counters of the run are exported too
+void bench_export(FILE* fout) {
+    tInstrumentSnapshot snapshot;
+    unsigned int i;
+
+    fprintf(fout, "{ \"total\": %u, \"results\": [", resultsCount);
+
+    for(i = 0; i < resultsCount; i++) {
+        if(i > 0) {
+            fprintf(fout, ", ");
+        }
+        fprintf(fout, "{ \"section\": ");
+        bench_exportString(fout, results[i].section);
+        fprintf(fout, ", \"operation\": ");
+        bench_exportString(fout, results[i].operation);
+        fprintf(fout, ", \"size\": %ld, \"operations\": %ld, \"seconds\": %.9f, \"ns_per_op\": %.2f }", results[i].size, results[i].operations,
+                results[i].seconds, results[i].operations > 0 ? results[i].seconds * 1e9 / (double)results[i].operations : 0.0);
+    }
+
+    fprintf(fout, "]");
+
+    if(instrument_enabled()) {
+        instrument_snapshot(&snapshot);
+        fprintf(fout, ", \"instrument\": ");
+        instrumentSnapshot_export(&snapshot, fout);
+    }
+
+    fprintf(fout, "}");
+}
+
+// Release the results kept for the export
+void bench_free(void) {
+    unsigned int i;
+
+    for(i = 0; i < resultsCount; i++) {
+        free(results[i].section);
+        free(results[i].operation);
+    }
+    free(results);
+    free(section);
+
+    results = NULL;
+    resultsCount = 0;
+    resultsAllocated = 0;
+    section = NULL;
+}
@@ -0,0 +1,208 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "country.h"
+#include "vaccineCatalog.h"
+#include "instrument.h"
+#include "bench_utils.h"
+#include "bench_world.h"
+
+#define WORLD_NAME_LENGTH 20
+#define NUMBER_WORLD_VACCINES 4
+#define NUMBER_WORLD_LOOKUPS 1000000
+
+// Percentage of the patients of each group, from HEALTH_WORKER to ANYONE_ELSE
+static const unsigned int groupMix[PATIENT_GROUPS] = { 5, 6, 14, 10, 10, 12, 43 };
+
+// Known vaccines authorized in all the countries of the world
+static const char* worldVaccines[NUMBER_WORLD_VACCINES] = { ASTRAZENECA_VAC, JANSSEN_VAC, MODERNA_VAC, PFIZER_VAC };
+static const tVaccineTec worldTechnologies[NUMBER_WORLD_VACCINES] = { ADENOVIRUSES, ADENOVIRUSES, RNA, RNA };
+
+// Get the group of a patient, following the mix of groups in a deterministic order
+static tPatientGroup bench_worldGroup(unsigned int patient) {
+    unsigned int value, group;
+
+    // Knuth's multiplicative hash spreads consecutive patients over the mix
+    value = (patient * 2654435761u) % 100;
+    for(group = 0; group < PATIENT_GROUPS - 1 && value >= groupMix[group]; group++) {
+        value -= groupMix[group];
+    }
+
+    return (tPatientGroup)group;
+}
+
+// Get the default size of the synthetic world
+void bench_worldDefaultOptions(tBenchWorldOptions* options) {
+    options->countries = BENCH_WORLD_COUNTRIES;
+    options->patients = BENCH_WORLD_PATIENTS;
+    options->batches = BENCH_WORLD_BATCHES;
+}
+
+// Get the patients of a country of the world. The first country takes the remainder
+static unsigned int bench_worldPatients(const tBenchWorldOptions* options, unsigned int country) {
+    return options->patients / options->countries + (country == 0 ? options->patients % options->countries : 0);
+}
+
+// Build a synthetic world of the given size and measure the public operations on it
+void bench_world(const tBenchWorldOptions* options) {
+    tCountryTable table;
+    tCountryTableStats stats;
+    tInstrumentSnapshot before, after, diff;
+    tCountry country;
+    tCountry* copies;
+    tCountry* added;
+    tVaccine vaccines[NUMBER_WORLD_VACCINES];
+    tVaccineBatch batch;
+    tPatient patient;
+    tVaccineTec technology;
+    char name[WORLD_NAME_LENGTH];
+    char title[128];
+    unsigned int c, v, b, i, patients, id, found, batches;
+    double start;
+    long count;
+
+    if(options->countries == 0 || options->patients < options->countries) {
+        printf("Invalid size of the world\n");
+        return;
+    }
+
+    snprintf(title, sizeof(title), "World: %u countries, %u patients, %u batches per vaccine",
+             options->countries, options->patients, options->batches);
+    bench_printHeader(title);
+
+    instrument_snapshot(&before);
+    countryTable_init(&table);
+    for(v = 0; v < NUMBER_WORLD_VACCINES; v++) {
+        vaccine_init(&vaccines[v], worldVaccines[v], worldTechnologies[v], PHASE3);
+    }
+
+    start = bench_now();
+    for(c = 0; c < options->countries; c++) {
+        snprintf(name, WORLD_NAME_LENGTH, "Country_%04u", c);
+        country_init(&country, name, c % 2 == 0);
+        countryTable_add(&table, &country);
+        country_free(&country);
+        added = countryTable_find(&table, name);
+        for(v = 0; v < NUMBER_WORLD_VACCINES; v++) {
+            country_addVaccine(added, vaccines[v]);
+        }
+    }
+    bench_printResult("countryTable_add", options->countries, bench_now() - start, options->countries);
+
+    start = bench_now();
+    for(c = 0; c < options->countries; c++) {
+        patients = bench_worldPatients(options, c);
+        for(i = 0; i < patients; i++) {
+            snprintf(name, WORLD_NAME_LENGTH, "Patient_%07u", i + 1);
+            patient_init(&patient, name, i + 1, NULL, 0, 0, bench_worldGroup(i));
+            country_addPatient(&table.elements[c], patient);
+            patient_free(&patient);
+        }
+    }
+    bench_printResult("country_addPatient", options->patients, bench_now() - start, options->patients);
+
+    // Doses for all the first doses and part of the second ones, in lots that arrive out of order
+    batches = options->countries * NUMBER_WORLD_VACCINES * options->batches;
+    start = bench_now();
+    for(c = 0; c < options->countries; c++) {
+        patients = bench_worldPatients(options, c);
+        for(b = 0; b < options->batches * NUMBER_WORLD_VACCINES; b++) {
+            vaccinationBatch_init(&batch, (int)((b * 7919u) % (options->batches * NUMBER_WORLD_VACCINES)) + 1,
+                                  &vaccines[b % NUMBER_WORLD_VACCINES], 3 * patients / (2 * options->batches * NUMBER_WORLD_VACCINES) + 1);
+            vaccineBatchList_append(table.elements[c].vbList, batch);
+        }
+    }
+    bench_printResult("vaccineBatchList_append", batches, bench_now() - start, batches);
+
+    start = bench_now();
+    for(c = 0; c < options->countries; c++) {
+        vaccineBatchList_mergesort(table.elements[c].vbList);
+    }
+    bench_printResult("vaccineBatchList_mergesort", batches, bench_now() - start, batches);
+
+    start = bench_now();
+    found = 0;
+    for(i = 0; i < NUMBER_WORLD_LOOKUPS; i++) {
+        c = i % options->countries;
+        id = (i * 2654435761u) % bench_worldPatients(options, c) + 1;
+        found += patientQueue_findById(table.elements[c].patients, (int)id) != NULL;
+    }
+    bench_printResult("patientQueue_findById", options->patients, bench_now() - start, NUMBER_WORLD_LOOKUPS);
+
+    start = bench_now();
+    for(c = 0; c < options->countries; c++) {
+        country_inoculate_first_vaccine_ordered(&table.elements[c]);
+    }
+    bench_printResult("country_inoculate_first_vaccine_ordered", options->patients, bench_now() - start, options->patients);
+
+    start = bench_now();
+    for(c = 0; c < options->countries; c++) {
+        country_inoculate_second_vaccine(&table.elements[c]);
+    }
+    bench_printResult("country_inoculate_second_vaccine", options->patients, bench_now() - start, options->patients);
+
+    // The queries of a dashboard for each country
+    start = bench_now();
+    count = 0;
+    for(c = 0; c < options->countries; c++) {
+        count += (long)country_percentage_vaccinated(&table.elements[c]);
+        for(v = 0; v < NUMBER_WORLD_VACCINES; v++) {
+            count += country_getPatientsPerVaccine(table.elements[c], vaccines[v]);
+        }
+        for(technology = NONE; technology <= RNA; technology++) {
+            count += country_getPatientsPerVaccineTechnology(table.elements[c], technology);
+        }
+        for(i = 0; i < PATIENT_GROUPS; i++) {
+            count += country_getPatientsPerGroup(table.elements[c], (tPatientGroup)i);
+        }
+    }
+    bench_printResult("country statistics queries", options->countries, bench_now() - start,
+                      options->countries * (1 + NUMBER_WORLD_VACCINES + VACCINE_TECHNOLOGIES + PATIENT_GROUPS));
+
+    start = bench_now();
+    if(countryTable_stats(&table, 1, &stats) != OK) {
+        printf("Unexpected statistics results\n");
+    } else {
+        count -= (long)stats.total.vaccinated;
+        countryTableStats_free(&stats);
+    }
+    bench_printResult("countryTable_stats", options->countries, bench_now() - start, options->countries);
+
+    copies = (tCountry*)malloc(options->countries * sizeof(tCountry));
+    if(copies != NULL) {
+        start = bench_now();
+        for(c = 0; c < options->countries; c++) {
+            country_init(&copies[c], "Copy", false);
+            country_cpy(&copies[c], &table.elements[c]);
+        }
+        bench_printResult("country_cpy", options->patients, bench_now() - start, options->patients);
+
+        start = bench_now();
+        for(c = 0; c < options->countries; c++) {
+            country_free(&copies[c]);
+        }
+        bench_printResult("country_free", options->patients, bench_now() - start, options->patients);
+        free(copies);
+    }
+
+    start = bench_now();
+    countryTable_free(&table);
+    bench_printResult("countryTable_free", options->patients, bench_now() - start, options->patients);
+
+    // With UOC_INSTRUMENT, where the time and the memory of the world went
+    if(instrument_enabled()) {
+        instrument_snapshot(&after);
+        instrument_diff(&before, &after, &diff);
+        printf("\nInstrumentation of the world\n");
+        instrumentSnapshot_print(&diff);
+    }
+
+    // The results are used, so that the loops are not removed
+    if(found == 0 && count == 0) {
+        printf("Unexpected world results\n");
+    }
+
+    for(v = 0; v < NUMBER_WORLD_VACCINES; v++) {
+        vaccine_free(&vaccines[v]);
+    }
+}
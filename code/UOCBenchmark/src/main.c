@@ -0,0 +1,112 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "bench_utils.h"
+#include "bench_country.h"
+#include "bench_patient.h"
+#include "bench_batch.h"
+#include "bench_world.h"
+
+void help(const char* name) {
+    printf("%s\t =>\t Run all benchmarks and show results on screen\n", name);
+    printf("%s -h\t =>\t Show this help\n", name);
+    printf("%s -e [<file_path>]\t =>\t Run all benchmarks and save results on file (default bench_result.json)\n", name);
+    printf("%s -w\t =>\t Run only the synthetic world benchmark\n", name);
+    printf("%s -c <countries> -p <patients> -b <batches>\t =>\t Size of the synthetic world (default %d countries, %d patients, %d batches per vaccine)\n",
+           name, BENCH_WORLD_COUNTRIES, BENCH_WORLD_PATIENTS, BENCH_WORLD_BATCHES);
+}
+
+// Read the value of an option, or stop if it is not a positive number
+unsigned int readValue(const char* name, int argc, char** argv, int* i) {
+    long value = 0;
+    char* end = NULL;
+
+    if(*i + 1 < argc) {
+        value = strtol(argv[*i + 1], &end, 10);
+    }
+    if(end == NULL || *end != '\0' || value <= 0) {
+        printf("Invalid parameters\n");
+        help(name);
+        exit(EXIT_FAILURE);
+    }
+    (*i)++;
+
+    return (unsigned int)value;
+}
+
+int main(int argc, char **argv) {
+    char output_filename[512];
+    tBenchWorldOptions world;
+    bool export = false, worldOnly = false;
+    FILE* fout = NULL;
+    int i;
+
+    bench_worldDefaultOptions(&world);
+
+    for(i = 1; i < argc; i++) {
+        if(strcmp(argv[i], "-h") == 0) {
+            // Show help message
+            help(argv[0]);
+            exit(EXIT_SUCCESS);
+        } else if(strcmp(argv[i], "-e") == 0) {
+            // Export the results in JSON format, to the file given or to the default one
+            export = true;
+            if(i + 1 < argc && argv[i + 1][0] != '-') {
+                strncpy(output_filename, argv[++i], 511);
+                output_filename[511] = '\0';
+            } else {
+                strcpy(output_filename, "bench_result.json");
+            }
+        } else if(strcmp(argv[i], "-w") == 0) {
+            worldOnly = true;
+        } else if(strcmp(argv[i], "-c") == 0) {
+            world.countries = readValue(argv[0], argc, argv, &i);
+        } else if(strcmp(argv[i], "-p") == 0) {
+            world.patients = readValue(argv[0], argc, argv, &i);
+        } else if(strcmp(argv[i], "-b") == 0) {
+            world.batches = readValue(argv[0], argc, argv, &i);
+        } else {
+            // Invalid parameters
+            printf("Invalid parameters\n");
+            help(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    if(!worldOnly) {
+        // Run all benchmarks
+        bench_countryTable_find();
+        bench_country_inoculate();
+        bench_country_inoculate_ordered();
+        bench_country_free();
+        bench_countryTable_load();
+        bench_countryTable_snapshot();
+        bench_journal();
+        bench_countryTable_inoculate_all();
+        bench_countryTable_stats();
+        bench_country_intake();
+        bench_generator();
+        bench_patientQueue();
+        bench_patientQueue_compare();
+        bench_patientRecord();
+        bench_patientQueue_byId();
+        bench_batchList_sort();
+        bench_batchList_inoculate();
+    }
+    bench_world(&world);
+
+    if(export) {
+        fout = fopen(output_filename, "w");
+        if(fout == NULL) {
+            printf("Cannot create %s\n", output_filename);
+            bench_free();
+            exit(EXIT_FAILURE);
+        }
+        bench_export(fout);
+        fclose(fout);
+    }
+    bench_free();
+
+    exit(EXIT_SUCCESS);
+}
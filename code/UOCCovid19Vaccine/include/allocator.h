@@ -0,0 +1,104 @@
+#ifndef __ALLOCATOR_H__
+#define __ALLOCATOR_H__
+
+#include <stddef.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "error.h"
+
+// Default size of the chunks of a bump allocator
+#define BUMP_ALLOCATOR_CHUNK_SIZE (1024 * 1024)
+
+// Memory functions used by the library. The context is given to all of them
+typedef struct {
+    void* (*alloc)(void* context, size_t size);
+    void* (*realloc)(void* context, void* ptr, size_t size);
+    void (*free)(void* context, void* ptr);
+    void* context;
+} tAllocator;
+
+// Reference allocator that counts the memory asked to another allocator
+typedef struct {
+    // Allocator that gives the memory, or NULL for malloc
+    const tAllocator* parent;
+    atomic_ulong allocations;
+    atomic_ulong reallocations;
+    atomic_ulong frees;
+    // Bytes asked to alloc and realloc
+    atomic_ullong bytes;
+} tCountingAllocator;
+
+// Chunk of a bump allocator. The blocks are stored after it
+typedef struct _tBumpAllocatorChunk {
+    struct _tBumpAllocatorChunk* next;
+    size_t size;
+    size_t used;
+} tBumpAllocatorChunk;
+
+// Reference allocator that gives consecutive blocks of big chunks. A block is only released
+// if it is the last one given, and all the memory is released at once with bumpAllocator_free
+typedef struct {
+    // Current chunk first
+    tBumpAllocatorChunk* chunks;
+    size_t chunkSize;
+    // Bytes given in blocks
+    size_t bytes;
+    // The rounds of the countries run in many threads
+    pthread_mutex_t lock;
+} tBumpAllocator;
+
+// **** Functions related to the memory of the library
+
+// Set the allocator of all the threads. NULL goes back to malloc. It has to be set before the
+// library allocates anything, as the memory has to be released by the allocator that gave it
+void allocator_setGlobal(const tAllocator* allocator);
+
+// Get the allocator of all the threads, or NULL for malloc
+const tAllocator* allocator_global(void);
+
+// Use an allocator in this thread until allocator_leave, and get the one used before. NULL keeps the current one
+const tAllocator* allocator_enter(const tAllocator* allocator);
+
+// Use the global allocator in this thread until allocator_leave, and get the one used before.
+// The data shared by all the tables, as the catalogue, is always kept in the global allocator
+const tAllocator* allocator_enterGlobal(void);
+
+// Use in this thread the allocator that gave the memory of an object until allocator_leave, and get the one
+// used before. The objects keep allocator_current() when they are created, so NULL is the global allocator
+const tAllocator* allocator_enterOwner(const tAllocator* owner);
+
+// Go back to the allocator used before allocator_enter
+void allocator_leave(const tAllocator* previous);
+
+// Get the allocator used by this thread, or NULL for malloc
+const tAllocator* allocator_current(void);
+
+// Memory of the library, given by the allocator of the thread
+void* uoc_malloc(size_t size);
+void* uoc_calloc(size_t count, size_t size);
+void* uoc_realloc(void* ptr, size_t size);
+void uoc_free(void* ptr);
+
+// **** Functions related to the counting allocator
+
+// Initialize a counting allocator over another allocator, or over malloc if parent is NULL
+void countingAllocator_init(tCountingAllocator* counting, const tAllocator* parent);
+
+// Get the functions of a counting allocator
+void countingAllocator_allocator(tCountingAllocator* counting, tAllocator* allocator);
+
+// Get the blocks given and not released yet
+unsigned long countingAllocator_live(tCountingAllocator* counting);
+
+// **** Functions related to the bump allocator
+
+// Initialize a bump allocator. A chunkSize of 0 uses BUMP_ALLOCATOR_CHUNK_SIZE
+tError bumpAllocator_init(tBumpAllocator* bump, size_t chunkSize);
+
+// Release all the memory given by a bump allocator
+void bumpAllocator_free(tBumpAllocator* bump);
+
+// Get the functions of a bump allocator
+void bumpAllocator_allocator(tBumpAllocator* bump, tAllocator* allocator);
+
+#endif // __ALLOCATOR_H__
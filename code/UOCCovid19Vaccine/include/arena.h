@@ -0,0 +1,84 @@
+#ifndef __ARENA__H__
+#define __ARENA__H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "error.h"
+
+// Default size of the blocks of memory of an arena
+#define ARENA_BLOCK_SIZE (4 * 1024 * 1024)
+
+// Alignment of the memory given by an arena
+#define ARENA_ALIGNMENT 8
+
+// Allocations up to this size are kept in free lists when they are released, to be reused
+#define ARENA_MAX_REUSED_SIZE 256
+
+// Number of free lists, one for each multiple of ARENA_ALIGNMENT up to ARENA_MAX_REUSED_SIZE
+#define ARENA_FREE_LISTS (ARENA_MAX_REUSED_SIZE / ARENA_ALIGNMENT)
+
+// Header of a block of memory of an arena. The memory given by the arena follows it
+typedef struct _tArenaBlock {
+    struct _tArenaBlock* next;
+    size_t size;
+} tArenaBlock;
+
+// Memory used by an arena, and the memory the same allocations would use with malloc
+typedef struct {
+    // Allocations done
+    unsigned long allocations;
+    // Allocations served from the free lists
+    unsigned long reused;
+    // Bytes given to the allocations that are in use, rounded up to the alignment
+    size_t bytesInUse;
+    // Bytes of the blocks requested to the operating system
+    size_t bytesReserved;
+    // Number of blocks
+    unsigned int blocks;
+    // Estimated heap size of the allocations in use if they were done with malloc
+    size_t mallocBytes;
+} tArenaReport;
+
+// Arena: memory taken in large blocks from the operating system and given in small pieces.
+// The pieces are not released one by one, all of them are released together with the arena
+typedef struct {
+    // Blocks of the arena. The first one is the block in use
+    tArenaBlock* blocks;
+    // Free memory of the block in use
+    char* current;
+    size_t remaining;
+    // Size of the new blocks
+    size_t blockSize;
+    // Released pieces of each size, to be reused. Each piece stores the next one
+    void* freeLists[ARENA_FREE_LISTS];
+    // Counters of the memory of the arena
+    tArenaReport report;
+} tArena;
+
+// **** Functions related to arenas
+
+// Initialize an arena without memory. Blocks of blockSize bytes are requested when needed
+tError arena_init(tArena* arena, size_t blockSize);
+
+// Release all the memory of the arena
+void arena_free(tArena* arena);
+
+// Give back all the pieces of the arena, keeping its blocks to be reused
+void arena_reset(tArena* arena);
+
+// Get a piece of memory of size bytes, or NULL if there is no memory
+void* arena_alloc(tArena* arena, size_t size);
+
+// Copy a string to memory of the arena, or NULL if there is no memory
+char* arena_strdup(tArena* arena, const char* str);
+
+// Give back a piece of memory of size bytes, to be reused by the next allocations of the same size
+void arena_release(tArena* arena, void* ptr, size_t size);
+
+// Get the counters of the memory of the arena
+void arena_report(const tArena* arena, tArenaReport* report);
+
+// Print the memory used by the arena and the memory saved compared with malloc
+void arena_printReport(const tArenaReport* report);
+
+#endif // __ARENA__H__
@@ -12,4 +12,7 @@ typedef struct {
 
 bool date_equal(tDate date1, tDate date2);
 
+// Compute the hash value of a string
+unsigned int string_hash(const char* str);
+
 #endif // __COMMONS_H__
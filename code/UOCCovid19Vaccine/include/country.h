@@ -7,6 +7,13 @@
 #include "patient.h"
 #include "vaccine.h"
 #include "vaccinationBatch.h"
+#include "arena.h"
+#include "journal.h"
+#include "patientIntake.h"
+#include "allocator.h"
+
+// Fewest countries given to each thread by countryTable_stats
+#define COUNTRY_STATS_PART 64
 
 // Data type to hold data related to a Country
 typedef struct {   
@@ -15,8 +22,35 @@ typedef struct {
 	tVaccineTable* authVaccines;
 	tPatientQueue* patients;
     tVaccinationBatchList* vbList;
+    // Arena where the patients of the country are stored, or NULL if they use malloc
+    tArena* arena;
+    // Patients waiting for the first dose, by group. It is filled from the patients by the ordered rounds
+    // when the generation of the queue changes. Patients that got a dose or left are skipped by the ordered rounds
+    tPatientPriorityQueue* waiting;
+    // Generation of the patients when waiting was filled, or 0
+    uint64_t waitingGeneration;
+    // Journal where the doses given are written, or NULL. The journal is not owned by the country
+    tJournal* journal;
+    // Id of the country in the journal
+    unsigned int journalId;
+    // Intake of new patients from other threads, or NULL
+    tPatientIntake* intake;
+    // Allocator of the memory of the country, the one of the thread that initialized it
+    const tAllocator* allocator;
 } tCountry;
 
+// Hash index over the names of the countries in a tCountryTable
+typedef struct {
+    // Number of slots. It is zero or a power of two
+    unsigned int capacity;
+    // Number of used slots
+    unsigned int count;
+    // Position of the country in the table for each slot, or -1 if the slot is empty
+    int* positions;
+    // Hash of the country name stored in each slot
+    unsigned int* hashes;
+} tCountryIndex;
+
 // Table of tCountry elements
 typedef struct {
     unsigned int size;
@@ -31,8 +65,40 @@ typedef struct {
     // when we want to add elements. We can add as many elements as we want,
     // the only limit is the total amount of memory of our computer.
     tCountry* elements;
+
+    // Open addressing index over the names of the elements, used to
+    // find a country by name without scanning the whole table.
+    tCountryIndex index;
+
+    // Allocator of the memory of the countries, or NULL for the allocator of the thread
+    const tAllocator* allocator;
 } tCountryTable;
 
+// Patients and doses of a set of countries
+typedef struct {
+    unsigned long patients;
+    // Patients that have been fully vaccinated
+    unsigned long vaccinated;
+    // Patients per number of doses, as in tPatientQueueStats
+    unsigned long doses[PATIENT_QUEUE_DOSE_COUNTERS];
+} tCountryCoverage;
+
+// Statistics of all the countries of a table
+typedef struct {
+    // All the countries, the EU ones and the others
+    tCountryCoverage total;
+    tCountryCoverage eu;
+    tCountryCoverage nonEU;
+    // Patients per vaccine authorized in their country, indexed by the vaccine catalogue id
+    unsigned long* vaccines;
+    unsigned int vaccinesCount;
+    // Patients per technology of the vaccine authorized in their country
+    unsigned long technologies[VACCINE_TECHNOLOGIES];
+    // Percentage of vaccinated patients of each country, in the order of the table
+    double* coverage;
+    unsigned int countries;
+} tCountryTableStats;
+
 // **** Functions related to management of tCountry objects
 
 // Initialize a country object
@@ -44,9 +110,27 @@ void country_free(tCountry* object);
 // Compare two country objects
 bool country_equals(tCountry* country1, tCountry* country2);
 
-// Copy the data of a country to another country
+// Copy the data of a country to another country, with the allocator of dest. The copy writes its doses to the same journal, but has no intake
 tError country_cpy(tCountry* dest, tCountry* src);
 
+// Store the patients of a country without patients in an arena owned by the country
+tError country_enableArena(tCountry* country);
+
+// Store the patients of a country without patients in chunks of contiguous patients, keeping its id index
+tError country_useChunks(tCountry* country);
+
+// Get the memory used by the patients of a country stored in an arena. All the counters are 0 without arena
+void country_memoryReport(tCountry* country, tArenaReport* report);
+
+// Write the doses given to the patients of a country to a journal, or stop writing them with NULL
+tError country_setJournal(tCountry* country, tJournal* journal);
+
+// Let other threads add patients to a country through an intake, without locks
+tError country_enableIntake(tCountry* country);
+
+// Add to the country up to max patients of its intake, or all of them with max 0. Only one thread can drain a country
+tError country_drainIntake(tCountry* country, unsigned int max, unsigned int* count);
+
 tVaccine* country_find_vaccine(tCountry* country, const char* name);
 
 // Add a new patient
@@ -71,9 +155,20 @@ int country_getPatientsPerVaccine(tCountry country, tVaccine vaccine);
 // count how many patients already vaccinated with a vaccine technology
 int country_getPatientsPerVaccineTechnology(tCountry country, tVaccineTec technology);
 
+// count how many patients of a poblational group the country has
+int country_getPatientsPerGroup(tCountry country, tPatientGroup group);
+
+// count how many patients the country has with a number of doses. The last dose counter
+// of the queue (PATIENT_QUEUE_DOSE_COUNTERS - 1) also includes the patients with more doses
+int country_getPatientsPerDoses(tCountry country, int number_doses);
+
 // inoculates all available doses of each batch of vaccines to the list of patients who have not received any vaccine
 tError country_inoculate_first_vaccine(tCountry* country);
 
+// inoculates the first dose to the patients who have not received any vaccine, serving the groups in priority order.
+// The patients are found by id: a patient with the id of an earlier patient of the queue is served as that patient
+tError country_inoculate_first_vaccine_ordered(tCountry* country);
+
 // inoculates all available doses of each batch of vaccines to the list of patients who have received 1 vaccine
 tError country_inoculate_second_vaccine(tCountry* country);
 
@@ -88,10 +183,14 @@ void countryTable_init(tCountryTable* table);
 // Release the memory used by countryTable structure
 void countryTable_free(tCountryTable* table);
 
+// Set the allocator of the memory of the countries of an empty table, or NULL for the allocator of the thread.
+// The functions of the table use it, and the countries of the table keep it
+tError countryTable_setAllocator(tCountryTable* table, const tAllocator* allocator);
+
 // Add a new country to the table
 tError countryTable_add(tCountryTable* table, tCountry* country);
 
-// Remove a country from the table
+// Remove a country from the table. The countries after it are moved and keep their journal and intake
 tError countryTable_remove(tCountryTable* table, tCountry* country);
 
 // Get country by name
@@ -121,4 +220,41 @@ int countryTable_num_authorized(tCountryTable* table);
 // Add an authorized country to a vaccine
 tError countryTable_add_authorized_vaccine(tCountryTable* table, const char* country_name,tVaccine* vac);
 
+// Write the doses given to the patients of all the countries of the table to a journal, or stop with NULL.
+// Countries added later need country_setJournal
+tError countryTable_setJournal(tCountryTable* table, tJournal* journal);
+
+// Give again the doses of a journal to the patients of the table, usually loaded from the snapshot taken before the journal.
+// The doses that the patients already have are skipped
+tError countryTable_replayJournal(tCountryTable* table, const char* filename, tJournalReplayReport* report);
+
+// Give the first and second doses of a round to the patients of all the countries, using nthreads threads
+tError countryTable_inoculate_all(tCountryTable* table, unsigned int nthreads);
+
+// Compute the statistics of all the countries of a table with one pass over them, using nthreads threads
+tError countryTable_stats(tCountryTable* table, unsigned int nthreads, tCountryTableStats* stats);
+
+// Release the memory used by the statistics of a table
+void countryTableStats_free(tCountryTableStats* stats);
+
+// Get the percentage of vaccinated patients of a set of countries
+double countryCoverage_percentage(const tCountryCoverage* coverage);
+
+// **** Functions related to management of tCountryIndex objects
+
+// Initialize an empty index
+void countryIndex_init(tCountryIndex* index);
+
+// Release the memory used by the index
+void countryIndex_free(tCountryIndex* index);
+
+// Add the country stored at the given position of the table to the index
+tError countryIndex_add(tCountryIndex* index, tCountryTable* table, int position);
+
+// Get the position in the table of the country with the given name, or -1 if not found
+int countryIndex_find(tCountryIndex* index, tCountryTable* table, const char* name);
+
+// Build the index again from all the elements of the table
+tError countryIndex_rebuild(tCountryIndex* index, tCountryTable* table);
+
 #endif // __COUNTRY__H__
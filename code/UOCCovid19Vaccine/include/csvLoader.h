@@ -0,0 +1,68 @@
+#ifndef __CSV_LOADER_H__
+#define __CSV_LOADER_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "error.h"
+#include "country.h"
+
+// Default size of the chunks read from a CSV file
+#define CSV_LOADER_BUFFER_SIZE (4 * 1024 * 1024)
+
+// Maximum number of fields of a row
+#define CSV_LOADER_MAX_FIELDS 8
+
+// Kinds of rows of a CSV file. The first field of each row is its kind:
+//   COUNTRY,name,isEU
+//   VACCINE,country,name,tec,phase
+//   PATIENT,country,id,name,group,doses,vaccine,lotID
+//   BATCH,country,lotID,vaccine,quantity
+// Empty lines and lines starting with '#' are skipped
+typedef enum {
+    CSV_COUNTRY,
+    CSV_VACCINE,
+    CSV_PATIENT,
+    CSV_BATCH,
+    CSV_ROW_KINDS
+} tCsvRowKind;
+
+// Options of a load
+typedef struct {
+    // Bytes read from the file each time
+    size_t bufferSize;
+    // Store the patients of the new countries in an arena
+    bool useArenas;
+} tCsvLoadOptions;
+
+// Result of a load
+typedef struct {
+    // Rows loaded of each kind
+    unsigned long rows[CSV_ROW_KINDS];
+    // Rows that could not be loaded
+    unsigned long rejected;
+    // Line of the first rejected row, or 0 if no row was rejected
+    unsigned long firstRejectedLine;
+    // Error of the first rejected row
+    tError firstError;
+    // Lines and bytes read
+    unsigned long lines;
+    size_t bytes;
+    // Time used by the load
+    double seconds;
+} tCsvLoadReport;
+
+// **** Functions related to the CSV loader
+
+// Get the default options of a load
+void csvLoader_defaultOptions(tCsvLoadOptions* options);
+
+// Load the rows of a CSV file into a table of countries. Rows that can not be loaded are counted in the report
+tError csvLoader_loadFile(tCountryTable* table, const char* filename, const tCsvLoadOptions* options, tCsvLoadReport* report);
+
+// Get the rows loaded per second
+double csvLoader_rowsPerSecond(const tCsvLoadReport* report);
+
+// Print the result of a load
+void csvLoader_printReport(const tCsvLoadReport* report);
+
+#endif // __CSV_LOADER_H__
@@ -0,0 +1,55 @@
+#ifndef __ELIGIBILITY__H__
+#define __ELIGIBILITY__H__
+
+#include <stdbool.h>
+#include "error.h"
+#include "vaccine.h"
+#include "patient.h"
+
+// Doses needed by the vaccines without a rule
+#define ELIGIBILITY_DEFAULT_DOSES 2
+
+// Maximum length of a rule
+#define ELIGIBILITY_MAX_RULE 256
+
+// Eligibility rules of the vaccines, indexed by vaccine id. A rule is a line with the
+// vaccine name, the doses needed and the groups that can not get the vaccine:
+//   AZD1222;2;ADULT_OVER_65,COMORBID
+// Vaccines without a rule are suitable for any group and need ELIGIBILITY_DEFAULT_DOSES doses
+typedef struct {
+    // The default rules have been loaded
+    bool ready;
+    // Number of vaccine ids in the tables. Higher ids have no rule
+    unsigned int count;
+    // Bit g is set if the vaccine is not suitable for the patients of group g
+    unsigned int* excluded;
+    // Doses needed to be fully vaccinated
+    int* doses;
+    // Changes every time a rule is set or the rules are released
+    unsigned int version;
+} tEligibilityRules;
+
+// **** Functions related to the eligibility rules
+
+// Load the default rules. Does nothing if they are already loaded
+tError eligibility_init(void);
+
+// Release the memory used by the rules. The default rules are loaded again when needed
+void eligibility_free(void);
+
+// Add a rule, replacing the previous rule of the same vaccine
+tError eligibility_parseRule(const char* rule);
+
+// Load the rules of a file, one per line. Empty lines and lines starting with # are skipped
+tError eligibility_load(const char* filename);
+
+// Returns true if the vaccine can be inoculated to the patients of a group
+bool eligibility_isSuitable(tVaccineId id, tPatientGroup group);
+
+// Get the doses of a vaccine needed to be fully vaccinated
+int eligibility_dosesRequired(tVaccineId id);
+
+// Get the version of the rules. The counters that depend on the rules are valid while it does not change
+unsigned int eligibility_version(void);
+
+#endif // __ELIGIBILITY__H__
@@ -0,0 +1,103 @@
+#ifndef __GENERATOR_H__
+#define __GENERATOR_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "error.h"
+#include "patient.h"
+#include "vaccinationBatch.h"
+#include "country.h"
+
+// Seed of the default options
+#define GENERATOR_DEFAULT_SEED 20210101u
+
+// Vaccines of the mix of the batches: the known vaccines of the catalogue, by id
+#define GENERATOR_VACCINES 4
+
+// Longest name of a patient
+#define GENERATOR_NAME_LENGTH 64
+
+// Length of the names of the countries, as Country_0000
+#define GENERATOR_COUNTRY_NAME_LENGTH 20
+
+// Size of the buffer used to write a file
+#define GENERATOR_BUFFER_SIZE (1024 * 1024)
+
+// Random numbers of a generator (splitmix64). The same seed gives the same numbers
+typedef struct {
+    uint64_t state;
+} tGeneratorRandom;
+
+// Discrete distribution sampled in constant time with the alias method
+typedef struct {
+    unsigned int count;
+    // Probability of keeping each column instead of taking its alias, scaled to 2^32
+    uint32_t* threshold;
+    unsigned int* alias;
+} tGeneratorAlias;
+
+// Shape of the data of a generator
+typedef struct {
+    uint64_t seed;
+    unsigned int countries;
+    // Percentage of the countries that are in the EU
+    unsigned int euPercentage;
+    // Exponent of the Zipf law of the sizes of the countries. With 0 all the countries have the same size
+    double zipf;
+    // Weight of each group in the patients
+    double groups[PATIENT_GROUPS];
+    // Weight of each known vaccine in the batches
+    double vaccines[GENERATOR_VACCINES];
+    // Lengths of the names of the patients, taken uniformly from the range
+    unsigned int nameLengthMin;
+    unsigned int nameLengthMax;
+    // Doses of the batches, taken uniformly from the range
+    unsigned int lotSizeMin;
+    unsigned int lotSizeMax;
+} tGeneratorOptions;
+
+// Generator of patients and batches
+typedef struct {
+    tGeneratorOptions options;
+    tGeneratorRandom random;
+    tGeneratorAlias countries;
+    tGeneratorAlias groups;
+    tGeneratorAlias vaccines;
+    // Patients and batches generated for each country. The ids of the patients and the lots follow them
+    unsigned int* patients;
+    unsigned int* batches;
+    // Name of the last patient. The letters are written in words of 8
+    char name[GENERATOR_NAME_LENGTH + 8];
+} tGenerator;
+
+// **** Functions related to generators
+
+// Get the default options of a generator: 64 countries with a Zipf law of exponent 1 and a realistic mix of groups
+void generator_defaultOptions(tGeneratorOptions* options);
+
+// Initialize a generator
+tError generator_init(tGenerator* generator, const tGeneratorOptions* options);
+
+// Release the memory used by a generator
+void generator_free(tGenerator* generator);
+
+// Get the name of a country of a generator
+void generator_countryName(unsigned int country, char* name);
+
+// Tell if a country of a generator is in the EU
+bool generator_isEU(const tGenerator* generator, unsigned int country);
+
+// Get the next patient and its country. The patient has no doses. Its name is valid until the next patient
+unsigned int generator_nextPatient(tGenerator* generator, tPatient* patient);
+
+// Get the next batch and its country. The batch points to a vaccine of the catalogue
+unsigned int generator_nextBatch(tGenerator* generator, tVaccineBatch* batch);
+
+// Add the countries of the generator to a table, and the given number of patients and batches to them
+tError generator_fillTable(tGenerator* generator, tCountryTable* table, unsigned int patients, unsigned int batches);
+
+// Write the countries, patients and batches to a file in the format of csvLoader_loadFile
+tError generator_writeFile(tGenerator* generator, const char* filename, unsigned int patients, unsigned int batches);
+
+#endif // __GENERATOR_H__
@@ -0,0 +1,89 @@
+#ifndef __INSTRUMENT_H__
+#define __INSTRUMENT_H__
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// Functions counted when the library is built with UOC_INSTRUMENT
+typedef enum {
+    INSTRUMENT_QUEUE_ENQUEUE,
+    INSTRUMENT_QUEUE_DEQUEUE,
+    INSTRUMENT_PATIENT_DUPLICATE,
+    INSTRUMENT_BATCH_LIST_GET,
+    INSTRUMENT_BATCH_LIST_SWAP,
+    INSTRUMENT_BATCH_INOCULATE_FIRST,
+    INSTRUMENT_BATCH_INOCULATE_SECOND,
+    INSTRUMENT_COUNTRY_INOCULATE_FIRST,
+    INSTRUMENT_COUNTRY_INOCULATE_FIRST_ORDERED,
+    INSTRUMENT_COUNTRY_INOCULATE_SECOND,
+    INSTRUMENT_MALLOC,
+    INSTRUMENT_CALLOC,
+    INSTRUMENT_REALLOC,
+    INSTRUMENT_FREE,
+    INSTRUMENT_COUNTERS
+} tInstrumentCounter;
+
+// Values of the counters at a moment
+typedef struct {
+    // Calls of each function
+    unsigned long long calls[INSTRUMENT_COUNTERS];
+    // Time spent in each function, including the functions it calls
+    unsigned long long nanoseconds[INSTRUMENT_COUNTERS];
+    // Bytes asked to malloc, calloc and realloc
+    unsigned long long bytes;
+} tInstrumentSnapshot;
+
+#ifdef UOC_INSTRUMENT
+
+// Measure the time of a call, from INSTRUMENT_START to INSTRUMENT_STOP
+#define INSTRUMENT_START(start) uint64_t start = instrument_now()
+#define INSTRUMENT_STOP(counter, start) instrument_add(counter, instrument_now() - (start))
+#define INSTRUMENT_STOP_MEMORY(counter, start, size) instrument_addMemory(counter, instrument_now() - (start), size)
+
+#else
+
+// Without UOC_INSTRUMENT the counters cost nothing
+#define INSTRUMENT_START(start) ((void)0)
+#define INSTRUMENT_STOP(counter, start) ((void)0)
+#define INSTRUMENT_STOP_MEMORY(counter, start, size) ((void)0)
+
+#endif // UOC_INSTRUMENT
+
+// **** Functions related to the instrumentation
+
+// Tell if the library is built with the counters
+bool instrument_enabled(void);
+
+// Get the current time in nanoseconds
+uint64_t instrument_now(void);
+
+// Count a call to a function and the time it took. It can be called from many threads at once
+void instrument_add(tInstrumentCounter counter, uint64_t elapsed);
+
+// Count a call to the allocator, the time it took and the bytes asked
+void instrument_addMemory(tInstrumentCounter counter, uint64_t elapsed, size_t size);
+
+// Get the values of the counters. They are all 0 without UOC_INSTRUMENT
+void instrument_snapshot(tInstrumentSnapshot* snapshot);
+
+// Set all the counters to 0
+void instrument_reset(void);
+
+// Get the counters between two snapshots
+void instrument_diff(const tInstrumentSnapshot* before, const tInstrumentSnapshot* after, tInstrumentSnapshot* diff);
+
+// Get the name of a counter
+const char* instrument_name(tInstrumentCounter counter);
+
+// Get the memory blocks asked to the allocator in a snapshot
+unsigned long long instrumentSnapshot_allocations(const tInstrumentSnapshot* snapshot);
+
+// Print the counters of a snapshot as a table
+void instrumentSnapshot_print(const tInstrumentSnapshot* snapshot);
+
+// Write the counters of a snapshot in JSON format
+void instrumentSnapshot_export(const tInstrumentSnapshot* snapshot, FILE* fout);
+
+#endif // __INSTRUMENT_H__
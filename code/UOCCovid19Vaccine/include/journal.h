@@ -0,0 +1,179 @@
+#ifndef __JOURNAL_H__
+#define __JOURNAL_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <pthread.h>
+#include "error.h"
+#include "patient.h"
+
+// Magic number at the start of the journal files
+#define JOURNAL_MAGIC "UOCJRNL"
+
+// Version of the format of the journal files. Files of other versions are rejected
+#define JOURNAL_VERSION 1
+
+// Magic number at the start of each frame
+#define JOURNAL_FRAME_MAGIC 0x4D415246u
+
+// Default bytes of records of a frame
+#define JOURNAL_BUFFER_SIZE (1024 * 1024)
+
+// Largest frame accepted by the replay
+#define JOURNAL_MAX_FRAME (64 * 1024 * 1024)
+
+// Kinds of records of a journal
+typedef enum {
+    // A name for the ids of the countries, followed by the name
+    JOURNAL_COUNTRY = 1,
+    // A name for the ids of the vaccines, followed by the name
+    JOURNAL_VACCINE = 2,
+    // A dose given to a patient
+    JOURNAL_DOSE = 3
+} tJournalRecordKind;
+
+// Header of a journal file. Frames follow it, each one with the records of one commit
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+} tJournalHeader;
+
+// Header of a frame. A frame that is not complete or does not match its checksum ends the journal
+typedef struct {
+    uint32_t magic;
+    // Bytes of records of the frame
+    uint32_t size;
+    // snapshot_checksum of the records
+    uint64_t checksum;
+} tJournalFrameHeader;
+
+// Record of a name of a country or a vaccine. The name follows it, with its '\0'
+typedef struct {
+    uint8_t kind;
+    uint8_t unused;
+    // Bytes of the name, including the '\0'
+    uint16_t length;
+    int32_t id;
+} tJournalName;
+
+// Record of a dose
+typedef struct {
+    uint8_t kind;
+    // Number of doses of the patient after this one
+    uint8_t dose;
+    // Id of the vaccine in the catalogue of the process that wrote the journal
+    int16_t vaccine;
+    uint32_t country;
+    int32_t patient;
+    int32_t lotID;
+} tJournalDose;
+
+// Options of a journal
+typedef struct {
+    // Bytes of the buffer. The buffer is written as a frame when it is full or when the journal is committed
+    size_t bufferSize;
+    // Frames written between two calls to fsync. With 0, fsync is only called by journal_sync and journal_close
+    unsigned int syncFrames;
+} tJournalOptions;
+
+// Counters of a journal
+typedef struct {
+    unsigned long doses;
+    unsigned long frames;
+    unsigned long syncs;
+    size_t bytes;
+} tJournalReport;
+
+// Journal of the doses given, written ahead to a file
+typedef struct {
+    FILE* fout;
+    unsigned char* buffer;
+    size_t used;
+    size_t size;
+    unsigned int syncFrames;
+    // Frames written since the last fsync
+    unsigned int unsynced;
+    // Countries with a name in the journal. Their ids go from 0 to countries - 1
+    unsigned int countries;
+    // Vaccines of the catalogue with a name in the journal, indexed by id
+    bool* vaccines;
+    unsigned int vaccinesCount;
+    tJournalReport report;
+    // The countries of a table can be inoculated by many threads that share the journal
+    pthread_mutex_t lock;
+} tJournal;
+
+// Journal file being read, one frame at a time
+typedef struct {
+    FILE* fin;
+    // Records of the current frame
+    unsigned char* buffer;
+    size_t allocated;
+    size_t size;
+    size_t position;
+    // Frames read
+    unsigned long frames;
+    // The last frame is not complete, or does not match its checksum
+    bool truncated;
+} tJournalReader;
+
+// Record read from a journal
+typedef struct {
+    tJournalRecordKind kind;
+    // Data of a JOURNAL_DOSE record
+    tJournalDose dose;
+    // Data of a JOURNAL_COUNTRY or JOURNAL_VACCINE record, and the name. The name is valid until the next record
+    tJournalName name;
+    const char* text;
+} tJournalRecord;
+
+// Result of a replay
+typedef struct {
+    unsigned long frames;
+    // Doses applied to the patients
+    unsigned long applied;
+    // Doses of patients that are not found or that already have them
+    unsigned long skipped;
+    // The journal ends with a frame that is not complete, as left by a crash
+    bool truncated;
+} tJournalReplayReport;
+
+// **** Functions related to journals
+
+// Get the default options of a journal
+void journal_defaultOptions(tJournalOptions* options);
+
+// Create a new journal file, replacing the old one. Take a snapshot before, the journal holds the doses given after it
+tError journal_open(tJournal* journal, const char* filename, const tJournalOptions* options);
+
+// Write the pending records and release the journal
+tError journal_close(tJournal* journal);
+
+// Get the id of a country for the doses of the journal, writing its name
+tError journal_addCountry(tJournal* journal, const char* name, unsigned int* id);
+
+// Add the last dose given to a patient, from a batch with the given lot
+tError journal_appendDose(tJournal* journal, unsigned int country, const tPatient* patient, int lotID);
+
+// Write the pending records as a frame. The frame is synced to disk as set by the options
+tError journal_commit(tJournal* journal);
+
+// Write the pending records and sync the file to disk
+tError journal_sync(tJournal* journal);
+
+// Get the counters of a journal
+void journal_report(const tJournal* journal, tJournalReport* report);
+
+// Open a journal file to read its records
+tError journalReader_open(tJournalReader* reader, const char* filename);
+
+// Get the next record of the journal. Returns ERR_EMPTY at the end of the journal, and ERR_INVALID if a record is wrong
+tError journalReader_next(tJournalReader* reader, tJournalRecord* record);
+
+// Release a journal reader
+void journalReader_close(tJournalReader* reader);
+
+#endif // __JOURNAL_H__
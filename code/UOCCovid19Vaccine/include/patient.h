@@ -2,8 +2,11 @@
 #define __PATIENT_H__
 
 #include <stdbool.h>
+#include <stdint.h>
 #include <vaccine.h>
 #include "error.h"
+#include "arena.h"
+#include "allocator.h"
 
 // Patient poblational group
 typedef enum {
@@ -20,7 +23,11 @@ typedef enum {
 typedef struct {
     char* name;
     int id;
+    // Name of the vaccine. It points to the name stored in the vaccine catalogue, so
+    // it is shared with other patients and must not be freed.
     char* vaccine;
+    // Id of the vaccine in the vaccine catalogue, or NO_VACCINE_ID
+    tVaccineId vaccineId;
 	int lotID;
     int number_doses;
     tPatientGroup group;
@@ -31,23 +38,229 @@ typedef struct {
 typedef struct _tPatientQueueNode {
     tPatient e;
     struct _tPatientQueueNode* next;
+    // Hash of the patient for the fingerprint of the queue
+    uint64_t hash;
 } tPatientQueueNode;
 
 
+// Number of patients stored in each chunk of a chunked queue
+#define PATIENT_QUEUE_CHUNK_SIZE 256
+
+// Size of the blocks of the arena where a chunked queue without arena stores the names of its patients
+#define PATIENT_QUEUE_NAMES_BLOCK_SIZE (64 * 1024)
+
+// Definition of a chunk of a chunked queue: a fixed size block of contiguous patients
+typedef struct _tPatientQueueChunk {
+    tPatient elements[PATIENT_QUEUE_CHUNK_SIZE];
+    struct _tPatientQueueChunk* next;
+    // Hashes of the patients for the fingerprint of the queue
+    uint64_t hashes[PATIENT_QUEUE_CHUNK_SIZE];
+} tPatientQueueChunk;
+
+// Number of dose counters of the queue statistics. The last one counts the patients
+// with that number of doses or more
+#define PATIENT_QUEUE_DOSE_COUNTERS 3
+
+// Number of patient groups
+#define PATIENT_GROUPS (ANYONE_ELSE + 1)
+
+// Counters of the patients of a queue, kept up to date by the queue operations
+typedef struct {
+    // Patients per number of doses
+    unsigned int doses[PATIENT_QUEUE_DOSE_COUNTERS];
+    // Patients that have been fully vaccinated
+    unsigned int vaccinated;
+    // Patients per poblational group
+    unsigned int groups[PATIENT_GROUPS];
+    // Patients per vaccine, indexed by the vaccine catalogue id
+    unsigned int* vaccines;
+    // Length of the vaccines array
+    unsigned int vaccinesCount;
+    // Version of the eligibility rules used to count the vaccinated patients
+    unsigned int rulesVersion;
+} tPatientQueueStats;
+
+// Storage used by a queue of patients
+typedef enum {
+    // One node per patient (first / last)
+    PATIENT_QUEUE_LINKED = 0,
+    // Chunks of PATIENT_QUEUE_CHUNK_SIZE patients (firstChunk / lastChunk)
+    PATIENT_QUEUE_CHUNKED = 1
+} tPatientQueueBackend;
+
+// Base of the fingerprint of the queues and its inverse modulo 2^64. The base is odd, so it has an inverse
+#define PATIENT_FINGERPRINT_BASE 0x9E3779B97F4A7C15ull
+#define PATIENT_FINGERPRINT_INVERSE 0xF1DE83E19937733Dull
+
+// Order-sensitive hash of the names and ids of the patients of a queue. With h(k) the hash of
+// the patient at position k from the head, hash is the sum of h(k) * base^k modulo 2^64
+typedef struct {
+    uint64_t hash;
+    // base^size, the weight of the next patient enqueued
+    uint64_t power;
+    // The hash has to be computed again from the patients before being used
+    bool dirty;
+} tPatientQueueFingerprint;
+
+// Id of the empty entries of the id index. The ids of the patients are positive
+#define PATIENT_QUEUE_NO_ID 0
+
+// Entries of a region of the id index. When the index is filled at once, the patients are placed region by region
+#define PATIENT_QUEUE_ID_REGION_SIZE 4096
+
+// Most regions that the patients are grouped in when the id index is filled at once
+#define PATIENT_QUEUE_ID_REGIONS 1024
+
+// Entry of the id index of a queue
+typedef struct {
+    // Linked queues: node before the patient, or NULL for the first one. Chunked queues: the patient
+    void* slot;
+    int id;
+    // Order of arrival, to find the first patient of the queue when several have the same id
+    unsigned int sequence;
+} tPatientQueueIdEntry;
+
+// Open addressing index from the ids of the patients to their place in a queue
+typedef struct {
+    // The queue keeps the index up to date. The entries are allocated with the first patient
+    bool enabled;
+    // Number of entries. It is zero or a power of two
+    unsigned int capacity;
+    // Number of used entries
+    unsigned int count;
+    // Sequence of the next patient
+    unsigned int sequence;
+    tPatientQueueIdEntry* entries;
+} tPatientQueueIdIndex;
+
 // Definition of a queue of patients
 typedef struct {
+    tPatientQueueBackend backend;
+    // Nodes of a linked queue
     tPatientQueueNode* first;
     tPatientQueueNode* last;
+    // Chunks of a chunked queue. The patients go from position head of firstChunk
+    // to the position before tail of lastChunk. The chunk emptied last by dequeue
+    // is kept in spareChunk, to be reused by the next enqueue that needs a chunk.
+    // Patients removed by id from the middle of the queue are left without name.
+    tPatientQueueChunk* firstChunk;
+    tPatientQueueChunk* lastChunk;
+    tPatientQueueChunk* spareChunk;
+    unsigned int head;
+    unsigned int tail;
+    // Number of patients in the queue
+    unsigned int size;
+    // Counters of the patients in the queue
+    tPatientQueueStats stats;
+    // Hash used to compare queues quickly
+    tPatientQueueFingerprint fingerprint;
+    // Arena where the nodes, chunks and names of the patients are stored, or NULL to use malloc.
+    // The arena is not owned by the queue
+    tArena* arena;
+    // Arena owned by a chunked queue without arena, where the names of its patients are stored, or NULL
+    tArena* names;
+    // Index to find the patients by id
+    tPatientQueueIdIndex ids;
+    // Changes when a patient starts waiting for the first dose: enqueued without doses or updated back to
+    // zero doses. The generations of two queues never match
+    uint64_t generation;
+    // The patient between patientQueue_beginUpdate and patientQueue_endUpdate had no doses
+    bool updateWaiting;
+    // Allocator of the memory of the queue, the one of the thread that created it
+    const tAllocator* allocator;
 } tPatientQueue;
 
+// Iterator to read the patients of a queue in order, for both storages
+typedef struct {
+    tPatientQueue* queue;
+    tPatientQueueNode* node;
+    tPatientQueueChunk* chunk;
+    unsigned int position;
+} tPatientQueueIterator;
+
+// Cursor to walk the patients of a queue in order and modify them in place
+typedef struct {
+    tPatientQueueIterator it;
+    // Patient returned last. It is not in the statistics of the queue until the cursor moves
+    tPatient* current;
+    // First error found updating the statistics of the queue
+    tError error;
+} tPatientQueueCursor;
+
+// Tells if a patient takes part in an aggregation. The data is given by the aggregation
+typedef bool (*tPatientPredicate)(const tPatient* patient, const void* data);
+
+// Adds a patient to the result of an aggregation
+typedef void (*tPatientAccumulator)(const tPatient* patient, void* result);
+
+// Aggregation computed by patientQueue_aggregate
+typedef struct {
+    // Patients to aggregate, or NULL for all of them
+    tPatientPredicate predicate;
+    const void* data;
+    // Function called for each patient that matches, or NULL to count them only
+    tPatientAccumulator accumulator;
+    void* result;
+    // Number of patients that match
+    unsigned int count;
+} tPatientAggregation;
+
+// Data of patient_matchesBatch
+typedef struct {
+    tVaccineId vaccineId;
+    int lotID;
+} tPatientBatchFilter;
+
+// Data of patient_matchesTechnology
+typedef struct {
+    tVaccineTable* vaccines;
+    tVaccineTec technology;
+} tPatientTechnologyFilter;
+
+// Result of patient_accumulateVaccine: patients per vaccine, indexed by the vaccine catalogue id
+typedef struct {
+    unsigned int* counts;
+    unsigned int size;
+} tPatientVaccineHistogram;
+
+// FIFO of patient ids, stored in a circular array
+typedef struct {
+    int* elements;
+    // Position of the first id
+    unsigned int head;
+    unsigned int size;
+    // Allocated length of the elements array. It is zero or a power of two
+    unsigned int allocated;
+} tPatientIdQueue;
+
+// Priority queue of patients: one FIFO per group, served in the order of tPatientGroup.
+// The patients are referenced by id, they are stored in a patient queue
+typedef struct {
+    tPatientIdQueue groups[PATIENT_GROUPS];
+    // Bit g is set if the FIFO of group g is not empty
+    unsigned int mask;
+    // Number of patients in all the groups
+    unsigned int size;
+} tPatientPriorityQueue;
+
+
 // *** PATIENT
 
 // Initialize a patient structure
 tError patient_init(tPatient *patient, const char* patientName, int patientId, const char* vaccine, int lotID, int number_doses, tPatientGroup group);
 
+// Get the name of a patient group, as written in files
+const char* patient_groupName(tPatientGroup group);
+
+// Get the group with the given name, as given by patient_groupName
+tError patient_groupFromName(const char* name, tPatientGroup* group);
+
 // inoculate a vaccine to a patient
 tError patient_inoculate_vaccine(tPatient* patient, const char* vaccine, int lotID);
 
+// inoculate a vaccine of the vaccine catalogue to a patient
+tError patient_inoculate_vaccineId(tPatient* patient, tVaccineId vaccineId, int lotID);
+
 // Compare two patients
 bool patient_compare(tPatient p1, tPatient p2);
 
@@ -61,13 +274,34 @@ void patient_free(tPatient* patient);
 bool patient_isSuitableForVaccine(tPatient* patient, tVaccine* vaccine);
 
 // Returns true if the patient has been fully vaccinated
-bool patient_isVaccinated(tPatient* patient);
+bool patient_isVaccinated(const tPatient* patient);
+
+// Predicate of aggregations: the patient has the vaccine with the id pointed by data
+bool patient_matchesVaccine(const tPatient* patient, const void* data);
+
+// Predicate of aggregations: the patient got a dose of the batch given by a tPatientBatchFilter
+bool patient_matchesBatch(const tPatient* patient, const void* data);
+
+// Predicate of aggregations: the patient has a vaccine of the table and technology given by a tPatientTechnologyFilter
+bool patient_matchesTechnology(const tPatient* patient, const void* data);
+
+// Accumulator of aggregations: count the patient in its vaccine of a tPatientVaccineHistogram
+void patient_accumulateVaccine(const tPatient* patient, void* result);
+
+// Accumulator of aggregations: count the patient in its group of an array of PATIENT_GROUPS counters
+void patient_accumulateGroup(const tPatient* patient, void* result);
 
 // *** PATIENT QUEUE
 
 // Create the patient queue
 tError patientQueue_create(tPatientQueue* queue);
 
+// Create the patient queue using chunks of contiguous patients as storage
+tError patientQueue_createChunked(tPatientQueue* queue);
+
+// Get the number of patients in the queue
+unsigned int patientQueue_size(tPatientQueue queue);
+
 // Check if the queue is empty
 bool patientQueue_empty(tPatientQueue queue);
 
@@ -77,16 +311,49 @@ tError patientQueue_enqueue(tPatientQueue* queue, tPatient patient);
 // Make a copy of the queue
 tError patientQueue_duplicate(tPatientQueue* dst, tPatientQueue src);
 
+// Enqueue a copy of all the patients of src at the tail of dst
+tError patientQueue_enqueueAll(tPatientQueue* dst, tPatientQueue* src);
+
+// Store the patients of an empty queue in an arena. The memory goes back to the system with the arena
+tError patientQueue_useArena(tPatientQueue* queue, tArena* arena);
+
+// Keep an index of the ids of the patients of the queue, to find them without walking the queue
+tError patientQueue_enableIdIndex(tPatientQueue* queue);
+
+// Stop keeping the index of the ids of the patients of the queue. patientQueue_enableIdIndex fills it again in one pass,
+// which is faster than keeping it while many patients are enqueued
+void patientQueue_disableIdIndex(tPatientQueue* queue);
+
+// Make room in the id index for count more patients, so that it does not grow while they are enqueued
+tError patientQueue_reserve(tPatientQueue* queue, unsigned int count);
+
+// Get the first patient of the queue with the given id, or NULL. Change it only with patientQueue_updateById
+tPatient* patientQueue_findById(tPatientQueue* queue, int id);
+
+// Replace the data of the first patient of the queue with the given id, keeping its place in the queue
+tError patientQueue_updateById(tPatientQueue* queue, int id, tPatient patient);
+
+// Remove from the queue the first patient with the given id
+tError patientQueue_removeById(tPatientQueue* queue, int id);
+
 // Remove all elements of the queue
 void patientQueue_free(tPatientQueue* queue);
 
-// Dequeue a patient from the presentation queue
+// Dequeue a patient from the presentation queue. It is released with patient_free and free, or with
+// patientQueue_release when the allocator of the thread is not the one of the queue
 tPatient * patientQueue_dequeue(tPatientQueue* queue);
 
+// Release a patient given by patientQueue_dequeue, releasing its name with the allocator of its queue
+void patientQueue_release(tPatientQueue* queue, tPatient* patient);
+
+// Dequeue a patient into the given one, that owns its name afterwards and is released with patient_free.
+// Returns ERR_EMPTY if the queue has no patients
+tError patientQueue_dequeueInto(tPatientQueue* queue, tPatient* patient);
+
 // Return the first patient from the queue
 tPatient* patientQueue_head(tPatientQueue queue);
 
-// create a copy of the queues before calling  patientQueue_compareRecursive
+// compare if two queues are equal. Queues with different size or fingerprint are rejected in O(1)
 bool patientQueue_compare(tPatientQueue *queue1, tPatientQueue *queue2);
 
 // compare if two queues are equal iteratively,
@@ -95,10 +362,10 @@ bool patientQueue_compareIterative(tPatientQueue *queue1, tPatientQueue *queue2)
 // compare if two queues are equal recursively.
 bool patientQueue_compareRecursive(tPatientQueue *queue1, tPatientQueue *queue2);
 
-// count how many patients already vaccinated with a vaccine technology
+// count how many patients already vaccinated with a vaccine technology. The queue is not modified
 int patientQueue_getPatientsPerVaccineTechnologyRecursive(tPatientQueue *queue, tVaccineTable vaccines, tVaccineTec technology);
 
-// count how many patients already vaccinated with a vaccine
+// count how many patients already vaccinated with a vaccine. The queue is not modified
 int patientQueue_getPatientsPerVaccineRecursive(tPatientQueue *queue, const char* vaccine);
 
 int patientQueue_countPatients_vaccinationBatch(tPatientQueue queue, const char* vaccine,int lotID);
@@ -107,6 +374,85 @@ int patientQueue_countPatients_vaccinationBatch(tPatientQueue queue, const char*
 // print all the information of a patient queue in the console
 void patientQueue_print(tPatientQueue queue);
 
+// Place the iterator before the first patient of the queue
+void patientQueue_iterator(tPatientQueue* queue, tPatientQueueIterator* it);
+
+// Get the next patient of the iterator, or NULL when all the patients have been read
+const tPatient* patientQueue_next(tPatientQueueIterator* it);
+
+// Place the cursor before the first patient of the queue
+void patientQueue_cursor(tPatientQueue* queue, tPatientQueueCursor* cursor);
+
+// Move the cursor to the next patient and get it to be modified in place, or NULL at the end of the queue.
+// The name and id of the patient must not be modified.
+tPatient* patientQueue_cursorNext(tPatientQueueCursor* cursor);
+
+// Finish a walk with the cursor, updating the statistics of the last patient. Returns the first error of the walk
+tError patientQueue_cursorClose(tPatientQueueCursor* cursor);
+
+// Remove a patient of the queue from the statistics, before modifying it in place
+void patientQueue_beginUpdate(tPatientQueue* queue, const tPatient* patient);
+
+// Add a patient of the queue to the statistics again, after modifying it in place
+tError patientQueue_endUpdate(tPatientQueue* queue, const tPatient* patient);
+
+// Get the counters of the patients of the queue
+const tPatientQueueStats* patientQueue_stats(tPatientQueue* queue);
+
+// Get the generation of the queue, that changes when a patient starts waiting for the first dose
+uint64_t patientQueue_generation(const tPatientQueue* queue);
+
+// Get the number of patients of the queue with the given number of doses. The last dose
+// counter also includes the patients with more doses
+unsigned int patientQueue_countDoses(tPatientQueue* queue, int number_doses);
+
+// Get the number of patients of the queue vaccinated with the given vaccine
+unsigned int patientQueue_countVaccine(tPatientQueue* queue, tVaccineId vaccineId);
+
+// Compute several aggregations walking the queue once, without copying or modifying it
+void patientQueue_aggregate(tPatientQueue* queue, tPatientAggregation* aggregations, unsigned int count);
+
+// Get the fingerprint of the queue. Equal queues have equal fingerprints
+uint64_t patientQueue_fingerprint(tPatientQueue* queue);
+
+// Mark the fingerprint as outdated. Call it after changing the name or id of patients of the queue directly
+void patientQueue_invalidateFingerprint(tPatientQueue* queue);
+
+// *** PATIENT PRIORITY QUEUE
+
+// Create an empty priority queue
+void patientPriorityQueue_create(tPatientPriorityQueue* queue);
+
+// Remove all the patients of the priority queue
+void patientPriorityQueue_free(tPatientPriorityQueue* queue);
+
+// Add a patient at the tail of the FIFO of its group
+tError patientPriorityQueue_enqueue(tPatientPriorityQueue* queue, const tPatient* patient);
+
+// Make room in the FIFO of a group for the given number of patients, so that they are enqueued without allocating
+tError patientPriorityQueue_reserve(tPatientPriorityQueue* queue, tPatientGroup group, unsigned int count);
+
+// Get the group with the highest priority that has patients, or -1 if the priority queue is empty
+int patientPriorityQueue_firstGroup(tPatientPriorityQueue* queue);
+
+// Get the group with the highest priority, starting at the given one, that has patients, or -1 if there is none
+int patientPriorityQueue_nextGroup(tPatientPriorityQueue* queue, int group);
+
+// Get the id of the first patient of a group, or PATIENT_QUEUE_NO_ID if the group has no patients
+int patientPriorityQueue_head(tPatientPriorityQueue* queue, tPatientGroup group);
+
+// Remove the first patient of a group, getting its id. Returns PATIENT_QUEUE_NO_ID if the group has no patients
+int patientPriorityQueue_dequeue(tPatientPriorityQueue* queue, tPatientGroup group);
+
+// Get the number of patients of the priority queue
+unsigned int patientPriorityQueue_size(tPatientPriorityQueue* queue);
+
+// Check if the priority queue is empty
+bool patientPriorityQueue_empty(tPatientPriorityQueue* queue);
+
+// Remove all the patients of the priority queue, keeping its memory
+void patientPriorityQueue_clear(tPatientPriorityQueue* queue);
+
 
 
 
@@ -0,0 +1,46 @@
+#ifndef __PATIENTINTAKE_H__
+#define __PATIENTINTAKE_H__
+
+#include <stdatomic.h>
+#include "error.h"
+#include "patient.h"
+#include "allocator.h"
+
+// A patient waiting in an intake. The name of the patient is stored after the node
+typedef struct _tPatientIntakeNode {
+    _Atomic(struct _tPatientIntakeNode*) next;
+    tPatient patient;
+} tPatientIntakeNode;
+
+// Intake of new patients from many threads, drained by a single thread. Producers never take a lock:
+// a push swaps the last node and links the old one to the new one (Vyukov's MPSC queue)
+typedef struct {
+    // Last node pushed. Written by the producers
+    _Atomic(tPatientIntakeNode*) head;
+    // First node not popped yet. Only used by the consumer
+    tPatientIntakeNode* tail;
+    // Empty node that keeps the queue linked when all the patients are popped
+    tPatientIntakeNode stub;
+    // Allocator of the nodes, the one of the thread that initialized the intake. It is used by all the threads
+    const tAllocator* allocator;
+} tPatientIntake;
+
+// **** Functions related to patient intakes
+
+// Initialize an empty intake. The intake can not be moved once initialized
+void patientIntake_init(tPatientIntake* intake);
+
+// Release the patients that are still in the intake. No producer can be pushing
+void patientIntake_free(tPatientIntake* intake);
+
+// Push a copy of a patient. It can be called from many threads at once
+tError patientIntake_push(tPatientIntake* intake, const tPatient* patient);
+
+// Pop the first patient of the intake, or NULL if it is empty or the next push is not linked yet.
+// Only one thread can pop. The node is released with patientIntake_release once the patient is used
+tPatientIntakeNode* patientIntake_pop(tPatientIntake* intake);
+
+// Release a node given by patientIntake_pop, with the allocator of the intake
+void patientIntake_release(tPatientIntake* intake, tPatientIntakeNode* node);
+
+#endif // __PATIENTINTAKE_H__
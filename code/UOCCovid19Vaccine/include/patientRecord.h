@@ -0,0 +1,92 @@
+#ifndef __PATIENT_RECORD_H__
+#define __PATIENT_RECORD_H__
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "error.h"
+#include "patient.h"
+
+// Maximum number of doses of a record
+#define PATIENT_RECORD_MAX_DOSES UINT8_MAX
+
+// Maximum vaccine id of a record
+#define PATIENT_RECORD_MAX_VACCINE INT16_MAX
+
+// Compact copy of a patient. The name is stored in a name heap shared by many records
+typedef struct {
+    uint32_t id;
+    uint8_t group;
+    uint8_t number_doses;
+    // Id of the vaccine in the vaccine catalogue, or NO_VACCINE_ID
+    int16_t vaccineId;
+    int32_t lotID;
+    // Position of the name in the name heap
+    uint32_t name;
+} tPatientRecord;
+
+// Names of the patients of many records, one after the other, each one ended by '\0'
+typedef struct {
+    char* data;
+    // Used bytes of data
+    size_t size;
+    // Allocated bytes of data
+    size_t allocated;
+} tPatientNameHeap;
+
+// Table of compact patients, with their names
+typedef struct {
+    tPatientRecord* elements;
+    unsigned int size;
+    unsigned int allocated;
+    tPatientNameHeap names;
+} tPatientRecordTable;
+
+// **** Functions related to patient records
+
+// Initialize an empty name heap
+void patientNameHeap_init(tPatientNameHeap* heap);
+
+// Release the memory used by a name heap
+void patientNameHeap_free(tPatientNameHeap* heap);
+
+// Copy a name at the end of the heap, getting its position
+tError patientNameHeap_add(tPatientNameHeap* heap, const char* name, uint32_t* position);
+
+// Get the name stored at a position of the heap
+const char* patientNameHeap_get(const tPatientNameHeap* heap, uint32_t position);
+
+// Fill a record with the data of a patient, copying its name to the heap
+tError patientRecord_fromPatient(tPatientRecord* record, tPatientNameHeap* heap, const tPatient* patient);
+
+// Initialize a patient with the data of a record. The patient has to be released with patient_free
+tError patientRecord_toPatient(const tPatientRecord* record, const tPatientNameHeap* heap, tPatient* patient);
+
+// Get the name of the patient of a record
+const char* patientRecord_name(const tPatientRecord* record, const tPatientNameHeap* heap);
+
+// Returns true if the patient of a record is fully vaccinated
+bool patientRecord_isVaccinated(const tPatientRecord* record);
+
+// Initialize an empty table of records
+void patientRecordTable_init(tPatientRecordTable* table);
+
+// Release the memory used by a table of records
+void patientRecordTable_free(tPatientRecordTable* table);
+
+// Add a patient at the end of the table
+tError patientRecordTable_add(tPatientRecordTable* table, const tPatient* patient);
+
+// Add all the patients of a queue at the end of the table, in the order of the queue
+tError patientRecordTable_addQueue(tPatientRecordTable* table, tPatientQueue* queue);
+
+// Get a copy of the patient at a position of the table. The patient has to be released with patient_free
+tError patientRecordTable_get(tPatientRecordTable* table, unsigned int index, tPatient* patient);
+
+// Get the number of records of the table
+unsigned int patientRecordTable_size(tPatientRecordTable* table);
+
+// Get the number of fully vaccinated patients of the table
+unsigned int patientRecordTable_countVaccinated(tPatientRecordTable* table);
+
+#endif // __PATIENT_RECORD_H__
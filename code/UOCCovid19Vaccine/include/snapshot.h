@@ -0,0 +1,60 @@
+#ifndef __SNAPSHOT_H__
+#define __SNAPSHOT_H__
+
+#include <stdint.h>
+#include "error.h"
+#include "country.h"
+
+// Magic number at the start of the snapshot files
+#define SNAPSHOT_MAGIC "UOCSNAP"
+
+// Version of the format of the snapshot files. Files of other versions are rejected
+#define SNAPSHOT_VERSION 1
+
+// Value written to check that a snapshot is read with the byte order it was written with
+#define SNAPSHOT_BYTE_ORDER 0x01020304u
+
+// Initial value of snapshot_checksum, the FNV-1a offset basis
+#define SNAPSHOT_CHECKSUM_SEED 0xcbf29ce484222325ull
+
+// Size of the buffer used to write a snapshot. It is a multiple of 8
+#define SNAPSHOT_BUFFER_SIZE (256 * 1024)
+
+// Header of a snapshot file. The payload follows it:
+//   uint32 number of countries, and for each country:
+//     string name, uint32 isEU
+//     uint32 number of authorized vaccines, and for each one: string name, int32 tec, int32 phase
+//     uint32 number of batches, and for each one: int32 lotID, int32 quantity, int32 vaccine id
+//     uint32 number of patients, padding to 8 bytes, the tPatientRecord of the patients,
+//     uint64 size of the name heap, the name heap, padding to 8 bytes
+//   at catalog: uint32 number of vaccines of the catalogue, and for each one: string name, int32 tec, int32 phase
+// Strings are a uint32 length, including the '\0', and the characters. Vaccine ids are positions in the catalogue section
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    // Bytes of the payload
+    uint64_t size;
+    // Position of the catalogue section in the payload
+    uint64_t catalog;
+    // snapshot_checksum of the payload
+    uint64_t checksum;
+} tSnapshotHeader;
+
+// **** Functions related to snapshots
+
+// FNV-1a hash of data, taken in 64 bit words and then in bytes for the last ones
+uint64_t snapshot_checksum(uint64_t hash, const void* data, size_t size);
+
+// Write all the countries of a table to a snapshot file. The file is replaced only when it is complete
+tError snapshot_save(tCountryTable* table, const char* filename);
+
+// Load the countries of a snapshot file into an empty table. The patients of each country are stored in an arena.
+// If the file is not valid, the table is left empty
+tError snapshot_load(tCountryTable* table, const char* filename);
+
+// Load the countries of a snapshot file into an empty table, adding the patients of the countries with nthreads threads.
+// The table is the same as with snapshot_load
+tError snapshot_loadParallel(tCountryTable* table, const char* filename, unsigned int nthreads);
+
+#endif // __SNAPSHOT_H__
@@ -0,0 +1,83 @@
+#ifndef __THREADPOOL_H__
+#define __THREADPOOL_H__
+
+#include <stdbool.h>
+#include <pthread.h>
+#include "error.h"
+
+// Largest number of threads of a pool
+#define THREAD_POOL_MAX_THREADS 256
+
+// Task run by a thread of a pool
+typedef void (*tThreadPoolTask)(void* arg);
+
+// A task waiting to run, and its argument
+typedef struct {
+    tThreadPoolTask task;
+    void* arg;
+} tThreadPoolJob;
+
+// Jobs waiting in a thread. The owner takes them from the first one, the other threads steal from the last one
+typedef struct {
+    pthread_mutex_t lock;
+    // Pool of the queue and position of its thread, for the thread
+    void* pool;
+    unsigned int index;
+    // Circular array of jobs
+    tThreadPoolJob* jobs;
+    unsigned int first;
+    unsigned int size;
+    unsigned int allocated;
+} tThreadPoolQueue;
+
+// Counters of a pool
+typedef struct {
+    unsigned long jobs;
+    // Jobs run by a thread that is not the one they were submitted to
+    unsigned long steals;
+} tThreadPoolReport;
+
+// Pool of threads, each one with its own queue of jobs. A thread with no jobs steals them from the others
+typedef struct {
+    pthread_t* threads;
+    tThreadPoolQueue* queues;
+    // Queues, one for each thread
+    unsigned int count;
+    // Threads started
+    unsigned int running;
+    // Queue of the next job submitted
+    unsigned int next;
+
+    // The counters, the stop flag and the conditions are protected by this lock
+    pthread_mutex_t lock;
+    // Signaled when jobs are submitted or the pool stops
+    pthread_cond_t work;
+    // Signaled when all the jobs submitted are done
+    pthread_cond_t done;
+    // Jobs in the queues
+    unsigned long queued;
+    // Jobs submitted and not done
+    unsigned long pending;
+    bool stop;
+    tThreadPoolReport report;
+} tThreadPool;
+
+// **** Functions related to thread pools
+
+// Start a pool with the given number of threads
+tError threadPool_init(tThreadPool* pool, unsigned int count);
+
+// Wait for the jobs submitted, and stop the threads of the pool
+void threadPool_free(tThreadPool* pool);
+
+// Add a job to the queue of the next thread. Jobs submitted to a thread start in submission order.
+// Jobs are submitted from a single thread
+tError threadPool_submit(tThreadPool* pool, tThreadPoolTask task, void* arg);
+
+// Wait until all the jobs submitted are done
+void threadPool_wait(tThreadPool* pool);
+
+// Get the counters of a pool
+void threadPool_report(tThreadPool* pool, tThreadPoolReport* report);
+
+#endif // __THREADPOOL_H__
@@ -20,11 +20,37 @@ typedef struct _tVBSNode {
     struct _tVBSNode* next;
 } tVaccinationBatchListNode;
 
+// Batch of the availability index, with its position in the list
+typedef struct {
+    tVaccinationBatchListNode* node;
+    unsigned int position;
+} tVaccinationBatchIndexEntry;
+
+// Batches of one vaccine in the availability index, in the order of the list.
+// The batches before head have no doses left
+typedef struct {
+    tVaccinationBatchIndexEntry* entries;
+    unsigned int size;
+    unsigned int allocated;
+    unsigned int head;
+} tVaccinationBatchGroup;
+
+// Index of the batches with doses, grouped by vaccine id
+typedef struct {
+    // The groups must be built again from the list before being used
+    bool dirty;
+    // Groups indexed by vaccine id
+    tVaccinationBatchGroup* groups;
+    unsigned int count;
+} tVaccinationBatchIndex;
+
 // List of tVaccineBatch elements
 typedef struct {
     tVaccinationBatchListNode *first;
 	tVaccinationBatchListNode *last;
 	int size;
+    // Index used to choose the batch of each dose
+    tVaccinationBatchIndex index;
 } tVaccinationBatchList;
 
 // **** Functions related to tVaccinationBatch
@@ -56,11 +82,14 @@ void vaccinationBatchList_free(tVaccinationBatchList *list);
 // Duplicate list
 tError vaccinationBatchList_duplicate(tVaccinationBatchList *dest, tVaccinationBatchList src);
 
-// inoculate first vaccine to a patient form a batch list
-void vaccineBatchList_inoculate_first_vaccine(tVaccinationBatchList* vbList, tPatient* patient);
+// inoculate first vaccine to a patient form a batch list. Returns the batch of the dose, or NULL if there is no dose
+tVaccineBatch* vaccineBatchList_inoculate_first_vaccine(tVaccinationBatchList* vbList, tPatient* patient);
+
+// inoculate second vaccine to a patient form a batch list. Returns the batch of the dose, or NULL if there is no dose
+tVaccineBatch* vaccineBatchList_inoculate_second_vaccine(tVaccinationBatchList* vbList, tPatient* patient);
 
-// inoculate second vaccine to a patient form a batch list
-void vaccineBatchList_inoculate_second_vaccine(tVaccinationBatchList* vbList, tPatient* patient);
+// Mark the availability index as outdated. Call it after changing the quantity of the batches directly
+void vaccineBatchList_invalidateIndex(tVaccinationBatchList* vbList);
 
 // recursive function to explore all batches for inoculate to a patient
 void vaccineBatchList_inoculate(tVaccinationBatchList* vbList, tPatient* patient);
@@ -68,6 +97,9 @@ void vaccineBatchList_inoculate(tVaccinationBatchList* vbList, tPatient* patient
 // Insert/adds a new Vaccine Batch  to the tVaccinationBatchList 
 tError vaccineBatchList_insert(tVaccinationBatchList* list, tVaccineBatch vaccineBatch, int index);
 
+// Adds a new Vaccine Batch at the end of the tVaccinationBatchList
+tError vaccineBatchList_append(tVaccinationBatchList* list, tVaccineBatch vaccineBatch);
+
 // Deletes a tBestVideoType from the tTopGender list
 tError vaccineBatchList_delete(tVaccinationBatchList* list, int index);
 
@@ -83,9 +115,12 @@ tError vaccineBatchList_swap(tVaccinationBatchList* queue, int index_dst, int in
 // Sorts input list using quickSort algorithm
 tError vaccineBatchList_quicksort(tVaccinationBatchList *queue);
 
-// Sorts input list using quickSort algorithm
+// Sorts the batches from position head to position tail (both included)
 void vaccineBatchList_quickSortRecursive(tVaccinationBatchList *list, int head, int tail);
 
+// Sorts input list using a merge sort that relinks the nodes
+tError vaccineBatchList_mergesort(tVaccinationBatchList *list);
+
 // Helper function - Print a queue in the console - use for debugging
 void vaccineBatchList_print(tVaccinationBatchList list);
 
@@ -21,6 +21,9 @@ typedef enum {
     RNA = 5	
 } tVaccineTec;
 
+// Number of vaccine technologies
+#define VACCINE_TECHNOLOGIES (RNA + 1)
+
 // vaccine phase enumeration
 typedef enum {	
     PRECLINICAL = 0,
@@ -31,9 +34,16 @@ typedef enum {
     PHASE3 = 5	
 } tVaccinePhase;
 
+// Identifier of a vaccine in the vaccine catalogue
+typedef int tVaccineId;
+
+// Value used when there is no vaccine or the vaccine is not in the catalogue
+#define NO_VACCINE_ID (-1)
+
 // Data type to hold data related to a vaccine
 typedef struct {
     char* name;
+    tVaccineId id;
     tVaccineTec vaccineTec;
     tVaccinePhase vaccinePhase;
 } tVaccine;
@@ -76,6 +86,9 @@ tError vaccineTable_cpy(tVaccineTable* dest, tVaccineTable* src);
 // Get vaccine by name
 tVaccine* vaccineTable_find(tVaccineTable* table, const char* name);
 
+// Get vaccine by catalogue id
+tVaccine* vaccineTable_findById(tVaccineTable* table, tVaccineId id);
+
 // Get the size of the table
 unsigned int vaccineTable_size(tVaccineTable* table);
 
@@ -0,0 +1,52 @@
+#ifndef __VACCINE_CATALOG__H__
+#define __VACCINE_CATALOG__H__
+
+#include <stdbool.h>
+#include "error.h"
+#include "vaccine.h"
+
+// Identifiers of the known vaccines. They are registered in this order when the catalogue is created
+#define ASTRAZENECA_VAC_ID 0
+#define JANSSEN_VAC_ID 1
+#define MODERNA_VAC_ID 2
+#define PFIZER_VAC_ID 3
+
+// Global catalogue of vaccines. Each different name is stored once and gets a small integer id
+typedef struct {
+    // Number of registered vaccines. Ids go from 0 to size - 1
+    unsigned int size;
+    // Allocated length of the elements array
+    unsigned int allocated;
+    // Registered vaccines, indexed by id. Each one has its own memory block, so the
+    // pointers returned by vaccineCatalog_get remain valid when the catalogue grows
+    tVaccine** elements;
+    // Number of slots of the name index. It is zero or a power of two
+    unsigned int capacity;
+    // Id stored in each slot of the name index, or NO_VACCINE_ID if the slot is empty
+    tVaccineId* slots;
+} tVaccineCatalog;
+
+// **** Functions related to the vaccine catalogue
+
+// Initialize the catalogue with the known vaccines. Does nothing if it is already initialized
+tError vaccineCatalog_init(void);
+
+// Release the memory used by the catalogue. Names and vaccines returned before become invalid
+void vaccineCatalog_free(void);
+
+// Get the id of a vaccine name, registering it if it is not in the catalogue yet
+tError vaccineCatalog_intern(const char* name, tVaccineTec tec, tVaccinePhase phase, tVaccineId* id);
+
+// Get the id of a vaccine name, or NO_VACCINE_ID if it is not in the catalogue
+tVaccineId vaccineCatalog_find(const char* name);
+
+// Get the vaccine registered with the given id, or NULL if the id is not valid
+tVaccine* vaccineCatalog_get(tVaccineId id);
+
+// Get the name of the vaccine registered with the given id, or NULL if the id is not valid
+const char* vaccineCatalog_name(tVaccineId id);
+
+// Get the number of registered vaccines
+unsigned int vaccineCatalog_size(void);
+
+#endif // __VACCINE_CATALOG__H__
@@ -0,0 +1,357 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <assert.h>
+#include "allocator.h"
+#include "instrument.h"
+
+// Alignment of the blocks of a bump allocator, enough for any type
+#define BUMP_ALIGNMENT 16
+
+// Size of a block stored before it, with the padding of the alignment
+#define BUMP_HEADER_SIZE BUMP_ALIGNMENT
+
+// Allocator of all the threads
+static const tAllocator* globalAllocator = NULL;
+
+// Allocator entered by this thread, used before the global one
+static _Thread_local const tAllocator* threadAllocator = NULL;
+
+// Set the allocator of all the threads. NULL goes back to malloc. It has to be set before the
+// library allocates anything, as the memory has to be released by the allocator that gave it
+void allocator_setGlobal(const tAllocator* allocator) {
+    // Verify pre conditions
+    assert(allocator == NULL || (allocator->alloc != NULL && allocator->realloc != NULL && allocator->free != NULL));
+
+    globalAllocator = allocator;
+}
+
+// Get the allocator of all the threads, or NULL for malloc
+const tAllocator* allocator_global(void) {
+    return globalAllocator;
+}
+
+// Use an allocator in this thread until allocator_leave, and get the one used before. NULL keeps the current one
+const tAllocator* allocator_enter(const tAllocator* allocator) {
+    const tAllocator* previous;
+
+    previous = threadAllocator;
+    if(allocator != NULL) {
+        threadAllocator = allocator;
+    }
+
+    return previous;
+}
+
+// Use the global allocator in this thread until allocator_leave, and get the one used before.
+// The data shared by all the tables, as the catalogue, is always kept in the global allocator
+const tAllocator* allocator_enterGlobal(void) {
+    const tAllocator* previous;
+
+    previous = threadAllocator;
+    threadAllocator = NULL;
+
+    return previous;
+}
+
+// Use in this thread the allocator that gave the memory of an object until allocator_leave, and get the one
+// used before. The objects keep allocator_current() when they are created, so NULL is the global allocator
+const tAllocator* allocator_enterOwner(const tAllocator* owner) {
+    const tAllocator* previous;
+
+    previous = threadAllocator;
+    threadAllocator = owner;
+
+    return previous;
+}
+
+// Go back to the allocator used before allocator_enter
+void allocator_leave(const tAllocator* previous) {
+    threadAllocator = previous;
+}
+
+// Get the allocator used by this thread, or NULL for malloc
+const tAllocator* allocator_current(void) {
+    return threadAllocator != NULL ? threadAllocator : globalAllocator;
+}
+
+void* uoc_malloc(size_t size) {
+    const tAllocator* allocator;
+    void* ptr;
+
+    INSTRUMENT_START(start);
+    allocator = allocator_current();
+    ptr = allocator == NULL ? malloc(size) : allocator->alloc(allocator->context, size);
+    INSTRUMENT_STOP_MEMORY(INSTRUMENT_MALLOC, start, size);
+
+    return ptr;
+}
+
+void* uoc_calloc(size_t count, size_t size) {
+    const tAllocator* allocator;
+    void* ptr;
+
+    INSTRUMENT_START(start);
+    allocator = allocator_current();
+    if(allocator == NULL) {
+        ptr = calloc(count, size);
+    } else if(size != 0 && count > SIZE_MAX / size) {
+        ptr = NULL;
+    } else {
+        ptr = allocator->alloc(allocator->context, count * size);
+        if(ptr != NULL) {
+            memset(ptr, 0, count * size);
+        }
+    }
+    INSTRUMENT_STOP_MEMORY(INSTRUMENT_CALLOC, start, count * size);
+
+    return ptr;
+}
+
+void* uoc_realloc(void* ptr, size_t size) {
+    const tAllocator* allocator;
+
+    INSTRUMENT_START(start);
+    allocator = allocator_current();
+    ptr = allocator == NULL ? realloc(ptr, size) : allocator->realloc(allocator->context, ptr, size);
+    INSTRUMENT_STOP_MEMORY(INSTRUMENT_REALLOC, start, size);
+
+    return ptr;
+}
+
+void uoc_free(void* ptr) {
+    const tAllocator* allocator;
+
+    // Releasing NULL is not a call to the allocator
+    if(ptr == NULL) {
+        return;
+    }
+
+    INSTRUMENT_START(start);
+    allocator = allocator_current();
+    if(allocator == NULL) {
+        free(ptr);
+    } else {
+        allocator->free(allocator->context, ptr);
+    }
+    INSTRUMENT_STOP(INSTRUMENT_FREE, start);
+}
+
+// Counting allocator: alloc
+static void* countingAllocator_alloc(void* context, size_t size) {
+    tCountingAllocator* counting = (tCountingAllocator*)context;
+
+    atomic_fetch_add_explicit(&counting->allocations, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counting->bytes, size, memory_order_relaxed);
+
+    return counting->parent == NULL ? malloc(size) : counting->parent->alloc(counting->parent->context, size);
+}
+
+// Counting allocator: realloc. Growing NULL is an allocation
+static void* countingAllocator_realloc(void* context, void* ptr, size_t size) {
+    tCountingAllocator* counting = (tCountingAllocator*)context;
+
+    atomic_fetch_add_explicit(ptr == NULL ? &counting->allocations : &counting->reallocations, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&counting->bytes, size, memory_order_relaxed);
+
+    return counting->parent == NULL ? realloc(ptr, size) : counting->parent->realloc(counting->parent->context, ptr, size);
+}
+
+// Counting allocator: free
+static void countingAllocator_release(void* context, void* ptr) {
+    tCountingAllocator* counting = (tCountingAllocator*)context;
+
+    if(ptr == NULL) {
+        return;
+    }
+
+    atomic_fetch_add_explicit(&counting->frees, 1, memory_order_relaxed);
+    if(counting->parent == NULL) {
+        free(ptr);
+    } else {
+        counting->parent->free(counting->parent->context, ptr);
+    }
+}
+
+// Initialize a counting allocator over another allocator, or over malloc if parent is NULL
+void countingAllocator_init(tCountingAllocator* counting, const tAllocator* parent) {
+    // Verify pre conditions
+    assert(counting != NULL);
+
+    counting->parent = parent;
+    atomic_init(&counting->allocations, 0);
+    atomic_init(&counting->reallocations, 0);
+    atomic_init(&counting->frees, 0);
+    atomic_init(&counting->bytes, 0);
+}
+
+// Get the functions of a counting allocator
+void countingAllocator_allocator(tCountingAllocator* counting, tAllocator* allocator) {
+    // Verify pre conditions
+    assert(counting != NULL);
+    assert(allocator != NULL);
+
+    allocator->alloc = countingAllocator_alloc;
+    allocator->realloc = countingAllocator_realloc;
+    allocator->free = countingAllocator_release;
+    allocator->context = counting;
+}
+
+// Get the blocks given and not released yet
+unsigned long countingAllocator_live(tCountingAllocator* counting) {
+    // Verify pre conditions
+    assert(counting != NULL);
+
+    return atomic_load_explicit(&counting->allocations, memory_order_relaxed) - atomic_load_explicit(&counting->frees, memory_order_relaxed);
+}
+
+// Round a size up to the alignment of the blocks
+static size_t bumpAllocator_align(size_t size) {
+    return (size + BUMP_ALIGNMENT - 1) & ~(size_t)(BUMP_ALIGNMENT - 1);
+}
+
+// Get the first byte of the blocks of a chunk
+static char* bumpAllocator_data(tBumpAllocatorChunk* chunk) {
+    return (char*)chunk + bumpAllocator_align(sizeof(tBumpAllocatorChunk));
+}
+
+// Tell if a block is the last one given by the current chunk
+static bool bumpAllocator_isLast(tBumpAllocator* bump, char* block, size_t size) {
+    return bump->chunks != NULL && block + bumpAllocator_align(size) == bumpAllocator_data(bump->chunks) + bump->chunks->used;
+}
+
+// Give a block. The lock is taken
+static void* bumpAllocator_give(tBumpAllocator* bump, size_t size) {
+    tBumpAllocatorChunk* chunk;
+    size_t needed, chunkSize;
+    char* block;
+
+    if(size > SIZE_MAX / 2) {
+        return NULL;
+    }
+    needed = BUMP_HEADER_SIZE + bumpAllocator_align(size);
+
+    // Big blocks get a chunk of their own
+    chunk = bump->chunks;
+    if(chunk == NULL || chunk->used + needed > chunk->size) {
+        chunkSize = needed > bump->chunkSize ? needed : bump->chunkSize;
+        chunk = (tBumpAllocatorChunk*)malloc(bumpAllocator_align(sizeof(tBumpAllocatorChunk)) + chunkSize);
+        if(chunk == NULL) {
+            return NULL;
+        }
+        chunk->size = chunkSize;
+        chunk->used = 0;
+        chunk->next = bump->chunks;
+        bump->chunks = chunk;
+    }
+
+    block = bumpAllocator_data(chunk) + chunk->used + BUMP_HEADER_SIZE;
+    *(size_t*)(block - BUMP_HEADER_SIZE) = size;
+    chunk->used += needed;
+    bump->bytes += size;
+
+    return block;
+}
+
+// Bump allocator: alloc
+static void* bumpAllocator_alloc(void* context, size_t size) {
+    tBumpAllocator* bump = (tBumpAllocator*)context;
+    void* block;
+
+    pthread_mutex_lock(&bump->lock);
+    block = bumpAllocator_give(bump, size);
+    pthread_mutex_unlock(&bump->lock);
+
+    return block;
+}
+
+// Bump allocator: realloc. The last block grows in place, the others are copied
+static void* bumpAllocator_realloc(void* context, void* ptr, size_t size) {
+    tBumpAllocator* bump = (tBumpAllocator*)context;
+    size_t oldSize;
+    char* block;
+
+    pthread_mutex_lock(&bump->lock);
+
+    if(ptr == NULL) {
+        block = bumpAllocator_give(bump, size);
+    } else {
+        oldSize = *(size_t*)((char*)ptr - BUMP_HEADER_SIZE);
+        if(bumpAllocator_isLast(bump, (char*)ptr, oldSize) && size <= SIZE_MAX / 2 &&
+                bump->chunks->used - bumpAllocator_align(oldSize) + bumpAllocator_align(size) <= bump->chunks->size) {
+            bump->chunks->used = bump->chunks->used - bumpAllocator_align(oldSize) + bumpAllocator_align(size);
+            *(size_t*)((char*)ptr - BUMP_HEADER_SIZE) = size;
+            block = (char*)ptr;
+        } else {
+            block = bumpAllocator_give(bump, size);
+            if(block != NULL) {
+                memcpy(block, ptr, oldSize < size ? oldSize : size);
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&bump->lock);
+
+    return block;
+}
+
+// Bump allocator: free. Only the last block is given back
+static void bumpAllocator_release(void* context, void* ptr) {
+    tBumpAllocator* bump = (tBumpAllocator*)context;
+    size_t size;
+
+    if(ptr == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&bump->lock);
+    size = *(size_t*)((char*)ptr - BUMP_HEADER_SIZE);
+    if(bumpAllocator_isLast(bump, (char*)ptr, size)) {
+        bump->chunks->used -= BUMP_HEADER_SIZE + bumpAllocator_align(size);
+    }
+    pthread_mutex_unlock(&bump->lock);
+}
+
+// Initialize a bump allocator. A chunkSize of 0 uses BUMP_ALLOCATOR_CHUNK_SIZE
+tError bumpAllocator_init(tBumpAllocator* bump, size_t chunkSize) {
+    // Verify pre conditions
+    assert(bump != NULL);
+
+    if(pthread_mutex_init(&bump->lock, NULL) != 0) {
+        return ERR_MEMORY_ERROR;
+    }
+    bump->chunks = NULL;
+    bump->chunkSize = chunkSize == 0 ? BUMP_ALLOCATOR_CHUNK_SIZE : bumpAllocator_align(chunkSize);
+    bump->bytes = 0;
+
+    return OK;
+}
+
+// Release all the memory given by a bump allocator
+void bumpAllocator_free(tBumpAllocator* bump) {
+    tBumpAllocatorChunk* chunk;
+
+    // Verify pre conditions
+    assert(bump != NULL);
+
+    while(bump->chunks != NULL) {
+        chunk = bump->chunks;
+        bump->chunks = chunk->next;
+        free(chunk);
+    }
+    bump->bytes = 0;
+    pthread_mutex_destroy(&bump->lock);
+}
+
+// Get the functions of a bump allocator
+void bumpAllocator_allocator(tBumpAllocator* bump, tAllocator* allocator) {
+    // Verify pre conditions
+    assert(bump != NULL);
+    assert(allocator != NULL);
+
+    allocator->alloc = bumpAllocator_alloc;
+    allocator->realloc = bumpAllocator_realloc;
+    allocator->free = bumpAllocator_release;
+    allocator->context = bump;
+}
@@ -0,0 +1,216 @@
+// mmap is not part of C11
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "arena.h"
+#include "allocator.h"
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#endif
+
+// Round a size up to a multiple of the alignment
+static size_t arena_align(size_t size) {
+    return (size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+}
+
+// Estimated heap size of an allocation done with malloc: a header of 8 bytes,
+// rounded up to 16 bytes, with a minimum of 32 bytes (glibc on 64 bits)
+static size_t arena_mallocSize(size_t size) {
+    size = (size + 8 + 15) & ~(size_t)15;
+    return size < 32 ? 32 : size;
+}
+
+// Request a block of size bytes to the operating system
+static tArenaBlock* arena_mapBlock(size_t size) {
+    tArenaBlock* block;
+
+#ifdef _WIN32
+    block = (tArenaBlock*)uoc_malloc(size);
+#else
+    block = (tArenaBlock*)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(block == MAP_FAILED) {
+        block = NULL;
+    }
+#endif
+
+    if(block != NULL) {
+        block->next = NULL;
+        block->size = size;
+    }
+
+    return block;
+}
+
+// Give a block back to the operating system
+static void arena_unmapBlock(tArenaBlock* block) {
+#ifdef _WIN32
+    uoc_free(block);
+#else
+    munmap(block, block->size);
+#endif
+}
+
+// Initialize an arena without memory. Blocks of blockSize bytes are requested when needed
+tError arena_init(tArena* arena, size_t blockSize) {
+    // Verify pre conditions
+    assert(arena != NULL);
+
+    memset(arena, 0, sizeof(tArena));
+    arena->blockSize = blockSize > 0 ? blockSize : ARENA_BLOCK_SIZE;
+
+    return OK;
+}
+
+// Release all the memory of the arena
+void arena_free(tArena* arena) {
+    tArenaBlock *block, *next;
+
+    // Verify pre conditions
+    assert(arena != NULL);
+
+    // The pieces are not released one by one: each block goes back with a single call
+    block = arena->blocks;
+    while(block != NULL) {
+        next = block->next;
+        arena_unmapBlock(block);
+        block = next;
+    }
+
+    arena_init(arena, arena->blockSize);
+}
+
+// Give back all the pieces of the arena, keeping its blocks to be reused
+void arena_reset(tArena* arena) {
+    tArenaBlock *block;
+
+    // Verify pre conditions
+    assert(arena != NULL);
+
+    // Only the first block is kept, the others are released
+    block = arena->blocks;
+    if(block != NULL) {
+        arena->blocks = block->next;
+        block->next = NULL;
+        arena_free(arena);
+
+        arena->blocks = block;
+        arena->current = (char*)block + arena_align(sizeof(tArenaBlock));
+        arena->remaining = block->size - arena_align(sizeof(tArenaBlock));
+        arena->report.bytesReserved = block->size;
+        arena->report.blocks = 1;
+    }
+}
+
+// Get a piece of memory of size bytes, or NULL if there is no memory
+void* arena_alloc(tArena* arena, size_t size) {
+    tArenaBlock* block;
+    size_t blockSize;
+    void* ptr;
+
+    // Verify pre conditions
+    assert(arena != NULL);
+
+    size = arena_align(size > 0 ? size : 1);
+
+    // Reuse a released piece of the same size
+    if(size <= ARENA_MAX_REUSED_SIZE && arena->freeLists[size / ARENA_ALIGNMENT - 1] != NULL) {
+        ptr = arena->freeLists[size / ARENA_ALIGNMENT - 1];
+        arena->freeLists[size / ARENA_ALIGNMENT - 1] = *(void**)ptr;
+        arena->report.reused++;
+    } else {
+        if(size > arena->remaining) {
+            // The rest of the current block is lost. Large pieces get a block of their own size
+            blockSize = arena_align(sizeof(tArenaBlock)) + size;
+            if(blockSize < arena->blockSize) {
+                blockSize = arena->blockSize;
+            }
+            block = arena_mapBlock(blockSize);
+            if(block == NULL) {
+                return NULL;
+            }
+            block->next = arena->blocks;
+            arena->blocks = block;
+            arena->current = (char*)block + arena_align(sizeof(tArenaBlock));
+            arena->remaining = blockSize - arena_align(sizeof(tArenaBlock));
+            arena->report.bytesReserved += blockSize;
+            arena->report.blocks++;
+        }
+        ptr = arena->current;
+        arena->current += size;
+        arena->remaining -= size;
+    }
+
+    arena->report.allocations++;
+    arena->report.bytesInUse += size;
+    arena->report.mallocBytes += arena_mallocSize(size);
+
+    return ptr;
+}
+
+// Copy a string to memory of the arena, or NULL if there is no memory
+char* arena_strdup(tArena* arena, const char* str) {
+    char* copy;
+    size_t length;
+
+    // Verify pre conditions
+    assert(arena != NULL);
+    assert(str != NULL);
+
+    length = strlen(str) + 1;
+    copy = (char*)arena_alloc(arena, length);
+    if(copy != NULL) {
+        memcpy(copy, str, length);
+    }
+
+    return copy;
+}
+
+// Give back a piece of memory of size bytes, to be reused by the next allocations of the same size
+void arena_release(tArena* arena, void* ptr, size_t size) {
+    // Verify pre conditions
+    assert(arena != NULL);
+
+    if(ptr == NULL) {
+        return;
+    }
+
+    size = arena_align(size > 0 ? size : 1);
+
+    arena->report.bytesInUse -= size;
+    arena->report.mallocBytes -= arena_mallocSize(size);
+
+    // Large pieces are not reused, they go back with the arena
+    if(size <= ARENA_MAX_REUSED_SIZE) {
+        *(void**)ptr = arena->freeLists[size / ARENA_ALIGNMENT - 1];
+        arena->freeLists[size / ARENA_ALIGNMENT - 1] = ptr;
+    }
+}
+
+// Get the counters of the memory of the arena
+void arena_report(const tArena* arena, tArenaReport* report) {
+    // Verify pre conditions
+    assert(arena != NULL);
+    assert(report != NULL);
+
+    *report = arena->report;
+}
+
+// Print the memory used by the arena and the memory saved compared with malloc
+void arena_printReport(const tArenaReport* report) {
+    // Verify pre conditions
+    assert(report != NULL);
+
+    printf("Allocations: %lu (%lu reused)\n", report->allocations, report->reused);
+    printf("Bytes in use: %zu\n", report->bytesInUse);
+    printf("Bytes reserved: %zu in %u blocks\n", report->bytesReserved, report->blocks);
+    printf("Bytes with malloc: %zu\n", report->mallocBytes);
+    if(report->mallocBytes > report->bytesReserved) {
+        printf("Bytes saved: %zu\n", report->mallocBytes - report->bytesReserved);
+    } else {
+        printf("Bytes saved: 0\n");
+    }
+}
@@ -4,3 +4,17 @@
 bool date_equal(tDate date1, tDate date2) {
     return date1.day == date2.day && date1.month == date2.month && date1.year == date2.year;
 }
+
+// Compute the hash value of a string. Uses the FNV-1a algorithm, which is fast
+// and spreads short keys (country and vaccine names) well over the hash space.
+unsigned int string_hash(const char* str) {
+    unsigned int hash = 2166136261u;
+
+    while(*str != '\0') {
+        hash ^= (unsigned char)*str;
+        hash *= 16777619u;
+        str++;
+    }
+
+    return hash;
+}
@@ -6,9 +6,19 @@
 #include <ctype.h>
 #include "country.h"
 #include "patient.h"
+#include "vaccineCatalog.h"
+#include "eligibility.h"
+#include "threadPool.h"
+#include "allocator.h"
+#include "instrument.h"
 
 // **** Functions related to management of tCountry objects
 
+// Use the allocator of a country in this thread until allocator_leave, and get the one used before
+static const tAllocator* country_enter(const tCountry* country) {
+    return allocator_enterOwner(country != NULL ? country->allocator : allocator_current());
+}
+
 // Initialize a country
 tError country_init(tCountry* country, const char* name, bool isEU) {
     // Verify pre conditions
@@ -18,8 +28,8 @@ tError country_init(tCountry* country, const char* name, bool isEU) {
     // Allocate the memory for all the fields, using the length of the provided
     // text plus 1 space for the "end of string" char '\0'.
     // To allocate memory we use the malloc command.
-    country->name = (char*)malloc((strlen(name) + 1) * sizeof(char));
-    country->authVaccines = (tVaccineTable*)malloc(sizeof(tVaccineTable));
+    country->name = (char*)uoc_malloc((strlen(name) + 1) * sizeof(char));
+    country->authVaccines = (tVaccineTable*)uoc_malloc(sizeof(tVaccineTable));
 
     // Check that memory has been allocated for all fields.
     // Pointer must be different from NULL.
@@ -35,41 +45,65 @@ tError country_init(tCountry* country, const char* name, bool isEU) {
 
     // Initialize the rest of fields
     country->isEU = isEU;
+    country->arena = NULL;
+    country->journal = NULL;
+    country->journalId = 0;
+    country->intake = NULL;
+    country->waitingGeneration = 0;
+    country->allocator = allocator_current();
 
     // Initialize vaccines table
     vaccineTable_init(country->authVaccines);
 
     // Initialize patients queue
-    country->patients = (tPatientQueue*)malloc(sizeof(tPatientQueue));
+    country->patients = (tPatientQueue*)uoc_malloc(sizeof(tPatientQueue));
     if(country->patients == NULL) {
-        free(country->name);
+        uoc_free(country->name);
         return ERR_MEMORY_ERROR;
     }
 
     patientQueue_create(country->patients);
 
+    // Patients are often looked up by id in a country. The index of an empty queue needs no memory yet
+    patientQueue_enableIdIndex(country->patients);
+
     // Initialize vaccination batch stack
-    country->vbList = (tVaccinationBatchList*)malloc(sizeof(tVaccinationBatchList));
+    country->vbList = (tVaccinationBatchList*)uoc_malloc(sizeof(tVaccinationBatchList));
     if(country->vbList == NULL) {
-        free(country->name);
-        free(country->patients);
+        uoc_free(country->name);
+        uoc_free(country->patients);
         return ERR_MEMORY_ERROR;
     }
 
     vaccinationBatchList_create(country->vbList);
 
+    // Initialize the patients waiting for the first dose
+    country->waiting = (tPatientPriorityQueue*)uoc_malloc(sizeof(tPatientPriorityQueue));
+    if(country->waiting == NULL) {
+        uoc_free(country->name);
+        uoc_free(country->patients);
+        uoc_free(country->vbList);
+        return ERR_MEMORY_ERROR;
+    }
+
+    patientPriorityQueue_create(country->waiting);
+
     return OK;
 }
 
 // Release memory used by country object
 void country_free(tCountry* object) {
+    const tAllocator* previous;
+
     // Verify pre conditions
     assert(object != NULL);
 
+    previous = country_enter(object);
+
     // All memory allocated with malloc and realloc needs to be freed using the free command.
     // In this case, as we use malloc to allocate the fields, we have to free them
     if(object->name != NULL) {
-        free(object->name);
+        uoc_free(object->name);
         object->name = NULL;
     }
 
@@ -77,24 +111,47 @@ void country_free(tCountry* object) {
     if(object->authVaccines != NULL) {
         vaccineTable_free(object->authVaccines);
 
-        free(object->authVaccines);
+        uoc_free(object->authVaccines);
         object->authVaccines = NULL;
     }
 
     // free patients queue
     if(object->patients != NULL) {
 		patientQueue_free(object->patients);
-		free(object->patients); 
+		uoc_free(object->patients); 
 		object->patients = NULL;
 	}
 
+    // free patients waiting for the first dose
+    if(object->waiting != NULL) {
+        patientPriorityQueue_free(object->waiting);
+        uoc_free(object->waiting);
+        object->waiting = NULL;
+    }
+
+    // Patients of the intake that were not drained
+    if(object->intake != NULL) {
+        patientIntake_free(object->intake);
+        uoc_free(object->intake);
+        object->intake = NULL;
+    }
+
+    // The memory of the patients stored in the arena goes back with a call for each block
+    if(object->arena != NULL) {
+        arena_free(object->arena);
+        uoc_free(object->arena);
+        object->arena = NULL;
+    }
+
 
     // free vaccination batch stack
     if(object->vbList != NULL) {
         vaccinationBatchList_free(object->vbList);
-        free(object->vbList);
+        uoc_free(object->vbList);
 		object->vbList = NULL;
     }
+
+    allocator_leave(previous);
 }
 
 // Compare two country objects
@@ -118,8 +175,8 @@ bool country_equals(tCountry * country1, tCountry * country2) {
     return true;
 }
 
-// Copy the data of a country to another country
-tError country_cpy(tCountry * dest, tCountry * src) {
+// Copy the data of a country to another country, with the allocator of dest entered
+static tError country_cpyImpl(tCountry * dest, tCountry * src) {
     tError error;
 
     // Verify pre conditions
@@ -139,8 +196,16 @@ tError country_cpy(tCountry * dest, tCountry * src) {
     if(error != OK)
         return error;
 
-    // Copy patient queue
-    error = patientQueue_duplicate(dest->patients, *src->patients);
+    // Copy patient queue, in an arena of its own if the source has one
+    if(src->arena != NULL) {
+        error = country_enableArena(dest);
+        if(error == OK)
+            error = patientQueue_enqueueAll(dest->patients, src->patients);
+    } else {
+        error = patientQueue_duplicate(dest->patients, *src->patients);
+        if(error == OK)
+            error = patientQueue_enableIdIndex(dest->patients);
+    }
     if(error != OK)
         return error;
 
@@ -149,51 +214,257 @@ tError country_cpy(tCountry * dest, tCountry * src) {
     if(error != OK)
         return error;
 
+    // The copy writes its doses to the same journal, with the same id. The journal is not owned by the country
+    dest->journal = src->journal;
+    dest->journalId = src->journalId;
+
     return OK;
 }
 
+// Copy the data of a country to another country, with the allocator of dest
+tError country_cpy(tCountry * dest, tCountry * src) {
+    const tAllocator* previous;
+    tError error;
 
-tVaccine* country_find_vaccine(tCountry * country, const char* name) {
-    int i;
+    // Verify pre conditions
+    assert(dest != NULL);
+    assert(src != NULL);
+
+    previous = country_enter(dest);
+    error = country_cpyImpl(dest, src);
+    allocator_leave(previous);
+
+    return error;
+}
+
+// Store the patients of a country without patients in an arena, with the allocator of the country entered
+static tError country_enableArenaImpl(tCountry* country) {
+    tError error;
 
     // Verify pre conditions
     assert(country != NULL);
-    assert(name != NULL);
+    assert(country->patients != NULL);
 
-    // Search over the table and return once we found the element.
-    for(i = 0; i < country->authVaccines->size; i++) {
-        if(strcmp(country->authVaccines->elements[i].name, name) == 0) {
-            // We return the ADDRESS (&) of the element, which is a pointer to the element
-            return &(country->authVaccines->elements[i]);
-        }
+    if(country->arena != NULL) {
+        return OK;
     }
 
-    // The element has not been found. Return NULL (empty pointer).
-    return NULL;
+    country->arena = (tArena*)uoc_malloc(sizeof(tArena));
+    if(country->arena == NULL) {
+        return ERR_MEMORY_ERROR;
+    }
+    arena_init(country->arena, ARENA_BLOCK_SIZE);
+
+    error = patientQueue_useArena(country->patients, country->arena);
+    if(error != OK) {
+        uoc_free(country->arena);
+        country->arena = NULL;
+    }
+
+    return error;
+}
+
+// Store the patients of a country without patients in an arena owned by the country
+tError country_enableArena(tCountry* country) {
+    const tAllocator* previous;
+    tError error;
+
+    // Verify pre conditions
+    assert(country != NULL);
+
+    previous = country_enter(country);
+    error = country_enableArenaImpl(country);
+    allocator_leave(previous);
+
+    return error;
+}
+
+// Store the patients of a country without patients in chunks, with the allocator of the country entered
+static tError country_useChunksImpl(tCountry* country) {
+    tError error;
+
+    // Verify pre conditions
+    assert(country != NULL);
+    assert(country->patients != NULL);
+    assert(patientQueue_empty(*country->patients));
+
+    patientQueue_free(country->patients);
+    error = patientQueue_createChunked(country->patients);
+
+    // The new queue keeps the arena and the id index of the country
+    if(error == OK && country->arena != NULL)
+        error = patientQueue_useArena(country->patients, country->arena);
+    if(error == OK)
+        error = patientQueue_enableIdIndex(country->patients);
+
+    return error;
+}
+
+// Store the patients of a country without patients in chunks of contiguous patients
+tError country_useChunks(tCountry* country) {
+    const tAllocator* previous;
+    tError error;
+
+    // Verify pre conditions
+    assert(country != NULL);
+
+    previous = country_enter(country);
+    error = country_useChunksImpl(country);
+    allocator_leave(previous);
+
+    return error;
+}
+
+// Get the memory used by the patients of a country stored in an arena. All the counters are 0 without arena
+void country_memoryReport(tCountry* country, tArenaReport* report) {
+    // Verify pre conditions
+    assert(country != NULL);
+    assert(report != NULL);
+
+    if(country->arena == NULL) {
+        memset(report, 0, sizeof(tArenaReport));
+    } else {
+        arena_report(country->arena, report);
+    }
+}
+
+// Write the doses given to the patients of a country to a journal, or stop writing them with NULL
+tError country_setJournal(tCountry* country, tJournal* journal) {
+    tError error;
+
+    // Verify pre conditions
+    assert(country != NULL);
+
+    // The journal gives the country an id, so that the doses do not repeat its name
+    if(journal != NULL) {
+        error = journal_addCountry(journal, country->name, &country->journalId);
+        if(error != OK)
+            return error;
+    }
+    country->journal = journal;
+
+    return OK;
+}
+
+// Give a country an intake, with the allocator of the country entered. The intake keeps it for its nodes
+static tError country_enableIntakeImpl(tCountry* country) {
+    // Verify pre conditions
+    assert(country != NULL);
+
+    if(country->intake != NULL) {
+        return OK;
+    }
+
+    country->intake = (tPatientIntake*)uoc_malloc(sizeof(tPatientIntake));
+    if(country->intake == NULL) {
+        return ERR_MEMORY_ERROR;
+    }
+    patientIntake_init(country->intake);
+
+    return OK;
+}
+
+// Let other threads add patients to a country through an intake, without locks
+tError country_enableIntake(tCountry* country) {
+    const tAllocator* previous;
+    tError error;
+
+    // Verify pre conditions
+    assert(country != NULL);
+
+    previous = country_enter(country);
+    error = country_enableIntakeImpl(country);
+    allocator_leave(previous);
+
+    return error;
+}
+
+// Add to the country up to max patients of its intake, or all of them with max 0. Only one thread can drain a country
+tError country_drainIntake(tCountry* country, unsigned int max, unsigned int* count) {
+    tPatientIntakeNode* node;
+    tError error;
+
+    // Verify pre conditions
+    assert(country != NULL);
+    assert(country->intake != NULL);
+    assert(count != NULL);
+
+    error = OK;
+    *count = 0;
+    while((max == 0 || *count < max) && (node = patientIntake_pop(country->intake)) != NULL) {
+        // The queue copies the patient, so the node goes back at once. A patient that can not be added is lost
+        error = country_addPatient(country, node->patient);
+        patientIntake_release(country->intake, node);
+        if(error != OK)
+            break;
+        (*count)++;
+    }
+
+    return error;
+}
+
+// Write a dose given to a patient of a country to its journal, if it has one
+static tError country_journalDose(tCountry* country, const tPatient* patient, const tVaccineBatch* batch) {
+    if(country->journal == NULL || batch == NULL) {
+        return OK;
+    }
+
+    return journal_appendDose(country->journal, country->journalId, patient, batch->lotID);
+}
+
+// Write the doses of a round to the journal of a country together, if it has one
+static tError country_journalCommit(tCountry* country) {
+    if(country->journal == NULL) {
+        return OK;
+    }
+
+    return journal_commit(country->journal);
+}
+
+
+tVaccine* country_find_vaccine(tCountry * country, const char* name) {
+    // Verify pre conditions
+    assert(country != NULL);
+    assert(name != NULL);
+
+    // Search the catalogue id of the name over the table of authorized vaccines
+    return vaccineTable_find(country->authVaccines, name);
 }
 
 
 // Add a new patient
 tError country_addPatient(tCountry * country, tPatient patient) {
+    const tAllocator* previous;
+    tError error;
 
     // Check preconditions
     assert(country != NULL);
 
+    previous = country_enter(country);
+
     // Enqueue the new patient
-    return patientQueue_enqueue(country->patients, patient);
+    error = patientQueue_enqueue(country->patients, patient);
+
+    allocator_leave(previous);
 
+    return error;
 }
 
 // Add a new autorized vaccine
 tError country_addVaccine(tCountry * country, tVaccine vaccine) {
+    const tAllocator* previous;
+    tError error;
 
     // Check preconditions
     assert(country != NULL);
 
 
     // add the new vaccine
-    return vaccineTable_add(country->authVaccines, vaccine);
+    previous = country_enter(country);
+    error = vaccineTable_add(country->authVaccines, vaccine);
+    allocator_leave(previous);
 
+    return error;
 }
 
 
@@ -208,25 +479,24 @@ tVaccineTec country_getMostUsedVaccineTechnology(tCountry country) {
 
     int arrayTechnologies[] = { 0, 0, 0, 0, 0, 0,  };
     int mostUsedtechnology = NONE;
-    tVaccine * vaccine = NULL;
+    int mostUsedCount = 0;
+    int i;
 
     if(patientQueue_empty(*country.patients)) {
         return NONE;
     }
 
-    tPatientQueueNode *nodePtr = country.patients->first;
+    // The queue counts the patients per vaccine. Only the authorized vaccines give their technology.
+    for(i = 0; i < country.authVaccines->size; i++) {
+        arrayTechnologies[country.authVaccines->elements[i].vaccineTec] += patientQueue_countVaccine(country.patients, country.authVaccines->elements[i].id);
+    }
 
-    while(nodePtr != NULL) {
-        if(nodePtr->e.vaccine != NULL) {
-            vaccine = vaccineTable_find(country.authVaccines, nodePtr->e.vaccine);
-            if(vaccine != NULL) {
-                arrayTechnologies[vaccine->vaccineTec]++;
-                if(arrayTechnologies[vaccine->vaccineTec] > mostUsedtechnology) {
-                    mostUsedtechnology = vaccine->vaccineTec;
-                }
-            }
+    // Compare the number of patients of each technology with the greatest number found
+    for(i = NONE; i <= RNA; i++) {
+        if(arrayTechnologies[i] > mostUsedCount) {
+            mostUsedtechnology = i;
+            mostUsedCount = arrayTechnologies[i];
         }
-        nodePtr = nodePtr->next;
     }
 
     return mostUsedtechnology;
@@ -234,25 +504,25 @@ tVaccineTec country_getMostUsedVaccineTechnology(tCountry country) {
 
 int country_getPatientsPerVaccine(tCountry country, tVaccine vaccine) {
 
-    tPatientQueue  copy_queue;
+    tVaccine * authVaccine;
 
     if(patientQueue_empty(*country.patients)) {
         return 0;
     }
 
-    if(!country_find_vaccine(&country, vaccine.name)) {
+    authVaccine = country_find_vaccine(&country, vaccine.name);
+    if(!authVaccine) {
         return 0;
     }
 
-    patientQueue_duplicate(&copy_queue, *country.patients);
-
-    return patientQueue_getPatientsPerVaccineRecursive(&copy_queue, vaccine.name);
+    return patientQueue_countVaccine(country.patients, authVaccine->id);
 }
 
 // count how many patients already vaccinated with a vaccine technology
 int country_getPatientsPerVaccineTechnology(tCountry country, tVaccineTec technology) {
 
-    tPatientQueue copy_queue;
+    int count = 0;
+    int i;
 
     if(patientQueue_empty(*country.patients)) {
         return 0;
@@ -262,143 +532,238 @@ int country_getPatientsPerVaccineTechnology(tCountry country, tVaccineTec techno
         return 0;
     }
 
-    patientQueue_duplicate(&copy_queue, *country.patients);
+    // Add the patients of the authorized vaccines with that technology
+    for(i = 0; i < country.authVaccines->size; i++) {
+        if(country.authVaccines->elements[i].vaccineTec == technology) {
+            count += patientQueue_countVaccine(country.patients, country.authVaccines->elements[i].id);
+        }
+    }
+
+    return count;
+}
 
-    return patientQueue_getPatientsPerVaccineTechnologyRecursive(&copy_queue, *country.authVaccines, technology);
+// count how many patients of a poblational group the country has
+int country_getPatientsPerGroup(tCountry country, tPatientGroup group) {
+
+    return patientQueue_stats(country.patients)->groups[group];
+}
+
+// count how many patients the country has with a number of doses
+int country_getPatientsPerDoses(tCountry country, int number_doses) {
+
+    return patientQueue_countDoses(country.patients, number_doses);
 }
 
 // inoculates all available doses of each batch of vaccines to the list of patients who have not received any vaccine
-tError country_inoculate_first_vaccine(tCountry* country) {
+static tError country_inoculate_first_vaccineImpl(tCountry* country) {
     if (country == NULL || country->patients == NULL || country->vbList == NULL) return ERR_INVALID;
 
-    /* Recorremos la lista de lotes una vez.
-       Para cada lote, iteramos la cola completa en su orden actual, intentando inocular 1ª dosis
-       a quienes tengan number_doses == 0, hasta agotar el lote. No eliminamos lotes vacíos. */
-    tVaccinationBatchListNode *node = country->vbList->first;
-    while (node != NULL) {
-        tVaccineBatch *vb = &node->e;
-        if (vb->quantity > 0) {
-            /* calcular longitud de la cola sin helper */
-            int len = 0;
-            {
-                tPatientQueue copy;
-                if (patientQueue_duplicate(&copy, *country->patients) == OK) {
-                    while (!patientQueue_empty(copy)) {
-                        tPatient *tp = patientQueue_dequeue(&copy);
-                        if (tp != NULL) {
-                            len++;
-                            patient_free(tp);
-                            free(tp);
-                        }
-                    }
-                }
-            }
+    /* Recorremos la cola una sola vez, en su orden, modificando los pacientes en su sitio.
+       Cada paciente sin dosis recibe la primera dosis del primer lote idóneo con dosis
+       disponibles. Un paciente que no encuentra lote tampoco lo encontraría más tarde,
+       porque las cantidades de los lotes solo disminuyen. No eliminamos lotes vacíos. */
+    tPatientQueueCursor cursor;
+    tPatient *p;
+    tVaccineBatch *vb;
+    tError error = OK, closeError;
+
+    patientQueue_cursor(country->patients, &cursor);
+    while ((p = patientQueue_cursorNext(&cursor)) != NULL) {
+        if (p->number_doses == 0) {
+            /* usa la función pedida por el enunciado (definida en vaccinationBatch.c) */
+            vb = vaccineBatchList_inoculate_first_vaccine(country->vbList, p);
+            if (error == OK)
+                error = country_journalDose(country, p, vb);
+        }
+    }
 
-            for (int i = 0; i < len && vb->quantity > 0; ++i) {
-                tPatient *p = patientQueue_dequeue(country->patients);
-                if (p == NULL) break;
+    /* el cursor actualiza los contadores de la cola con los cambios */
+    closeError = patientQueue_cursorClose(&cursor);
 
-                if (p->number_doses == 0 && vb->quantity > 0) {
-                    /* usa la función pedida por el enunciado (definida en vaccinationBatch.c) */
-                    vaccineBatchList_inoculate_first_vaccine(country->vbList, p);
-                }
+    /* las dosis de la ronda se escriben juntas en el diario */
+    if (error == OK)
+        error = country_journalCommit(country);
+    return closeError != OK ? closeError : error;
+}
 
-                /* re-encolar manteniendo el orden */
-                patientQueue_enqueue(country->patients, *p);
-                patient_free(p);
-                free(p);
-            }
+// Measured entry point of country_inoculate_first_vaccine
+tError country_inoculate_first_vaccine(tCountry* country) {
+    const tAllocator* previous;
+    tError error;
+
+    INSTRUMENT_START(start);
+    previous = country_enter(country);
+    error = country_inoculate_first_vaccineImpl(country);
+    allocator_leave(previous);
+    INSTRUMENT_STOP(INSTRUMENT_COUNTRY_INOCULATE_FIRST, start);
+
+    return error;
+}
+
+
+// Fill again the patients waiting for the first dose if the queue of the country has new ones since the last time.
+// The patients that got a dose or left stay in the priority queue until the ordered rounds skip them
+static tError country_refreshWaiting(tCountry* country) {
+    tPatientQueueIterator it;
+    const tPatient* patient;
+    const tPatientQueueStats* stats;
+    uint64_t generation;
+    tError error;
+    int group;
+
+    generation = patientQueue_generation(country->patients);
+    if(country->waitingGeneration == generation)
+        return OK;
+
+    // The ordered rounds find the patients by id
+    error = patientQueue_enableIdIndex(country->patients);
+    if(error != OK)
+        return error;
+
+    // The patients without doses wait in the order of the queue. Each group is sized at once for all its patients
+    patientPriorityQueue_clear(country->waiting);
+    stats = patientQueue_stats(country->patients);
+    for(group = HEALTH_WORKER; group < PATIENT_GROUPS; group++) {
+        error = patientPriorityQueue_reserve(country->waiting, (tPatientGroup)group, stats->groups[group]);
+        if(error != OK)
+            return error;
+    }
+    patientQueue_iterator(country->patients, &it);
+    while((patient = patientQueue_next(&it)) != NULL) {
+        if(patient->number_doses == 0) {
+            error = patientPriorityQueue_enqueue(country->waiting, patient);
+            if(error != OK)
+                return error;
         }
-        node = node->next;
     }
+    country->waitingGeneration = generation;
 
     return OK;
 }
 
+static tError country_inoculate_first_vaccine_orderedImpl(tCountry* country) {
+    if (country == NULL || country->patients == NULL || country->vbList == NULL || country->waiting == NULL) return ERR_INVALID;
+
+    /* Los grupos se sirven por orden de prioridad, y dentro de cada grupo por orden de llegada.
+       Todos los pacientes de un grupo son idóneos para las mismas vacunas: cuando uno no
+       encuentra lote, tampoco lo encuentran los siguientes, que siguen esperando a otra ronda.
+       Así no se recorre la población que no puede recibir dosis. */
+    tError error = OK, updateError;
+    tPatient *p;
+    tVaccineBatch *vb;
+    int group, id;
+
+    /* la cola de espera se rellena si llegaron pacientes sin dosis desde la última ronda */
+    error = country_refreshWaiting(country);
+    if (error != OK)
+        return error;
 
-tError country_inoculate_second_vaccine(tCountry* country) {
-    if (country == NULL || country->patients == NULL || country->vbList == NULL) return ERR_INVALID;
+    for (group = patientPriorityQueue_firstGroup(country->waiting); group >= 0;
+            group = patientPriorityQueue_nextGroup(country->waiting, group + 1)) {
+        while ((id = patientPriorityQueue_head(country->waiting, group)) != PATIENT_QUEUE_NO_ID) {
+            p = patientQueue_findById(country->patients, id);
 
-    tVaccinationBatchListNode *node = country->vbList->first;
-    while (node != NULL) {
-        tVaccineBatch *vb = &node->e;
-        if (vb->quantity > 0) {
-            /* calcular longitud de la cola sin helper */
-            int len = 0;
-            {
-                tPatientQueue copy;
-                if (patientQueue_duplicate(&copy, *country->patients) == OK) {
-                    while (!patientQueue_empty(copy)) {
-                        tPatient *tp = patientQueue_dequeue(&copy);
-                        if (tp != NULL) {
-                            len++;
-                            patient_free(tp);
-                            free(tp);
-                        }
-                    }
-                }
+            /* pacientes que ya no esperan: se fueron o ya tienen dosis */
+            if (p == NULL || p->number_doses != 0) {
+                patientPriorityQueue_dequeue(country->waiting, group);
+                continue;
             }
 
-            for (int i = 0; i < len && vb->quantity > 0; ++i) {
-                tPatient *p = patientQueue_dequeue(country->patients);
-                if (p == NULL) break;
+            /* pacientes que cambiaron de grupo: esperan en su nuevo grupo */
+            if ((int)p->group != group) {
+                patientPriorityQueue_dequeue(country->waiting, group);
+                if (patientPriorityQueue_enqueue(country->waiting, p) != OK && error == OK)
+                    error = ERR_MEMORY_ERROR;
+                continue;
+            }
 
-                if (p->number_doses == 1) {
-                    /* si fue Janssen (monodosis), no corresponde 2ª */
-                    if (!(p->vaccine != NULL && strcmp(p->vaccine, JANSSEN_VAC) == 0)) {
-                        vaccineBatchList_inoculate_second_vaccine(country->vbList, p);
-                    }
-                }
+            /* los contadores de la cola se actualizan con el cambio, como con el cursor */
+            patientQueue_beginUpdate(country->patients, p);
+            vb = vaccineBatchList_inoculate_first_vaccine(country->vbList, p);
+            updateError = patientQueue_endUpdate(country->patients, p);
+            if (error == OK)
+                error = updateError;
 
-                patientQueue_enqueue(country->patients, *p);
-                patient_free(p);
-                free(p);
-            }
+            if (vb == NULL)
+                break;
+
+            if (error == OK)
+                error = country_journalDose(country, p, vb);
+            patientPriorityQueue_dequeue(country->waiting, group);
         }
-        node = node->next;
     }
 
-    return OK;
+    /* las dosis de la ronda se escriben juntas en el diario */
+    if (error == OK)
+        error = country_journalCommit(country);
+    return error;
 }
 
+// Measured entry point of country_inoculate_first_vaccine_ordered
+tError country_inoculate_first_vaccine_ordered(tCountry* country) {
+    const tAllocator* previous;
+    tError error;
 
-double country_percentage_vaccinated(tCountry* country) {
-    if (country == NULL || country->patients == NULL) return 0.0;
+    INSTRUMENT_START(start);
+    previous = country_enter(country);
+    error = country_inoculate_first_vaccine_orderedImpl(country);
+    allocator_leave(previous);
+    INSTRUMENT_STOP(INSTRUMENT_COUNTRY_INOCULATE_FIRST_ORDERED, start);
 
-    /* calcular longitud y contar completos en una pasada, manteniendo el orden */
-    int len = 0;
-    {
-        tPatientQueue copy;
-        if (patientQueue_duplicate(&copy, *country->patients) == OK) {
-            while (!patientQueue_empty(copy)) {
-                tPatient *tp = patientQueue_dequeue(&copy);
-                if (tp != NULL) {
-                    len++;
-                    patient_free(tp);
-                    free(tp);
-                }
+    return error;
+}
+
+static tError country_inoculate_second_vaccineImpl(tCountry* country) {
+    if (country == NULL || country->patients == NULL || country->vbList == NULL) return ERR_INVALID;
+
+    tPatientQueueCursor cursor;
+    tPatient *p;
+    tVaccineBatch *vb;
+    tError error = OK, closeError;
+
+    patientQueue_cursor(country->patients, &cursor);
+    while ((p = patientQueue_cursorNext(&cursor)) != NULL) {
+        if (p->number_doses == 1) {
+            /* si fue monodosis (Janssen), no corresponde 2ª */
+            if (!(p->vaccine != NULL && eligibility_dosesRequired(p->vaccineId) < 2)) {
+                vb = vaccineBatchList_inoculate_second_vaccine(country->vbList, p);
+                if (error == OK)
+                    error = country_journalDose(country, p, vb);
             }
         }
     }
-    if (len == 0) return 0.0;
 
-    int fully = 0;
-    for (int i = 0; i < len; ++i) {
-        tPatient *p = patientQueue_dequeue(country->patients);
-        if (p == NULL) break;
+    closeError = patientQueue_cursorClose(&cursor);
 
-        int complete = 0;
-        if (p->vaccine != NULL && strcmp(p->vaccine, JANSSEN_VAC) == 0) {
-            complete = (p->number_doses >= 1);
-        } else {
-            complete = (p->number_doses >= 2);
-        }
-        if (complete) fully++;
+    /* las dosis de la ronda se escriben juntas en el diario */
+    if (error == OK)
+        error = country_journalCommit(country);
+    return closeError != OK ? closeError : error;
+}
 
-        patientQueue_enqueue(country->patients, *p);
-        patient_free(p);
-        free(p);
-    }
+// Measured entry point of country_inoculate_second_vaccine
+tError country_inoculate_second_vaccine(tCountry* country) {
+    const tAllocator* previous;
+    tError error;
+
+    INSTRUMENT_START(start);
+    previous = country_enter(country);
+    error = country_inoculate_second_vaccineImpl(country);
+    allocator_leave(previous);
+    INSTRUMENT_STOP(INSTRUMENT_COUNTRY_INOCULATE_SECOND, start);
+
+    return error;
+}
+
+
+double country_percentage_vaccinated(tCountry* country) {
+    if (country == NULL || country->patients == NULL) return 0.0;
+
+    /* la cola conoce su longitud y cuántos pacientes tienen la pauta completa */
+    unsigned int len = patientQueue_size(*country->patients);
+    if (len == 0) return 0.0;
+
+    unsigned int fully = patientQueue_stats(country->patients)->vaccinated;
 
     return (100.0 * (double)fully) / (double)len;
 }
@@ -417,29 +782,59 @@ void countryTable_init(tCountryTable * table) {
     // Using dynamic memory, the pointer to the elements
     // must be set to NULL (no memory allocated).
     table->elements = NULL;
+
+    // The index starts empty too
+    countryIndex_init(&table->index);
+
+    // The memory comes from the allocator of the thread
+    table->allocator = NULL;
+}
+
+// Set the allocator of the memory of the countries of an empty table, or NULL for the allocator of the thread.
+// The functions of the table use it, and the countries of the table keep it
+tError countryTable_setAllocator(tCountryTable* table, const tAllocator* allocator) {
+    // Verify pre conditions
+    assert(table != NULL);
+
+    // The memory has to be released by the allocator that gave it
+    if(table->size > 0 || table->index.capacity > 0) {
+        return ERR_INVALID;
+    }
+
+    table->allocator = allocator;
+
+    return OK;
 }
 
 // Release the memory used by countryTable structure
 void countryTable_free(tCountryTable * table) {
+    const tAllocator* previous;
     int i;
 
     // Verify pre conditions
     assert(table != NULL);
 
+    previous = allocator_enter(table->allocator);
+
     // All memory allocated with malloc and realloc needs to be freed using the free command. In this case, as we use malloc/realloc to allocate the elements, and need to free them.
     if(table->elements != NULL) {
         for(i = 0; i < table->size; i++) {
             country_free(&table->elements[i]);
         }
-        free(table->elements);
+        uoc_free(table->elements);
         table->elements = NULL;
         // As the table is now empty, assign the size to 0.
         table->size = 0;
     }
+
+    // Release the index
+    countryIndex_free(&table->index);
+
+    allocator_leave(previous);
 }
 
-// Add a new country to the table
-tError countryTable_add(tCountryTable * table, tCountry * country) {
+// Add a new country to the table, with the allocator of the table entered
+static tError countryTable_addImpl(tCountryTable * table, tCountry * country) {
     tCountry* elementsAux;
     tError error;
 
@@ -461,7 +856,7 @@ tError countryTable_add(tCountryTable * table, tCountry * country) {
         // we have to use malloc. The amount of memory we need is the number of
         // elements (will be 1) times the size of one element, which is computed
         // by sizeof(type). In this case the type is tCountry.
-        elementsAux = (tCountry*)malloc((table->size + 1) * sizeof(tCountry));
+        elementsAux = (tCountry*)uoc_malloc((table->size + 1) * sizeof(tCountry));
 
         // Check that the memory has been allocated
         if(elementsAux == NULL) {
@@ -478,7 +873,7 @@ tError countryTable_add(tCountryTable * table, tCountry * country) {
         // The amount of memory we need is the number of elements times
         // the size of one element, which is computed by sizeof(type).
         // In this case the type is tCountry. We provide the previous block of memory.
-        elementsAux = (tCountry*)realloc(table->elements, (table->size + 1) * sizeof(tCountry));
+        elementsAux = (tCountry*)uoc_realloc(table->elements, (table->size + 1) * sizeof(tCountry));
         // Check that the memory has been allocated
         if(elementsAux == NULL) {
             // Error allocating or reallocating the memory
@@ -497,84 +892,98 @@ tError countryTable_add(tCountryTable * table, tCountry * country) {
     if(error != OK)
         return error;
 
-    return OK;
+    // Register the new element on the index
+    return countryIndex_add(&table->index, table, table->size - 1);
 }
 
-// Remove a country from the table
-tError countryTable_remove(tCountryTable * table, tCountry * country) {
-    bool found;
-    int i;
+// Add a new country to the table
+tError countryTable_add(tCountryTable * table, tCountry * country) {
+    const tAllocator* previous;
+    tError error;
+
+    // Verify pre conditions
+    assert(table != NULL);
+
+    previous = allocator_enter(table->allocator);
+    error = countryTable_addImpl(table, country);
+    allocator_leave(previous);
+
+    return error;
+}
+
+// Remove a country from the table, with the allocator of the table entered
+static tError countryTable_removeImpl(tCountryTable * table, tCountry * country) {
+    unsigned int i;
     tCountry* elementsAux;
 
     // Verify pre conditions
     assert(table != NULL);
     assert(country != NULL);
 
-    // To remove an element of a table, we will move all elements after this element one position,
-    // to fill the space of the removed element.
-    found = false;
-    for(i = 0; i < table->size; i++) {
-        // If the element has been found. Displace this element to the previous element
-        // (will never happend for the first one). We use the ADDRESS of the previous element &(table->elements[i-1])
-        // as destination, and ADDRESS of the current element &(table->elements[i]) as source.
-        if(found) {
-            // Check the return code to detect memory allocation errors
-            if(country_cpy(&(table->elements[i - 1]), &(table->elements[i])) == ERR_MEMORY_ERROR) {
-                // Error allocating memory. Just stop the process and return memory error.
-                return ERR_MEMORY_ERROR;
-            }
-        } else
-            if(country_equals(&table->elements[i], country)) {
-                // The current element is the element we want to remove. Set found flag to true to start element movement.
-                found = true;
-            }
-    }
+    // Search the position of the element we want to remove
+    for(i = 0; i < table->size && !country_equals(&table->elements[i], country); i++);
 
-    // Once removed the element, we need to modify the memory used by the table.
-    if(found) {
-        // If we are removing the last element, we will free
-        // the last/remaining element in table / assign pointer
-        // to NULL
-        if(table->size <= 1) {
-            countryTable_free(table);
-        } else {
-            country_free(&table->elements[table->size - 1]);
-            // Modify the used memory. As we are modifying a previously
-            // allocated block, we need to use the realloc command.
-            elementsAux = (tCountry*)realloc(table->elements, (table->size - 1) * sizeof(tCountry));
-
-            // Check that the memory has been allocated
-            if(elementsAux == NULL) {
-                // Error allocating or reallocating the memory
-                return ERR_MEMORY_ERROR;
-            } else {
-                table->elements = elementsAux;
-                // Succesfully allocated, set new table size
-                table->size = table->size - 1;
-            }
-        }
-    } else {
-        // If the element was not in the table, return an error.
+    // If the element was not in the table, return an error.
+    if(i == table->size) {
         return ERR_NOT_FOUND;
     }
 
-    return OK;
+    // If we are removing the last element, we will free
+    // the last/remaining element in table / assign pointer
+    // to NULL
+    if(table->size <= 1) {
+        countryTable_free(table);
+        return OK;
+    }
+
+    // Release the removed element, and move all the elements after it one position to fill its space.
+    // The elements are moved and not copied, so that they keep their journal, their intake and
+    // the memory of their patients
+    country_free(&table->elements[i]);
+    memmove(&table->elements[i], &table->elements[i + 1], (table->size - i - 1) * sizeof(tCountry));
+    table->size = table->size - 1;
+
+    // Modify the used memory. As we are modifying a previously
+    // allocated block, we need to use the realloc command.
+    // If the block can not be reduced, the old one is still valid
+    elementsAux = (tCountry*)uoc_realloc(table->elements, table->size * sizeof(tCountry));
+    if(elementsAux != NULL) {
+        table->elements = elementsAux;
+    }
+
+    // The elements after the removed one have been displaced, so the
+    // positions stored in the index are no longer valid.
+    return countryIndex_rebuild(&table->index, table);
+}
+
+// Remove a country from the table
+tError countryTable_remove(tCountryTable * table, tCountry * country) {
+    const tAllocator* previous;
+    tError error;
+
+    // Verify pre conditions
+    assert(table != NULL);
+
+    previous = allocator_enter(table->allocator);
+    error = countryTable_removeImpl(table, country);
+    allocator_leave(previous);
+
+    return error;
 }
 
 // Get country by name
 tCountry* countryTable_find(tCountryTable * table, const char* name) {
-    int i;
+    int position;
 
     // Verify pre conditions
     assert(table != NULL);
     assert(name != NULL);
 
-    // Search over the table and return once we found the element.
-    for(i = 0; i < table->size; i++) {
-        if(strcmp(table->elements[i].name, name) == 0) {
-            // We return the ADDRESS (&) of the element, which is a pointer to the element
-            return &(table->elements[i]);
-        }
+    // Search the name on the index instead of comparing it with all the elements of the table.
+    position = countryIndex_find(&table->index, table, name);
+    if(position >= 0) {
+        // We return the ADDRESS (&) of the element, which is a pointer to the element
+        return &(table->elements[position]);
     }
 
     // The element has not been found. Return NULL (empty pointer).
@@ -592,6 +1001,7 @@ unsigned int countryTable_size(tCountryTable * table) {
 
 // Copy the data of a country to another country
 tError countryTable_cpy(tCountryTable* dest, tCountryTable* src) {
+    const tAllocator* allocator;
     int i;
     tError error;
 
@@ -602,8 +1012,10 @@ tError countryTable_cpy(tCountryTable* dest, tCountryTable* src) {
     // free dest (just in case)
     countryTable_free(dest);
 
-    // initialize dest
+    // initialize dest, which keeps its allocator
+    allocator = dest->allocator;
     countryTable_init(dest);
+    dest->allocator = allocator;
 
     // add countries from src to dest
     for(i = 0; i < src->size; i++) {
@@ -637,28 +1049,40 @@ void country_print(tCountry country) {
 tError countryTable_addPatient(tCountryTable * table, const char* name, tPatient patient) {
     assert(table != NULL);
     assert(name != NULL);
+    const tAllocator* previous;
     tCountry * country;
+    tError error;
 
     country = countryTable_find(table, name);
     if(country == NULL) {
         return ERR_INVALID_COUNTRY;
     }
 
-    return country_addPatient(country, patient);
+    previous = allocator_enter(table->allocator);
+    error = country_addPatient(country, patient);
+    allocator_leave(previous);
+
+    return error;
 }
 
 // Add authorized vaccine to a country
 tError countryTable_addVaccine(tCountryTable * table, const char* name, tVaccine vaccine) {
     assert(table != NULL);
     assert(name != NULL);
+    const tAllocator* previous;
     tCountry * country;
+    tError error;
 
     country = countryTable_find(table, name);
     if(country == NULL) {
         return ERR_INVALID_COUNTRY;
     }
 
-    return country_addVaccine(country, vaccine);
+    previous = allocator_enter(table->allocator);
+    error = country_addVaccine(country, vaccine);
+    allocator_leave(previous);
+
+    return error;
 }
 
 // Returns the number of tCountries that have an authorized vaccine
@@ -683,3 +1107,599 @@ int countryTable_num_authorized(tCountryTable * table) {
     // Return the number of developers found.
     return count;
 }
+
+// Round of a country in countryTable_inoculate_all
+typedef struct {
+    tCountry* country;
+    // Position of the country in the table
+    unsigned int index;
+    // Allocator of the table, entered by the thread that runs the round
+    const tAllocator* allocator;
+    tError error;
+} tCountryRound;
+
+// Give the first and second doses of a round to the patients of a country
+static void countryTable_inoculateCountry(void* arg) {
+    tCountryRound* round = (tCountryRound*)arg;
+    const tAllocator* previous;
+
+    previous = allocator_enter(round->allocator);
+    round->error = country_inoculate_first_vaccine(round->country);
+    if(round->error == OK)
+        round->error = country_inoculate_second_vaccine(round->country);
+    allocator_leave(previous);
+}
+
+// Compare two rounds to start with the countries with most patients. Ties keep the order of the table
+static int countryTable_compareRounds(const void* a, const void* b) {
+    const tCountryRound* round1 = *(const tCountryRound* const*)a;
+    const tCountryRound* round2 = *(const tCountryRound* const*)b;
+    unsigned int size1, size2;
+
+    size1 = patientQueue_size(*round1->country->patients);
+    size2 = patientQueue_size(*round2->country->patients);
+    if(size1 != size2) {
+        return size1 > size2 ? -1 : 1;
+    }
+
+    return round1->index < round2->index ? -1 : (round1->index > round2->index ? 1 : 0);
+}
+
+// Give the first and second doses of a round to the patients of all the countries, using nthreads threads.
+// The countries share no data, so the patients and batches are the same as in a round with one thread
+tError countryTable_inoculate_all(tCountryTable* table, unsigned int nthreads) {
+    tCountryRound* rounds;
+    tCountryRound** order;
+    tThreadPool pool;
+    unsigned int i;
+    tError error;
+
+    // Verify pre conditions
+    assert(table != NULL);
+
+    // The catalogue and the rules are loaded when they are first used. They are only read by the threads
+    error = vaccineCatalog_init();
+    if(error == OK)
+        error = eligibility_init();
+    if(error != OK)
+        return error;
+
+    if(nthreads > table->size) {
+        nthreads = table->size;
+    }
+    if(nthreads > THREAD_POOL_MAX_THREADS) {
+        nthreads = THREAD_POOL_MAX_THREADS;
+    }
+
+    rounds = (tCountryRound*)uoc_malloc(table->size * sizeof(tCountryRound));
+    order = (tCountryRound**)uoc_malloc(table->size * sizeof(tCountryRound*));
+    if(table->size > 0 && (rounds == NULL || order == NULL)) {
+        uoc_free(rounds);
+        uoc_free(order);
+        return ERR_MEMORY_ERROR;
+    }
+
+    for(i = 0; i < table->size; i++) {
+        rounds[i].country = &table->elements[i];
+        rounds[i].index = i;
+        rounds[i].allocator = table->allocator;
+        rounds[i].error = OK;
+        order[i] = &rounds[i];
+    }
+
+    if(nthreads <= 1 || threadPool_init(&pool, nthreads) != OK) {
+        for(i = 0; i < table->size; i++) {
+            countryTable_inoculateCountry(&rounds[i]);
+        }
+    } else {
+        // The largest countries start first, so that none of them is left alone at the end
+        qsort(order, table->size, sizeof(tCountryRound*), countryTable_compareRounds);
+        for(i = 0; i < table->size; i++) {
+            if(threadPool_submit(&pool, countryTable_inoculateCountry, order[i]) != OK) {
+                countryTable_inoculateCountry(order[i]);
+            }
+        }
+        threadPool_free(&pool);
+    }
+
+    // The first error in the order of the table, as with one thread
+    error = OK;
+    for(i = 0; i < table->size && error == OK; i++) {
+        error = rounds[i].error;
+    }
+
+    uoc_free(rounds);
+    uoc_free(order);
+
+    return error;
+}
+
+// Part of the countries of a table for countryTable_stats
+typedef struct {
+    tCountryTable* table;
+    unsigned int first;
+    unsigned int last;
+    // Statistics of the countries of the part. The coverage of each country is written to the result
+    tCountryTableStats stats;
+    double* coverage;
+} tCountryStatsPart;
+
+// Add the patients of a country to a coverage
+static void countryCoverage_add(tCountryCoverage* coverage, const tPatientQueueStats* queueStats, unsigned int patients) {
+    unsigned int i;
+
+    coverage->patients += patients;
+    coverage->vaccinated += queueStats->vaccinated;
+    for(i = 0; i < PATIENT_QUEUE_DOSE_COUNTERS; i++) {
+        coverage->doses[i] += queueStats->doses[i];
+    }
+}
+
+// Add two coverages
+static void countryCoverage_merge(tCountryCoverage* dest, const tCountryCoverage* src) {
+    unsigned int i;
+
+    dest->patients += src->patients;
+    dest->vaccinated += src->vaccinated;
+    for(i = 0; i < PATIENT_QUEUE_DOSE_COUNTERS; i++) {
+        dest->doses[i] += src->doses[i];
+    }
+}
+
+// Compute the statistics of a part of the countries, using the counters kept by their queues
+static void countryTable_statsPart(void* arg) {
+    tCountryStatsPart* part = (tCountryStatsPart*)arg;
+    const tPatientQueueStats* queueStats;
+    tCountry* country;
+    tVaccine* vaccine;
+    unsigned int i, j, patients, count;
+
+    for(i = part->first; i < part->last; i++) {
+        country = &part->table->elements[i];
+        queueStats = patientQueue_stats(country->patients);
+        patients = patientQueue_size(*country->patients);
+
+        countryCoverage_add(&part->stats.total, queueStats, patients);
+        countryCoverage_add(country->isEU ? &part->stats.eu : &part->stats.nonEU, queueStats, patients);
+        part->coverage[i] = patients == 0 ? 0.0 : (100.0 * (double)queueStats->vaccinated) / (double)patients;
+
+        // As country_getPatientsPerVaccine, only the authorized vaccines are counted
+        for(j = 0; j < country->authVaccines->size; j++) {
+            vaccine = &country->authVaccines->elements[j];
+            if(vaccine->id == NO_VACCINE_ID || (unsigned int)vaccine->id >= part->stats.vaccinesCount) {
+                continue;
+            }
+            count = (unsigned int)vaccine->id < queueStats->vaccinesCount ? queueStats->vaccines[vaccine->id] : 0;
+            part->stats.vaccines[vaccine->id] += count;
+            if((unsigned int)vaccine->vaccineTec < VACCINE_TECHNOLOGIES) {
+                part->stats.technologies[vaccine->vaccineTec] += count;
+            }
+        }
+    }
+}
+
+// Compute the statistics of all the countries of a table with one pass over them, using nthreads threads
+tError countryTable_stats(tCountryTable* table, unsigned int nthreads, tCountryTableStats* stats) {
+    tCountryStatsPart* parts;
+    tThreadPool pool;
+    unsigned int i, j, count, length;
+    bool parallel;
+    tError error;
+
+    // Verify pre conditions
+    assert(table != NULL);
+    assert(stats != NULL);
+
+    memset(stats, 0, sizeof(tCountryTableStats));
+
+    // The counters of the queues are checked against the rules, which are only read by the threads
+    error = eligibility_init();
+    if(error != OK)
+        return error;
+
+    // Each thread takes at least COUNTRY_STATS_PART countries, fewer are not worth a thread
+    count = (table->size + COUNTRY_STATS_PART - 1) / COUNTRY_STATS_PART;
+    if(count > nthreads) {
+        count = nthreads;
+    }
+    if(count > THREAD_POOL_MAX_THREADS) {
+        count = THREAD_POOL_MAX_THREADS;
+    }
+    if(count == 0) {
+        count = 1;
+    }
+
+    stats->vaccinesCount = vaccineCatalog_size();
+    stats->countries = table->size;
+    stats->vaccines = (unsigned long*)uoc_calloc(stats->vaccinesCount + 1, sizeof(unsigned long));
+    stats->coverage = (double*)uoc_malloc((table->size + 1) * sizeof(double));
+    parts = (tCountryStatsPart*)uoc_calloc(count, sizeof(tCountryStatsPart));
+    if(stats->vaccines == NULL || stats->coverage == NULL || parts == NULL) {
+        uoc_free(parts);
+        countryTableStats_free(stats);
+        return ERR_MEMORY_ERROR;
+    }
+
+    // Contiguous parts of the table, each one with its own counters
+    length = (table->size + count - 1) / count;
+    for(i = 0; i < count; i++) {
+        parts[i].table = table;
+        parts[i].first = i * length < table->size ? i * length : table->size;
+        parts[i].last = (i + 1) * length < table->size ? (i + 1) * length : table->size;
+        parts[i].coverage = stats->coverage;
+        parts[i].stats.vaccinesCount = stats->vaccinesCount;
+        parts[i].stats.vaccines = (unsigned long*)uoc_calloc(stats->vaccinesCount + 1, sizeof(unsigned long));
+        if(parts[i].stats.vaccines == NULL) {
+            for(j = 0; j < i; j++) {
+                uoc_free(parts[j].stats.vaccines);
+            }
+            uoc_free(parts);
+            countryTableStats_free(stats);
+            return ERR_MEMORY_ERROR;
+        }
+    }
+
+    parallel = count > 1 && threadPool_init(&pool, count) == OK;
+    for(i = 0; i < count; i++) {
+        if(!parallel || threadPool_submit(&pool, countryTable_statsPart, &parts[i]) != OK) {
+            countryTable_statsPart(&parts[i]);
+        }
+    }
+    if(parallel) {
+        threadPool_free(&pool);
+    }
+
+    // Merge the counters of the parts
+    for(i = 0; i < count; i++) {
+        countryCoverage_merge(&stats->total, &parts[i].stats.total);
+        countryCoverage_merge(&stats->eu, &parts[i].stats.eu);
+        countryCoverage_merge(&stats->nonEU, &parts[i].stats.nonEU);
+        for(j = 0; j < stats->vaccinesCount; j++) {
+            stats->vaccines[j] += parts[i].stats.vaccines[j];
+        }
+        for(j = 0; j < VACCINE_TECHNOLOGIES; j++) {
+            stats->technologies[j] += parts[i].stats.technologies[j];
+        }
+        uoc_free(parts[i].stats.vaccines);
+    }
+    uoc_free(parts);
+
+    return OK;
+}
+
+// Release the memory used by the statistics of a table
+void countryTableStats_free(tCountryTableStats* stats) {
+    // Verify pre conditions
+    assert(stats != NULL);
+
+    uoc_free(stats->vaccines);
+    uoc_free(stats->coverage);
+    memset(stats, 0, sizeof(tCountryTableStats));
+}
+
+// Get the percentage of vaccinated patients of a set of countries
+double countryCoverage_percentage(const tCountryCoverage* coverage) {
+    // Verify pre conditions
+    assert(coverage != NULL);
+
+    if(coverage->patients == 0) {
+        return 0.0;
+    }
+
+    return (100.0 * (double)coverage->vaccinated) / (double)coverage->patients;
+}
+
+// Write the doses given to the patients of all the countries of the table to a journal, or stop with NULL.
+// Countries added later need country_setJournal
+tError countryTable_setJournal(tCountryTable* table, tJournal* journal) {
+    unsigned int i;
+    tError error;
+
+    // Verify pre conditions
+    assert(table != NULL);
+
+    for(i = 0; i < table->size; i++) {
+        error = country_setJournal(&table->elements[i], journal);
+        if(error != OK)
+            return error;
+    }
+
+    return OK;
+}
+
+// Give a dose of a journal to a patient of a country, and take it from its batch.
+// Returns false if the patient is not found or the dose does not follow the doses of the patient
+static bool countryTable_replayDose(tCountry* country, const tJournalDose* dose, tVaccineId vaccineId) {
+    tVaccinationBatchListNode* node;
+    tPatient* patient;
+
+    patient = patientQueue_findById(country->patients, dose->patient);
+    if(patient == NULL || patient->number_doses != dose->dose - 1 || (dose->dose > 1 && patient->vaccineId != vaccineId)) {
+        return false;
+    }
+
+    // The counters of the queue are updated with the change
+    patientQueue_beginUpdate(country->patients, patient);
+    if(dose->dose == 1) {
+        patient->vaccine = (char*) vaccineCatalog_name(vaccineId);
+        patient->vaccineId = vaccineId;
+        patient->lotID = dose->lotID;
+    }
+    patient->number_doses = dose->dose;
+    patientQueue_endUpdate(country->patients, patient);
+
+    for(node = country->vbList->first; node != NULL; node = node->next) {
+        if(node->e.lotID == dose->lotID && node->e.vaccine->id == vaccineId && node->e.quantity > 0) {
+            node->e.quantity--;
+            break;
+        }
+    }
+
+    return true;
+}
+
+// Give again the doses of a journal to the patients of the table, with the allocator of the table entered
+static tError countryTable_replayJournalImpl(tCountryTable* table, const char* filename, tJournalReplayReport* report) {
+    tJournalReader reader;
+    tJournalRecord record;
+    tCountry** countries;
+    tCountry** countriesAux;
+    tVaccineId* vaccines;
+    tVaccineId* vaccinesAux;
+    unsigned int countriesCount, vaccinesCount;
+    tError error;
+
+    // Verify pre conditions
+    assert(table != NULL);
+    assert(filename != NULL);
+    assert(report != NULL);
+
+    memset(report, 0, sizeof(tJournalReplayReport));
+
+    error = journalReader_open(&reader, filename);
+    if(error != OK)
+        return error;
+
+    // Countries and vaccines of the ids of the journal
+    countries = NULL;
+    countriesCount = 0;
+    vaccines = NULL;
+    vaccinesCount = 0;
+
+    while(error == OK && (error = journalReader_next(&reader, &record)) == OK) {
+        if(record.kind == JOURNAL_COUNTRY) {
+            // The ids of the countries are given in order
+            if(record.name.id != (int)countriesCount) {
+                error = ERR_INVALID;
+                break;
+            }
+            countriesAux = (tCountry**)uoc_realloc(countries, (countriesCount + 1) * sizeof(tCountry*));
+            if(countriesAux == NULL) {
+                error = ERR_MEMORY_ERROR;
+                break;
+            }
+            countries = countriesAux;
+            countries[countriesCount++] = countryTable_find(table, record.text);
+        } else if(record.kind == JOURNAL_VACCINE) {
+            if(record.name.id < 0 || record.name.id > INT16_MAX) {
+                error = ERR_INVALID;
+                break;
+            }
+            if((unsigned int)record.name.id >= vaccinesCount) {
+                vaccinesAux = (tVaccineId*)uoc_realloc(vaccines, (record.name.id + 1) * sizeof(tVaccineId));
+                if(vaccinesAux == NULL) {
+                    error = ERR_MEMORY_ERROR;
+                    break;
+                }
+                vaccines = vaccinesAux;
+                while(vaccinesCount <= (unsigned int)record.name.id) {
+                    vaccines[vaccinesCount++] = NO_VACCINE_ID;
+                }
+            }
+            error = vaccineCatalog_intern(record.text, NONE, PRECLINICAL, &vaccines[record.name.id]);
+        } else {
+            if(record.dose.country >= countriesCount || record.dose.vaccine < 0 || (unsigned int)record.dose.vaccine >= vaccinesCount ||
+                    vaccines[record.dose.vaccine] == NO_VACCINE_ID || record.dose.dose == 0) {
+                error = ERR_INVALID;
+                break;
+            }
+            // Doses of countries that are not in the table are skipped too
+            if(countries[record.dose.country] != NULL &&
+                    countryTable_replayDose(countries[record.dose.country], &record.dose, vaccines[record.dose.vaccine])) {
+                report->applied++;
+            } else {
+                report->skipped++;
+            }
+        }
+    }
+    if(error == ERR_EMPTY) {
+        error = OK;
+    }
+
+    report->frames = reader.frames;
+    report->truncated = reader.truncated;
+
+    journalReader_close(&reader);
+    uoc_free(countries);
+    uoc_free(vaccines);
+
+    return error;
+}
+
+// Give again the doses of a journal to the patients of the table, usually loaded from the snapshot taken before the journal.
+// The doses that the patients already have are skipped
+tError countryTable_replayJournal(tCountryTable* table, const char* filename, tJournalReplayReport* report) {
+    const tAllocator* previous;
+    tError error;
+
+    // Verify pre conditions
+    assert(table != NULL);
+
+    previous = allocator_enter(table->allocator);
+    error = countryTable_replayJournalImpl(table, filename, report);
+    allocator_leave(previous);
+
+    return error;
+}
+
+// **** Functions related to management of tCountryIndex objects
+
+// Initialize an empty index
+void countryIndex_init(tCountryIndex* index) {
+    // Verify pre conditions
+    assert(index != NULL);
+
+    // An empty index has no slots. Memory is allocated with the first element.
+    index->capacity = 0;
+    index->count = 0;
+    index->positions = NULL;
+    index->hashes = NULL;
+}
+
+// Release the memory used by the index
+void countryIndex_free(tCountryIndex* index) {
+    // Verify pre conditions
+    assert(index != NULL);
+
+    if(index->positions != NULL) {
+        uoc_free(index->positions);
+        index->positions = NULL;
+    }
+
+    if(index->hashes != NULL) {
+        uoc_free(index->hashes);
+        index->hashes = NULL;
+    }
+
+    index->capacity = 0;
+    index->count = 0;
+}
+
+// Change the number of slots of the index, placing again all the stored positions
+static tError countryIndex_resize(tCountryIndex* index, unsigned int capacity) {
+    int* positions;
+    unsigned int* hashes;
+    unsigned int i, slot;
+
+    // The capacity must be a power of two, to compute the slot with a mask
+    assert((capacity & (capacity - 1)) == 0);
+    assert(capacity >= 2 * index->count);
+
+    positions = (int*)uoc_malloc(capacity * sizeof(int));
+    hashes = (unsigned int*)uoc_malloc(capacity * sizeof(unsigned int));
+    if(positions == NULL || hashes == NULL) {
+        uoc_free(positions);
+        uoc_free(hashes);
+        return ERR_MEMORY_ERROR;
+    }
+
+    for(i = 0; i < capacity; i++) {
+        positions[i] = -1;
+        hashes[i] = 0;
+    }
+
+    // Move the old slots to the new arrays. The hash is stored, so there is no need to
+    // access the names of the countries.
+    for(i = 0; i < index->capacity; i++) {
+        if(index->positions[i] >= 0) {
+            slot = index->hashes[i] & (capacity - 1);
+            while(positions[slot] >= 0) {
+                slot = (slot + 1) & (capacity - 1);
+            }
+            positions[slot] = index->positions[i];
+            hashes[slot] = index->hashes[i];
+        }
+    }
+
+    uoc_free(index->positions);
+    uoc_free(index->hashes);
+    index->positions = positions;
+    index->hashes = hashes;
+    index->capacity = capacity;
+
+    return OK;
+}
+
+// Add the country stored at the given position of the table to the index
+tError countryIndex_add(tCountryIndex* index, tCountryTable* table, int position) {
+    unsigned int hash, slot;
+    tError error;
+
+    // Verify pre conditions
+    assert(index != NULL);
+    assert(table != NULL);
+    assert(position >= 0 && (unsigned int)position < table->size);
+
+    // Keep the index at most half full, so that probe sequences stay short
+    if(2 * (index->count + 1) > index->capacity) {
+        error = countryIndex_resize(index, index->capacity == 0 ? 16 : 2 * index->capacity);
+        if(error != OK)
+            return error;
+    }
+
+    // Linear probing: use the first free slot starting at the one given by the hash
+    hash = string_hash(table->elements[position].name);
+    slot = hash & (index->capacity - 1);
+    while(index->positions[slot] >= 0) {
+        slot = (slot + 1) & (index->capacity - 1);
+    }
+
+    index->positions[slot] = position;
+    index->hashes[slot] = hash;
+    index->count++;
+
+    return OK;
+}
+
+// Get the position in the table of the country with the given name, or -1 if not found
+int countryIndex_find(tCountryIndex* index, tCountryTable* table, const char* name) {
+    unsigned int hash, slot;
+    int position;
+
+    // Verify pre conditions
+    assert(index != NULL);
+    assert(table != NULL);
+    assert(name != NULL);
+
+    if(index->count == 0) {
+        return -1;
+    }
+
+    // Follow the probe sequence until an empty slot is reached. The names are only
+    // compared when the stored hash matches.
+    hash = string_hash(name);
+    slot = hash & (index->capacity - 1);
+    while(index->positions[slot] >= 0) {
+        position = index->positions[slot];
+        if(index->hashes[slot] == hash && strcmp(table->elements[position].name, name) == 0) {
+            return position;
+        }
+        slot = (slot + 1) & (index->capacity - 1);
+    }
+
+    return -1;
+}
+
+// Build the index again from all the elements of the table
+tError countryIndex_rebuild(tCountryIndex* index, tCountryTable* table) {
+    unsigned int i;
+    tError error;
+
+    // Verify pre conditions
+    assert(index != NULL);
+    assert(table != NULL);
+
+    // Empty all the slots, but keep the allocated memory
+    for(i = 0; i < index->capacity; i++) {
+        index->positions[i] = -1;
+    }
+    index->count = 0;
+
+    for(i = 0; i < table->size; i++) {
+        error = countryIndex_add(index, table, i);
+        if(error != OK)
+            return error;
+    }
+
+    return OK;
+}
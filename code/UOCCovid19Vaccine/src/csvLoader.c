@@ -0,0 +1,471 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <assert.h>
+#include "vaccineCatalog.h"
+#include "csvLoader.h"
+#include "allocator.h"
+
+// Names of the kinds of rows, in the order of tCsvRowKind
+static const char* rowKindNames[CSV_ROW_KINDS] = {
+    "COUNTRY",
+    "VACCINE",
+    "PATIENT",
+    "BATCH"
+};
+
+// Number of fields of each kind of row, including the kind
+static const int rowKindFields[CSV_ROW_KINDS] = { 3, 5, 8, 5 };
+
+// State of a load
+typedef struct {
+    tCountryTable* table;
+    const tCsvLoadOptions* options;
+    // Country of the last row. Rows of the same country usually come together
+    tCountry* country;
+} tCsvLoader;
+
+// Current time in seconds
+static double csvLoader_now() {
+    struct timespec ts;
+
+    timespec_get(&ts, TIME_UTC);
+
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// Split a line in fields, ending each field with '\0' in place. Quoted fields
+// are unescaped in place too. Returns the number of fields, or -1 if the line is wrong
+static int csvLoader_split(char* line, char* end, char** fields) {
+    char *p, *out;
+    int count;
+
+    p = line;
+    count = 0;
+    while(true) {
+        if(count == CSV_LOADER_MAX_FIELDS) {
+            return -1;
+        }
+        if(p < end && *p == '"') {
+            // Quoted field: two quotes stand for one quote
+            out = ++p;
+            fields[count] = out;
+            while(p < end && (*p != '"' || (p + 1 < end && p[1] == '"'))) {
+                if(*p == '"') {
+                    p++;
+                }
+                *out++ = *p++;
+            }
+            if(p == end) {
+                return -1;
+            }
+            p++;
+            if(p < end && *p != ',') {
+                return -1;
+            }
+        } else {
+            fields[count] = p;
+            while(p < end && *p != ',') {
+                p++;
+            }
+            out = p;
+        }
+        count++;
+        // The field ends where its text ends. The end of the line is the '\n' or a spare byte
+        *out = '\0';
+        if(p == end) {
+            return count;
+        }
+        p++;
+    }
+}
+
+// Parse an integer field. The whole field must be a number
+static bool csvLoader_parseInt(const char* field, int* value) {
+    long result;
+    bool negative;
+
+    negative = *field == '-';
+    if(negative) {
+        field++;
+    }
+    if(*field == '\0') {
+        return false;
+    }
+
+    result = 0;
+    while(*field >= '0' && *field <= '9') {
+        result = result * 10 + (*field - '0');
+        if(result > 2147483647L) {
+            return false;
+        }
+        field++;
+    }
+    if(*field != '\0') {
+        return false;
+    }
+
+    *value = (int)(negative ? -result : result);
+
+    return true;
+}
+
+// Parse a patient group, given by its number or by its name
+static bool csvLoader_parseGroup(const char* field, tPatientGroup* group) {
+    int value;
+
+    if(csvLoader_parseInt(field, &value)) {
+        if(value < HEALTH_WORKER || value >= PATIENT_GROUPS) {
+            return false;
+        }
+        *group = (tPatientGroup)value;
+        return true;
+    }
+
+    return patient_groupFromName(field, group) == OK;
+}
+
+// Get the country of a row, or NULL if it is not in the table
+static tCountry* csvLoader_country(tCsvLoader* loader, const char* name) {
+    if(loader->country == NULL || strcmp(loader->country->name, name) != 0) {
+        loader->country = countryTable_find(loader->table, name);
+    }
+
+    return loader->country;
+}
+
+// COUNTRY,name,isEU
+static tError csvLoader_addCountry(tCsvLoader* loader, char** fields) {
+    tCountry key;
+    tCountry* country;
+    tError error;
+
+    if(strcmp(fields[2], "1") == 0 || strcmp(fields[2], "true") == 0) {
+        key.isEU = true;
+    } else if(strcmp(fields[2], "0") == 0 || strcmp(fields[2], "false") == 0) {
+        key.isEU = false;
+    } else {
+        return ERR_INVALID;
+    }
+    key.name = fields[1];
+
+    // The table may move its countries
+    loader->country = NULL;
+
+    error = countryTable_add(loader->table, &key);
+    if(error != OK)
+        return error;
+
+    if(loader->options->useArenas) {
+        country = countryTable_find(loader->table, key.name);
+        assert(country != NULL);
+        return country_enableArena(country);
+    }
+
+    return OK;
+}
+
+// VACCINE,country,name,tec,phase
+static tError csvLoader_addVaccine(tCsvLoader* loader, char** fields) {
+    tCountry* country;
+    tVaccine vaccine;
+    int tec, phase;
+
+    country = csvLoader_country(loader, fields[1]);
+    if(country == NULL) {
+        return ERR_NOT_FOUND;
+    }
+
+    if(fields[2][0] == '\0' || !csvLoader_parseInt(fields[3], &tec) || tec < NONE || tec > RNA ||
+            !csvLoader_parseInt(fields[4], &phase) || phase < PRECLINICAL || phase > PHASE3) {
+        return ERR_INVALID;
+    }
+
+    // The table makes its own copy of the name
+    vaccine.name = fields[2];
+    vaccine.id = NO_VACCINE_ID;
+    vaccine.vaccineTec = (tVaccineTec)tec;
+    vaccine.vaccinePhase = (tVaccinePhase)phase;
+
+    return country_addVaccine(country, vaccine);
+}
+
+// PATIENT,country,id,name,group,doses,vaccine,lotID
+static tError csvLoader_addPatient(tCsvLoader* loader, char** fields) {
+    tCountry* country;
+    tPatient patient;
+
+    country = csvLoader_country(loader, fields[1]);
+    if(country == NULL) {
+        return ERR_NOT_FOUND;
+    }
+
+    if(!csvLoader_parseInt(fields[2], &patient.id) || patient.id <= 0 || fields[3][0] == '\0' ||
+            !csvLoader_parseGroup(fields[4], &patient.group) ||
+            !csvLoader_parseInt(fields[5], &patient.number_doses) || patient.number_doses < 0) {
+        return ERR_INVALID;
+    }
+
+    // The patient is not initialized with patient_init: the queue copies the name from the buffer
+    patient.name = fields[3];
+    patient.vaccine = NULL;
+    patient.vaccineId = NO_VACCINE_ID;
+    patient.lotID = 0;
+
+    // The vaccine name is shared with the catalogue
+    if(fields[6][0] != '\0') {
+        if(!csvLoader_parseInt(fields[7], &patient.lotID)) {
+            return ERR_INVALID;
+        }
+        if(vaccineCatalog_intern(fields[6], NONE, PRECLINICAL, &patient.vaccineId) != OK) {
+            return ERR_MEMORY_ERROR;
+        }
+        patient.vaccine = (char*) vaccineCatalog_name(patient.vaccineId);
+    }
+
+    return country_addPatient(country, patient);
+}
+
+// BATCH,country,lotID,vaccine,quantity
+static tError csvLoader_addBatch(tCsvLoader* loader, char** fields) {
+    tCountry* country;
+    tVaccine vaccine;
+    tVaccineBatch batch;
+    int lotID, quantity;
+    tError error;
+
+    country = csvLoader_country(loader, fields[1]);
+    if(country == NULL) {
+        return ERR_NOT_FOUND;
+    }
+
+    if(!csvLoader_parseInt(fields[2], &lotID) || fields[3][0] == '\0' ||
+            !csvLoader_parseInt(fields[4], &quantity) || quantity < 0) {
+        return ERR_INVALID;
+    }
+
+    // The batch points to the vaccine of the catalogue
+    vaccine.name = fields[3];
+    vaccine.id = NO_VACCINE_ID;
+    vaccine.vaccineTec = NONE;
+    vaccine.vaccinePhase = PRECLINICAL;
+
+    error = vaccinationBatch_init(&batch, lotID, &vaccine, quantity);
+    if(error != OK)
+        return error;
+
+    return vaccineBatchList_append(country->vbList, batch);
+}
+
+// Load a line of the file, without its end of line
+static tError csvLoader_loadLine(tCsvLoader* loader, char* line, char* end, tCsvLoadReport* report) {
+    char* fields[CSV_LOADER_MAX_FIELDS];
+    int count, kind;
+    tError error;
+
+    // Skip empty lines and comments
+    if(line == end || *line == '#') {
+        return OK;
+    }
+
+    count = csvLoader_split(line, end, fields);
+    if(count < 0) {
+        return ERR_INVALID;
+    }
+
+    for(kind = 0; kind < CSV_ROW_KINDS && strcmp(fields[0], rowKindNames[kind]) != 0; kind++);
+    if(kind == CSV_ROW_KINDS || count != rowKindFields[kind]) {
+        return ERR_INVALID;
+    }
+
+    switch(kind) {
+    case CSV_COUNTRY:
+        error = csvLoader_addCountry(loader, fields);
+        break;
+    case CSV_VACCINE:
+        error = csvLoader_addVaccine(loader, fields);
+        break;
+    case CSV_PATIENT:
+        error = csvLoader_addPatient(loader, fields);
+        break;
+    default:
+        error = csvLoader_addBatch(loader, fields);
+        break;
+    }
+
+    if(error == OK) {
+        report->rows[kind]++;
+    }
+
+    return error;
+}
+
+// Load a line of the file ending at its end of line, counting it in the report.
+// Only the errors of memory stop the load, the other errors reject the row
+static tError csvLoader_loadRow(tCsvLoader* loader, char* line, char* end, tCsvLoadReport* report) {
+    tError error;
+
+    report->lines++;
+    if(end > line && end[-1] == '\r') {
+        end--;
+    }
+
+    error = csvLoader_loadLine(loader, line, end, report);
+    if(error == OK || error == ERR_MEMORY_ERROR)
+        return error;
+
+    if(report->rejected++ == 0) {
+        report->firstRejectedLine = report->lines;
+        report->firstError = error;
+    }
+
+    return OK;
+}
+
+// Get the default options of a load
+void csvLoader_defaultOptions(tCsvLoadOptions* options) {
+    // Verify pre conditions
+    assert(options != NULL);
+
+    options->bufferSize = CSV_LOADER_BUFFER_SIZE;
+    options->useArenas = false;
+}
+
+// Load the rows of a CSV file into a table of countries, with the allocator of the table entered
+static tError csvLoader_loadFileImpl(tCountryTable* table, const char* filename, const tCsvLoadOptions* options, tCsvLoadReport* report) {
+    tCsvLoadOptions defaultOptions;
+    tCsvLoader loader;
+    FILE* fin;
+    char *buffer, *bufferAux, *line, *newline, *end;
+    size_t bufferSize, kept, bytes;
+    double start;
+    bool eof;
+    tError error;
+
+    // Verify pre conditions
+    assert(table != NULL);
+    assert(filename != NULL);
+    assert(report != NULL);
+
+    if(options == NULL) {
+        csvLoader_defaultOptions(&defaultOptions);
+        options = &defaultOptions;
+    }
+
+    memset(report, 0, sizeof(tCsvLoadReport));
+    report->firstError = OK;
+    start = csvLoader_now();
+
+    fin = fopen(filename, "rb");
+    if(fin == NULL) {
+        return ERR_NOT_FOUND;
+    }
+
+    // One spare byte ends the last line when the file does not end with a newline
+    bufferSize = options->bufferSize > 0 ? options->bufferSize : CSV_LOADER_BUFFER_SIZE;
+    buffer = (char*)uoc_malloc(bufferSize + 1);
+    if(buffer == NULL) {
+        fclose(fin);
+        return ERR_MEMORY_ERROR;
+    }
+
+    loader.table = table;
+    loader.options = options;
+    loader.country = NULL;
+
+    error = OK;
+    kept = 0;
+    eof = false;
+    while(!eof && error == OK) {
+        // A line that does not fit in the buffer makes it grow
+        if(kept == bufferSize) {
+            bufferAux = (char*)uoc_realloc(buffer, 2 * bufferSize + 1);
+            if(bufferAux == NULL) {
+                error = ERR_MEMORY_ERROR;
+                break;
+            }
+            buffer = bufferAux;
+            bufferSize *= 2;
+        }
+
+        bytes = fread(buffer + kept, 1, bufferSize - kept, fin);
+        report->bytes += bytes;
+        end = buffer + kept + bytes;
+        eof = bytes < bufferSize - kept;
+
+        // Load the complete lines of the buffer
+        line = buffer;
+        while(error == OK && (newline = (char*)memchr(line, '\n', end - line)) != NULL) {
+            error = csvLoader_loadRow(&loader, line, newline, report);
+            line = newline + 1;
+        }
+
+        // The last line may continue in the next chunk
+        kept = end - line;
+        if(error == OK && eof && kept > 0) {
+            error = csvLoader_loadRow(&loader, line, end, report);
+        } else if(kept > 0) {
+            memmove(buffer, line, kept);
+        }
+    }
+
+    if(error == OK && ferror(fin)) {
+        error = ERR_INVALID;
+    }
+
+    uoc_free(buffer);
+    fclose(fin);
+
+    report->seconds = csvLoader_now() - start;
+
+    return error;
+}
+
+// Load the rows of a CSV file into a table of countries. Rows that can not be loaded are counted in the report
+tError csvLoader_loadFile(tCountryTable* table, const char* filename, const tCsvLoadOptions* options, tCsvLoadReport* report) {
+    const tAllocator* previous;
+    tError error;
+
+    // Verify pre conditions
+    assert(table != NULL);
+
+    previous = allocator_enter(table->allocator);
+    error = csvLoader_loadFileImpl(table, filename, options, report);
+    allocator_leave(previous);
+
+    return error;
+}
+
+// Get the rows loaded per second
+double csvLoader_rowsPerSecond(const tCsvLoadReport* report) {
+    unsigned long rows;
+    int i;
+
+    // Verify pre conditions
+    assert(report != NULL);
+
+    rows = 0;
+    for(i = 0; i < CSV_ROW_KINDS; i++) {
+        rows += report->rows[i];
+    }
+
+    return report->seconds > 0 ? rows / report->seconds : 0;
+}
+
+// Print the result of a load
+void csvLoader_printReport(const tCsvLoadReport* report) {
+    int i;
+
+    // Verify pre conditions
+    assert(report != NULL);
+
+    for(i = 0; i < CSV_ROW_KINDS; i++) {
+        printf("%s rows: %lu\n", rowKindNames[i], report->rows[i]);
+    }
+    printf("Rejected rows: %lu\n", report->rejected);
+    if(report->rejected > 0) {
+        printf("First rejected line: %lu (error %d)\n", report->firstRejectedLine, report->firstError);
+    }
+    printf("Read %lu lines, %zu bytes in %.3f s (%.0f rows/s)\n", report->lines, report->bytes, report->seconds, csvLoader_rowsPerSecond(report));
+}
@@ -5,6 +5,7 @@
 #include <ctype.h>
 #include <stdio.h>
 #include "developer.h"
+#include "allocator.h"
 
 // **** Functions related to management of tDeveloper objects
 // Initialize a developer object
@@ -21,9 +22,9 @@ tError developer_init(tDeveloper* dev, const char* name, const char* country, tV
     // Allocate the memory for all the fields, using the length of the provided
     // text plus 1 space for the "end of string" char '\0'.
     // To allocate memory we use the malloc command.
-    dev->name = (char*)malloc((strlen(name) + 1) * sizeof(char));
-    dev->country = (char*)malloc((strlen(country) + 1) * sizeof(char));
-    dev->vaccine = (tVaccine*)malloc(sizeof(tVaccine));
+    dev->name = (char*)uoc_malloc((strlen(name) + 1) * sizeof(char));
+    dev->country = (char*)uoc_malloc((strlen(country) + 1) * sizeof(char));
+    dev->vaccine = (tVaccine*)uoc_malloc(sizeof(tVaccine));
 
     // Check that memory has been allocated for all fields.
     // Pointer must be different from NULL.
@@ -59,18 +60,18 @@ void developer_free(tDeveloper* object) {
     // All memory allocated with malloc and realloc needs to be freed using the free command.
     // In this case, as we use malloc to allocate the fields, we have to free them
     if(object->name != NULL) {
-        free(object->name);
+        uoc_free(object->name);
         object->name = NULL;
     }
 
     if(object->country != NULL) {
-        free(object->country);
+        uoc_free(object->country);
         object->country = NULL;
     }
 
     if(object->vaccine != NULL) {
         vaccine_free(object->vaccine);
-        free(object->vaccine);
+        uoc_free(object->vaccine);
         object->vaccine = NULL;
     }
 }
@@ -148,7 +149,7 @@ void developerTable_free(tDeveloperTable* table) {
         for(i = 0; i < table->size; i++) {
             developer_free(&table->elements[i]);
         }
-        free(table->elements);
+        uoc_free(table->elements);
         table->elements = NULL;
         // As the table is now empty, assign the size to 0.
         table->size = 0;
@@ -179,7 +180,7 @@ tError developerTable_add(tDeveloperTable* table, tDeveloper* dev) {
         // we have to use malloc. The amount of memory we need is the number of
         // elements (will be 1) times the size of one element, which is computed
         // by sizeof(type). In this case the type is tDeveloper.
-        elementsAux = (tDeveloper*)malloc((table->size + 1) * sizeof(tDeveloper));
+        elementsAux = (tDeveloper*)uoc_malloc((table->size + 1) * sizeof(tDeveloper));
 
         // Check that the memory has been allocated
         if(elementsAux == NULL) {
@@ -196,7 +197,7 @@ tError developerTable_add(tDeveloperTable* table, tDeveloper* dev) {
         // The amount of memory we need is the number of elements times
         // the size of one element, which is computed by sizeof(type).
         // In this case the type is tDeveloper. We provide the previous block of memory.
-        elementsAux = (tDeveloper*)realloc(table->elements, (table->size + 1) * sizeof(tDeveloper));
+        elementsAux = (tDeveloper*)uoc_realloc(table->elements, (table->size + 1) * sizeof(tDeveloper));
         // Check that the memory has been allocated
         if(elementsAux == NULL) {
             // Error allocating or reallocating the memory
@@ -260,7 +261,7 @@ tError developerTable_remove(tDeveloperTable* table, tDeveloper* dev) {
             developer_free(&table->elements[table->size - 1]);
             // Modify the used memory. As we are modifying a previously
             // allocated block, we need to use the realloc command.
-            elementsAux = (tDeveloper*)realloc(table->elements, (table->size - 1) * sizeof(tDeveloper));
+            elementsAux = (tDeveloper*)uoc_realloc(table->elements, (table->size - 1) * sizeof(tDeveloper));
 
             // Check that the memory has been allocated
             if(elementsAux == NULL) {
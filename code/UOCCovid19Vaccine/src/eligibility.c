@@ -0,0 +1,258 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "vaccineCatalog.h"
+#include "eligibility.h"
+#include "allocator.h"
+
+// The rules are shared by all the objects of the library
+static tEligibilityRules rules = { false, 0, NULL, NULL, 0 };
+
+// Rules compiled in the library
+static const char* defaultRules[] = {
+    ASTRAZENECA_VAC ";2;ADULT_OVER_65,COMORBID",
+    JANSSEN_VAC ";1;",
+    NULL
+};
+
+// Remove the blanks at the start and at the end of a string, in place
+static char* eligibility_trim(char* str) {
+    char* end;
+
+    while(*str == ' ' || *str == '\t') {
+        str++;
+    }
+
+    end = str + strlen(str);
+    while(end > str && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r' || end[-1] == '\n')) {
+        end--;
+    }
+    *end = '\0';
+
+    return str;
+}
+
+// Set the rule of a vaccine id, making room for it in the tables
+static tError eligibility_set(tVaccineId id, unsigned int excluded, int doses) {
+    const tAllocator* previous;
+    unsigned int* excludedAux;
+    int* dosesAux;
+    unsigned int i, count;
+
+    assert(id >= 0);
+
+    if((unsigned int)id >= rules.count) {
+        count = (unsigned int)id + 1;
+
+        // The rules are shared by all the tables, so they are kept in the global allocator
+        previous = allocator_enterGlobal();
+        excludedAux = (unsigned int*)uoc_realloc(rules.excluded, count * sizeof(unsigned int));
+        if(excludedAux != NULL) {
+            rules.excluded = excludedAux;
+        }
+        dosesAux = excludedAux == NULL ? NULL : (int*)uoc_realloc(rules.doses, count * sizeof(int));
+        if(dosesAux != NULL) {
+            rules.doses = dosesAux;
+        }
+        allocator_leave(previous);
+
+        if(dosesAux == NULL) {
+            return ERR_MEMORY_ERROR;
+        }
+
+        // The ids between the old and the new rule have no rule
+        for(i = rules.count; i < count; i++) {
+            rules.excluded[i] = 0;
+            rules.doses[i] = ELIGIBILITY_DEFAULT_DOSES;
+        }
+        rules.count = count;
+    }
+
+    rules.excluded[id] = excluded;
+    rules.doses[id] = doses;
+    rules.version++;
+
+    return OK;
+}
+
+// Add a rule to the tables
+static tError eligibility_add(const char* rule) {
+    char buffer[ELIGIBILITY_MAX_RULE];
+    char *name, *doses, *groups, *group, *next, *end;
+    unsigned int excluded;
+    tPatientGroup patientGroup;
+    tVaccineId id;
+    tError error;
+    long value;
+
+    if(strlen(rule) >= ELIGIBILITY_MAX_RULE) {
+        return ERR_INVALID;
+    }
+    strcpy(buffer, rule);
+
+    // The rule has three fields separated by ';'
+    name = buffer;
+    doses = strchr(name, ';');
+    if(doses == NULL) {
+        return ERR_INVALID;
+    }
+    *doses++ = '\0';
+    groups = strchr(doses, ';');
+    if(groups == NULL) {
+        return ERR_INVALID;
+    }
+    *groups++ = '\0';
+
+    name = eligibility_trim(name);
+    if(*name == '\0') {
+        return ERR_INVALID;
+    }
+
+    value = strtol(eligibility_trim(doses), &end, 10);
+    if(*end != '\0' || value < 1 || value > 9) {
+        return ERR_INVALID;
+    }
+
+    // The groups are separated by ','. The list can be empty
+    excluded = 0;
+    group = eligibility_trim(groups);
+    while(*group != '\0') {
+        next = strchr(group, ',');
+        if(next != NULL) {
+            *next++ = '\0';
+        }
+        group = eligibility_trim(group);
+
+        if(patient_groupFromName(group, &patientGroup) != OK) {
+            return ERR_INVALID;
+        }
+        excluded |= 1u << patientGroup;
+
+        group = next != NULL ? next : group + strlen(group);
+    }
+
+    // Vaccines that are not known yet are registered only by name
+    error = vaccineCatalog_intern(name, NONE, PRECLINICAL, &id);
+    if(error != OK)
+        return error;
+
+    return eligibility_set(id, excluded, (int)value);
+}
+
+// Load the default rules. Does nothing if they are already loaded
+tError eligibility_init(void) {
+    tError error;
+    int i;
+
+    if(rules.ready) {
+        return OK;
+    }
+
+    for(i = 0; defaultRules[i] != NULL; i++) {
+        error = eligibility_add(defaultRules[i]);
+        if(error != OK) {
+            eligibility_free();
+            return error;
+        }
+    }
+
+    rules.ready = true;
+
+    return OK;
+}
+
+// Release the memory used by the rules. The default rules are loaded again when needed
+void eligibility_free(void) {
+    const tAllocator* previous;
+
+    previous = allocator_enterGlobal();
+    uoc_free(rules.excluded);
+    uoc_free(rules.doses);
+    allocator_leave(previous);
+
+    rules.excluded = NULL;
+    rules.doses = NULL;
+    rules.count = 0;
+    rules.ready = false;
+    rules.version++;
+}
+
+// Add a rule, replacing the previous rule of the same vaccine
+tError eligibility_parseRule(const char* rule) {
+    tError error;
+
+    // Verify pre conditions
+    assert(rule != NULL);
+
+    // The defaults go first, so that they do not replace this rule later
+    error = eligibility_init();
+    if(error != OK)
+        return error;
+
+    return eligibility_add(rule);
+}
+
+// Load the rules of a file, one per line. Empty lines and lines starting with # are skipped
+tError eligibility_load(const char* filename) {
+    char line[ELIGIBILITY_MAX_RULE];
+    char* rule;
+    FILE* fin;
+    tError error;
+
+    // Verify pre conditions
+    assert(filename != NULL);
+
+    fin = fopen(filename, "r");
+    if(fin == NULL) {
+        return ERR_NOT_FOUND;
+    }
+
+    error = OK;
+    while(error == OK && fgets(line, ELIGIBILITY_MAX_RULE, fin) != NULL) {
+        rule = eligibility_trim(line);
+        if(*rule != '\0' && *rule != '#') {
+            error = eligibility_parseRule(rule);
+        }
+    }
+
+    fclose(fin);
+
+    return error;
+}
+
+// Returns true if the vaccine can be inoculated to the patients of a group
+bool eligibility_isSuitable(tVaccineId id, tPatientGroup group) {
+    if(!rules.ready) {
+        eligibility_init();
+    }
+
+    if(id < 0 || (unsigned int)id >= rules.count) {
+        return true;
+    }
+
+    return (rules.excluded[id] & (1u << group)) == 0;
+}
+
+// Get the doses of a vaccine needed to be fully vaccinated
+int eligibility_dosesRequired(tVaccineId id) {
+    if(!rules.ready) {
+        eligibility_init();
+    }
+
+    if(id < 0 || (unsigned int)id >= rules.count) {
+        return ELIGIBILITY_DEFAULT_DOSES;
+    }
+
+    return rules.doses[id];
+}
+
+// Get the version of the rules. The counters that depend on the rules are valid while it does not change
+unsigned int eligibility_version(void) {
+    // Loading the default rules changes the version, so they are loaded first
+    if(!rules.ready) {
+        eligibility_init();
+    }
+
+    return rules.version;
+}
@@ -0,0 +1,488 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <assert.h>
+#include "vaccineCatalog.h"
+#include "generator.h"
+#include "allocator.h"
+
+// Longest row written to a file
+#define GENERATOR_ROW_LENGTH 256
+
+// Percentage of the patients of each group in the default options, from HEALTH_WORKER to ANYONE_ELSE
+static const double defaultGroups[PATIENT_GROUPS] = { 5, 6, 14, 10, 10, 12, 43 };
+
+// Share of each known vaccine in the default options, by id
+static const double defaultVaccines[GENERATOR_VACCINES] = { 25, 10, 15, 50 };
+
+// Get the next number of a splitmix64 sequence
+static uint64_t generator_next(tGeneratorRandom* random) {
+    uint64_t z;
+
+    z = (random->state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+
+    return z ^ (z >> 31);
+}
+
+// Get a number in [0, count) from the high bits of a random number, without a division
+static unsigned int generator_scale(uint64_t value, unsigned int count) {
+    return (unsigned int)(((value >> 32) * count) >> 32);
+}
+
+// Get a number in [min, max] from a random number
+static unsigned int generator_range(uint64_t value, unsigned int min, unsigned int max) {
+    return min + (unsigned int)(((value >> 32) * ((uint64_t)max - min + 1)) >> 32);
+}
+
+// Turn each byte of a random number into a lowercase letter, as 'a' + byte * 26 / 256, in two halves of 16 bit lanes
+static uint64_t generator_letters(uint64_t value) {
+    uint64_t even, odd;
+
+    even = (((value & 0x00FF00FF00FF00FFull) * 26) >> 8) & 0x00FF00FF00FF00FFull;
+    odd = ((((value >> 8) & 0x00FF00FF00FF00FFull) * 26) >> 8) & 0x00FF00FF00FF00FFull;
+
+    return (even | (odd << 8)) + 0x6161616161616161ull;
+}
+
+// Build the alias table of a distribution from its weights (Vose's method)
+static tError generatorAlias_init(tGeneratorAlias* alias, const double* weights, unsigned int count) {
+    double* scaled;
+    unsigned int* small;
+    unsigned int* large;
+    unsigned int i, s, l, nSmall, nLarge;
+    double total;
+
+    assert(alias != NULL);
+    assert(weights != NULL);
+    assert(count > 0);
+
+    total = 0;
+    for(i = 0; i < count; i++) {
+        assert(weights[i] >= 0);
+        total += weights[i];
+    }
+    if(total <= 0) {
+        return ERR_INVALID;
+    }
+
+    alias->count = count;
+    alias->threshold = (uint32_t*)uoc_malloc(count * sizeof(uint32_t));
+    alias->alias = (unsigned int*)uoc_malloc(count * sizeof(unsigned int));
+    scaled = (double*)uoc_malloc(count * sizeof(double));
+    small = (unsigned int*)uoc_malloc(2 * count * sizeof(unsigned int));
+    if(alias->threshold == NULL || alias->alias == NULL || scaled == NULL || small == NULL) {
+        uoc_free(alias->threshold);
+        uoc_free(alias->alias);
+        uoc_free(scaled);
+        uoc_free(small);
+        alias->threshold = NULL;
+        alias->alias = NULL;
+        return ERR_MEMORY_ERROR;
+    }
+    large = small + count;
+
+    // Each column holds an average weight of 1: the small ones are filled with part of a large one
+    nSmall = nLarge = 0;
+    for(i = 0; i < count; i++) {
+        scaled[i] = weights[i] * count / total;
+        if(scaled[i] < 1.0) {
+            small[nSmall++] = i;
+        } else {
+            large[nLarge++] = i;
+        }
+    }
+
+    while(nSmall > 0 && nLarge > 0) {
+        s = small[--nSmall];
+        l = large[nLarge - 1];
+        alias->threshold[s] = (uint32_t)(scaled[s] * 4294967296.0);
+        alias->alias[s] = l;
+        scaled[l] -= 1.0 - scaled[s];
+        if(scaled[l] < 1.0) {
+            nLarge--;
+            small[nSmall++] = l;
+        }
+    }
+
+    // The columns left are full, up to rounding errors
+    while(nLarge > 0) {
+        l = large[--nLarge];
+        alias->threshold[l] = UINT32_MAX;
+        alias->alias[l] = l;
+    }
+    while(nSmall > 0) {
+        s = small[--nSmall];
+        alias->threshold[s] = UINT32_MAX;
+        alias->alias[s] = s;
+    }
+
+    uoc_free(scaled);
+    uoc_free(small);
+
+    return OK;
+}
+
+// Release the memory used by an alias table
+static void generatorAlias_free(tGeneratorAlias* alias) {
+    uoc_free(alias->threshold);
+    uoc_free(alias->alias);
+    alias->threshold = NULL;
+    alias->alias = NULL;
+    alias->count = 0;
+}
+
+// Take a value of a distribution: the high bits choose a column, the low bits the column or its alias
+static unsigned int generatorAlias_sample(const tGeneratorAlias* alias, uint64_t value) {
+    unsigned int column, keep;
+
+    column = generator_scale(value, alias->count);
+
+    // Without a branch: the choice is random, so a branch would be mispredicted half of the times
+    keep = (uint32_t)value < alias->threshold[column];
+
+    return column ^ ((column ^ alias->alias[column]) & (keep - 1u));
+}
+
+// Get the default options of a generator: 64 countries with a Zipf law of exponent 1 and a realistic mix of groups
+void generator_defaultOptions(tGeneratorOptions* options) {
+    // Verify pre conditions
+    assert(options != NULL);
+
+    options->seed = GENERATOR_DEFAULT_SEED;
+    options->countries = 64;
+    options->euPercentage = 40;
+    options->zipf = 1.0;
+    memcpy(options->groups, defaultGroups, sizeof(defaultGroups));
+    memcpy(options->vaccines, defaultVaccines, sizeof(defaultVaccines));
+    options->nameLengthMin = 6;
+    options->nameLengthMax = 24;
+    options->lotSizeMin = 500;
+    options->lotSizeMax = 5000;
+}
+
+// Initialize a generator
+tError generator_init(tGenerator* generator, const tGeneratorOptions* options) {
+    double* sizes;
+    unsigned int c;
+    tError error;
+
+    // Verify pre conditions
+    assert(generator != NULL);
+    assert(options != NULL);
+
+    if(options->countries == 0 || options->zipf < 0 || options->euPercentage > 100 ||
+            options->nameLengthMin == 0 || options->nameLengthMin > options->nameLengthMax ||
+            options->nameLengthMax > GENERATOR_NAME_LENGTH || options->lotSizeMin > options->lotSizeMax ||
+            options->lotSizeMax > INT32_MAX) {
+        return ERR_INVALID;
+    }
+
+    // The batches point to the known vaccines of the catalogue
+    error = vaccineCatalog_init();
+    if(error != OK)
+        return error;
+
+    memset(generator, 0, sizeof(tGenerator));
+    generator->options = *options;
+    generator->random.state = options->seed;
+
+    // The k-th country has a size proportional to 1 / k^zipf
+    sizes = (double*)uoc_malloc(options->countries * sizeof(double));
+    generator->patients = (unsigned int*)uoc_calloc(options->countries, sizeof(unsigned int));
+    generator->batches = (unsigned int*)uoc_calloc(options->countries, sizeof(unsigned int));
+    if(sizes == NULL || generator->patients == NULL || generator->batches == NULL) {
+        uoc_free(sizes);
+        generator_free(generator);
+        return ERR_MEMORY_ERROR;
+    }
+    for(c = 0; c < options->countries; c++) {
+        sizes[c] = 1.0 / pow((double)(c + 1), options->zipf);
+    }
+
+    error = generatorAlias_init(&generator->countries, sizes, options->countries);
+    uoc_free(sizes);
+    if(error == OK)
+        error = generatorAlias_init(&generator->groups, options->groups, PATIENT_GROUPS);
+    if(error == OK)
+        error = generatorAlias_init(&generator->vaccines, options->vaccines, GENERATOR_VACCINES);
+
+    if(error != OK) {
+        generator_free(generator);
+        return error;
+    }
+
+    return OK;
+}
+
+// Release the memory used by a generator
+void generator_free(tGenerator* generator) {
+    // Verify pre conditions
+    assert(generator != NULL);
+
+    generatorAlias_free(&generator->countries);
+    generatorAlias_free(&generator->groups);
+    generatorAlias_free(&generator->vaccines);
+    uoc_free(generator->patients);
+    uoc_free(generator->batches);
+    generator->patients = NULL;
+    generator->batches = NULL;
+}
+
+// Get the name of a country of a generator
+void generator_countryName(unsigned int country, char* name) {
+    // Verify pre conditions
+    assert(name != NULL);
+
+    snprintf(name, GENERATOR_COUNTRY_NAME_LENGTH, "Country_%04u", country);
+}
+
+// Tell if a country of a generator is in the EU
+bool generator_isEU(const tGenerator* generator, unsigned int country) {
+    // Verify pre conditions
+    assert(generator != NULL);
+    assert(country < generator->options.countries);
+
+    // Knuth's multiplicative hash spreads the EU over large and small countries
+    return (country * 2654435761u) % 100 < generator->options.euPercentage;
+}
+
+// Get the next patient and its country. The patient has no doses. Its name is valid until the next patient
+unsigned int generator_nextPatient(tGenerator* generator, tPatient* patient) {
+    unsigned int country, length, i;
+    uint64_t value;
+
+    // Verify pre conditions
+    assert(generator != NULL);
+    assert(patient != NULL);
+
+    value = generator_next(&generator->random);
+    country = generatorAlias_sample(&generator->countries, value);
+    value = generator_next(&generator->random);
+    patient->group = (tPatientGroup)generatorAlias_sample(&generator->groups, value);
+    value = generator_next(&generator->random);
+    length = generator_range(value, generator->options.nameLengthMin, generator->options.nameLengthMax);
+
+    // Each random number gives 8 letters. All the words of the longest name are written, so the loop always
+    // runs the same times and the name is cut at its length
+    for(i = 0; i < generator->options.nameLengthMax; i += 8) {
+        value = generator_letters(generator_next(&generator->random));
+        memcpy(&generator->name[i], &value, sizeof(value));
+    }
+    generator->name[0] += 'A' - 'a';
+    generator->name[length] = '\0';
+
+    patient->name = generator->name;
+    patient->id = (int)++generator->patients[country];
+    patient->vaccine = NULL;
+    patient->vaccineId = NO_VACCINE_ID;
+    patient->lotID = 0;
+    patient->number_doses = 0;
+
+    return country;
+}
+
+// Get the next batch and its country. The batch points to a vaccine of the catalogue
+unsigned int generator_nextBatch(tGenerator* generator, tVaccineBatch* batch) {
+    unsigned int country;
+    uint64_t value;
+
+    // Verify pre conditions
+    assert(generator != NULL);
+    assert(batch != NULL);
+
+    // The deliveries follow the sizes of the countries
+    value = generator_next(&generator->random);
+    country = generatorAlias_sample(&generator->countries, value);
+    value = generator_next(&generator->random);
+    batch->vaccine = vaccineCatalog_get((tVaccineId)generatorAlias_sample(&generator->vaccines, value));
+    value = generator_next(&generator->random);
+    batch->quantity = (int)generator_range(value, generator->options.lotSizeMin, generator->options.lotSizeMax);
+    batch->lotID = (int)++generator->batches[country];
+
+    return country;
+}
+
+// Add the countries of the generator to a table, with the allocator of the table entered
+static tError generator_fillTableImpl(tGenerator* generator, tCountryTable* table, unsigned int patients, unsigned int batches) {
+    tCountry** countries;
+    tCountry key;
+    tPatient patient;
+    tVaccineBatch batch;
+    char name[GENERATOR_COUNTRY_NAME_LENGTH];
+    unsigned int c, v, i;
+    tError error;
+
+    // Verify pre conditions
+    assert(generator != NULL);
+    assert(table != NULL);
+
+    // Countries already in the table keep their data
+    for(c = 0; c < generator->options.countries; c++) {
+        generator_countryName(c, name);
+        key.name = name;
+        key.isEU = generator_isEU(generator, c);
+        error = countryTable_add(table, &key);
+        if(error != OK && error != ERR_DUPLICATED)
+            return error;
+    }
+
+    // The table does not move its countries once they are all added
+    countries = (tCountry**)uoc_malloc(generator->options.countries * sizeof(tCountry*));
+    if(countries == NULL) {
+        return ERR_MEMORY_ERROR;
+    }
+    error = OK;
+    for(c = 0; c < generator->options.countries && error == OK; c++) {
+        generator_countryName(c, name);
+        countries[c] = countryTable_find(table, name);
+        assert(countries[c] != NULL);
+        for(v = 0; v < GENERATOR_VACCINES && error == OK; v++) {
+            error = country_addVaccine(countries[c], *vaccineCatalog_get((tVaccineId)v));
+            if(error == ERR_DUPLICATED)
+                error = OK;
+        }
+    }
+
+    for(i = 0; i < patients && error == OK; i++) {
+        c = generator_nextPatient(generator, &patient);
+        error = country_addPatient(countries[c], patient);
+    }
+
+    for(i = 0; i < batches && error == OK; i++) {
+        c = generator_nextBatch(generator, &batch);
+        error = vaccineBatchList_append(countries[c]->vbList, batch);
+    }
+
+    uoc_free(countries);
+
+    return error;
+}
+
+// Add the countries of the generator to a table, and the given number of patients and batches to them
+tError generator_fillTable(tGenerator* generator, tCountryTable* table, unsigned int patients, unsigned int batches) {
+    const tAllocator* previous;
+    tError error;
+
+    // Verify pre conditions
+    assert(table != NULL);
+
+    previous = allocator_enter(table->allocator);
+    error = generator_fillTableImpl(generator, table, patients, batches);
+    allocator_leave(previous);
+
+    return error;
+}
+
+// Write an unsigned number and return the end of the text
+static char* generator_writeNumber(char* text, unsigned int value) {
+    char digits[10];
+    int n;
+
+    n = 0;
+    do {
+        digits[n++] = (char)('0' + value % 10);
+        value /= 10;
+    } while(value > 0);
+    while(n > 0) {
+        *text++ = digits[--n];
+    }
+
+    return text;
+}
+
+// Write a text and return its end
+static char* generator_writeText(char* text, const char* value) {
+    size_t length;
+
+    length = strlen(value);
+    memcpy(text, value, length);
+
+    return text + length;
+}
+
+// Write the countries, patients and batches to a file in the format of csvLoader_loadFile
+tError generator_writeFile(tGenerator* generator, const char* filename, unsigned int patients, unsigned int batches) {
+    FILE* fout;
+    char* buffer;
+    char* p;
+    char name[GENERATOR_COUNTRY_NAME_LENGTH];
+    tPatient patient;
+    tVaccineBatch batch;
+    tVaccine* vaccine;
+    unsigned int c, v, i;
+    bool failed;
+
+    // Verify pre conditions
+    assert(generator != NULL);
+    assert(filename != NULL);
+
+    buffer = (char*)uoc_malloc(GENERATOR_BUFFER_SIZE);
+    if(buffer == NULL) {
+        return ERR_MEMORY_ERROR;
+    }
+
+    fout = fopen(filename, "w");
+    if(fout == NULL) {
+        uoc_free(buffer);
+        return ERR_INVALID;
+    }
+
+    // Rows are written to the buffer, which is flushed when the next row may not fit
+    failed = false;
+    p = buffer;
+    for(c = 0; c < generator->options.countries; c++) {
+        generator_countryName(c, name);
+        p += sprintf(p, "COUNTRY,%s,%d\n", name, generator_isEU(generator, c) ? 1 : 0);
+        for(v = 0; v < GENERATOR_VACCINES; v++) {
+            vaccine = vaccineCatalog_get((tVaccineId)v);
+            p += sprintf(p, "VACCINE,%s,%s,%d,%d\n", name, vaccine->name, (int)vaccine->vaccineTec, (int)vaccine->vaccinePhase);
+        }
+        if(p - buffer > GENERATOR_BUFFER_SIZE - 8 * GENERATOR_ROW_LENGTH) {
+            failed |= fwrite(buffer, 1, (size_t)(p - buffer), fout) != (size_t)(p - buffer);
+            p = buffer;
+        }
+    }
+
+    // Country names have a fixed prefix, so they are written without sprintf
+    for(i = 0; i < patients; i++) {
+        c = generator_nextPatient(generator, &patient);
+        p = generator_writeText(p, "PATIENT,Country_");
+        if(c < 1000)
+            *p++ = '0';
+        if(c < 100)
+            *p++ = '0';
+        if(c < 10)
+            *p++ = '0';
+        p = generator_writeNumber(p, c);
+        *p++ = ',';
+        p = generator_writeNumber(p, (unsigned int)patient.id);
+        *p++ = ',';
+        p = generator_writeText(p, patient.name);
+        *p++ = ',';
+        p = generator_writeNumber(p, (unsigned int)patient.group);
+        p = generator_writeText(p, ",0,,0\n");
+        if(p - buffer > GENERATOR_BUFFER_SIZE - GENERATOR_ROW_LENGTH) {
+            failed |= fwrite(buffer, 1, (size_t)(p - buffer), fout) != (size_t)(p - buffer);
+            p = buffer;
+        }
+    }
+
+    for(i = 0; i < batches; i++) {
+        c = generator_nextBatch(generator, &batch);
+        generator_countryName(c, name);
+        p += sprintf(p, "BATCH,%s,%d,%s,%d\n", name, batch.lotID, batch.vaccine->name, batch.quantity);
+        if(p - buffer > GENERATOR_BUFFER_SIZE - GENERATOR_ROW_LENGTH) {
+            failed |= fwrite(buffer, 1, (size_t)(p - buffer), fout) != (size_t)(p - buffer);
+            p = buffer;
+        }
+    }
+
+    failed |= fwrite(buffer, 1, (size_t)(p - buffer), fout) != (size_t)(p - buffer);
+    failed |= fclose(fout) != 0;
+    uoc_free(buffer);
+
+    return failed ? ERR_INVALID : OK;
+}
@@ -0,0 +1,148 @@
+#include <time.h>
+#include <stdatomic.h>
+#include <assert.h>
+#include "instrument.h"
+
+// Names of the counters, in the order of tInstrumentCounter
+static const char* counterNames[INSTRUMENT_COUNTERS] = {
+    "patientQueue_enqueue",
+    "patientQueue_dequeue",
+    "patient_duplicate",
+    "vaccineBatchList_get",
+    "vaccineBatchList_swap",
+    "vaccineBatchList_inoculate_first_vaccine",
+    "vaccineBatchList_inoculate_second_vaccine",
+    "country_inoculate_first_vaccine",
+    "country_inoculate_first_vaccine_ordered",
+    "country_inoculate_second_vaccine",
+    "malloc",
+    "calloc",
+    "realloc",
+    "free"
+};
+
+// Counters of the library. The rounds of the countries run in many threads, so they are atomic
+static atomic_ullong calls[INSTRUMENT_COUNTERS];
+static atomic_ullong nanoseconds[INSTRUMENT_COUNTERS];
+static atomic_ullong bytes;
+
+// Tell if the library is built with the counters
+bool instrument_enabled(void) {
+#ifdef UOC_INSTRUMENT
+    return true;
+#else
+    return false;
+#endif
+}
+
+// Get the current time in nanoseconds
+uint64_t instrument_now(void) {
+    struct timespec ts;
+
+    timespec_get(&ts, TIME_UTC);
+
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+// Count a call to a function and the time it took. It can be called from many threads at once
+void instrument_add(tInstrumentCounter counter, uint64_t elapsed) {
+    // Verify pre conditions
+    assert(counter < INSTRUMENT_COUNTERS);
+
+    atomic_fetch_add_explicit(&calls[counter], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&nanoseconds[counter], elapsed, memory_order_relaxed);
+}
+
+// Count a call to the allocator, the time it took and the bytes asked
+void instrument_addMemory(tInstrumentCounter counter, uint64_t elapsed, size_t size) {
+    instrument_add(counter, elapsed);
+    atomic_fetch_add_explicit(&bytes, size, memory_order_relaxed);
+}
+
+// Get the values of the counters. They are all 0 without UOC_INSTRUMENT
+void instrument_snapshot(tInstrumentSnapshot* snapshot) {
+    int i;
+
+    // Verify pre conditions
+    assert(snapshot != NULL);
+
+    for(i = 0; i < INSTRUMENT_COUNTERS; i++) {
+        snapshot->calls[i] = atomic_load_explicit(&calls[i], memory_order_relaxed);
+        snapshot->nanoseconds[i] = atomic_load_explicit(&nanoseconds[i], memory_order_relaxed);
+    }
+    snapshot->bytes = atomic_load_explicit(&bytes, memory_order_relaxed);
+}
+
+// Set all the counters to 0
+void instrument_reset(void) {
+    int i;
+
+    for(i = 0; i < INSTRUMENT_COUNTERS; i++) {
+        atomic_store_explicit(&calls[i], 0, memory_order_relaxed);
+        atomic_store_explicit(&nanoseconds[i], 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&bytes, 0, memory_order_relaxed);
+}
+
+// Get the counters between two snapshots
+void instrument_diff(const tInstrumentSnapshot* before, const tInstrumentSnapshot* after, tInstrumentSnapshot* diff) {
+    int i;
+
+    // Verify pre conditions
+    assert(before != NULL);
+    assert(after != NULL);
+    assert(diff != NULL);
+
+    for(i = 0; i < INSTRUMENT_COUNTERS; i++) {
+        diff->calls[i] = after->calls[i] - before->calls[i];
+        diff->nanoseconds[i] = after->nanoseconds[i] - before->nanoseconds[i];
+    }
+    diff->bytes = after->bytes - before->bytes;
+}
+
+// Get the name of a counter
+const char* instrument_name(tInstrumentCounter counter) {
+    // Verify pre conditions
+    assert(counter < INSTRUMENT_COUNTERS);
+
+    return counterNames[counter];
+}
+
+// Get the memory blocks asked to the allocator in a snapshot
+unsigned long long instrumentSnapshot_allocations(const tInstrumentSnapshot* snapshot) {
+    // Verify pre conditions
+    assert(snapshot != NULL);
+
+    return snapshot->calls[INSTRUMENT_MALLOC] + snapshot->calls[INSTRUMENT_CALLOC] + snapshot->calls[INSTRUMENT_REALLOC];
+}
+
+// Print the counters of a snapshot as a table
+void instrumentSnapshot_print(const tInstrumentSnapshot* snapshot) {
+    int i;
+
+    // Verify pre conditions
+    assert(snapshot != NULL);
+
+    printf("%-44s %12s %14s %12s\n", "Function", "Calls", "Time (ms)", "ns/call");
+    for(i = 0; i < INSTRUMENT_COUNTERS; i++) {
+        printf("%-44s %12llu %14.3f %12.1f\n", counterNames[i], snapshot->calls[i], snapshot->nanoseconds[i] / 1e6,
+               snapshot->calls[i] > 0 ? (double)snapshot->nanoseconds[i] / snapshot->calls[i] : 0.0);
+    }
+    printf("%-44s %12llu\n", "bytes allocated", snapshot->bytes);
+}
+
+// Write the counters of a snapshot in JSON format
+void instrumentSnapshot_export(const tInstrumentSnapshot* snapshot, FILE* fout) {
+    int i;
+
+    // Verify pre conditions
+    assert(snapshot != NULL);
+    assert(fout != NULL);
+
+    fprintf(fout, "{ \"enabled\": %s, \"bytes\": %llu, \"counters\": [", instrument_enabled() ? "true" : "false", snapshot->bytes);
+    for(i = 0; i < INSTRUMENT_COUNTERS; i++) {
+        fprintf(fout, "%s\n    { \"function\": \"%s\", \"calls\": %llu, \"nanoseconds\": %llu }", i > 0 ? "," : "",
+                counterNames[i], snapshot->calls[i], snapshot->nanoseconds[i]);
+    }
+    fprintf(fout, "\n] }\n");
+}
@@ -0,0 +1,455 @@
+// fileno and fsync are not part of C11
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "vaccineCatalog.h"
+#include "snapshot.h"
+#include "journal.h"
+#include "allocator.h"
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// Sync a file to disk
+static bool journal_fsync(FILE* file) {
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+// Get the default options of a journal
+void journal_defaultOptions(tJournalOptions* options) {
+    // Verify pre conditions
+    assert(options != NULL);
+
+    options->bufferSize = JOURNAL_BUFFER_SIZE;
+    options->syncFrames = 1;
+}
+
+// Create a new journal file with the global allocator
+static tError journal_openImpl(tJournal* journal, const char* filename, const tJournalOptions* options) {
+    tJournalOptions defaultOptions;
+    tJournalHeader header;
+
+    // Verify pre conditions
+    assert(journal != NULL);
+    assert(filename != NULL);
+
+    if(options == NULL) {
+        journal_defaultOptions(&defaultOptions);
+        options = &defaultOptions;
+    }
+
+    memset(journal, 0, sizeof(tJournal));
+    journal->syncFrames = options->syncFrames;
+
+    // The largest record has to fit in the buffer
+    journal->size = options->bufferSize > 256 ? options->bufferSize : 256;
+    if(journal->size > JOURNAL_MAX_FRAME) {
+        journal->size = JOURNAL_MAX_FRAME;
+    }
+    journal->buffer = (unsigned char*)uoc_malloc(journal->size);
+    if(journal->buffer == NULL) {
+        return ERR_MEMORY_ERROR;
+    }
+
+    journal->fout = fopen(filename, "wb");
+    if(journal->fout == NULL) {
+        uoc_free(journal->buffer);
+        journal->buffer = NULL;
+        return ERR_INVALID;
+    }
+
+    // The header is synced at once, so that the file is a valid empty journal
+    memset(&header, 0, sizeof(tJournalHeader));
+    memcpy(header.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC));
+    header.version = JOURNAL_VERSION;
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    if(fwrite(&header, sizeof(tJournalHeader), 1, journal->fout) != 1 || fflush(journal->fout) != 0 || !journal_fsync(journal->fout)) {
+        fclose(journal->fout);
+        uoc_free(journal->buffer);
+        memset(journal, 0, sizeof(tJournal));
+        return ERR_INVALID;
+    }
+    journal->report.bytes = sizeof(tJournalHeader);
+
+    if(pthread_mutex_init(&journal->lock, NULL) != 0) {
+        fclose(journal->fout);
+        uoc_free(journal->buffer);
+        memset(journal, 0, sizeof(tJournal));
+        return ERR_MEMORY_ERROR;
+    }
+
+    return OK;
+}
+
+// Create a new journal file, replacing the old one. Take a snapshot before, the journal holds the doses given after it
+tError journal_open(tJournal* journal, const char* filename, const tJournalOptions* options) {
+    const tAllocator* previous;
+    tError error;
+
+    // The rounds of the tables write to the journal, so it is kept in the global allocator
+    previous = allocator_enterGlobal();
+    error = journal_openImpl(journal, filename, options);
+    allocator_leave(previous);
+
+    return error;
+}
+
+// Write the pending records and release the journal
+tError journal_close(tJournal* journal) {
+    const tAllocator* previous;
+    tError error;
+
+    // Verify pre conditions
+    assert(journal != NULL);
+
+    if(journal->fout == NULL) {
+        return OK;
+    }
+
+    error = journal_sync(journal);
+    if(fclose(journal->fout) != 0 && error == OK) {
+        error = ERR_INVALID;
+    }
+    pthread_mutex_destroy(&journal->lock);
+    previous = allocator_enterGlobal();
+    uoc_free(journal->buffer);
+    uoc_free(journal->vaccines);
+    allocator_leave(previous);
+    memset(journal, 0, sizeof(tJournal));
+
+    return error;
+}
+
+// Write the pending records as a frame, with the lock of the journal taken
+static tError journal_writeFrame(tJournal* journal) {
+    tJournalFrameHeader frame;
+
+    if(journal->used == 0) {
+        return OK;
+    }
+
+    frame.magic = JOURNAL_FRAME_MAGIC;
+    frame.size = (uint32_t)journal->used;
+    frame.checksum = snapshot_checksum(SNAPSHOT_CHECKSUM_SEED, journal->buffer, journal->used);
+
+    // The replay ignores a frame that did not reach the file complete
+    if(fwrite(&frame, sizeof(tJournalFrameHeader), 1, journal->fout) != 1 ||
+            fwrite(journal->buffer, 1, journal->used, journal->fout) != journal->used || fflush(journal->fout) != 0) {
+        return ERR_INVALID;
+    }
+
+    journal->report.frames++;
+    journal->report.bytes += sizeof(tJournalFrameHeader) + journal->used;
+    journal->used = 0;
+
+    // Many frames share the cost of one fsync
+    journal->unsynced++;
+    if(journal->syncFrames > 0 && journal->unsynced >= journal->syncFrames) {
+        if(!journal_fsync(journal->fout)) {
+            return ERR_INVALID;
+        }
+        journal->report.syncs++;
+        journal->unsynced = 0;
+    }
+
+    return OK;
+}
+
+// Write the pending records as a frame. The frame is synced to disk as set by the options
+tError journal_commit(tJournal* journal) {
+    tError error;
+
+    // Verify pre conditions
+    assert(journal != NULL);
+    assert(journal->fout != NULL);
+
+    pthread_mutex_lock(&journal->lock);
+    error = journal_writeFrame(journal);
+    pthread_mutex_unlock(&journal->lock);
+
+    return error;
+}
+
+// Write the pending records and sync the file to disk
+tError journal_sync(tJournal* journal) {
+    tError error;
+
+    // Verify pre conditions
+    assert(journal != NULL);
+    assert(journal->fout != NULL);
+
+    pthread_mutex_lock(&journal->lock);
+    error = journal_writeFrame(journal);
+    if(error == OK && journal->unsynced > 0) {
+        if(journal_fsync(journal->fout)) {
+            journal->report.syncs++;
+            journal->unsynced = 0;
+        } else {
+            error = ERR_INVALID;
+        }
+    }
+    pthread_mutex_unlock(&journal->lock);
+
+    return error;
+}
+
+// Add a record to the buffer, writing the buffer first if it is full
+static tError journal_append(tJournal* journal, const void* record, size_t size, const void* data, size_t dataSize) {
+    tError error;
+
+    if(journal->used + size + dataSize > journal->size) {
+        error = journal_writeFrame(journal);
+        if(error != OK)
+            return error;
+    }
+
+    memcpy(journal->buffer + journal->used, record, size);
+    if(dataSize > 0) {
+        memcpy(journal->buffer + journal->used + size, data, dataSize);
+    }
+    journal->used += size + dataSize;
+
+    return OK;
+}
+
+// Add the record of a name of a country or a vaccine
+static tError journal_appendName(tJournal* journal, tJournalRecordKind kind, int id, const char* name) {
+    tJournalName record;
+    size_t length;
+
+    length = strlen(name) + 1;
+    if(length > UINT16_MAX || sizeof(tJournalName) + length > journal->size) {
+        return ERR_INVALID;
+    }
+
+    memset(&record, 0, sizeof(tJournalName));
+    record.kind = (uint8_t)kind;
+    record.length = (uint16_t)length;
+    record.id = id;
+
+    return journal_append(journal, &record, sizeof(tJournalName), name, length);
+}
+
+// Get the id of a country for the doses of the journal, writing its name
+tError journal_addCountry(tJournal* journal, const char* name, unsigned int* id) {
+    tError error;
+
+    // Verify pre conditions
+    assert(journal != NULL);
+    assert(journal->fout != NULL);
+    assert(name != NULL);
+    assert(id != NULL);
+
+    pthread_mutex_lock(&journal->lock);
+    error = journal_appendName(journal, JOURNAL_COUNTRY, (int)journal->countries, name);
+    if(error == OK) {
+        *id = journal->countries++;
+    }
+    pthread_mutex_unlock(&journal->lock);
+
+    return error;
+}
+
+// Write the name of a vaccine of the catalogue the first time it is used
+static tError journal_addVaccine(tJournal* journal, tVaccineId id) {
+    const tAllocator* previous;
+    bool* vaccinesAux;
+    unsigned int count;
+    tError error;
+
+    if((unsigned int)id < journal->vaccinesCount && journal->vaccines[id]) {
+        return OK;
+    }
+
+    if((unsigned int)id >= journal->vaccinesCount) {
+        count = vaccineCatalog_size();
+        previous = allocator_enterGlobal();
+        vaccinesAux = (bool*)uoc_realloc(journal->vaccines, count * sizeof(bool));
+        allocator_leave(previous);
+        if(vaccinesAux == NULL) {
+            return ERR_MEMORY_ERROR;
+        }
+        memset(vaccinesAux + journal->vaccinesCount, 0, (count - journal->vaccinesCount) * sizeof(bool));
+        journal->vaccines = vaccinesAux;
+        journal->vaccinesCount = count;
+    }
+
+    error = journal_appendName(journal, JOURNAL_VACCINE, id, vaccineCatalog_name(id));
+    if(error != OK)
+        return error;
+
+    journal->vaccines[id] = true;
+
+    return OK;
+}
+
+// Add the last dose given to a patient, from a batch with the given lot
+tError journal_appendDose(tJournal* journal, unsigned int country, const tPatient* patient, int lotID) {
+    tJournalDose record;
+    tError error;
+
+    // Verify pre conditions
+    assert(journal != NULL);
+    assert(journal->fout != NULL);
+    assert(patient != NULL);
+    assert(vaccineCatalog_get(patient->vaccineId) != NULL);
+
+    record.kind = JOURNAL_DOSE;
+    record.dose = (uint8_t)patient->number_doses;
+    record.vaccine = (int16_t)patient->vaccineId;
+    record.country = country;
+    record.patient = patient->id;
+    record.lotID = lotID;
+
+    // The doses of each patient keep their order, as each country is inoculated by a single thread
+    pthread_mutex_lock(&journal->lock);
+    assert(country < journal->countries);
+    error = journal_addVaccine(journal, patient->vaccineId);
+    if(error == OK)
+        error = journal_append(journal, &record, sizeof(tJournalDose), NULL, 0);
+    if(error == OK)
+        journal->report.doses++;
+    pthread_mutex_unlock(&journal->lock);
+
+    return error;
+}
+
+// Get the counters of a journal
+void journal_report(const tJournal* journal, tJournalReport* report) {
+    // Verify pre conditions
+    assert(journal != NULL);
+    assert(report != NULL);
+
+    pthread_mutex_lock((pthread_mutex_t*)&journal->lock);
+    *report = journal->report;
+    pthread_mutex_unlock((pthread_mutex_t*)&journal->lock);
+}
+
+// Open a journal file to read its records
+tError journalReader_open(tJournalReader* reader, const char* filename) {
+    tJournalHeader header;
+
+    // Verify pre conditions
+    assert(reader != NULL);
+    assert(filename != NULL);
+
+    memset(reader, 0, sizeof(tJournalReader));
+
+    reader->fin = fopen(filename, "rb");
+    if(reader->fin == NULL) {
+        return ERR_NOT_FOUND;
+    }
+
+    if(fread(&header, sizeof(tJournalHeader), 1, reader->fin) != 1 || memcmp(header.magic, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0 ||
+            header.version != JOURNAL_VERSION || header.byteOrder != SNAPSHOT_BYTE_ORDER) {
+        fclose(reader->fin);
+        reader->fin = NULL;
+        return ERR_INVALID;
+    }
+
+    return OK;
+}
+
+// Read the next frame of the journal. Returns false at the end of the journal
+static bool journalReader_nextFrame(tJournalReader* reader) {
+    tJournalFrameHeader frame;
+    unsigned char* bufferAux;
+    size_t bytes;
+
+    bytes = fread(&frame, 1, sizeof(tJournalFrameHeader), reader->fin);
+    if(bytes == 0) {
+        return false;
+    }
+
+    // The frame written last by a process that stopped may be incomplete
+    if(bytes != sizeof(tJournalFrameHeader) || frame.magic != JOURNAL_FRAME_MAGIC || frame.size == 0 || frame.size > JOURNAL_MAX_FRAME) {
+        reader->truncated = true;
+        return false;
+    }
+    if(frame.size > reader->allocated) {
+        bufferAux = (unsigned char*)uoc_realloc(reader->buffer, frame.size);
+        if(bufferAux == NULL) {
+            reader->truncated = true;
+            return false;
+        }
+        reader->buffer = bufferAux;
+        reader->allocated = frame.size;
+    }
+    if(fread(reader->buffer, 1, frame.size, reader->fin) != frame.size ||
+            snapshot_checksum(SNAPSHOT_CHECKSUM_SEED, reader->buffer, frame.size) != frame.checksum) {
+        reader->truncated = true;
+        return false;
+    }
+
+    reader->size = frame.size;
+    reader->position = 0;
+    reader->frames++;
+
+    return true;
+}
+
+// Get the next record of the journal. Returns ERR_EMPTY at the end of the journal, and ERR_INVALID if a record is wrong
+tError journalReader_next(tJournalReader* reader, tJournalRecord* record) {
+    const unsigned char* data;
+    size_t left;
+
+    // Verify pre conditions
+    assert(reader != NULL);
+    assert(reader->fin != NULL);
+    assert(record != NULL);
+
+    if(reader->position == reader->size && !journalReader_nextFrame(reader)) {
+        return ERR_EMPTY;
+    }
+
+    data = reader->buffer + reader->position;
+    left = reader->size - reader->position;
+    record->kind = (tJournalRecordKind)data[0];
+
+    if(record->kind == JOURNAL_DOSE) {
+        if(left < sizeof(tJournalDose)) {
+            return ERR_INVALID;
+        }
+        memcpy(&record->dose, data, sizeof(tJournalDose));
+        reader->position += sizeof(tJournalDose);
+        return OK;
+    }
+
+    if(record->kind != JOURNAL_COUNTRY && record->kind != JOURNAL_VACCINE) {
+        return ERR_INVALID;
+    }
+    if(left < sizeof(tJournalName)) {
+        return ERR_INVALID;
+    }
+    memcpy(&record->name, data, sizeof(tJournalName));
+    if(record->name.length == 0 || left - sizeof(tJournalName) < record->name.length ||
+            data[sizeof(tJournalName) + record->name.length - 1] != '\0') {
+        return ERR_INVALID;
+    }
+    record->text = (const char*)data + sizeof(tJournalName);
+    reader->position += sizeof(tJournalName) + record->name.length;
+
+    return OK;
+}
+
+// Release a journal reader
+void journalReader_close(tJournalReader* reader) {
+    // Verify pre conditions
+    assert(reader != NULL);
+
+    if(reader->fin != NULL) {
+        fclose(reader->fin);
+    }
+    uoc_free(reader->buffer);
+    memset(reader, 0, sizeof(tJournalReader));
+}
@@ -3,9 +3,14 @@
 #include <assert.h>
 #include <stdio.h>
 #include <string.h>
+#include <stdatomic.h>
 #include "vaccine.h"
 #include "patient.h"
 #include "vaccinationBatch.h"
+#include "vaccineCatalog.h"
+#include "eligibility.h"
+#include "allocator.h"
+#include "instrument.h"
 
 
 // Initialize a patient structure
@@ -16,7 +21,7 @@ tError patient_init(tPatient *patient, const char* patientName, int patientId, c
     assert(patientId > 0);
 
     // Allocate the memory for patient and vaccine name, using the length of the provided text plus 1 space for the "end of string" char '\0'. To allocate memory we use the malloc command.
-    patient->name = (char*) malloc((strlen(patientName) + 1) * sizeof(char));
+    patient->name = (char*) uoc_malloc((strlen(patientName) + 1) * sizeof(char));
     // Check that memory has been allocated for all fields.
     // Pointer must be different from NULL.
     if(patient->name == NULL) {
@@ -29,15 +34,17 @@ tError patient_init(tPatient *patient, const char* patientName, int patientId, c
     strcpy(patient->name, patientName);
 
     if(vaccine != NULL) {
-        patient->vaccine = (char*) malloc((strlen(vaccine) + 1) * sizeof(char));
-        if(patient->vaccine == NULL) {
-            free(patient->name);
+        // The vaccine name is not copied. The patient points to the name stored in the catalogue.
+        if(vaccineCatalog_intern(vaccine, NONE, PRECLINICAL, &patient->vaccineId) != OK) {
+            uoc_free(patient->name);
+            patient->name = NULL;
             return ERR_MEMORY_ERROR;
         }
-        strcpy(patient->vaccine, vaccine);
+        patient->vaccine = (char*) vaccineCatalog_name(patient->vaccineId);
 		patient->lotID = lotID;
     } else {
         patient->vaccine = NULL;
+        patient->vaccineId = NO_VACCINE_ID;
 		patient->lotID = 0;
     }
 
@@ -48,28 +55,73 @@ tError patient_init(tPatient *patient, const char* patientName, int patientId, c
     return OK;
 }
 
+// Names of the patient groups, in the order of tPatientGroup
+static const char* groupNames[PATIENT_GROUPS] = {
+    "HEALTH_WORKER",
+    "ADULT_OVER_80",
+    "ADULT_OVER_65",
+    "COMORBID",
+    "ESSENTIAL_WORKER",
+    "ADULT_OVER_55",
+    "ANYONE_ELSE"
+};
+
+// Get the name of a patient group, as written in files
+const char* patient_groupName(tPatientGroup group) {
+    // Verify pre conditions
+    assert(group >= HEALTH_WORKER && group < PATIENT_GROUPS);
+
+    return groupNames[group];
+}
+
+// Get the group with the given name, as given by patient_groupName
+tError patient_groupFromName(const char* name, tPatientGroup* group) {
+    int i;
+
+    // Verify pre conditions
+    assert(name != NULL);
+    assert(group != NULL);
+
+    for(i = 0; i < PATIENT_GROUPS; i++) {
+        if(strcmp(name, groupNames[i]) == 0) {
+            *group = (tPatientGroup)i;
+            return OK;
+        }
+    }
+
+    return ERR_INVALID;
+}
+
 // inoculate a vaccine to a patient
 tError patient_inoculate_vaccine(tPatient* patient, const char* vaccine, int lotID) {
+    tVaccineId vaccineId;
+
     // Verify pre conditions
     assert(patient != NULL);
     assert(vaccine != NULL);
 
+    if(vaccineCatalog_intern(vaccine, NONE, PRECLINICAL, &vaccineId) != OK) {
+        return ERR_MEMORY_ERROR;
+    }
+
+    return patient_inoculate_vaccineId(patient, vaccineId, lotID);
+}
+
+// inoculate a vaccine of the vaccine catalogue to a patient
+tError patient_inoculate_vaccineId(tPatient* patient, tVaccineId vaccineId, int lotID) {
+    // Verify pre conditions
+    assert(patient != NULL);
+    assert(vaccineCatalog_get(vaccineId) != NULL);
 
-    if((patient->vaccine != NULL) && (strcmp(patient->vaccine, vaccine) != 0)) {
+    if((patient->vaccine != NULL) && (patient->vaccineId != vaccineId)) {
         return ERR_INVALID_VACCINE;
     }
 
     if(patient->vaccine != NULL) {
         patient->number_doses++;
     } else {
-
-        patient->vaccine = (char*) malloc((strlen(vaccine) + 1) * sizeof(char));
-        if(patient->vaccine == NULL) {
-            free(patient->name);
-            patient->name = NULL;
-            return ERR_MEMORY_ERROR;
-        }
-        strcpy(patient->vaccine, vaccine);
+        patient->vaccine = (char*) vaccineCatalog_name(vaccineId);
+        patient->vaccineId = vaccineId;
         patient->number_doses = 1;
 		patient->lotID = lotID;
     }
@@ -84,14 +136,13 @@ void patient_free(tPatient* patient){
     // All memory allocated with malloc and realloc needs to be freed using the free command.
     // In this case, as we use malloc to allocate the fields, we have to free them
     if(patient->name != NULL) {
-        free(patient->name);
+        uoc_free(patient->name);
         patient->name = NULL;
     }
 	
-	if(patient->vaccine != NULL) {
-        free(patient->vaccine);
-        patient->vaccine = NULL;
-    }
+	// The vaccine name belongs to the vaccine catalogue
+	patient->vaccine = NULL;
+	patient->vaccineId = NO_VACCINE_ID;
 	
 	patient->id = 0;
 }
@@ -104,12 +155,37 @@ bool patient_compare(tPatient p1, tPatient p2) {
 }
 
 // Duplicate a patient
-tError patient_duplicate(tPatient *dst, tPatient src) {
+static tError patient_duplicateImpl(tPatient *dst, tPatient src) {
     // Check preconditions
     assert(dst != NULL);
 
-    // Copy the values of both structures
-    return patient_init(dst, src.name, src.id, src.vaccine, src.lotID, src.number_doses, src.group);
+    // A patient without a catalogue id has to look up its vaccine name
+    if(src.vaccine != NULL && src.vaccineId == NO_VACCINE_ID) {
+        return patient_init(dst, src.name, src.id, src.vaccine, src.lotID, src.number_doses, src.group);
+    }
+
+    // Copy the values of both structures. The vaccine name is shared, so only the id is copied.
+    if(patient_init(dst, src.name, src.id, NULL, 0, src.number_doses, src.group) != OK) {
+        return ERR_MEMORY_ERROR;
+    }
+    if(src.vaccine != NULL) {
+        dst->vaccine = src.vaccine;
+        dst->vaccineId = src.vaccineId;
+        dst->lotID = src.lotID;
+    }
+
+    return OK;
+}
+
+// Measured entry point of patient_duplicate
+tError patient_duplicate(tPatient *dst, tPatient src) {
+    tError error;
+
+    INSTRUMENT_START(start);
+    error = patient_duplicateImpl(dst, src);
+    INSTRUMENT_STOP(INSTRUMENT_PATIENT_DUPLICATE, start);
+
+    return error;
 }
 
 // Returns true if the vaccine can be inoculated.
@@ -117,410 +193,1989 @@ bool patient_isSuitableForVaccine(tPatient* patient, tVaccine* vaccine) {
     
     if (patient == NULL || vaccine == NULL) return false;
 
-    // Regla típica del enunciado: AstraZeneca NO para ciertos grupos (ejemplo: >65 y comórbidos)
-    // Ajustado a tus enums: ADULT_OVER_65 y COMORBID
-    if (strcmp(vaccine->name, ASTRAZENECA_VAC) == 0) {
-        if (patient->group == ADULT_OVER_65 || patient->group == COMORBID) {
-            return false;
-        }
-    }
-
-    // Janssen: monodosis -> idónea igualmente para primera (la segunda no aplica)
-    // Resto: idóneas por defecto
-    return true;
+    // Los grupos excluidos de cada vacuna (por ejemplo, AstraZeneca para >65 y comórbidos)
+    // están en la tabla de reglas de elegibilidad
+    return eligibility_isSuitable(vaccine->id, patient->group);
 }
 
 // Returns true if the patient has been fully vaccinated
-bool patient_isVaccinated(tPatient* patient) {
-    // With more than one dose anyone is vaccinated. 
-    if(patient->number_doses > 1) 
-        return true;
+bool patient_isVaccinated(const tPatient* patient) {
+    // Without a known vaccine, more than one dose is needed
+    if(patient->vaccine == NULL) 
+        return patient->number_doses > 1;
     
-    // Check if it is a Janssen vaccine with one or more doses
-    if(patient->vaccine != NULL && patient->number_doses > 0)
-        if(strcmp(patient->vaccine, JANSSEN_VAC) == 0)
-            return true;
-            
-    return false;
+    // Check the doses required by the vaccine (one for Janssen)
+    return patient->number_doses > 0 && patient->number_doses >= eligibility_dosesRequired(patient->vaccineId);
 }
 
-// Create the patient queue
-tError patientQueue_create(tPatientQueue* queue) {
-    // Check preconditions
-    assert(queue != NULL);
-
-    // Assign pointers to NULL
-    queue->first = NULL;
-    queue->last = NULL;
-    return OK;
+// Predicate of aggregations: the patient has the vaccine with the id pointed by data
+bool patient_matchesVaccine(const tPatient* patient, const void* data) {
+    return patient->vaccine != NULL && patient->vaccineId == *(const tVaccineId*)data;
 }
 
-// Check if the queue is empty
-bool patientQueue_empty(tPatientQueue queue) {
+// Predicate of aggregations: the patient got a dose of the batch given by a tPatientBatchFilter
+bool patient_matchesBatch(const tPatient* patient, const void* data) {
+    const tPatientBatchFilter* filter = (const tPatientBatchFilter*)data;
 
-    return queue.first == NULL;
+    return patient->number_doses >= 1 && patient->vaccine != NULL &&
+        patient->vaccineId == filter->vaccineId && patient->lotID == filter->lotID;
 }
 
-// Enqueue a new match to the match queue
-tError patientQueue_enqueue(tPatientQueue* queue, tPatient patient) {
-
-    tPatientQueueNode *tmp;
-
-    // Check preconditions
-    assert(queue != NULL);
+// Predicate of aggregations: the patient has a vaccine of the table and technology given by a tPatientTechnologyFilter
+bool patient_matchesTechnology(const tPatient* patient, const void* data) {
+    const tPatientTechnologyFilter* filter = (const tPatientTechnologyFilter*)data;
+    tVaccine* vaccine;
 
-    tmp = (tPatientQueueNode*) malloc(sizeof(tPatientQueueNode));
-    if(tmp == NULL) {
-        return ERR_MEMORY_ERROR;
-    } else {
-        if(patient_duplicate(&tmp->e, patient) != OK) {
-            free(tmp);
-            return ERR_MEMORY_ERROR;
-        }
-        tmp->next = NULL;
-        if(queue->first == NULL) {
-            // empty queue
-            queue->first = tmp;
-        } else {
-            queue->last->next = tmp;
-        }
-        queue->last = tmp;
+    if(patient->vaccine == NULL) {
+        return false;
     }
 
-    return OK;
+    vaccine = vaccineTable_findById(filter->vaccines, patient->vaccineId);
+    return vaccine != NULL && vaccine->vaccineTec == filter->technology;
 }
 
-// Make a copy of the queue
-tError patientQueue_duplicate(tPatientQueue* dst, tPatientQueue src) {
-    tPatientQueueNode *pNode;
-    tError error;
-    // Check preconditions
-    assert(dst != NULL);
-
-    // Initialize the new queue
-    error = patientQueue_create(dst);
+// Accumulator of aggregations: count the patient in its vaccine of a tPatientVaccineHistogram
+void patient_accumulateVaccine(const tPatient* patient, void* result) {
+    tPatientVaccineHistogram* histogram = (tPatientVaccineHistogram*)result;
 
-    if(error != OK) {
-        return error;
-    }
-    // Assign pointer to first element
-    pNode = src.first;
-    while(pNode != NULL) {
-        // Enqueue the current element to the output queue
-        error = patientQueue_enqueue(dst, pNode->e);
-        if(error != OK) {
-            patientQueue_free(dst);
-            return error;
-        }
-        // Move to next element
-        pNode = pNode->next;
+    if(patient->vaccine != NULL && patient->vaccineId >= 0 && (unsigned int)patient->vaccineId < histogram->size) {
+        histogram->counts[patient->vaccineId]++;
     }
-
-    return OK;
-
 }
 
+// Accumulator of aggregations: count the patient in its group of an array of PATIENT_GROUPS counters
+void patient_accumulateGroup(const tPatient* patient, void* result) {
+    ((unsigned int*)result)[patient->group]++;
+}
 
-// Remove all elements of the queue
-void patientQueue_free(tPatientQueue* queue){
+// Reset all the counters of the statistics of a queue
+static void patientQueueStats_init(tPatientQueueStats* stats) {
+    int i;
 
-    // Check preconditions
-    assert(queue != NULL);
-    tPatient * patient;
-    // Remove all elements
-    while(!patientQueue_empty(*queue)) {
-        patient = patientQueue_dequeue(queue);
-		patient_free(patient);
-		free(patient);
+    for(i = 0; i < PATIENT_QUEUE_DOSE_COUNTERS; i++) {
+        stats->doses[i] = 0;
     }
-    
-    // Check postconditions
-    assert(queue->first == NULL);
-    assert(queue->last == NULL);
+    for(i = 0; i < PATIENT_GROUPS; i++) {
+        stats->groups[i] = 0;
+    }
+    stats->vaccinated = 0;
+    stats->vaccines = NULL;
+    stats->vaccinesCount = 0;
+    stats->rulesVersion = eligibility_version();
+}
 
-	}
+// Release the memory used by the statistics of a queue, resetting all the counters
+static void patientQueueStats_free(tPatientQueueStats* stats) {
+    uoc_free(stats->vaccines);
+    patientQueueStats_init(stats);
+}
 
+// Get the dose counter of a number of doses
+static int patientQueueStats_doseCounter(int number_doses) {
+    if(number_doses < 0) {
+        return 0;
+    }
+    if(number_doses >= PATIENT_QUEUE_DOSE_COUNTERS) {
+        return PATIENT_QUEUE_DOSE_COUNTERS - 1;
+    }
+    return number_doses;
+}
 
-// Dequeue a patient from the presentation queue
-tPatient* patientQueue_dequeue(tPatientQueue* queue) {
+// Add a patient to the statistics of a queue
+static tError patientQueueStats_add(tPatientQueueStats* stats, const tPatient* patient) {
+    unsigned int* vaccinesAux;
+    unsigned int count, i;
 
-    tPatientQueueNode *node = NULL;
-    tPatient *patient;
+    assert(patient->group >= HEALTH_WORKER && patient->group < PATIENT_GROUPS);
 
-    if(patientQueue_empty(*queue)) {
-        return NULL;
+    if(patient->vaccine != NULL && patient->vaccineId != NO_VACCINE_ID) {
+        // Make room for all the vaccines of the catalogue
+        if(patient->vaccineId >= (tVaccineId)stats->vaccinesCount) {
+            count = vaccineCatalog_size();
+            if(count <= (unsigned int)patient->vaccineId) {
+                count = patient->vaccineId + 1;
+            }
+            vaccinesAux = (unsigned int*)uoc_realloc(stats->vaccines, count * sizeof(unsigned int));
+            if(vaccinesAux == NULL) {
+                return ERR_MEMORY_ERROR;
+            }
+            for(i = stats->vaccinesCount; i < count; i++) {
+                vaccinesAux[i] = 0;
+            }
+            stats->vaccines = vaccinesAux;
+            stats->vaccinesCount = count;
+        }
+        stats->vaccines[patient->vaccineId]++;
     }
 
-    patient = (tPatient*)malloc(sizeof(tPatient));
-    if(patient == NULL)
-        return NULL;
-
-    if(patient_duplicate(patient, queue->first->e) != OK) {
-        free(patient);
-        return NULL;
+    stats->doses[patientQueueStats_doseCounter(patient->number_doses)]++;
+    stats->groups[patient->group]++;
+    if(patient_isVaccinated(patient)) {
+        stats->vaccinated++;
     }
 
-    node = queue->first;
-    queue->first = queue->first->next;
-
+    return OK;
+}
 
-    patient_free(&(node->e));
+// Remove a patient from the statistics of a queue
+static void patientQueueStats_remove(tPatientQueueStats* stats, const tPatient* patient) {
+    if(patient->vaccine != NULL && patient->vaccineId != NO_VACCINE_ID && patient->vaccineId < (tVaccineId)stats->vaccinesCount) {
+        stats->vaccines[patient->vaccineId]--;
+    }
 
-    if(queue->first == NULL) {
-        queue->last = NULL;
+    stats->doses[patientQueueStats_doseCounter(patient->number_doses)]--;
+    stats->groups[patient->group]--;
+    if(patient_isVaccinated(patient)) {
+        stats->vaccinated--;
     }
+}
 
-    free(node);
-    return patient;
+// Count again the vaccinated patients of a queue if the eligibility rules changed since they were counted.
+// It is called before the statistics are read or changed, while all the patients of the queue are counted
+static void patientQueue_checkRules(tPatientQueue* queue) {
+    tPatientQueueIterator it;
+    const tPatient* patient;
+    unsigned int version;
 
+    version = eligibility_version();
+    if(queue->stats.rulesVersion == version) {
+        return;
+    }
 
+    queue->stats.vaccinated = 0;
+    patientQueue_iterator(queue, &it);
+    while((patient = patientQueue_next(&it)) != NULL) {
+        if(patient_isVaccinated(patient)) {
+            queue->stats.vaccinated++;
+        }
+    }
+    queue->stats.rulesVersion = version;
 }
 
-// Return the first patient from the queue
-tPatient* patientQueue_head(tPatientQueue queue) {
+// Hash of the name and id of a patient, used by the fingerprint of the queues
+static uint64_t patient_hash(const tPatient* patient) {
+    const unsigned char* c;
+    uint64_t hash;
 
-    if(patientQueue_empty(queue)) {
-        return NULL;
-    } else {
-        return &queue.first->e;
+    // FNV-1a of the name, followed by the id and a final mix of the bits
+    hash = 0xCBF29CE484222325ull;
+    for(c = (const unsigned char*)patient->name; *c != '\0'; c++) {
+        hash = (hash ^ *c) * 0x100000001B3ull;
     }
+    hash ^= (uint64_t)(unsigned int)patient->id;
+    hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ull;
+    hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBull;
 
+    return hash ^ (hash >> 31);
 }
 
-// create a copy of the queues before calling  patientQueue_compareRecursive
-bool patientQueue_compare(tPatientQueue *queue1, tPatientQueue *queue2){
-	bool equal = false;
-	
-	tPatientQueue  copy_queue1, copy_queue2;
-
-	patientQueue_duplicate(&copy_queue1,*queue1);
-	patientQueue_duplicate(&copy_queue2,*queue2);
-	
-	equal = patientQueue_compareRecursive(&copy_queue1, &copy_queue2);
-	
-	patientQueue_free(&copy_queue1);
-	patientQueue_free(&copy_queue2);
-	
-	return equal;
-	
+// Initialize the fingerprint of an empty queue
+static void patientQueueFingerprint_init(tPatientQueueFingerprint* fingerprint) {
+    fingerprint->hash = 0;
+    fingerprint->power = 1;
+    fingerprint->dirty = false;
 }
 
+// Add the hash of a patient at the tail to the fingerprint
+static void patientQueueFingerprint_add(tPatientQueueFingerprint* fingerprint, uint64_t hash) {
+    fingerprint->hash += hash * fingerprint->power;
+    fingerprint->power *= PATIENT_FINGERPRINT_BASE;
+}
 
-// create a copy of the queues before calling  patientQueue_compareRecursive
-bool patientQueue_compareIterative(tPatientQueue *queue1, tPatientQueue *queue2){
-	
-	tPatientQueue  copy_queue1, copy_queue2;
-	tPatient* patient1, * patient2; 
-
- 	if(patientQueue_empty(*queue1) && patientQueue_empty(*queue2) ) {
-        return true;
-    }
-	
-	patientQueue_duplicate(&copy_queue1,*queue1);
-	patientQueue_duplicate(&copy_queue2,*queue2);
-	
-	while(!patientQueue_empty(copy_queue1)) {
-		// Get the head
-		patient1 = patientQueue_dequeue(&copy_queue1);
-		patient2 = patientQueue_dequeue(&copy_queue2);
-		
-		
-		if(patient1 == NULL || patient2 == NULL){		
-	
-			patientQueue_free(&copy_queue1);
-			patientQueue_free(&copy_queue2);
-			patient_free(patient1);
-			patient_free(patient2);
-			free(patient1);
-			free(patient2);
-			return false;
-		}
-		else if (!patient_compare(*patient1,*patient2)) {
-			patientQueue_free(&copy_queue1);
-			patientQueue_free(&copy_queue2);
-			patient_free(patient1);
-			patient_free(patient2);
-			free(patient1);
-			free(patient2);
-			return false;
-
-		}
-		
-		
-		patient_free(patient1);
-		patient_free(patient2);
-		free(patient1);
-		free(patient2);
-		
-	}
-	
-	patientQueue_free(&copy_queue1);
-	patientQueue_free(&copy_queue2);
+// Remove the hash of the patient at the head from the fingerprint. The weights of the other patients are divided by the base
+static void patientQueueFingerprint_remove(tPatientQueueFingerprint* fingerprint, uint64_t hash) {
+    fingerprint->hash = (fingerprint->hash - hash) * PATIENT_FINGERPRINT_INVERSE;
+    fingerprint->power *= PATIENT_FINGERPRINT_INVERSE;
+}
 
-	return true;	
-	
+// Initialize a disabled id index
+static void patientQueueIdIndex_init(tPatientQueueIdIndex* index) {
+    index->enabled = false;
+    index->capacity = 0;
+    index->count = 0;
+    index->sequence = 0;
+    index->entries = NULL;
 }
 
+// Release the entries of the id index. The index stays enabled, and is filled again by the next patients
+static void patientQueueIdIndex_free(tPatientQueueIdIndex* index) {
+    uoc_free(index->entries);
+    index->entries = NULL;
+    index->capacity = 0;
+    index->count = 0;
+    index->sequence = 0;
+}
 
-// compare if two queues are equal recursively.
-bool patientQueue_compareRecursive(tPatientQueue *queue1, tPatientQueue *queue2){
+// Get the entry of the id index where the search of an id starts
+static unsigned int patientQueueIdIndex_start(const tPatientQueueIdIndex* index, int id) {
+    // Multiplying by an odd constant spreads consecutive ids over different entries
+    return ((unsigned int)id * 2654435761u) & (index->capacity - 1);
+}
 
-	bool flag;
-	tPatient* patient1, * patient2; 
-	
-    if(patientQueue_empty(*queue1) && patientQueue_empty(*queue2) ) {
-        flag = true ;
-	}
-    else
-    {
-		patient1 = patientQueue_dequeue(queue1);
-		patient2 = patientQueue_dequeue(queue2);
-		
-        if(patient1 == NULL || patient2 == NULL){			
-			flag = false;
-			
-			patient_free(patient1);
-			patient_free(patient2);
-			free(patient1);
-			free(patient2);
-			
-		}
-		else if (!patient_compare(*patient1,*patient2)) {
-			
-			
-			flag = false;
-			patient_free(patient1);
-			patient_free(patient2);
-			free(patient1);
-			free(patient2);
+// Store an entry in the id index, which must have a free entry
+static void patientQueueIdIndex_put(tPatientQueueIdIndex* index, int id, void* slot, unsigned int sequence) {
+    unsigned int i;
 
-		}
-        else{
-            patient_free(patient1);
-			patient_free(patient2);
-			free(patient1);
-			free(patient2);
-			return patientQueue_compareRecursive ( queue1, queue2);
-		}
-	}
-			 
-    
+    // Linear probing: use the first free entry starting at the one given by the hash
+    i = patientQueueIdIndex_start(index, id);
+    while(index->entries[i].id != PATIENT_QUEUE_NO_ID) {
+        i = (i + 1) & (index->capacity - 1);
+    }
 
-			
-    return (flag) ;	
-   
+    index->entries[i].slot = slot;
+    index->entries[i].id = id;
+    index->entries[i].sequence = sequence;
+    index->count++;
 }
 
+// Change the number of entries of the id index, placing again all the entries
+static tError patientQueueIdIndex_resize(tPatientQueueIdIndex* index, unsigned int capacity) {
+    tPatientQueueIdEntry *entries, *oldEntries;
+    unsigned int i, oldCapacity;
 
-// count how many patients already vaccinated with a vaccine
-int patientQueue_getPatientsPerVaccineRecursive(tPatientQueue *queue, const char* vaccine){
-
-	int vaccinated_patients = 0;    
-    tPatient* patient; 
+    // The capacity must be a power of two, to compute the entry with a mask
+    assert((capacity & (capacity - 1)) == 0);
+    assert(capacity >= 2 * index->count);
 
-    // Base cases
-    // 1) The queue is empty => score = 0
-    if(patientQueue_empty(*queue)) {
-        return 0;
+    entries = (tPatientQueueIdEntry*)uoc_malloc(capacity * sizeof(tPatientQueueIdEntry));
+    if(entries == NULL) {
+        return ERR_MEMORY_ERROR;
     }
-    
-    // Recursion
-    
-    // Get the head
-     patient = patientQueue_dequeue(queue);
-    
-    // check if have been vacinnated 
-	if( (patient->vaccine!=NULL) && (strcmp(patient->vaccine, vaccine) == 0) ) {
-        // names are different
-       vaccinated_patients++;
+    for(i = 0; i < capacity; i++) {
+        entries[i].id = PATIENT_QUEUE_NO_ID;
     }
-	
-	patient_free(patient);
-	free(patient);
-    
-    return vaccinated_patients + patientQueue_getPatientsPerVaccineRecursive(queue, vaccine);
 
+    oldEntries = index->entries;
+    oldCapacity = index->capacity;
+    index->entries = entries;
+    index->capacity = capacity;
+    index->count = 0;
+
+    for(i = 0; i < oldCapacity; i++) {
+        if(oldEntries[i].id != PATIENT_QUEUE_NO_ID) {
+            patientQueueIdIndex_put(index, oldEntries[i].id, oldEntries[i].slot, oldEntries[i].sequence);
+        }
+    }
+    uoc_free(oldEntries);
+
+    return OK;
 }
 
+// Make room in the id index for one more patient, so that adding it can not fail
+static tError patientQueueIdIndex_reserve(tPatientQueueIdIndex* index) {
+    // Keep the index at most half full, so that probe sequences stay short
+    if(index->enabled && 2 * (index->count + 1) > index->capacity) {
+        return patientQueueIdIndex_resize(index, index->capacity == 0 ? 64 : 2 * index->capacity);
+    }
 
+    return OK;
+}
 
-// count how many patients already vaccinated with a vaccine technology
-int patientQueue_getPatientsPerVaccineTechnologyRecursive(tPatientQueue *queue, tVaccineTable vaccines, tVaccineTec technology){
+// Add a patient that arrives at the queue to the id index. There must be room for it
+static void patientQueueIdIndex_add(tPatientQueueIdIndex* index, int id, void* slot) {
+    if(index->enabled && id != PATIENT_QUEUE_NO_ID) {
+        patientQueueIdIndex_put(index, id, slot, index->sequence);
+        index->sequence++;
+    }
+}
 
-	int vaccinated_technology = 0;    
-    tPatient* patient; 
-    tVaccine* vaccine; 
+// Get the entry of the first patient of the queue with the given id, or -1
+static int patientQueueIdIndex_find(const tPatientQueueIdIndex* index, int id) {
+    unsigned int i;
+    int found;
 
-    // Base cases
-    // 1) The queue is empty => score = 0
-    if(patientQueue_empty(*queue)) {
-        return 0;
+    if(index->count == 0) {
+        return -1;
     }
-    
-    // Recursion
-    
-    // Get the head
-     patient = patientQueue_dequeue(queue);
-    
-    // check if use the technology
-	if( patient->vaccine!=NULL) {
-		vaccine = vaccineTable_find(&vaccines,patient->vaccine);
-		if ( (vaccine != NULL) && (vaccine->vaccineTec ==technology) ){			
-			vaccinated_technology++;
-		}
+
+    // All the patients with the same id are in the same probe sequence. Keep the one that arrived first
+    found = -1;
+    for(i = patientQueueIdIndex_start(index, id); index->entries[i].id != PATIENT_QUEUE_NO_ID; i = (i + 1) & (index->capacity - 1)) {
+        if(index->entries[i].id == id && (found < 0 || (int)(index->entries[i].sequence - index->entries[found].sequence) < 0)) {
+            found = (int)i;
+        }
     }
-    patient_free(patient);
-	free(patient);
-	
-    return vaccinated_technology + patientQueue_getPatientsPerVaccineTechnologyRecursive(queue, vaccines, technology);
 
+    return found;
 }
 
-int patientQueue_countPatients_vaccinationBatch(tPatientQueue queue, const char* vaccine, int lotID){
-
-    if (vaccine == NULL || vaccine[0] == '\0') return 0;  // nombre inválido → 0
-    // Nota: asumimos lotID puede ser 0 o positivo; no filtramos por <0 salvo que tus tests lo exijan.
-
-    int count = 0;
+// Get the entry of the patient with the given id and slot, or -1
+static int patientQueueIdIndex_findSlot(const tPatientQueueIdIndex* index, int id, const void* slot) {
+    unsigned int i;
 
-    // Copiamos la cola para poder hacer dequeue sin tocar la original
-    tPatientQueue copy;
-    if (patientQueue_duplicate(&copy, queue) != OK) {
-        return 0;
+    if(index->count == 0) {
+        return -1;
     }
 
-    while (!patientQueue_empty(copy)) {
-        tPatient* p = patientQueue_dequeue(&copy);
-        if (p != NULL) {
-            if (p->number_doses >= 1 &&
-                p->vaccine != NULL &&
-                strcmp(p->vaccine, vaccine) == 0 &&
-                p->lotID == lotID) {
-                count++;
-            }
-            patient_free(p);
-            free(p);
+    for(i = patientQueueIdIndex_start(index, id); index->entries[i].id != PATIENT_QUEUE_NO_ID; i = (i + 1) & (index->capacity - 1)) {
+        if(index->entries[i].id == id && index->entries[i].slot == slot) {
+            return (int)i;
         }
     }
 
-    // Libera la copia si tu TAD lo soporta
-    patientQueue_free(&copy);
-
-    return count;
+    return -1;
 }
 
+// Remove an entry of the id index, moving back the entries after it in the probe sequence
+static void patientQueueIdIndex_removeAt(tPatientQueueIdIndex* index, unsigned int position) {
+    unsigned int i, j, k;
 
-// Helper function - Print a queue in the console - use for debugging
-void patientQueue_print(tPatientQueue queue) {
-    tPatientQueueNode *nodePtr = queue.first;
-    int i = 0;
-
-    while(nodePtr != NULL) {
+    i = position;
+    j = position;
+    while(true) {
+        j = (j + 1) & (index->capacity - 1);
+        if(index->entries[j].id == PATIENT_QUEUE_NO_ID) {
+            break;
+        }
+        // The entry stays if the start of its search is cyclically in (i, j]
+        k = patientQueueIdIndex_start(index, index->entries[j].id);
+        if(i <= j ? (i < k && k <= j) : (i < k || k <= j)) {
+            continue;
+        }
+        index->entries[i] = index->entries[j];
+        i = j;
+    }
+
+    index->entries[i].id = PATIENT_QUEUE_NO_ID;
+    index->count--;
+}
+
+// Remove a patient that leaves the queue from the id index
+static void patientQueueIdIndex_remove(tPatientQueueIdIndex* index, int id, const void* slot) {
+    int entry;
+
+    if(index->enabled) {
+        entry = patientQueueIdIndex_findSlot(index, id, slot);
+        if(entry >= 0) {
+            patientQueueIdIndex_removeAt(index, (unsigned int)entry);
+        }
+    }
+}
+
+// Change the slot of a patient in the id index
+static void patientQueueIdIndex_move(tPatientQueueIdIndex* index, int id, const void* from, void* to) {
+    int entry;
+
+    if(index->enabled) {
+        entry = patientQueueIdIndex_findSlot(index, id, from);
+        if(entry >= 0) {
+            index->entries[entry].slot = to;
+        }
+    }
+}
+
+// Queues created so far, used to give each queue its own range of generations
+static atomic_uint patientQueue_created;
+
+// Create the patient queue
+tError patientQueue_create(tPatientQueue* queue) {
+    // Check preconditions
+    assert(queue != NULL);
+
+    // Assign pointers to NULL
+    queue->backend = PATIENT_QUEUE_LINKED;
+    queue->first = NULL;
+    queue->last = NULL;
+    queue->firstChunk = NULL;
+    queue->lastChunk = NULL;
+    queue->spareChunk = NULL;
+    queue->head = 0;
+    queue->tail = 0;
+    queue->size = 0;
+    patientQueueStats_init(&queue->stats);
+    patientQueueFingerprint_init(&queue->fingerprint);
+    queue->arena = NULL;
+    queue->names = NULL;
+    patientQueueIdIndex_init(&queue->ids);
+    queue->generation = (uint64_t)(atomic_fetch_add_explicit(&patientQueue_created, 1, memory_order_relaxed) + 1) << 32;
+    queue->updateWaiting = false;
+    queue->allocator = allocator_current();
+    return OK;
+}
+
+// Create the patient queue using chunks of contiguous patients as storage
+tError patientQueue_createChunked(tPatientQueue* queue) {
+    tError error;
+
+    // Check preconditions
+    assert(queue != NULL);
+
+    // Chunks are allocated with the first patient
+    error = patientQueue_create(queue);
+    queue->backend = PATIENT_QUEUE_CHUNKED;
+
+    return error;
+}
+
+// Get the number of patients in the queue
+unsigned int patientQueue_size(tPatientQueue queue) {
+
+    return queue.size;
+}
+
+// Check if the queue is empty
+bool patientQueue_empty(tPatientQueue queue) {
+
+    if(queue.backend == PATIENT_QUEUE_CHUNKED) {
+        return queue.size == 0;
+    }
+
+    return queue.first == NULL;
+}
+
+// Store the patients of an empty queue in an arena. The memory goes back to the system with the arena
+tError patientQueue_useArena(tPatientQueue* queue, tArena* arena) {
+    // Check preconditions
+    assert(queue != NULL);
+
+    // The patients already stored were allocated with malloc
+    if(queue->size > 0 || queue->firstChunk != NULL || queue->spareChunk != NULL) {
+        return ERR_INVALID;
+    }
+
+    queue->arena = arena;
+
+    return OK;
+}
+
+// Get the memory for a new chunk, from the arena of the queue or from malloc
+static tPatientQueueChunk* patientQueue_allocChunk(tPatientQueue* queue) {
+    if(queue->arena != NULL) {
+        return (tPatientQueueChunk*) arena_alloc(queue->arena, sizeof(tPatientQueueChunk));
+    }
+    return (tPatientQueueChunk*) uoc_malloc(sizeof(tPatientQueueChunk));
+}
+
+// Release the memory of a chunk. Chunks of an arena are released with the arena
+static void patientQueue_releaseChunk(tPatientQueue* queue, tPatientQueueChunk* chunk) {
+    if(queue->arena != NULL) {
+        arena_release(queue->arena, chunk, sizeof(tPatientQueueChunk));
+    } else {
+        uoc_free(chunk);
+    }
+}
+
+// Get the memory for a new node, from the arena of the queue or from malloc
+static tPatientQueueNode* patientQueue_allocNode(tPatientQueue* queue) {
+    if(queue->arena != NULL) {
+        return (tPatientQueueNode*) arena_alloc(queue->arena, sizeof(tPatientQueueNode));
+    }
+    return (tPatientQueueNode*) uoc_malloc(sizeof(tPatientQueueNode));
+}
+
+// Release the memory of a node, to be reused by the next nodes of the arena
+static void patientQueue_releaseNode(tPatientQueue* queue, tPatientQueueNode* node) {
+    if(queue->arena != NULL) {
+        arena_release(queue->arena, node, sizeof(tPatientQueueNode));
+    } else {
+        uoc_free(node);
+    }
+}
+
+// Get the arena where the names of the patients of the queue are stored, or NULL if they use malloc
+static tArena* patientQueue_nameArena(tPatientQueue* queue) {
+    return queue->arena != NULL ? queue->arena : queue->names;
+}
+
+// Copy a patient to the storage of the queue. The name is copied to the arena of its names, if it has one
+static tError patientQueue_store(tPatientQueue* queue, tPatient* dst, tPatient src) {
+    tArena *arena;
+
+    arena = patientQueue_nameArena(queue);
+    if(arena == NULL) {
+        return patient_duplicate(dst, src);
+    }
+
+    *dst = src;
+
+    // A patient without a catalogue id has to look up its vaccine name
+    if(src.vaccine == NULL) {
+        dst->vaccineId = NO_VACCINE_ID;
+        dst->lotID = 0;
+    } else if(src.vaccineId == NO_VACCINE_ID) {
+        if(vaccineCatalog_intern(src.vaccine, NONE, PRECLINICAL, &dst->vaccineId) != OK) {
+            return ERR_MEMORY_ERROR;
+        }
+        dst->vaccine = (char*) vaccineCatalog_name(dst->vaccineId);
+    }
+
+    dst->name = arena_strdup(arena, src.name);
+    if(dst->name == NULL) {
+        return ERR_MEMORY_ERROR;
+    }
+
+    return OK;
+}
+
+// Release the name of a patient stored in the queue
+static void patientQueue_releasePatient(tPatientQueue* queue, tPatient* patient) {
+    tArena *arena;
+
+    arena = patientQueue_nameArena(queue);
+    if(arena != NULL) {
+        arena_release(arena, patient->name, strlen(patient->name) + 1);
+        patient->name = NULL;
+        patient->id = 0;
+    } else {
+        patient_free(patient);
+    }
+}
+
+// Enqueue a new patient at the tail of a chunked queue
+static tError patientQueue_enqueueChunked(tPatientQueue* queue, tPatient patient, uint64_t hash) {
+
+    tPatientQueueChunk *chunk;
+
+    // The names are stored together instead of one allocation each
+    if(queue->arena == NULL && queue->names == NULL) {
+        queue->names = (tArena*)uoc_malloc(sizeof(tArena));
+        if(queue->names == NULL) {
+            return ERR_MEMORY_ERROR;
+        }
+        arena_init(queue->names, PATIENT_QUEUE_NAMES_BLOCK_SIZE);
+    }
+
+    // Add a chunk when there is no chunk or the last one is full
+    if(queue->lastChunk == NULL || queue->tail == PATIENT_QUEUE_CHUNK_SIZE) {
+        if(queue->spareChunk != NULL) {
+            chunk = queue->spareChunk;
+            queue->spareChunk = NULL;
+        } else {
+            chunk = patientQueue_allocChunk(queue);
+            if(chunk == NULL) {
+                return ERR_MEMORY_ERROR;
+            }
+        }
+        chunk->next = NULL;
+        if(queue->lastChunk == NULL) {
+            // empty queue
+            queue->firstChunk = chunk;
+            queue->head = 0;
+        } else {
+            queue->lastChunk->next = chunk;
+        }
+        queue->lastChunk = chunk;
+        queue->tail = 0;
+    }
+
+    if(patientQueue_store(queue, &queue->lastChunk->elements[queue->tail], patient) != OK) {
+        return ERR_MEMORY_ERROR;
+    }
+    queue->lastChunk->hashes[queue->tail] = hash;
+    patientQueueIdIndex_add(&queue->ids, patient.id, &queue->lastChunk->elements[queue->tail]);
+    queue->tail++;
+    queue->size++;
+
+    return OK;
+}
+
+// Enqueue a new match to the match queue
+static tError patientQueue_enqueueImpl(tPatientQueue* queue, tPatient patient) {
+
+    tPatientQueueNode *tmp;
+    uint64_t hash;
+    tError error;
+
+    // Check preconditions
+    assert(queue != NULL);
+
+    patientQueue_checkRules(queue);
+
+    // The hash is kept with the patient, so that dequeue does not need to compute it again
+    hash = patient_hash(&patient);
+
+    // Make room for the patient in the id index first, so that nothing has to be undone later
+    error = patientQueueIdIndex_reserve(&queue->ids);
+    if(error != OK) {
+        return error;
+    }
+
+    // Count the patient. It is removed from the statistics again if it cannot be stored.
+    error = patientQueueStats_add(&queue->stats, &patient);
+    if(error != OK) {
+        return error;
+    }
+
+    if(queue->backend == PATIENT_QUEUE_CHUNKED) {
+        error = patientQueue_enqueueChunked(queue, patient, hash);
+        if(error != OK) {
+            patientQueueStats_remove(&queue->stats, &patient);
+        } else {
+            patientQueueFingerprint_add(&queue->fingerprint, hash);
+            if(patient.number_doses == 0) {
+                queue->generation++;
+            }
+        }
+        return error;
+    }
+
+    tmp = patientQueue_allocNode(queue);
+    if(tmp == NULL) {
+        patientQueueStats_remove(&queue->stats, &patient);
+        return ERR_MEMORY_ERROR;
+    } else {
+        if(patientQueue_store(queue, &tmp->e, patient) != OK) {
+            patientQueueStats_remove(&queue->stats, &patient);
+            patientQueue_releaseNode(queue, tmp);
+            return ERR_MEMORY_ERROR;
+        }
+        tmp->next = NULL;
+        tmp->hash = hash;
+        patientQueueIdIndex_add(&queue->ids, tmp->e.id, queue->first == NULL ? NULL : queue->last);
+        if(queue->first == NULL) {
+            // empty queue
+            queue->first = tmp;
+        } else {
+            queue->last->next = tmp;
+        }
+        queue->last = tmp;
+        queue->size++;
+        patientQueueFingerprint_add(&queue->fingerprint, hash);
+        if(patient.number_doses == 0) {
+            queue->generation++;
+        }
+    }
+
+    return OK;
+}
+
+// Measured entry point of patientQueue_enqueue
+tError patientQueue_enqueue(tPatientQueue* queue, tPatient patient) {
+    const tAllocator* previous;
+    tError error;
+
+    INSTRUMENT_START(start);
+    previous = allocator_enterOwner(queue->allocator);
+    error = patientQueue_enqueueImpl(queue, patient);
+    allocator_leave(previous);
+    INSTRUMENT_STOP(INSTRUMENT_QUEUE_ENQUEUE, start);
+
+    return error;
+}
+
+// Make a copy of the queue
+tError patientQueue_duplicate(tPatientQueue* dst, tPatientQueue src) {
+    tError error;
+    // Check preconditions
+    assert(dst != NULL);
+
+    // Initialize the new queue, with the same storage as the source queue
+    if(src.backend == PATIENT_QUEUE_CHUNKED) {
+        error = patientQueue_createChunked(dst);
+    } else {
+        error = patientQueue_create(dst);
+    }
+
+    if(error != OK) {
+        return error;
+    }
+
+    error = patientQueue_enqueueAll(dst, &src);
+    if(error != OK) {
+        patientQueue_free(dst);
+    }
+
+    return error;
+
+}
+
+// Enqueue a copy of all the patients of src at the tail of dst
+tError patientQueue_enqueueAll(tPatientQueue* dst, tPatientQueue* src) {
+    tPatientQueueIterator it;
+    const tPatient *patient;
+    tError error;
+    // Check preconditions
+    assert(dst != NULL);
+    assert(src != NULL);
+
+    // Visit all the patients in order
+    patientQueue_iterator(src, &it);
+    while((patient = patientQueue_next(&it)) != NULL) {
+        // Enqueue the current element to the output queue
+        error = patientQueue_enqueue(dst, *patient);
+        if(error != OK) {
+            return error;
+        }
+    }
+
+    return OK;
+}
+
+
+// Remove all elements of the queue, with the allocator of the queue entered
+static void patientQueue_freeImpl(tPatientQueue* queue){
+
+    // Check preconditions
+    assert(queue != NULL);
+    tPatient * patient;
+    tPatientQueueChunk *chunk;
+
+    // The patients are not removed one by one from the id index
+    patientQueueIdIndex_free(&queue->ids);
+
+    if(queue->arena != NULL) {
+        // The nodes, chunks and names stay in the arena, and are released all together with it
+        queue->first = NULL;
+        queue->last = NULL;
+        queue->firstChunk = NULL;
+        queue->lastChunk = NULL;
+        queue->spareChunk = NULL;
+        queue->head = 0;
+        queue->tail = 0;
+        queue->size = 0;
+        patientQueueStats_free(&queue->stats);
+        patientQueueFingerprint_init(&queue->fingerprint);
+        return;
+    }
+
+    if(queue->backend == PATIENT_QUEUE_CHUNKED) {
+        // The names are released all together with their arena, and then the chunks
+        if(queue->names != NULL) {
+            arena_free(queue->names);
+            uoc_free(queue->names);
+            queue->names = NULL;
+        }
+        while(queue->firstChunk != NULL) {
+            chunk = queue->firstChunk;
+            queue->firstChunk = chunk->next;
+            uoc_free(chunk);
+        }
+        uoc_free(queue->spareChunk);
+        queue->lastChunk = NULL;
+        queue->spareChunk = NULL;
+        queue->head = 0;
+        queue->tail = 0;
+        queue->size = 0;
+        patientQueueStats_free(&queue->stats);
+        patientQueueFingerprint_init(&queue->fingerprint);
+        return;
+    }
+
+    // Remove all elements
+    while(!patientQueue_empty(*queue)) {
+        patient = patientQueue_dequeue(queue);
+		patient_free(patient);
+		free(patient);
+    }
+    patientQueueStats_free(&queue->stats);
+    
+    // Check postconditions
+    assert(queue->first == NULL);
+    assert(queue->last == NULL);
+
+	}
+
+// Remove all elements of the queue
+void patientQueue_free(tPatientQueue* queue) {
+    const tAllocator* previous;
+
+    // Check preconditions
+    assert(queue != NULL);
+
+    previous = allocator_enterOwner(queue->allocator);
+    patientQueue_freeImpl(queue);
+    allocator_leave(previous);
+}
+
+
+// Move the head of a chunked queue to the next position
+static void patientQueue_advanceHead(tPatientQueue* queue) {
+    tPatientQueueChunk *chunk;
+
+    queue->head++;
+
+    // Once the first chunk has been read completely, keep it to be reused
+    if(queue->head == PATIENT_QUEUE_CHUNK_SIZE && queue->firstChunk != queue->lastChunk) {
+        chunk = queue->firstChunk;
+        queue->firstChunk = chunk->next;
+        queue->head = 0;
+        if(queue->spareChunk == NULL) {
+            queue->spareChunk = chunk;
+        } else {
+            patientQueue_releaseChunk(queue, chunk);
+        }
+    }
+}
+
+// Move the head of a chunked queue past the patients removed by id, so that it is always a patient
+static void patientQueue_skipRemoved(tPatientQueue* queue) {
+    while((queue->firstChunk != queue->lastChunk || queue->head < queue->tail) &&
+            queue->firstChunk->elements[queue->head].name == NULL) {
+        patientQueue_advanceHead(queue);
+    }
+
+    // An empty queue starts again at the beginning of its chunk
+    if(queue->size == 0) {
+        queue->head = 0;
+        queue->tail = 0;
+    }
+}
+
+// Dequeue the patient at the head of a chunked queue into the given patient
+static void patientQueue_dequeueChunked(tPatientQueue* queue, tPatient* patient, uint64_t* hash) {
+
+    // The patient leaves the chunk, so its fields are moved instead of duplicated
+    patientQueueIdIndex_remove(&queue->ids, queue->firstChunk->elements[queue->head].id, &queue->firstChunk->elements[queue->head]);
+    *patient = queue->firstChunk->elements[queue->head];
+    *hash = queue->firstChunk->hashes[queue->head];
+    queue->size--;
+    patientQueue_advanceHead(queue);
+    patientQueue_skipRemoved(queue);
+}
+
+// Dequeue a patient from the presentation queue into the given patient
+static tError patientQueue_dequeueIntoImpl(tPatientQueue* queue, tPatient* patient) {
+
+    tPatientQueueNode *node = NULL;
+    tPatient *head;
+    tArena *arena;
+    char *name = NULL;
+    uint64_t hash;
+
+    if(patientQueue_empty(*queue)) {
+        return ERR_EMPTY;
+    }
+
+    patientQueue_checkRules(queue);
+
+    // The patient leaves the arena, so its name is copied to memory that can be released with patient_free
+    arena = patientQueue_nameArena(queue);
+    if(arena != NULL) {
+        head = patientQueue_head(*queue);
+        name = (char*)uoc_malloc((strlen(head->name) + 1) * sizeof(char));
+        if(name == NULL)
+            return ERR_MEMORY_ERROR;
+        strcpy(name, head->name);
+    }
+
+    if(queue->backend == PATIENT_QUEUE_CHUNKED) {
+        patientQueue_dequeueChunked(queue, patient, &hash);
+    } else {
+        // The node is released, so its fields are moved to the patient instead of duplicated
+        node = queue->first;
+        patientQueueIdIndex_remove(&queue->ids, node->e.id, NULL);
+        if(node->next != NULL) {
+            patientQueueIdIndex_move(&queue->ids, node->next->e.id, node, NULL);
+        }
+        *patient = node->e;
+        hash = node->hash;
+        queue->first = queue->first->next;
+        queue->size--;
+
+        if(queue->first == NULL) {
+            queue->last = NULL;
+        }
+
+        patientQueue_releaseNode(queue, node);
+    }
+
+    if(arena != NULL) {
+        arena_release(arena, patient->name, strlen(patient->name) + 1);
+        patient->name = name;
+    }
+
+    // Uncount the patient. An empty queue releases the counters, as queues are often
+    // emptied with dequeue and never freed.
+    patientQueueStats_remove(&queue->stats, patient);
+    patientQueueFingerprint_remove(&queue->fingerprint, hash);
+    if(queue->size == 0) {
+        patientQueueStats_free(&queue->stats);
+        patientQueueFingerprint_init(&queue->fingerprint);
+    }
+
+    return OK;
+}
+
+// Dequeue a patient from the presentation queue
+static tPatient* patientQueue_dequeueImpl(tPatientQueue* queue) {
+
+    tPatient *patient;
+
+    if(patientQueue_empty(*queue)) {
+        return NULL;
+    }
+
+    // The caller releases the returned patient with free, so it does not come from the allocator
+    patient = (tPatient*)malloc(sizeof(tPatient));
+    if(patient == NULL) {
+        return NULL;
+    }
+
+    if(patientQueue_dequeueIntoImpl(queue, patient) != OK) {
+        free(patient);
+        return NULL;
+    }
+
+    return patient;
+}
+
+// Measured entry point of patientQueue_dequeue
+tPatient* patientQueue_dequeue(tPatientQueue* queue) {
+    const tAllocator* previous;
+    tPatient* result;
+
+    INSTRUMENT_START(start);
+    previous = allocator_enterOwner(queue->allocator);
+    result = patientQueue_dequeueImpl(queue);
+    allocator_leave(previous);
+    INSTRUMENT_STOP(INSTRUMENT_QUEUE_DEQUEUE, start);
+
+    return result;
+}
+
+// Release a patient given by patientQueue_dequeue, releasing its name with the allocator of its queue
+void patientQueue_release(tPatientQueue* queue, tPatient* patient) {
+    const tAllocator* previous;
+
+    // Check preconditions
+    assert(queue != NULL);
+
+    if(patient == NULL) {
+        return;
+    }
+
+    previous = allocator_enterOwner(queue->allocator);
+    patient_free(patient);
+    allocator_leave(previous);
+    free(patient);
+}
+
+// Dequeue a patient into the given one, that owns its name afterwards and is released with patient_free
+tError patientQueue_dequeueInto(tPatientQueue* queue, tPatient* patient) {
+    const tAllocator* previous;
+    tError error;
+
+    // Check preconditions
+    assert(queue != NULL);
+    assert(patient != NULL);
+
+    INSTRUMENT_START(start);
+    previous = allocator_enterOwner(queue->allocator);
+    error = patientQueue_dequeueIntoImpl(queue, patient);
+    allocator_leave(previous);
+    INSTRUMENT_STOP(INSTRUMENT_QUEUE_DEQUEUE, start);
+
+    return error;
+}
+
+// Return the first patient from the queue
+tPatient* patientQueue_head(tPatientQueue queue) {
+
+    if(patientQueue_empty(queue)) {
+        return NULL;
+    } else if(queue.backend == PATIENT_QUEUE_CHUNKED) {
+        return &queue.firstChunk->elements[queue.head];
+    } else {
+        return &queue.first->e;
+    }
+
+}
+
+// Compare two queues patient by patient, without copying them
+static bool patientQueue_compareWalk(tPatientQueue *queue1, tPatientQueue *queue2){
+    tPatientQueueIterator it1, it2;
+    const tPatient *patient1, *patient2;
+
+    patientQueue_iterator(queue1, &it1);
+    patientQueue_iterator(queue2, &it2);
+    do {
+        patient1 = patientQueue_next(&it1);
+        patient2 = patientQueue_next(&it2);
+        if(patient1 == NULL || patient2 == NULL) {
+            return patient1 == patient2;
+        }
+    } while(strcmp(patient1->name, patient2->name) == 0 && patient1->id == patient2->id);
+
+    return false;
+}
+
+// compare if two queues are equal. Queues with different size or fingerprint are rejected
+// without reading the patients, otherwise the patients are compared in place
+bool patientQueue_compare(tPatientQueue *queue1, tPatientQueue *queue2){
+
+    if(queue1->size != queue2->size) {
+        return false;
+    }
+
+    if(patientQueue_fingerprint(queue1) != patientQueue_fingerprint(queue2)) {
+        return false;
+    }
+
+    return patientQueue_compareWalk(queue1, queue2);
+}
+
+
+// compare if two queues are equal iteratively
+bool patientQueue_compareIterative(tPatientQueue *queue1, tPatientQueue *queue2){
+
+    // The iterative comparison is the one done by patientQueue_compare
+    return patientQueue_compare(queue1, queue2);
+}
+
+
+// compare if two queues are equal recursively.
+bool patientQueue_compareRecursive(tPatientQueue *queue1, tPatientQueue *queue2){
+
+	bool flag;
+	tPatient* patient1, * patient2; 
+	
+    if(patientQueue_empty(*queue1) && patientQueue_empty(*queue2) ) {
+        flag = true ;
+	}
+    else
+    {
+		patient1 = patientQueue_dequeue(queue1);
+		patient2 = patientQueue_dequeue(queue2);
+		
+        if(patient1 == NULL || patient2 == NULL){			
+			flag = false;
+			
+			patientQueue_release(queue1, patient1);
+			patientQueue_release(queue2, patient2);
+			
+		}
+		else if (!patient_compare(*patient1,*patient2)) {
+			
+			
+			flag = false;
+			patientQueue_release(queue1, patient1);
+			patientQueue_release(queue2, patient2);
+
+		}
+        else{
+			patientQueue_release(queue1, patient1);
+			patientQueue_release(queue2, patient2);
+			return patientQueue_compareRecursive ( queue1, queue2);
+		}
+	}
+			 
+    
+
+			
+    return (flag) ;	
+   
+}
+
+
+// count how many patients already vaccinated with a vaccine
+int patientQueue_getPatientsPerVaccineRecursive(tPatientQueue *queue, const char* vaccine){
+
+    tPatientAggregation aggregation;
+    tVaccineId vaccineId;
+
+    // Compare catalogue ids instead of names. The name is searched only once.
+    vaccineId = vaccineCatalog_find(vaccine);
+    if(vaccineId == NO_VACCINE_ID) {
+        return 0;
+    }
+
+    // The queue is walked without dequeuing the patients
+    aggregation.predicate = patient_matchesVaccine;
+    aggregation.data = &vaccineId;
+    aggregation.accumulator = NULL;
+    aggregation.result = NULL;
+    patientQueue_aggregate(queue, &aggregation, 1);
+
+    return aggregation.count;
+
+}
+
+
+
+// count how many patients already vaccinated with a vaccine technology
+int patientQueue_getPatientsPerVaccineTechnologyRecursive(tPatientQueue *queue, tVaccineTable vaccines, tVaccineTec technology){
+
+    tPatientAggregation aggregation;
+    tPatientTechnologyFilter filter;
+
+    // The queue is walked without dequeuing the patients
+    filter.vaccines = &vaccines;
+    filter.technology = technology;
+    aggregation.predicate = patient_matchesTechnology;
+    aggregation.data = &filter;
+    aggregation.accumulator = NULL;
+    aggregation.result = NULL;
+    patientQueue_aggregate(queue, &aggregation, 1);
+
+    return aggregation.count;
+
+}
+
+int patientQueue_countPatients_vaccinationBatch(tPatientQueue queue, const char* vaccine, int lotID){
+
+    if (vaccine == NULL || vaccine[0] == '\0') return 0;  // nombre inválido → 0
+    // Nota: asumimos lotID puede ser 0 o positivo; no filtramos por <0 salvo que tus tests lo exijan.
+
+    tPatientAggregation aggregation;
+    tPatientBatchFilter filter;
+
+    // Una vacuna que no está en el catálogo no la tiene ningún paciente
+    filter.vaccineId = vaccineCatalog_find(vaccine);
+    if (filter.vaccineId == NO_VACCINE_ID) return 0;
+    filter.lotID = lotID;
+
+    // Se recorre la cola sin copiarla ni hacer dequeue
+    aggregation.predicate = patient_matchesBatch;
+    aggregation.data = &filter;
+    aggregation.accumulator = NULL;
+    aggregation.result = NULL;
+    patientQueue_aggregate(&queue, &aggregation, 1);
+
+    return aggregation.count;
+}
+
+
+// Helper function - Print a queue in the console - use for debugging
+void patientQueue_print(tPatientQueue queue) {
+    tPatientQueueIterator it;
+    const tPatient *patient;
+    int i = 0;
+
+    patientQueue_iterator(&queue, &it);
+    while((patient = patientQueue_next(&it)) != NULL) {
 		
-        printf("%d) %s group %d %d dosis %d %s batch %d\n", i, nodePtr->e.name, nodePtr->e.group, nodePtr->e.id, nodePtr->e.number_doses, nodePtr->e.vaccine, nodePtr->e.lotID);
-        nodePtr = nodePtr->next;
+        printf("%d) %s group %d %d dosis %d %s batch %d\n", i, patient->name, patient->group, patient->id, patient->number_doses, patient->vaccine, patient->lotID);
         i++;
     }
 
-    printf("\n");
+    printf("\n");
+}
+
+// Place the iterator before the first patient of the queue
+void patientQueue_iterator(tPatientQueue* queue, tPatientQueueIterator* it) {
+    // Check preconditions
+    assert(queue != NULL);
+    assert(it != NULL);
+
+    it->queue = queue;
+    it->node = queue->first;
+    it->chunk = queue->firstChunk;
+    it->position = queue->head;
+}
+
+// Get the next patient of the iterator, or NULL when all the patients have been read
+const tPatient* patientQueue_next(tPatientQueueIterator* it) {
+    const tPatient *patient;
+
+    // Check preconditions
+    assert(it != NULL);
+
+    if(it->queue->backend == PATIENT_QUEUE_CHUNKED) {
+        // All the chunks but the last one are full. Move to the next chunk at the end of each one.
+        // Skip the patients removed by id
+        do {
+            if(it->chunk != NULL && it->position == PATIENT_QUEUE_CHUNK_SIZE) {
+                it->chunk = it->chunk->next;
+                it->position = 0;
+            }
+            if(it->chunk == NULL || (it->chunk == it->queue->lastChunk && it->position >= it->queue->tail)) {
+                return NULL;
+            }
+            patient = &it->chunk->elements[it->position];
+            it->position++;
+        } while(patient->name == NULL);
+        return patient;
+    }
+
+    if(it->node == NULL) {
+        return NULL;
+    }
+    patient = &it->node->e;
+    it->node = it->node->next;
+    return patient;
+}
+
+// Place the cursor before the first patient of the queue
+void patientQueue_cursor(tPatientQueue* queue, tPatientQueueCursor* cursor) {
+    // Check preconditions
+    assert(queue != NULL);
+    assert(cursor != NULL);
+
+    patientQueue_iterator(queue, &cursor->it);
+    cursor->current = NULL;
+    cursor->error = OK;
+}
+
+// Move the cursor to the next patient and get it to be modified in place, or NULL at the end of the queue.
+// The name and id of the patient must not be modified.
+tPatient* patientQueue_cursorNext(tPatientQueueCursor* cursor) {
+    tError error;
+
+    // Check preconditions
+    assert(cursor != NULL);
+
+    // Count again the previous patient, with the changes done
+    if(cursor->current != NULL) {
+        error = patientQueue_endUpdate(cursor->it.queue, cursor->current);
+        if(cursor->error == OK) {
+            cursor->error = error;
+        }
+    }
+
+    // The patients are stored in the queue, so they can be modified. The next patient
+    // is uncounted until the cursor moves again.
+    cursor->current = (tPatient*) patientQueue_next(&cursor->it);
+    if(cursor->current != NULL) {
+        patientQueue_beginUpdate(cursor->it.queue, cursor->current);
+    }
+
+    return cursor->current;
+}
+
+// Finish a walk with the cursor, updating the statistics of the last patient. Returns the first error of the walk
+tError patientQueue_cursorClose(tPatientQueueCursor* cursor) {
+    tError error;
+
+    // Check preconditions
+    assert(cursor != NULL);
+
+    if(cursor->current != NULL) {
+        error = patientQueue_endUpdate(cursor->it.queue, cursor->current);
+        if(cursor->error == OK) {
+            cursor->error = error;
+        }
+        cursor->current = NULL;
+    }
+
+    return cursor->error;
+}
+
+// Remove a patient of the queue from the statistics, before modifying it in place
+void patientQueue_beginUpdate(tPatientQueue* queue, const tPatient* patient) {
+    // Check preconditions
+    assert(queue != NULL);
+    assert(patient != NULL);
+
+    patientQueue_checkRules(queue);
+    patientQueueStats_remove(&queue->stats, patient);
+    queue->updateWaiting = patient->number_doses == 0;
+}
+
+// Add a patient of the queue to the statistics again, after modifying it in place
+tError patientQueue_endUpdate(tPatientQueue* queue, const tPatient* patient) {
+    const tAllocator* previous;
+    tError error;
+
+    // Check preconditions
+    assert(queue != NULL);
+    assert(patient != NULL);
+
+    previous = allocator_enterOwner(queue->allocator);
+    error = patientQueueStats_add(&queue->stats, patient);
+    allocator_leave(previous);
+
+    if(patient->number_doses == 0 && !queue->updateWaiting) {
+        queue->generation++;
+    }
+
+    return error;
+}
+
+// Get the counters of the patients of the queue
+const tPatientQueueStats* patientQueue_stats(tPatientQueue* queue) {
+    // Check preconditions
+    assert(queue != NULL);
+
+    patientQueue_checkRules(queue);
+
+    return &queue->stats;
+}
+
+// Get the generation of the queue, that changes when a patient starts waiting for the first dose
+uint64_t patientQueue_generation(const tPatientQueue* queue) {
+    // Check preconditions
+    assert(queue != NULL);
+
+    return queue->generation;
+}
+
+// Get the number of patients of the queue with the given number of doses
+unsigned int patientQueue_countDoses(tPatientQueue* queue, int number_doses) {
+    // Check preconditions
+    assert(queue != NULL);
+
+    if(number_doses < 0) {
+        return 0;
+    }
+
+    return queue->stats.doses[patientQueueStats_doseCounter(number_doses)];
+}
+
+// Get the number of patients of the queue vaccinated with the given vaccine
+unsigned int patientQueue_countVaccine(tPatientQueue* queue, tVaccineId vaccineId) {
+    // Check preconditions
+    assert(queue != NULL);
+
+    if(vaccineId < 0 || vaccineId >= (tVaccineId)queue->stats.vaccinesCount) {
+        return 0;
+    }
+
+    return queue->stats.vaccines[vaccineId];
+}
+
+// Compute several aggregations walking the queue once, without copying or modifying it
+void patientQueue_aggregate(tPatientQueue* queue, tPatientAggregation* aggregations, unsigned int count) {
+    tPatientQueueIterator it;
+    const tPatient* patient;
+    tPatientAggregation* aggregation;
+    unsigned int i;
+
+    // Verify pre conditions
+    assert(queue != NULL);
+    assert(aggregations != NULL || count == 0);
+
+    for(i = 0; i < count; i++) {
+        aggregations[i].count = 0;
+    }
+
+    patientQueue_iterator(queue, &it);
+    while((patient = patientQueue_next(&it)) != NULL) {
+        for(i = 0; i < count; i++) {
+            aggregation = &aggregations[i];
+            if(aggregation->predicate == NULL || aggregation->predicate(patient, aggregation->data)) {
+                aggregation->count++;
+                if(aggregation->accumulator != NULL) {
+                    aggregation->accumulator(patient, aggregation->result);
+                }
+            }
+        }
+    }
+}
+
+// Get the fingerprint of the queue. Equal queues have equal fingerprints
+uint64_t patientQueue_fingerprint(tPatientQueue* queue) {
+    tPatientQueueNode* node;
+    tPatientQueueChunk* chunk;
+    unsigned int i, position;
+    uint64_t* hash;
+
+    // Verify pre conditions
+    assert(queue != NULL);
+
+    // Compute again the hashes kept with the patients, and add them in order
+    if(queue->fingerprint.dirty) {
+        patientQueueFingerprint_init(&queue->fingerprint);
+        if(queue->backend == PATIENT_QUEUE_CHUNKED) {
+            chunk = queue->firstChunk;
+            position = queue->head;
+            for(i = 0; i < queue->size; position++) {
+                if(position == PATIENT_QUEUE_CHUNK_SIZE) {
+                    chunk = chunk->next;
+                    position = 0;
+                }
+                // Skip the patients removed by id
+                if(chunk->elements[position].name != NULL) {
+                    hash = &chunk->hashes[position];
+                    *hash = patient_hash(&chunk->elements[position]);
+                    patientQueueFingerprint_add(&queue->fingerprint, *hash);
+                    i++;
+                }
+            }
+        } else {
+            for(node = queue->first; node != NULL; node = node->next) {
+                node->hash = patient_hash(&node->e);
+                patientQueueFingerprint_add(&queue->fingerprint, node->hash);
+            }
+        }
+    }
+
+    return queue->fingerprint.hash;
+}
+
+// Mark the fingerprint as outdated. Call it after changing the name or id of patients of the queue directly
+void patientQueue_invalidateFingerprint(tPatientQueue* queue) {
+    // Verify pre conditions
+    assert(queue != NULL);
+
+    queue->fingerprint.dirty = true;
+}
+
+// Place a patient of the queue in the entries of its region of the id index, or only count it without entries
+static void patientQueueIdIndex_place(tPatientQueueIdIndex* index, unsigned int shift, unsigned int* offsets,
+                                      tPatientQueueIdEntry* entries, int id, void* slot) {
+    tPatientQueueIdEntry* entry;
+    unsigned int region;
+
+    if(id == PATIENT_QUEUE_NO_ID) {
+        return;
+    }
+
+    region = patientQueueIdIndex_start(index, id) >> shift;
+    if(entries == NULL) {
+        offsets[region]++;
+    } else {
+        entry = &entries[offsets[region]++];
+        entry->id = id;
+        entry->slot = slot;
+        entry->sequence = index->sequence;
+        index->sequence++;
+    }
+}
+
+// Walk the patients of the queue in order, placing each one with patientQueueIdIndex_place
+static void patientQueueIdIndex_placeAll(tPatientQueue* queue, unsigned int shift, unsigned int* offsets, tPatientQueueIdEntry* entries) {
+    tPatientQueueIterator it;
+    tPatientQueueNode *node, *previous;
+    const tPatient *patient;
+
+    if(queue->backend == PATIENT_QUEUE_CHUNKED) {
+        patientQueue_iterator(queue, &it);
+        while((patient = patientQueue_next(&it)) != NULL) {
+            patientQueueIdIndex_place(&queue->ids, shift, offsets, entries, patient->id, (tPatient*) patient);
+        }
+    } else {
+        previous = NULL;
+        for(node = queue->first; node != NULL; node = node->next) {
+            patientQueueIdIndex_place(&queue->ids, shift, offsets, entries, node->e.id, previous);
+            previous = node;
+        }
+    }
+}
+
+// Fill the empty id index with the patients of the queue in one pass. The index is sized once, and the patients are
+// grouped by the region of the index where they start, so that each region is written while it is in the cache
+static tError patientQueueIdIndex_fill(tPatientQueue* queue) {
+    tPatientQueueIdEntry* entries;
+    unsigned int *offsets;
+    unsigned int capacity, regions, shift, count, next, i;
+    tError error;
+
+    assert(queue->ids.count == 0);
+
+    capacity = 64;
+    while(capacity < 2 * queue->size) {
+        capacity *= 2;
+    }
+    error = patientQueueIdIndex_resize(&queue->ids, capacity);
+    if(error != OK) {
+        return error;
+    }
+
+    // The region of an entry is given by the highest bits of the entry where its search starts
+    regions = 1;
+    shift = 0;
+    while((1u << shift) < capacity) {
+        shift++;
+    }
+    while(regions < PATIENT_QUEUE_ID_REGIONS && (capacity / regions) > PATIENT_QUEUE_ID_REGION_SIZE) {
+        regions *= 2;
+        shift--;
+    }
+
+    entries = (tPatientQueueIdEntry*)uoc_malloc((queue->size > 0 ? queue->size : 1) * sizeof(tPatientQueueIdEntry));
+    offsets = (unsigned int*)uoc_calloc(regions, sizeof(unsigned int));
+    if(entries == NULL || offsets == NULL) {
+        uoc_free(entries);
+        uoc_free(offsets);
+        return ERR_MEMORY_ERROR;
+    }
+
+    // Count the patients of each region, and then place them after the ones of the regions before
+    patientQueueIdIndex_placeAll(queue, shift, offsets, NULL);
+    next = 0;
+    for(i = 0; i < regions; i++) {
+        count = offsets[i];
+        offsets[i] = next;
+        next += count;
+    }
+    patientQueueIdIndex_placeAll(queue, shift, offsets, entries);
+
+    for(i = 0; i < next; i++) {
+        patientQueueIdIndex_put(&queue->ids, entries[i].id, entries[i].slot, entries[i].sequence);
+    }
+
+    uoc_free(entries);
+    uoc_free(offsets);
+
+    return OK;
+}
+
+// Keep an index of the ids of the patients of the queue, with the allocator of the queue entered
+static tError patientQueue_enableIdIndexImpl(tPatientQueue* queue) {
+    tError error;
+
+    // Verify pre conditions
+    assert(queue != NULL);
+
+    if(queue->ids.enabled) {
+        return OK;
+    }
+    queue->ids.enabled = true;
+
+    // Add the patients already in the queue, in order
+    error = patientQueueIdIndex_fill(queue);
+    if(error != OK) {
+        patientQueueIdIndex_free(&queue->ids);
+        queue->ids.enabled = false;
+    }
+
+    return error;
+}
+
+// Keep an index of the ids of the patients of the queue, to find them without walking the queue
+tError patientQueue_enableIdIndex(tPatientQueue* queue) {
+    const tAllocator* previous;
+    tError error;
+
+    // Verify pre conditions
+    assert(queue != NULL);
+
+    previous = allocator_enterOwner(queue->allocator);
+    error = patientQueue_enableIdIndexImpl(queue);
+    allocator_leave(previous);
+
+    return error;
+}
+
+// Stop keeping the index of the ids of the patients of the queue. patientQueue_enableIdIndex fills it again in one pass
+void patientQueue_disableIdIndex(tPatientQueue* queue) {
+    const tAllocator* previous;
+
+    // Verify pre conditions
+    assert(queue != NULL);
+
+    previous = allocator_enterOwner(queue->allocator);
+    patientQueueIdIndex_free(&queue->ids);
+    queue->ids.enabled = false;
+    allocator_leave(previous);
+}
+
+// Find the first patient of the queue with the given id. For linked queues, get also the node before it.
+// The entry of the patient in the id index is -1 if the queue has no index
+static tPatient* patientQueue_locate(tPatientQueue* queue, int id, tPatientQueueNode** previous, int* entry) {
+    tPatientQueueIterator it;
+    tPatientQueueNode *node;
+    const tPatient *patient;
+
+    *previous = NULL;
+    *entry = -1;
+
+    if(queue->ids.enabled) {
+        *entry = patientQueueIdIndex_find(&queue->ids, id);
+        if(*entry < 0) {
+            return NULL;
+        }
+        if(queue->backend == PATIENT_QUEUE_CHUNKED) {
+            return (tPatient*) queue->ids.entries[*entry].slot;
+        }
+        *previous = (tPatientQueueNode*) queue->ids.entries[*entry].slot;
+        return *previous != NULL ? &(*previous)->next->e : &queue->first->e;
+    }
+
+    // Without index, the queue is walked
+    if(queue->backend == PATIENT_QUEUE_CHUNKED) {
+        patientQueue_iterator(queue, &it);
+        while((patient = patientQueue_next(&it)) != NULL) {
+            if(patient->id == id) {
+                return (tPatient*) patient;
+            }
+        }
+        return NULL;
+    }
+
+    for(node = queue->first; node != NULL; node = node->next) {
+        if(node->e.id == id) {
+            return &node->e;
+        }
+        *previous = node;
+    }
+
+    return NULL;
+}
+
+// Make room in the id index for count more patients, with the allocator of the queue entered
+static tError patientQueue_reserveImpl(tPatientQueue* queue, unsigned int count) {
+    unsigned int capacity;
+
+    // Check preconditions
+    assert(queue != NULL);
+
+    if(!queue->ids.enabled || 2 * (queue->ids.count + count) <= queue->ids.capacity) {
+        return OK;
+    }
+
+    capacity = queue->ids.capacity == 0 ? 64 : queue->ids.capacity;
+    while(capacity < 2 * (queue->ids.count + count)) {
+        capacity *= 2;
+    }
+
+    return patientQueueIdIndex_resize(&queue->ids, capacity);
+}
+
+// Make room in the id index for count more patients, so that it does not grow while they are enqueued
+tError patientQueue_reserve(tPatientQueue* queue, unsigned int count) {
+    const tAllocator* previous;
+    tError error;
+
+    // Verify pre conditions
+    assert(queue != NULL);
+
+    previous = allocator_enterOwner(queue->allocator);
+    error = patientQueue_reserveImpl(queue, count);
+    allocator_leave(previous);
+
+    return error;
+}
+
+// Get the first patient of the queue with the given id, or NULL. Change it only with patientQueue_updateById
+tPatient* patientQueue_findById(tPatientQueue* queue, int id) {
+    tPatientQueueNode *previous;
+    int entry;
+
+    // Verify pre conditions
+    assert(queue != NULL);
+
+    return patientQueue_locate(queue, id, &previous, &entry);
+}
+
+// Replace the data of the first patient of the queue with the given id, with the allocator of the queue entered
+static tError patientQueue_updateByIdImpl(tPatientQueue* queue, int id, tPatient patient) {
+    tPatientQueueNode *previous;
+    tPatient *current;
+    tPatient copy;
+    unsigned int sequence;
+    void *slot;
+    tError error;
+    int entry;
+
+    // Verify pre conditions
+    assert(queue != NULL);
+    assert(patient.name != NULL);
+
+    current = patientQueue_locate(queue, id, &previous, &entry);
+    if(current == NULL) {
+        return ERR_NOT_FOUND;
+    }
+    patientQueue_checkRules(queue);
+
+    error = patientQueue_store(queue, &copy, patient);
+    if(error != OK) {
+        return error;
+    }
+
+    // Count the new data instead of the old one. The old data is counted again if the new one can not be
+    patientQueueStats_remove(&queue->stats, current);
+    error = patientQueueStats_add(&queue->stats, &copy);
+    if(error != OK) {
+        patientQueueStats_add(&queue->stats, current);
+        patientQueue_releasePatient(queue, &copy);
+        return error;
+    }
+
+    // A patient without doses under a new id waits again
+    if(copy.number_doses == 0 && (current->number_doses != 0 || copy.id != id)) {
+        queue->generation++;
+    }
+
+    // A new id takes the patient to other entry of the index, keeping its order of arrival
+    if(copy.id != id && entry >= 0) {
+        slot = queue->ids.entries[entry].slot;
+        sequence = queue->ids.entries[entry].sequence;
+        patientQueueIdIndex_removeAt(&queue->ids, (unsigned int)entry);
+        if(copy.id != PATIENT_QUEUE_NO_ID) {
+            patientQueueIdIndex_put(&queue->ids, copy.id, slot, sequence);
+        }
+    }
+
+    patientQueue_releasePatient(queue, current);
+    *current = copy;
+
+    // The hash of the patient is computed again with the fingerprint
+    queue->fingerprint.dirty = true;
+
+    return OK;
+}
+
+// Replace the data of the first patient of the queue with the given id, keeping its place in the queue
+tError patientQueue_updateById(tPatientQueue* queue, int id, tPatient patient) {
+    const tAllocator* previous;
+    tError error;
+
+    // Verify pre conditions
+    assert(queue != NULL);
+
+    previous = allocator_enterOwner(queue->allocator);
+    error = patientQueue_updateByIdImpl(queue, id, patient);
+    allocator_leave(previous);
+
+    return error;
+}
+
+// Remove from the queue the first patient with the given id, with the allocator of the queue entered
+static tError patientQueue_removeByIdImpl(tPatientQueue* queue, int id) {
+    tPatientQueueNode *previous, *node;
+    tPatient *patient;
+    int entry;
+
+    // Verify pre conditions
+    assert(queue != NULL);
+
+    patient = patientQueue_locate(queue, id, &previous, &entry);
+    if(patient == NULL) {
+        return ERR_NOT_FOUND;
+    }
+    patientQueue_checkRules(queue);
+
+    patientQueueStats_remove(&queue->stats, patient);
+
+    if(queue->backend == PATIENT_QUEUE_CHUNKED) {
+        // The patient is left without name in its chunk, and skipped by the rest of operations
+        if(entry >= 0) {
+            patientQueueIdIndex_removeAt(&queue->ids, (unsigned int)entry);
+        }
+        patientQueue_releasePatient(queue, patient);
+        queue->size--;
+        patientQueue_skipRemoved(queue);
+    } else {
+        // The node after the removed one gets its previous node
+        node = previous != NULL ? previous->next : queue->first;
+        if(entry >= 0) {
+            patientQueueIdIndex_removeAt(&queue->ids, (unsigned int)entry);
+        }
+        if(node->next != NULL) {
+            patientQueueIdIndex_move(&queue->ids, node->next->e.id, node, previous);
+        }
+
+        if(previous != NULL) {
+            previous->next = node->next;
+        } else {
+            queue->first = node->next;
+        }
+        if(queue->last == node) {
+            queue->last = previous;
+        }
+
+        patientQueue_releasePatient(queue, &node->e);
+        patientQueue_releaseNode(queue, node);
+        queue->size--;
+    }
+
+    // The weights of the patients after the removed one change
+    queue->fingerprint.dirty = true;
+    if(queue->size == 0) {
+        patientQueueStats_free(&queue->stats);
+        patientQueueFingerprint_init(&queue->fingerprint);
+    }
+
+    return OK;
+}
+
+// Remove from the queue the first patient with the given id
+tError patientQueue_removeById(tPatientQueue* queue, int id) {
+    const tAllocator* previous;
+    tError error;
+
+    // Verify pre conditions
+    assert(queue != NULL);
+
+    previous = allocator_enterOwner(queue->allocator);
+    error = patientQueue_removeByIdImpl(queue, id);
+    allocator_leave(previous);
+
+    return error;
+}
+
+// Create an empty priority queue
+void patientPriorityQueue_create(tPatientPriorityQueue* queue) {
+    int i;
+
+    // Verify pre conditions
+    assert(queue != NULL);
+
+    for(i = 0; i < PATIENT_GROUPS; i++) {
+        queue->groups[i].elements = NULL;
+        queue->groups[i].head = 0;
+        queue->groups[i].size = 0;
+        queue->groups[i].allocated = 0;
+    }
+    queue->mask = 0;
+    queue->size = 0;
+}
+
+// Remove all the patients of the priority queue
+void patientPriorityQueue_free(tPatientPriorityQueue* queue) {
+    int i;
+
+    // Verify pre conditions
+    assert(queue != NULL);
+
+    for(i = 0; i < PATIENT_GROUPS; i++) {
+        uoc_free(queue->groups[i].elements);
+    }
+    patientPriorityQueue_create(queue);
+}
+
+// Add a patient at the tail of the FIFO of its group
+// Move the ids of a FIFO to a new array with the given length, a power of two, placing them again from the start
+static tError patientIdQueue_resize(tPatientIdQueue* fifo, unsigned int allocated) {
+    int *elements;
+    unsigned int i;
+
+    elements = (int*)uoc_malloc(allocated * sizeof(int));
+    if(elements == NULL) {
+        return ERR_MEMORY_ERROR;
+    }
+    for(i = 0; i < fifo->size; i++) {
+        elements[i] = fifo->elements[(fifo->head + i) & (fifo->allocated - 1)];
+    }
+    uoc_free(fifo->elements);
+    fifo->elements = elements;
+    fifo->head = 0;
+    fifo->allocated = allocated;
+
+    return OK;
+}
+
+tError patientPriorityQueue_enqueue(tPatientPriorityQueue* queue, const tPatient* patient) {
+    tPatientIdQueue *fifo;
+    tError error;
+
+    // Verify pre conditions
+    assert(queue != NULL);
+    assert(patient != NULL);
+    assert(patient->group >= HEALTH_WORKER && patient->group < PATIENT_GROUPS);
+
+    fifo = &queue->groups[patient->group];
+
+    // Double the array when it is full
+    if(fifo->size == fifo->allocated) {
+        error = patientIdQueue_resize(fifo, fifo->allocated == 0 ? 64 : 2 * fifo->allocated);
+        if(error != OK) {
+            return error;
+        }
+    }
+
+    fifo->elements[(fifo->head + fifo->size) & (fifo->allocated - 1)] = patient->id;
+    fifo->size++;
+    queue->mask |= 1u << patient->group;
+    queue->size++;
+
+    return OK;
+}
+
+// Make room in the FIFO of a group for the given number of patients, so that they are enqueued without allocating
+tError patientPriorityQueue_reserve(tPatientPriorityQueue* queue, tPatientGroup group, unsigned int count) {
+    tPatientIdQueue *fifo;
+    unsigned int allocated;
+
+    // Verify pre conditions
+    assert(queue != NULL);
+    assert(group >= HEALTH_WORKER && group < PATIENT_GROUPS);
+
+    fifo = &queue->groups[group];
+    if(count <= fifo->allocated) {
+        return OK;
+    }
+
+    for(allocated = fifo->allocated == 0 ? 64 : fifo->allocated; allocated < count; allocated *= 2);
+
+    return patientIdQueue_resize(fifo, allocated);
+}
+
+// Get the group with the highest priority that has patients, or -1 if the priority queue is empty
+int patientPriorityQueue_firstGroup(tPatientPriorityQueue* queue) {
+    return patientPriorityQueue_nextGroup(queue, HEALTH_WORKER);
+}
+
+// Get the group with the highest priority, starting at the given one, that has patients, or -1 if there is none
+int patientPriorityQueue_nextGroup(tPatientPriorityQueue* queue, int group) {
+    unsigned int mask;
+
+    // Verify pre conditions
+    assert(queue != NULL);
+    assert(group >= HEALTH_WORKER);
+
+    if(group >= PATIENT_GROUPS) {
+        return -1;
+    }
+
+    // The groups before the given one are ignored
+    mask = queue->mask & ~((1u << group) - 1);
+    if(mask == 0) {
+        return -1;
+    }
+
+    // The first group with patients is the lowest bit set of the mask
+#if defined(__GNUC__)
+    group = __builtin_ctz(mask);
+#else
+    for(group = 0; (mask & (1u << group)) == 0; group++);
+#endif
+
+    return group;
+}
+
+// Get the id of the first patient of a group, or PATIENT_QUEUE_NO_ID if the group has no patients
+int patientPriorityQueue_head(tPatientPriorityQueue* queue, tPatientGroup group) {
+    tPatientIdQueue *fifo;
+
+    // Verify pre conditions
+    assert(queue != NULL);
+    assert(group >= HEALTH_WORKER && group < PATIENT_GROUPS);
+
+    fifo = &queue->groups[group];
+    if(fifo->size == 0) {
+        return PATIENT_QUEUE_NO_ID;
+    }
+
+    return fifo->elements[fifo->head];
+}
+
+// Remove the first patient of a group, getting its id. Returns PATIENT_QUEUE_NO_ID if the group has no patients
+int patientPriorityQueue_dequeue(tPatientPriorityQueue* queue, tPatientGroup group) {
+    tPatientIdQueue *fifo;
+    int id;
+
+    // Verify pre conditions
+    assert(queue != NULL);
+    assert(group >= HEALTH_WORKER && group < PATIENT_GROUPS);
+
+    fifo = &queue->groups[group];
+    if(fifo->size == 0) {
+        return PATIENT_QUEUE_NO_ID;
+    }
+
+    id = fifo->elements[fifo->head];
+    fifo->head = (fifo->head + 1) & (fifo->allocated - 1);
+    fifo->size--;
+    queue->size--;
+
+    // An empty group leaves the mask, and starts again at the beginning of its array
+    if(fifo->size == 0) {
+        fifo->head = 0;
+        queue->mask &= ~(1u << group);
+    }
+
+    return id;
+}
+
+// Get the number of patients of the priority queue
+unsigned int patientPriorityQueue_size(tPatientPriorityQueue* queue) {
+    // Verify pre conditions
+    assert(queue != NULL);
+
+    return queue->size;
+}
+
+// Check if the priority queue is empty
+bool patientPriorityQueue_empty(tPatientPriorityQueue* queue) {
+    // Verify pre conditions
+    assert(queue != NULL);
+
+    return queue->mask == 0;
+}
+
+// Remove all the patients of the priority queue, keeping its memory
+void patientPriorityQueue_clear(tPatientPriorityQueue* queue) {
+    int i;
+
+    // Verify pre conditions
+    assert(queue != NULL);
+
+    for(i = 0; i < PATIENT_GROUPS; i++) {
+        queue->groups[i].head = 0;
+        queue->groups[i].size = 0;
+    }
+    queue->mask = 0;
+    queue->size = 0;
 }
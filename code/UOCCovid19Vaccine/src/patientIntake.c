@@ -0,0 +1,124 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "patientIntake.h"
+
+// Link a node at the end of the intake
+static void patientIntake_link(tPatientIntake* intake, tPatientIntakeNode* node) {
+    tPatientIntakeNode* prev;
+
+    atomic_store_explicit(&node->next, NULL, memory_order_relaxed);
+
+    // The node is the last one at once. Until prev is linked to it, the consumer sees the intake end at prev
+    prev = atomic_exchange_explicit(&intake->head, node, memory_order_acq_rel);
+    atomic_store_explicit(&prev->next, node, memory_order_release);
+}
+
+// Initialize an empty intake. The intake can not be moved once initialized
+void patientIntake_init(tPatientIntake* intake) {
+    // Verify pre conditions
+    assert(intake != NULL);
+
+    memset(&intake->stub.patient, 0, sizeof(tPatient));
+    atomic_init(&intake->stub.next, NULL);
+    atomic_init(&intake->head, &intake->stub);
+    intake->tail = &intake->stub;
+    intake->allocator = allocator_current();
+}
+
+// Release the patients that are still in the intake. No producer can be pushing
+void patientIntake_free(tPatientIntake* intake) {
+    tPatientIntakeNode* node;
+
+    // Verify pre conditions
+    assert(intake != NULL);
+
+    while((node = patientIntake_pop(intake)) != NULL) {
+        patientIntake_release(intake, node);
+    }
+}
+
+// Push a copy of a patient. It can be called from many threads at once
+tError patientIntake_push(tPatientIntake* intake, const tPatient* patient) {
+    const tAllocator* previous;
+    tPatientIntakeNode* node;
+    size_t length;
+
+    // Verify pre conditions
+    assert(intake != NULL);
+    assert(patient != NULL);
+    assert(patient->name != NULL);
+
+    // One allocation for the node and the name. The vaccine name belongs to the catalogue.
+    // The node is released by another thread, so it comes from the allocator of the intake
+    length = strlen(patient->name) + 1;
+    previous = allocator_enterOwner(intake->allocator);
+    node = (tPatientIntakeNode*)uoc_malloc(sizeof(tPatientIntakeNode) + length);
+    allocator_leave(previous);
+    if(node == NULL) {
+        return ERR_MEMORY_ERROR;
+    }
+
+    node->patient = *patient;
+    node->patient.name = (char*)(node + 1);
+    memcpy(node->patient.name, patient->name, length);
+
+    patientIntake_link(intake, node);
+
+    return OK;
+}
+
+// Pop the first patient of the intake, or NULL if it is empty or the next push is not linked yet.
+// Only one thread can pop. The node is released with patientIntake_release once the patient is used
+tPatientIntakeNode* patientIntake_pop(tPatientIntake* intake) {
+    tPatientIntakeNode *tail, *next;
+
+    // Verify pre conditions
+    assert(intake != NULL);
+
+    tail = intake->tail;
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+
+    // Skip the stub
+    if(tail == &intake->stub) {
+        if(next == NULL) {
+            return NULL;
+        }
+        intake->tail = next;
+        tail = next;
+        next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    }
+
+    if(next != NULL) {
+        intake->tail = next;
+        return tail;
+    }
+
+    // A producer has swapped the head but not linked its node yet. It is popped in the next drain
+    if(tail != atomic_load_explicit(&intake->head, memory_order_acquire)) {
+        return NULL;
+    }
+
+    // The tail is the last node: push the stub behind it, so that the tail can be returned
+    patientIntake_link(intake, &intake->stub);
+    next = atomic_load_explicit(&tail->next, memory_order_acquire);
+    if(next != NULL) {
+        intake->tail = next;
+        return tail;
+    }
+
+    return NULL;
+}
+
+// Release a node given by patientIntake_pop, with the allocator of the intake
+void patientIntake_release(tPatientIntake* intake, tPatientIntakeNode* node) {
+    const tAllocator* previous;
+
+    // Verify pre conditions
+    assert(intake != NULL);
+    assert(node != NULL && node != &intake->stub);
+
+    previous = allocator_enterOwner(intake->allocator);
+    uoc_free(node);
+    allocator_leave(previous);
+}
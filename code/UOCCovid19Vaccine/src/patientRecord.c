@@ -0,0 +1,263 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "vaccineCatalog.h"
+#include "eligibility.h"
+#include "patientRecord.h"
+#include "allocator.h"
+
+// The records of a national registry must fit in memory: keep them at 16 bytes
+_Static_assert(sizeof(tPatientRecord) == 16, "tPatientRecord must take 16 bytes");
+
+// Initialize an empty name heap
+void patientNameHeap_init(tPatientNameHeap* heap) {
+    // Verify pre conditions
+    assert(heap != NULL);
+
+    heap->data = NULL;
+    heap->size = 0;
+    heap->allocated = 0;
+}
+
+// Release the memory used by a name heap
+void patientNameHeap_free(tPatientNameHeap* heap) {
+    // Verify pre conditions
+    assert(heap != NULL);
+
+    uoc_free(heap->data);
+    patientNameHeap_init(heap);
+}
+
+// Copy a name at the end of the heap, getting its position
+tError patientNameHeap_add(tPatientNameHeap* heap, const char* name, uint32_t* position) {
+    size_t length, allocated;
+    char* dataAux;
+
+    // Verify pre conditions
+    assert(heap != NULL);
+    assert(name != NULL);
+    assert(position != NULL);
+
+    length = strlen(name) + 1;
+
+    // The positions have 32 bits
+    if(heap->size + length > UINT32_MAX) {
+        return ERR_MEMORY_ERROR;
+    }
+
+    // Double the heap when the name does not fit
+    if(heap->size + length > heap->allocated) {
+        allocated = heap->allocated == 0 ? 1024 : 2 * heap->allocated;
+        while(heap->size + length > allocated) {
+            allocated *= 2;
+        }
+        dataAux = (char*)uoc_realloc(heap->data, allocated);
+        if(dataAux == NULL) {
+            return ERR_MEMORY_ERROR;
+        }
+        heap->data = dataAux;
+        heap->allocated = allocated;
+    }
+
+    memcpy(heap->data + heap->size, name, length);
+    *position = (uint32_t)heap->size;
+    heap->size += length;
+
+    return OK;
+}
+
+// Get the name stored at a position of the heap
+const char* patientNameHeap_get(const tPatientNameHeap* heap, uint32_t position) {
+    // Verify pre conditions
+    assert(heap != NULL);
+    assert(position < heap->size);
+
+    return heap->data + position;
+}
+
+// Fill a record with the data of a patient, copying its name to the heap
+tError patientRecord_fromPatient(tPatientRecord* record, tPatientNameHeap* heap, const tPatient* patient) {
+    tVaccineId vaccineId;
+
+    // Verify pre conditions
+    assert(record != NULL);
+    assert(heap != NULL);
+    assert(patient != NULL);
+    assert(patient->name != NULL);
+
+    // The fields must fit in the sizes of the record
+    if(patient->id < 0 || patient->number_doses < 0 || patient->number_doses > PATIENT_RECORD_MAX_DOSES) {
+        return ERR_INVALID;
+    }
+
+    // A patient without a catalogue id has to look up its vaccine name
+    vaccineId = NO_VACCINE_ID;
+    if(patient->vaccine != NULL) {
+        vaccineId = patient->vaccineId;
+        if(vaccineId == NO_VACCINE_ID && vaccineCatalog_intern(patient->vaccine, NONE, PRECLINICAL, &vaccineId) != OK) {
+            return ERR_MEMORY_ERROR;
+        }
+        if(vaccineId > PATIENT_RECORD_MAX_VACCINE) {
+            return ERR_INVALID;
+        }
+    }
+
+    if(patientNameHeap_add(heap, patient->name, &record->name) != OK) {
+        return ERR_MEMORY_ERROR;
+    }
+
+    record->id = (uint32_t)patient->id;
+    record->group = (uint8_t)patient->group;
+    record->number_doses = (uint8_t)patient->number_doses;
+    record->vaccineId = (int16_t)vaccineId;
+    record->lotID = vaccineId != NO_VACCINE_ID ? patient->lotID : 0;
+
+    return OK;
+}
+
+// Initialize a patient with the data of a record. The patient has to be released with patient_free
+tError patientRecord_toPatient(const tPatientRecord* record, const tPatientNameHeap* heap, tPatient* patient) {
+    // Verify pre conditions
+    assert(record != NULL);
+    assert(heap != NULL);
+    assert(patient != NULL);
+
+    if(patient_init(patient, patientNameHeap_get(heap, record->name), (int)record->id, NULL, 0, record->number_doses, (tPatientGroup)record->group) != OK) {
+        return ERR_MEMORY_ERROR;
+    }
+
+    // The vaccine name is shared with the catalogue
+    if(record->vaccineId != NO_VACCINE_ID) {
+        patient->vaccine = (char*) vaccineCatalog_name(record->vaccineId);
+        patient->vaccineId = record->vaccineId;
+        patient->lotID = record->lotID;
+    }
+
+    return OK;
+}
+
+// Get the name of the patient of a record
+const char* patientRecord_name(const tPatientRecord* record, const tPatientNameHeap* heap) {
+    // Verify pre conditions
+    assert(record != NULL);
+
+    return patientNameHeap_get(heap, record->name);
+}
+
+// Returns true if the patient of a record is fully vaccinated
+bool patientRecord_isVaccinated(const tPatientRecord* record) {
+    // Same rules as patient_isVaccinated
+    if(record->vaccineId == NO_VACCINE_ID)
+        return record->number_doses > 1;
+
+    return record->number_doses > 0 && record->number_doses >= eligibility_dosesRequired(record->vaccineId);
+}
+
+// Initialize an empty table of records
+void patientRecordTable_init(tPatientRecordTable* table) {
+    // Verify pre conditions
+    assert(table != NULL);
+
+    table->elements = NULL;
+    table->size = 0;
+    table->allocated = 0;
+    patientNameHeap_init(&table->names);
+}
+
+// Release the memory used by a table of records
+void patientRecordTable_free(tPatientRecordTable* table) {
+    // Verify pre conditions
+    assert(table != NULL);
+
+    uoc_free(table->elements);
+    patientNameHeap_free(&table->names);
+    patientRecordTable_init(table);
+}
+
+// Add a patient at the end of the table
+tError patientRecordTable_add(tPatientRecordTable* table, const tPatient* patient) {
+    tPatientRecord* elementsAux;
+    unsigned int allocated;
+    tError error;
+
+    // Verify pre conditions
+    assert(table != NULL);
+    assert(patient != NULL);
+
+    // Double the array of records when it is full
+    if(table->size == table->allocated) {
+        allocated = table->allocated == 0 ? 64 : 2 * table->allocated;
+        elementsAux = (tPatientRecord*)uoc_realloc(table->elements, allocated * sizeof(tPatientRecord));
+        if(elementsAux == NULL) {
+            return ERR_MEMORY_ERROR;
+        }
+        table->elements = elementsAux;
+        table->allocated = allocated;
+    }
+
+    error = patientRecord_fromPatient(&table->elements[table->size], &table->names, patient);
+    if(error != OK)
+        return error;
+
+    table->size++;
+
+    return OK;
+}
+
+// Add all the patients of a queue at the end of the table, in the order of the queue
+tError patientRecordTable_addQueue(tPatientRecordTable* table, tPatientQueue* queue) {
+    tPatientQueueIterator it;
+    const tPatient *patient;
+    tError error;
+
+    // Verify pre conditions
+    assert(table != NULL);
+    assert(queue != NULL);
+
+    patientQueue_iterator(queue, &it);
+    while((patient = patientQueue_next(&it)) != NULL) {
+        error = patientRecordTable_add(table, patient);
+        if(error != OK)
+            return error;
+    }
+
+    return OK;
+}
+
+// Get a copy of the patient at a position of the table. The patient has to be released with patient_free
+tError patientRecordTable_get(tPatientRecordTable* table, unsigned int index, tPatient* patient) {
+    // Verify pre conditions
+    assert(table != NULL);
+    assert(patient != NULL);
+
+    if(index >= table->size) {
+        return ERR_INVALID_INDEX;
+    }
+
+    return patientRecord_toPatient(&table->elements[index], &table->names, patient);
+}
+
+// Get the number of records of the table
+unsigned int patientRecordTable_size(tPatientRecordTable* table) {
+    // Verify pre conditions
+    assert(table != NULL);
+
+    return table->size;
+}
+
+// Get the number of fully vaccinated patients of the table
+unsigned int patientRecordTable_countVaccinated(tPatientRecordTable* table) {
+    unsigned int i, count;
+
+    // Verify pre conditions
+    assert(table != NULL);
+
+    count = 0;
+    for(i = 0; i < table->size; i++) {
+        if(patientRecord_isVaccinated(&table->elements[i])) {
+            count++;
+        }
+    }
+
+    return count;
+}
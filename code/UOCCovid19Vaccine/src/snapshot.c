@@ -0,0 +1,719 @@
+// mmap is not part of C11
+#define _DEFAULT_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "vaccineCatalog.h"
+#include "eligibility.h"
+#include "threadPool.h"
+#include "patientRecord.h"
+#include "snapshot.h"
+#include "allocator.h"
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// FNV-1a prime
+#define SNAPSHOT_CHECKSUM_PRIME 0x100000001b3ull
+
+// Snapshot file being written. The payload goes through a buffer that is hashed when it is written
+typedef struct {
+    FILE* fout;
+    unsigned char* buffer;
+    size_t used;
+    // Bytes of payload written
+    uint64_t size;
+    uint64_t checksum;
+    // A write to the file failed
+    bool failed;
+} tSnapshotWriter;
+
+// Snapshot file being read, mapped in memory
+typedef struct {
+    const unsigned char* data;
+    size_t size;
+    size_t position;
+} tSnapshotReader;
+
+// Patients section of a country of a snapshot, added to the country once all the countries are read
+typedef struct {
+    // Position of the country in the table
+    unsigned int index;
+    tCountry* country;
+    const tPatientRecord* records;
+    unsigned int count;
+    const char* names;
+    uint64_t namesSize;
+    // Catalogue ids of the vaccines of the snapshot
+    const tVaccineId* ids;
+    unsigned int idsCount;
+    // Allocator of the table, entered by the thread that adds the patients
+    const tAllocator* allocator;
+    tError error;
+} tSnapshotPatients;
+
+// FNV-1a hash of data, taken in 64 bit words and then in bytes for the last ones
+uint64_t snapshot_checksum(uint64_t hash, const void* data, size_t size) {
+    const unsigned char* bytes;
+    uint64_t word;
+    size_t i;
+
+    bytes = (const unsigned char*)data;
+    for(i = 0; i + 8 <= size; i += 8) {
+        memcpy(&word, bytes + i, 8);
+        hash = (hash ^ word) * SNAPSHOT_CHECKSUM_PRIME;
+    }
+    for(; i < size; i++) {
+        hash = (hash ^ bytes[i]) * SNAPSHOT_CHECKSUM_PRIME;
+    }
+
+    return hash;
+}
+
+// Write the buffer to the file. Only the last write can have a size that is not a multiple of 8
+static void snapshot_flush(tSnapshotWriter* writer) {
+    if(writer->used > 0) {
+        writer->checksum = snapshot_checksum(writer->checksum, writer->buffer, writer->used);
+        if(fwrite(writer->buffer, 1, writer->used, writer->fout) != writer->used) {
+            writer->failed = true;
+        }
+        writer->used = 0;
+    }
+}
+
+// Add bytes to the payload
+static void snapshot_write(tSnapshotWriter* writer, const void* data, size_t size) {
+    const unsigned char* bytes;
+    size_t length;
+
+    bytes = (const unsigned char*)data;
+    while(size > 0) {
+        length = SNAPSHOT_BUFFER_SIZE - writer->used;
+        if(length > size) {
+            length = size;
+        }
+        memcpy(writer->buffer + writer->used, bytes, length);
+        writer->used += length;
+        writer->size += length;
+        bytes += length;
+        size -= length;
+        if(writer->used == SNAPSHOT_BUFFER_SIZE) {
+            snapshot_flush(writer);
+        }
+    }
+}
+
+// Add a 32 bit integer to the payload
+static void snapshot_writeInt(tSnapshotWriter* writer, int32_t value) {
+    snapshot_write(writer, &value, sizeof(int32_t));
+}
+
+// Add a string to the payload, with its length
+static void snapshot_writeString(tSnapshotWriter* writer, const char* str) {
+    uint32_t length;
+
+    length = (uint32_t)strlen(str) + 1;
+    snapshot_write(writer, &length, sizeof(uint32_t));
+    snapshot_write(writer, str, length);
+}
+
+// Add zeros to the payload up to a multiple of 8 bytes
+static void snapshot_writePadding(tSnapshotWriter* writer) {
+    static const unsigned char zeros[8] = { 0 };
+
+    snapshot_write(writer, zeros, (8 - writer->size % 8) % 8);
+}
+
+// Add a country to the payload
+static tError snapshot_writeCountry(tSnapshotWriter* writer, tCountry* country) {
+    tPatientRecordTable records;
+    tVaccinationBatchListNode* node;
+    uint64_t namesSize;
+    unsigned int i;
+    tError error;
+
+    snapshot_writeString(writer, country->name);
+    snapshot_writeInt(writer, country->isEU);
+
+    snapshot_writeInt(writer, (int32_t)country->authVaccines->size);
+    for(i = 0; i < country->authVaccines->size; i++) {
+        snapshot_writeString(writer, country->authVaccines->elements[i].name);
+        snapshot_writeInt(writer, country->authVaccines->elements[i].vaccineTec);
+        snapshot_writeInt(writer, country->authVaccines->elements[i].vaccinePhase);
+    }
+
+    snapshot_writeInt(writer, country->vbList->size);
+    for(node = country->vbList->first; node != NULL; node = node->next) {
+        snapshot_writeInt(writer, node->e.lotID);
+        snapshot_writeInt(writer, node->e.quantity);
+        snapshot_writeInt(writer, node->e.vaccine->id);
+    }
+
+    // The patients are written as the records of a table, with their name heap
+    patientRecordTable_init(&records);
+    error = patientRecordTable_addQueue(&records, country->patients);
+    if(error == OK) {
+        namesSize = records.names.size;
+        snapshot_writeInt(writer, (int32_t)records.size);
+        snapshot_writePadding(writer);
+        snapshot_write(writer, records.elements, records.size * sizeof(tPatientRecord));
+        snapshot_write(writer, &namesSize, sizeof(uint64_t));
+        snapshot_write(writer, records.names.data, records.names.size);
+        snapshot_writePadding(writer);
+    }
+    patientRecordTable_free(&records);
+
+    return error;
+}
+
+// Write all the countries of a table to a snapshot file. The file is replaced only when it is complete
+tError snapshot_save(tCountryTable* table, const char* filename) {
+    tSnapshotWriter writer;
+    tSnapshotHeader header;
+    tVaccine* vaccine;
+    char* tmpFilename;
+    unsigned int i;
+    tError error;
+
+    // Verify pre conditions
+    assert(table != NULL);
+    assert(filename != NULL);
+
+    // The snapshot is written to a temporary file, that replaces the old snapshot at the end
+    tmpFilename = (char*)uoc_malloc(strlen(filename) + 5);
+    writer.buffer = (unsigned char*)uoc_malloc(SNAPSHOT_BUFFER_SIZE);
+    if(tmpFilename == NULL || writer.buffer == NULL) {
+        uoc_free(tmpFilename);
+        uoc_free(writer.buffer);
+        return ERR_MEMORY_ERROR;
+    }
+    sprintf(tmpFilename, "%s.tmp", filename);
+
+    writer.fout = fopen(tmpFilename, "wb");
+    if(writer.fout == NULL) {
+        uoc_free(tmpFilename);
+        uoc_free(writer.buffer);
+        return ERR_INVALID;
+    }
+    writer.used = 0;
+    writer.size = 0;
+    writer.checksum = SNAPSHOT_CHECKSUM_SEED;
+    writer.failed = false;
+
+    // The header is written again when the size and the checksum are known
+    memset(&header, 0, sizeof(tSnapshotHeader));
+    if(fwrite(&header, sizeof(tSnapshotHeader), 1, writer.fout) != 1) {
+        writer.failed = true;
+    }
+
+    error = OK;
+    snapshot_writeInt(&writer, (int32_t)table->size);
+    for(i = 0; i < table->size && error == OK; i++) {
+        error = snapshot_writeCountry(&writer, &table->elements[i]);
+    }
+
+    // The catalogue goes last, as writing the patients may register new vaccines
+    header.catalog = writer.size;
+    snapshot_writeInt(&writer, (int32_t)vaccineCatalog_size());
+    for(i = 0; i < vaccineCatalog_size(); i++) {
+        vaccine = vaccineCatalog_get((tVaccineId)i);
+        snapshot_writeString(&writer, vaccine->name);
+        snapshot_writeInt(&writer, vaccine->vaccineTec);
+        snapshot_writeInt(&writer, vaccine->vaccinePhase);
+    }
+    snapshot_flush(&writer);
+
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = SNAPSHOT_BYTE_ORDER;
+    header.size = writer.size;
+    header.checksum = writer.checksum;
+    if(fseek(writer.fout, 0, SEEK_SET) != 0 || fwrite(&header, sizeof(tSnapshotHeader), 1, writer.fout) != 1) {
+        writer.failed = true;
+    }
+    if(fclose(writer.fout) != 0) {
+        writer.failed = true;
+    }
+
+    if(error == OK && writer.failed) {
+        error = ERR_INVALID;
+    }
+    if(error == OK && rename(tmpFilename, filename) != 0) {
+        error = ERR_INVALID;
+    }
+    if(error != OK) {
+        remove(tmpFilename);
+    }
+
+    uoc_free(tmpFilename);
+    uoc_free(writer.buffer);
+
+    return error;
+}
+
+// Get a pointer to the next size bytes of the payload, or NULL if the payload is shorter
+static const void* snapshot_read(tSnapshotReader* reader, size_t size) {
+    const void* data;
+
+    if(size > reader->size - reader->position) {
+        return NULL;
+    }
+    data = reader->data + reader->position;
+    reader->position += size;
+
+    return data;
+}
+
+// Read a 32 bit integer of the payload
+static bool snapshot_readInt(tSnapshotReader* reader, int32_t* value) {
+    const void* data;
+
+    data = snapshot_read(reader, sizeof(int32_t));
+    if(data == NULL) {
+        return false;
+    }
+    memcpy(value, data, sizeof(int32_t));
+
+    return true;
+}
+
+// Read a count of the payload. Each element takes at least minSize bytes, so the count cannot be larger than the rest of the payload
+static bool snapshot_readCount(tSnapshotReader* reader, size_t minSize, unsigned int* count) {
+    int32_t value;
+
+    if(!snapshot_readInt(reader, &value) || value < 0 || (size_t)value * minSize > reader->size - reader->position) {
+        return false;
+    }
+    *count = (unsigned int)value;
+
+    return true;
+}
+
+// Read a string of the payload. It points to the payload
+static const char* snapshot_readString(tSnapshotReader* reader) {
+    const char* str;
+    unsigned int length;
+
+    if(!snapshot_readCount(reader, 1, &length) || length == 0) {
+        return NULL;
+    }
+    str = (const char*)snapshot_read(reader, length);
+    if(str == NULL || str[length - 1] != '\0') {
+        return NULL;
+    }
+
+    return str;
+}
+
+// Skip the padding of the payload up to a multiple of 8 bytes
+static bool snapshot_readPadding(tSnapshotReader* reader) {
+    return snapshot_read(reader, (8 - reader->position % 8) % 8) != NULL;
+}
+
+// Read a vaccine of the payload, with its name, technology and phase
+static bool snapshot_readVaccine(tSnapshotReader* reader, tVaccine* vaccine) {
+    int32_t tec, phase;
+
+    vaccine->name = (char*)snapshot_readString(reader);
+    if(vaccine->name == NULL || !snapshot_readInt(reader, &tec) || !snapshot_readInt(reader, &phase) ||
+            tec < NONE || tec > RNA || phase < PRECLINICAL || phase > PHASE3) {
+        return false;
+    }
+    vaccine->id = NO_VACCINE_ID;
+    vaccine->vaccineTec = (tVaccineTec)tec;
+    vaccine->vaccinePhase = (tVaccinePhase)phase;
+
+    return true;
+}
+
+// Read the catalogue section, getting the id in the catalogue of each vaccine of the snapshot
+static tError snapshot_readCatalog(tSnapshotReader* reader, tVaccineId** ids, unsigned int* count) {
+    tVaccine vaccine;
+    unsigned int i;
+
+    if(!snapshot_readCount(reader, 12, count)) {
+        return ERR_INVALID;
+    }
+    *ids = (tVaccineId*)uoc_malloc((*count > 0 ? *count : 1) * sizeof(tVaccineId));
+    if(*ids == NULL) {
+        return ERR_MEMORY_ERROR;
+    }
+
+    for(i = 0; i < *count; i++) {
+        if(!snapshot_readVaccine(reader, &vaccine)) {
+            return ERR_INVALID;
+        }
+        if(vaccineCatalog_intern(vaccine.name, vaccine.vaccineTec, vaccine.vaccinePhase, &(*ids)[i]) != OK) {
+            return ERR_MEMORY_ERROR;
+        }
+    }
+
+    return OK;
+}
+
+// Read the patients section of a country, leaving the patients to snapshot_addPatients
+static tError snapshot_readPatients(tSnapshotReader* reader, tSnapshotPatients* patients) {
+    const void* data;
+
+    if(!snapshot_readCount(reader, sizeof(tPatientRecord), &patients->count) || !snapshot_readPadding(reader)) {
+        return ERR_INVALID;
+    }
+    // The records are aligned, as the payload starts at a multiple of 8 bytes
+    patients->records = (const tPatientRecord*)snapshot_read(reader, patients->count * sizeof(tPatientRecord));
+    data = snapshot_read(reader, sizeof(uint64_t));
+    if(patients->records == NULL || data == NULL) {
+        return ERR_INVALID;
+    }
+    memcpy(&patients->namesSize, data, sizeof(uint64_t));
+    patients->names = patients->namesSize <= reader->size - reader->position ?
+        (const char*)snapshot_read(reader, (size_t)patients->namesSize) : NULL;
+    if(patients->names == NULL || (patients->namesSize > 0 && patients->names[patients->namesSize - 1] != '\0') ||
+            !snapshot_readPadding(reader)) {
+        return ERR_INVALID;
+    }
+
+    return OK;
+}
+
+// Add the patients of a section to its country
+static tError snapshot_addPatientsImpl(const tSnapshotPatients* patients) {
+    const tPatientRecord* records;
+    tPatient patient;
+    unsigned int i;
+    tError error;
+
+    // The id index is filled at once with all the patients, instead of one by one
+    patientQueue_disableIdIndex(patients->country->patients);
+
+    // The queue copies the names from the snapshot
+    records = patients->records;
+    for(i = 0; i < patients->count; i++) {
+        if(records[i].id == PATIENT_QUEUE_NO_ID || records[i].id > INT32_MAX || records[i].group >= PATIENT_GROUPS ||
+                records[i].name >= patients->namesSize ||
+                (records[i].vaccineId != NO_VACCINE_ID &&
+                 (records[i].vaccineId < 0 || (unsigned int)records[i].vaccineId >= patients->idsCount))) {
+            return ERR_INVALID;
+        }
+        patient.name = (char*)patients->names + records[i].name;
+        patient.id = (int)records[i].id;
+        patient.number_doses = records[i].number_doses;
+        patient.group = (tPatientGroup)records[i].group;
+        patient.vaccine = NULL;
+        patient.vaccineId = NO_VACCINE_ID;
+        patient.lotID = 0;
+        if(records[i].vaccineId != NO_VACCINE_ID) {
+            patient.vaccineId = patients->ids[records[i].vaccineId];
+            patient.vaccine = (char*) vaccineCatalog_name(patient.vaccineId);
+            patient.lotID = records[i].lotID;
+        }
+
+        error = country_addPatient(patients->country, patient);
+        if(error != OK)
+            return error;
+    }
+
+    return patientQueue_enableIdIndex(patients->country->patients);
+}
+
+// Add the patients of a section to its country, with the allocator of the table entered
+static void snapshot_addPatients(void* arg) {
+    tSnapshotPatients* patients = (tSnapshotPatients*)arg;
+    const tAllocator* previous;
+
+    previous = allocator_enter(patients->allocator);
+    patients->error = snapshot_addPatientsImpl(patients);
+    allocator_leave(previous);
+}
+
+// Compare two sections to start with the countries with most patients. Ties keep the order of the table
+static int snapshot_comparePatients(const void* a, const void* b) {
+    const tSnapshotPatients* patients1 = *(const tSnapshotPatients* const*)a;
+    const tSnapshotPatients* patients2 = *(const tSnapshotPatients* const*)b;
+
+    if(patients1->count != patients2->count) {
+        return patients1->count > patients2->count ? -1 : 1;
+    }
+
+    return patients1->index < patients2->index ? -1 : (patients1->index > patients2->index ? 1 : 0);
+}
+
+// Add the patients of all the countries of a snapshot, using nthreads threads. The countries share no data
+static tError snapshot_addAllPatients(tSnapshotPatients* patients, unsigned int count, unsigned int nthreads) {
+    tSnapshotPatients** order;
+    tThreadPool pool;
+    unsigned int i;
+    tError error;
+
+    // The rules are loaded when they are first used. They are only read by the threads
+    error = eligibility_init();
+    if(error != OK)
+        return error;
+
+    if(nthreads > count) {
+        nthreads = count;
+    }
+    if(nthreads > THREAD_POOL_MAX_THREADS) {
+        nthreads = THREAD_POOL_MAX_THREADS;
+    }
+
+    order = NULL;
+    if(nthreads > 1) {
+        order = (tSnapshotPatients**)uoc_malloc(count * sizeof(tSnapshotPatients*));
+    }
+    if(order == NULL || threadPool_init(&pool, nthreads) != OK) {
+        for(i = 0; i < count; i++) {
+            snapshot_addPatients(&patients[i]);
+        }
+    } else {
+        // The largest countries start first, so that none of them is left alone at the end
+        for(i = 0; i < count; i++) {
+            order[i] = &patients[i];
+        }
+        qsort(order, count, sizeof(tSnapshotPatients*), snapshot_comparePatients);
+        for(i = 0; i < count; i++) {
+            if(threadPool_submit(&pool, snapshot_addPatients, order[i]) != OK) {
+                snapshot_addPatients(order[i]);
+            }
+        }
+        threadPool_free(&pool);
+    }
+    uoc_free(order);
+
+    // The first error in the order of the table, as with one thread
+    error = OK;
+    for(i = 0; i < count && error == OK; i++) {
+        error = patients[i].error;
+    }
+
+    return error;
+}
+
+// Read a country and add it to the table, leaving its patients to snapshot_addPatients
+static tError snapshot_readCountry(tSnapshotReader* reader, tCountryTable* table, tSnapshotPatients* patients) {
+    tCountry key;
+    tCountry* country;
+    tVaccine vaccine;
+    tVaccineBatch batch;
+    int32_t isEU, lotID, quantity, vaccineId;
+    unsigned int count, i;
+    tError error;
+
+    key.name = (char*)snapshot_readString(reader);
+    if(key.name == NULL || !snapshot_readInt(reader, &isEU)) {
+        return ERR_INVALID;
+    }
+    key.isEU = isEU != 0;
+
+    error = countryTable_add(table, &key);
+    if(error != OK)
+        return error == ERR_DUPLICATED ? ERR_INVALID : error;
+    country = countryTable_find(table, key.name);
+    assert(country != NULL);
+
+    error = country_enableArena(country);
+    if(error != OK)
+        return error;
+
+    if(!snapshot_readCount(reader, 12, &count)) {
+        return ERR_INVALID;
+    }
+    for(i = 0; i < count; i++) {
+        if(!snapshot_readVaccine(reader, &vaccine)) {
+            return ERR_INVALID;
+        }
+        error = country_addVaccine(country, vaccine);
+        if(error != OK)
+            return error == ERR_DUPLICATED ? ERR_INVALID : error;
+    }
+
+    if(!snapshot_readCount(reader, 12, &count)) {
+        return ERR_INVALID;
+    }
+    for(i = 0; i < count; i++) {
+        if(!snapshot_readInt(reader, &lotID) || !snapshot_readInt(reader, &quantity) || !snapshot_readInt(reader, &vaccineId) ||
+                vaccineId < 0 || (unsigned int)vaccineId >= patients->idsCount) {
+            return ERR_INVALID;
+        }
+        error = vaccinationBatch_init(&batch, lotID, vaccineCatalog_get(patients->ids[vaccineId]), quantity);
+        if(error == OK) {
+            error = vaccineBatchList_append(country->vbList, batch);
+        }
+        if(error != OK)
+            return error;
+    }
+
+    // The table can grow with the next countries, so the country is found again by its position
+    patients->index = table->size - 1;
+
+    return snapshot_readPatients(reader, patients);
+}
+
+// Read the payload of a snapshot into an empty table, adding the patients of the countries with nthreads threads
+static tError snapshot_readPayload(const tSnapshotHeader* header, const unsigned char* payload, tCountryTable* table,
+                                   unsigned int nthreads) {
+    tSnapshotReader reader;
+    tSnapshotPatients* patients;
+    tVaccineId* ids;
+    unsigned int idsCount, count, i;
+    tError error;
+
+    // The catalogue is read first, to know the vaccines of the countries
+    reader.data = payload;
+    reader.size = (size_t)header->size;
+    reader.position = (size_t)header->catalog;
+    ids = NULL;
+    count = 0;
+    error = snapshot_readCatalog(&reader, &ids, &idsCount);
+
+    reader.size = (size_t)header->catalog;
+    reader.position = 0;
+    if(error == OK && !snapshot_readCount(&reader, 1, &count)) {
+        error = ERR_INVALID;
+    }
+
+    patients = NULL;
+    if(error == OK) {
+        patients = (tSnapshotPatients*)uoc_calloc(count > 0 ? count : 1, sizeof(tSnapshotPatients));
+        if(patients == NULL) {
+            error = ERR_MEMORY_ERROR;
+        }
+    }
+    for(i = 0; error == OK && i < count; i++) {
+        patients[i].ids = ids;
+        patients[i].idsCount = idsCount;
+        patients[i].allocator = table->allocator;
+        error = snapshot_readCountry(&reader, table, &patients[i]);
+    }
+    if(error == OK && reader.position != reader.size) {
+        error = ERR_INVALID;
+    }
+
+    // The patients are added once the table has all its countries
+    if(error == OK) {
+        for(i = 0; i < count; i++) {
+            patients[i].country = &table->elements[patients[i].index];
+        }
+        error = snapshot_addAllPatients(patients, count, nthreads);
+    }
+
+    uoc_free(patients);
+    uoc_free(ids);
+
+    return error;
+}
+
+// Check the header and the payload of a snapshot, and read it into an empty table
+static tError snapshot_readFile(const unsigned char* data, size_t size, tCountryTable* table, unsigned int nthreads) {
+    tSnapshotHeader header;
+
+    if(size < sizeof(tSnapshotHeader)) {
+        return ERR_INVALID;
+    }
+    memcpy(&header, data, sizeof(tSnapshotHeader));
+
+    if(memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 || header.version != SNAPSHOT_VERSION ||
+            header.byteOrder != SNAPSHOT_BYTE_ORDER || header.size != size - sizeof(tSnapshotHeader) || header.catalog > header.size) {
+        return ERR_INVALID;
+    }
+    if(snapshot_checksum(SNAPSHOT_CHECKSUM_SEED, data + sizeof(tSnapshotHeader), (size_t)header.size) != header.checksum) {
+        return ERR_INVALID;
+    }
+
+    return snapshot_readPayload(&header, data + sizeof(tSnapshotHeader), table, nthreads);
+}
+
+// Load the countries of a snapshot file into an empty table, with the allocator of the table entered
+static tError snapshot_loadImpl(tCountryTable* table, const char* filename, unsigned int nthreads) {
+    unsigned char* data;
+    size_t size;
+    tError error;
+#ifdef _WIN32
+    FILE* fin;
+    long length;
+#else
+    struct stat st;
+    int fd;
+#endif
+
+    // Verify pre conditions
+    assert(table != NULL);
+    assert(filename != NULL);
+
+    if(table->size > 0) {
+        return ERR_INVALID;
+    }
+
+#ifdef _WIN32
+    // Without mmap the file is read at once
+    fin = fopen(filename, "rb");
+    if(fin == NULL) {
+        return ERR_NOT_FOUND;
+    }
+    if(fseek(fin, 0, SEEK_END) != 0 || (length = ftell(fin)) < 0 || fseek(fin, 0, SEEK_SET) != 0) {
+        fclose(fin);
+        return ERR_INVALID;
+    }
+    size = (size_t)length;
+    data = (unsigned char*)uoc_malloc(size > 0 ? size : 1);
+    if(data == NULL) {
+        fclose(fin);
+        return ERR_MEMORY_ERROR;
+    }
+    error = fread(data, 1, size, fin) == size ? snapshot_readFile(data, size, table, nthreads) : ERR_INVALID;
+    uoc_free(data);
+    fclose(fin);
+#else
+    fd = open(filename, O_RDONLY);
+    if(fd < 0) {
+        return ERR_NOT_FOUND;
+    }
+    if(fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(tSnapshotHeader)) {
+        close(fd);
+        return ERR_INVALID;
+    }
+    size = (size_t)st.st_size;
+    data = (unsigned char*)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(data == MAP_FAILED) {
+        return ERR_MEMORY_ERROR;
+    }
+    // The file is read from the start to the end, twice
+    madvise(data, size, MADV_SEQUENTIAL);
+    error = snapshot_readFile(data, size, table, nthreads);
+    munmap(data, size);
+#endif
+
+    if(error != OK) {
+        countryTable_free(table);
+    }
+
+    return error;
+}
+
+// Load the countries of a snapshot file into an empty table. The patients of each country are stored in an arena.
+// If the file is not valid, the table is left empty
+tError snapshot_load(tCountryTable* table, const char* filename) {
+    return snapshot_loadParallel(table, filename, 1);
+}
+
+// Load the countries of a snapshot file into an empty table, adding the patients of the countries with nthreads threads.
+// The table is the same as with snapshot_load
+tError snapshot_loadParallel(tCountryTable* table, const char* filename, unsigned int nthreads) {
+    const tAllocator* previous;
+    tError error;
+
+    // Verify pre conditions
+    assert(table != NULL);
+
+    previous = allocator_enter(table->allocator);
+    error = snapshot_loadImpl(table, filename, nthreads);
+    allocator_leave(previous);
+
+    return error;
+}
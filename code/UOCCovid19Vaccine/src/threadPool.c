@@ -0,0 +1,219 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "threadPool.h"
+#include "allocator.h"
+
+// Take a job of a thread: the first one of its own queue or, when it is empty, the last one of another queue
+static tThreadPoolJob threadPool_take(tThreadPool* pool, unsigned int index, bool* stolen) {
+    tThreadPoolQueue* queue;
+    tThreadPoolJob job;
+    unsigned int i;
+
+    // The caller has reserved a job, so there is one in some queue
+    for(;;) {
+        for(i = 0; i < pool->count; i++) {
+            queue = &pool->queues[(index + i) % pool->count];
+            pthread_mutex_lock(&queue->lock);
+            if(queue->size > 0) {
+                if(i == 0) {
+                    job = queue->jobs[queue->first];
+                    queue->first = (queue->first + 1) % queue->allocated;
+                } else {
+                    job = queue->jobs[(queue->first + queue->size - 1) % queue->allocated];
+                }
+                queue->size--;
+                pthread_mutex_unlock(&queue->lock);
+                *stolen = i > 0;
+                return job;
+            }
+            pthread_mutex_unlock(&queue->lock);
+        }
+    }
+}
+
+// Run the jobs of a thread until the pool stops
+static void* threadPool_worker(void* arg) {
+    tThreadPoolQueue* own = (tThreadPoolQueue*)arg;
+    tThreadPool* pool = (tThreadPool*)own->pool;
+    tThreadPoolJob job;
+    bool stolen;
+
+    for(;;) {
+        pthread_mutex_lock(&pool->lock);
+        while(pool->queued == 0 && !pool->stop) {
+            pthread_cond_wait(&pool->work, &pool->lock);
+        }
+        if(pool->queued == 0) {
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+        // Reserve a job, so that no other thread waits for it
+        pool->queued--;
+        pthread_mutex_unlock(&pool->lock);
+
+        job = threadPool_take(pool, own->index, &stolen);
+        job.task(job.arg);
+
+        pthread_mutex_lock(&pool->lock);
+        pool->report.jobs++;
+        if(stolen) {
+            pool->report.steals++;
+        }
+        pool->pending--;
+        if(pool->pending == 0) {
+            pthread_cond_broadcast(&pool->done);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    return NULL;
+}
+
+// Start a pool with the given number of threads
+tError threadPool_init(tThreadPool* pool, unsigned int count) {
+    unsigned int i;
+
+    // Verify pre conditions
+    assert(pool != NULL);
+    assert(count > 0 && count <= THREAD_POOL_MAX_THREADS);
+
+    memset(pool, 0, sizeof(tThreadPool));
+
+    pool->threads = (pthread_t*)uoc_malloc(count * sizeof(pthread_t));
+    pool->queues = (tThreadPoolQueue*)uoc_calloc(count, sizeof(tThreadPoolQueue));
+    if(pool->threads == NULL || pool->queues == NULL) {
+        uoc_free(pool->threads);
+        uoc_free(pool->queues);
+        return ERR_MEMORY_ERROR;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->work, NULL);
+    pthread_cond_init(&pool->done, NULL);
+
+    for(i = 0; i < count; i++) {
+        pthread_mutex_init(&pool->queues[i].lock, NULL);
+        pool->queues[i].pool = pool;
+        pool->queues[i].index = i;
+    }
+
+    pool->count = count;
+
+    // The threads that could be started are used if some of them fail. Their jobs are stolen
+    for(i = 0; i < count; i++) {
+        if(pthread_create(&pool->threads[i], NULL, threadPool_worker, &pool->queues[i]) != 0) {
+            break;
+        }
+        pool->running++;
+    }
+
+    if(pool->running == 0) {
+        threadPool_free(pool);
+        return ERR_MEMORY_ERROR;
+    }
+
+    return OK;
+}
+
+// Wait for the jobs submitted, and stop the threads of the pool
+void threadPool_free(tThreadPool* pool) {
+    unsigned int i;
+
+    // Verify pre conditions
+    assert(pool != NULL);
+
+    threadPool_wait(pool);
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stop = true;
+    pthread_cond_broadcast(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+
+    for(i = 0; i < pool->running; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    for(i = 0; i < pool->count; i++) {
+        pthread_mutex_destroy(&pool->queues[i].lock);
+        uoc_free(pool->queues[i].jobs);
+    }
+
+    pthread_cond_destroy(&pool->done);
+    pthread_cond_destroy(&pool->work);
+    pthread_mutex_destroy(&pool->lock);
+    uoc_free(pool->threads);
+    uoc_free(pool->queues);
+    memset(pool, 0, sizeof(tThreadPool));
+}
+
+// Add a job to the queue of the next thread. Jobs submitted to a thread start in submission order
+tError threadPool_submit(tThreadPool* pool, tThreadPoolTask task, void* arg) {
+    tThreadPoolQueue* queue;
+    tThreadPoolJob* jobs;
+    unsigned int i, allocated;
+
+    // Verify pre conditions
+    assert(pool != NULL);
+    assert(task != NULL);
+
+    queue = &pool->queues[pool->next];
+    pool->next = (pool->next + 1) % pool->count;
+
+    pthread_mutex_lock(&queue->lock);
+
+    // Double the circular array when it is full, keeping the jobs in order
+    if(queue->size == queue->allocated) {
+        allocated = queue->allocated == 0 ? 8 : 2 * queue->allocated;
+        jobs = (tThreadPoolJob*)uoc_malloc(allocated * sizeof(tThreadPoolJob));
+        if(jobs == NULL) {
+            pthread_mutex_unlock(&queue->lock);
+            return ERR_MEMORY_ERROR;
+        }
+        for(i = 0; i < queue->size; i++) {
+            jobs[i] = queue->jobs[(queue->first + i) % queue->allocated];
+        }
+        uoc_free(queue->jobs);
+        queue->jobs = jobs;
+        queue->first = 0;
+        queue->allocated = allocated;
+    }
+
+    queue->jobs[(queue->first + queue->size) % queue->allocated].task = task;
+    queue->jobs[(queue->first + queue->size) % queue->allocated].arg = arg;
+    queue->size++;
+
+    pthread_mutex_unlock(&queue->lock);
+
+    // The job is counted once it is in the queue, so a thread that reserves it finds it
+    pthread_mutex_lock(&pool->lock);
+    pool->queued++;
+    pool->pending++;
+    pthread_cond_signal(&pool->work);
+    pthread_mutex_unlock(&pool->lock);
+
+    return OK;
+}
+
+// Wait until all the jobs submitted are done
+void threadPool_wait(tThreadPool* pool) {
+    // Verify pre conditions
+    assert(pool != NULL);
+
+    pthread_mutex_lock(&pool->lock);
+    while(pool->pending > 0) {
+        pthread_cond_wait(&pool->done, &pool->lock);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+// Get the counters of a pool
+void threadPool_report(tThreadPool* pool, tThreadPoolReport* report) {
+    // Verify pre conditions
+    assert(pool != NULL);
+    assert(report != NULL);
+
+    pthread_mutex_lock(&pool->lock);
+    *report = pool->report;
+    pthread_mutex_unlock(&pool->lock);
+}
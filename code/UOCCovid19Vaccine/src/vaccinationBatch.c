@@ -4,37 +4,34 @@
 #include <assert.h>
 #include "patient.h"
 #include "vaccinationBatch.h"
+#include "vaccineCatalog.h"
+#include "eligibility.h"
 #include "country.h"
+#include "allocator.h"
+#include "instrument.h"
 
 // Initialize a vaccine batch
 tError vaccinationBatch_init(tVaccineBatch* vb, int id, tVaccine* vac, int num) {
+    tVaccineId vaccineId;
     tError error;
 
     // Verify pre conditions
     assert(vb != NULL);
     assert(vac != NULL);
 
-    // Allocate the memory for the name string field, using the length of the provided
-    // text plus 1 space for the "end of string" char '\0'.
-    // To allocate memory we use the malloc command.
-    vb->vaccine = (tVaccine*)malloc(sizeof(tVaccine));
-
-    // Check that memory has been allocated.
-    // Pointer must be different from NULL.
-    if(vb->vaccine == NULL) {
-        return ERR_MEMORY_ERROR;
-    } else {
-        vb->vaccine->name = NULL;
+    // The batch does not keep its own copy of the vaccine. It points to the vaccine
+    // stored in the catalogue, which is shared by all the batches of that vaccine.
+    vaccineId = vac->id;
+    if(vaccineId == NO_VACCINE_ID) {
+        error = vaccineCatalog_intern(vac->name, vac->vaccineTec, vac->vaccinePhase, &vaccineId);
+        // check if any error occured
+        if(error != OK)
+            return error;
     }
 
-    // Once the memory is allocated, copy the data.
+    vb->vaccine = vaccineCatalog_get(vaccineId);
     vb->lotID = id;
     vb->quantity = num;
-    error = vaccine_cpy(vb->vaccine, vac);
-
-    // check if any error occured
-    if(error != OK)
-        return error;
 
     return OK;
 }
@@ -44,14 +41,8 @@ void vaccinationBatch_free(tVaccineBatch* vb) {
     // Verify pre conditions
     assert(vb != NULL);
 
-    // All memory allocated with malloc and realloc needs to be freed using the free command.
-    // In this case, as we use malloc to allocate the fields, we have to free them
-    if(vb->vaccine != NULL) {
-        vaccine_free(vb->vaccine);
-        free(vb->vaccine);
-        vb->vaccine = NULL;
-    }
-
+    // The vaccine belongs to the vaccine catalogue, so there is no memory to release
+    vb->vaccine = NULL;
     vb->lotID = 0;
     vb->quantity = 0;
 }
@@ -94,7 +85,11 @@ tError vaccinationBatch_cpy(tVaccineBatch* dest, tVaccineBatch* src) {
 tError vaccinationBatchList_create(tVaccinationBatchList *list) {
     if (list == NULL) return ERR_INVALID;   // parámetro nulo -> ERR_INVALID
     list->first = NULL;
+    list->last  = NULL;
     list->size  = 0u;
+    list->index.dirty = false;
+    list->index.groups = NULL;
+    list->index.count = 0u;
     return OK;
 }
 
@@ -107,18 +102,99 @@ void vaccinationBatchList_free(tVaccinationBatchList *list) {
     tVaccinationBatchListNode *p = list->first;
     while (p != NULL) {
         tVaccinationBatchListNode *n = p->next;
-        free(p);
+        uoc_free(p);
         p = n;
     }
     list->first = NULL;
+    list->last  = NULL;
     list->size  = 0u;
+
+    for (unsigned int i = 0; i < list->index.count; ++i) uoc_free(list->index.groups[i].entries);
+    uoc_free(list->index.groups);
+    list->index.dirty = false;
+    list->index.groups = NULL;
+    list->index.count = 0u;
+}
+
+// Add a batch at the end of its group in the availability index. Batches without doses are not added
+static tError vaccineBatchList_indexAdd(tVaccinationBatchIndex* index, tVaccinationBatchListNode* node, unsigned int position) {
+    tVaccinationBatchGroup *groups, *group;
+    tVaccinationBatchIndexEntry *entries;
+    unsigned int count, allocated;
+    tVaccineId id;
+
+    if (node->e.quantity <= 0 || node->e.vaccine == NULL) return OK;
+
+    // There is a group for each id of the catalogue, up to the highest one in the list
+    id = node->e.vaccine->id;
+    assert(id != NO_VACCINE_ID);
+    if ((unsigned int)id >= index->count) {
+        count = (unsigned int)id + 1;
+        groups = (tVaccinationBatchGroup*) uoc_realloc(index->groups, count * sizeof(tVaccinationBatchGroup));
+        if (groups == NULL) return ERR_MEMORY_ERROR;
+        memset(groups + index->count, 0, (count - index->count) * sizeof(tVaccinationBatchGroup));
+        index->groups = groups;
+        index->count = count;
+    }
+
+    group = &index->groups[id];
+    if (group->size == group->allocated) {
+        allocated = group->allocated == 0 ? 8 : 2 * group->allocated;
+        entries = (tVaccinationBatchIndexEntry*) uoc_realloc(group->entries, allocated * sizeof(tVaccinationBatchIndexEntry));
+        if (entries == NULL) return ERR_MEMORY_ERROR;
+        group->entries = entries;
+        group->allocated = allocated;
+    }
+
+    group->entries[group->size].node = node;
+    group->entries[group->size].position = position;
+    group->size++;
+
+    return OK;
+}
+
+// Build the availability index again if the list has changed since it was built
+static tError vaccineBatchList_updateIndex(tVaccinationBatchList* list) {
+    tVaccinationBatchListNode *node;
+    unsigned int i, position;
+    tError err;
+
+    if (!list->index.dirty) return OK;
+
+    // The memory of the groups is reused
+    for (i = 0; i < list->index.count; ++i) {
+        list->index.groups[i].size = 0;
+        list->index.groups[i].head = 0;
+    }
+
+    position = 0;
+    for (node = list->first; node != NULL; node = node->next) {
+        err = vaccineBatchList_indexAdd(&list->index, node, position++);
+        if (err != OK) return err;
+    }
+
+    list->index.dirty = false;
+    return OK;
+}
+
+// Get the first batch of a group with doses left. Exhausted batches are skipped only once,
+// so choosing the batches for all the doses of a group costs O(batches of the group)
+static tVaccinationBatchIndexEntry* vaccineBatchList_groupHead(tVaccinationBatchGroup* group) {
+    while (group->head < group->size && group->entries[group->head].node->e.quantity <= 0) group->head++;
+    return group->head < group->size ? &group->entries[group->head] : NULL;
+}
+
+// Mark the availability index as outdated. Call it after changing the quantity of the batches directly
+void vaccineBatchList_invalidateIndex(tVaccinationBatchList* vbList) {
+    if (vbList == NULL) return;
+    vbList->index.dirty = true;
 }
 
 tError vaccineBatchList_insert(tVaccinationBatchList* list, tVaccineBatch vb, int index) {
     if (list == NULL) return ERR_INVALID;
     if (index < 0 || (unsigned)index > list->size) return ERR_INVALID_INDEX;
 
-    tVaccinationBatchListNode *node = (tVaccinationBatchListNode*) malloc(sizeof(*node));
+    tVaccinationBatchListNode *node = (tVaccinationBatchListNode*) uoc_malloc(sizeof(*node));
     if (node == NULL) return ERR_MEMORY_ERROR;
 
     node->e    = vb;
@@ -127,14 +203,24 @@ tError vaccineBatchList_insert(tVaccinationBatchList* list, tVaccineBatch vb, in
     if (index == 0) {
         node->next  = list->first;
         list->first = node;
+    } else if (index == list->size) {
+        // al final: usamos el puntero al último, sin recorrer la lista
+        list->last->next = node;
     } else {
         tVaccinationBatchListNode *prev = list->first;
         for (int i = 0; i < index - 1 && prev != NULL; ++i) prev = prev->next;
-        if (prev == NULL) { free(node); return ERR_INVALID_INDEX; }
+        if (prev == NULL) { uoc_free(node); return ERR_INVALID_INDEX; }
         node->next = prev->next;
         prev->next = node;
     }
 
+    if (node->next == NULL) list->last = node;
+
+    // A batch added at the end keeps the positions of the index. Otherwise the index is built again when it is used
+    if (node->next != NULL || list->index.dirty || vaccineBatchList_indexAdd(&list->index, node, list->size) != OK) {
+        list->index.dirty = true;
+    }
+
     list->size++;
     return OK;
 }
@@ -145,24 +231,28 @@ tError vaccineBatchList_delete(tVaccinationBatchList* list, int index) {
     if (index < 0 || (unsigned)index >= list->size) return ERR_INVALID_INDEX;
 
     tVaccinationBatchListNode *toDel = NULL;
+    tVaccinationBatchListNode *prev = NULL;
 
     if (index == 0) {
         toDel = list->first;
         list->first = toDel->next;
     } else {
-        tVaccinationBatchListNode *prev = list->first;
+        prev = list->first;
         for (int i = 0; i < index - 1 && prev != NULL; ++i) prev = prev->next;
         if (prev == NULL || prev->next == NULL) return ERR_INVALID_INDEX;
         toDel = prev->next;
         prev->next = toDel->next;
     }
 
-    free(toDel);
+    if (toDel == list->last) list->last = prev;
+
+    list->index.dirty = true;
+    uoc_free(toDel);
     list->size--;
     return OK;
 }
 
-tVaccinationBatchListNode* vaccineBatchList_get(tVaccinationBatchList list, int index) {
+static tVaccinationBatchListNode* vaccineBatchList_getImpl(tVaccinationBatchList list, int index) {
     if (list.size == 0u) return NULL;
     if (index < 0 || (unsigned)index >= list.size) return NULL;
 
@@ -171,6 +261,17 @@ tVaccinationBatchListNode* vaccineBatchList_get(tVaccinationBatchList list, int
     return p;  // NULL si index fuera de rango
 }
 
+// Measured entry point of vaccineBatchList_get
+tVaccinationBatchListNode* vaccineBatchList_get(tVaccinationBatchList list, int index) {
+    tVaccinationBatchListNode* result;
+
+    INSTRUMENT_START(start);
+    result = vaccineBatchList_getImpl(list, index);
+    INSTRUMENT_STOP(INSTRUMENT_BATCH_LIST_GET, start);
+
+    return result;
+}
+
 // Duplicate list
 tError vaccinationBatchList_duplicate(tVaccinationBatchList *dest, tVaccinationBatchList src) {
     tVaccinationBatchListNode *currNode = NULL;
@@ -185,74 +286,138 @@ tError vaccinationBatchList_duplicate(tVaccinationBatchList *dest, tVaccinationB
     if(err != OK)
         return err;
 
-    // Duplicate the list
+    // Duplicate the list, keeping the order of the batches
     currNode = src.first;
     while(currNode != NULL && err == OK) {
         nextNode = currNode->next;
-        err = vaccineBatchList_insert(dest, currNode->e, 0);
+        err = vaccineBatchList_append(dest, currNode->e);
         currNode = nextNode;
     }
     return err;
 }
 
-// inoculate first vaccine to a patient from a batch list
-void vaccineBatchList_inoculate_first_vaccine(tVaccinationBatchList* vbList, tPatient* patient) {
+// Adds a new Vaccine Batch at the end of the tVaccinationBatchList
+tError vaccineBatchList_append(tVaccinationBatchList* list, tVaccineBatch vaccineBatch) {
+    if (list == NULL) return ERR_INVALID;
 
-    if (vbList == NULL || patient == NULL) return;
-    if (patient->number_doses != 0) return; // no corresponde primera
+    return vaccineBatchList_insert(list, vaccineBatch, list->size);
+}
 
-    tVaccinationBatchListNode *node = vbList->first;
-    while (node != NULL) {
-        tVaccineBatch *vb = &node->e;
-        if (vb->quantity > 0 && patient_isSuitableForVaccine(patient, vb->vaccine)) {
-            // Asignar vacuna y lote
-            if (patient->vaccine == NULL) {
-                size_t n = strlen(vb->vaccine->name);
-                patient->vaccine = (char*)malloc((n + 1) * sizeof(char));
-                if (patient->vaccine == NULL) return; // sin memoria -> no inoculamos
-                strcpy(patient->vaccine, vb->vaccine->name);
-            } else {
-                // si viniera con string previa, no debería ocurrir en 1ª dosis, pero por seguridad:
-                if (strcmp(patient->vaccine, vb->vaccine->name) != 0) {
-                    // Mantener la primera vacuna que se le asigna en PR2; pero si quieres
-                    // forzar a la del lote actual, libera y asigna. Aquí no tocamos.
-                }
+// Get the first batch of the list with doses of a vaccine suitable for the patient, or NULL if there is none
+static tVaccineBatch* vaccineBatchList_findFirstDose(tVaccinationBatchList* vbList, tPatient* patient) {
+    tVaccinationBatchIndexEntry *entry, *best;
+    tVaccinationBatchListNode *node;
+    unsigned int i;
+
+    if (vaccineBatchList_updateIndex(vbList) == OK) {
+        // The first batch of each vaccine is the head of its group. The one that comes first in the list wins
+        best = NULL;
+        for (i = 0; i < vbList->index.count; ++i) {
+            entry = vaccineBatchList_groupHead(&vbList->index.groups[i]);
+            if (entry != NULL && (best == NULL || entry->position < best->position) &&
+                patient_isSuitableForVaccine(patient, entry->node->e.vaccine)) {
+                best = entry;
             }
-            patient->lotID = vb->lotID;
-            patient->number_doses += 1;
-            vb->quantity -= 1;
-            return;
         }
-        node = node->next;
+        return best != NULL ? &best->node->e : NULL;
+    }
+
+    // Without memory for the index, walk the list
+    for (node = vbList->first; node != NULL; node = node->next) {
+        if (node->e.quantity > 0 && patient_isSuitableForVaccine(patient, node->e.vaccine)) return &node->e;
     }
+    return NULL;
 }
 
-// inoculate second vaccine to a patient from a batch list
-void vaccineBatchList_inoculate_second_vaccine(tVaccinationBatchList* vbList, tPatient* patient) {
+// Get the first batch of the list with doses of the vaccine of the patient, or NULL if there is none
+static tVaccineBatch* vaccineBatchList_findSecondDose(tVaccinationBatchList* vbList, tPatient* patient) {
+    tVaccinationBatchIndexEntry *entry;
+    tVaccinationBatchListNode *node;
 
-    if (vbList == NULL || patient == NULL) return;
-    if (patient->number_doses != 1) return; // no corresponde segunda
-    if (patient->vaccine == NULL) return;   // no sabemos cuál fue la primera
-    if (strcmp(patient->vaccine, JANSSEN_VAC) == 0) {
-        // Janssen es monodosis: no aplicar segunda
-        return;
+    if (vaccineBatchList_updateIndex(vbList) == OK) {
+        if (patient->vaccineId < 0 || (unsigned int)patient->vaccineId >= vbList->index.count) return NULL;
+        entry = vaccineBatchList_groupHead(&vbList->index.groups[patient->vaccineId]);
+        if (entry == NULL || !patient_isSuitableForVaccine(patient, entry->node->e.vaccine)) return NULL;
+        return &entry->node->e;
     }
 
-    tVaccinationBatchListNode *node = vbList->first;
-    while (node != NULL) {
-        tVaccineBatch *vb = &node->e;
-        if (vb->quantity > 0 &&
-            vb->vaccine != NULL &&
-            vb->vaccine->name != NULL &&
-            strcmp(vb->vaccine->name, patient->vaccine) == 0 &&
-            patient_isSuitableForVaccine(patient, vb->vaccine)) {
-
-            patient->number_doses += 1;
-            vb->quantity -= 1;
-            return;
+    // Without memory for the index, walk the list
+    for (node = vbList->first; node != NULL; node = node->next) {
+        if (node->e.quantity > 0 &&
+            node->e.vaccine != NULL &&
+            node->e.vaccine->id == patient->vaccineId &&
+            patient_isSuitableForVaccine(patient, node->e.vaccine)) {
+            return &node->e;
         }
-        node = node->next;
     }
+    return NULL;
+}
+
+// inoculate first vaccine to a patient from a batch list. Returns the batch of the dose, or NULL if there is no dose
+static tVaccineBatch* vaccineBatchList_inoculate_first_vaccineImpl(tVaccinationBatchList* vbList, tPatient* patient) {
+
+    if (vbList == NULL || patient == NULL) return NULL;
+    if (patient->number_doses != 0) return NULL; // no corresponde primera
+
+    tVaccineBatch *vb = vaccineBatchList_findFirstDose(vbList, patient);
+    if (vb != NULL) {
+        // Asignar vacuna y lote (el nombre es el del catálogo, no se copia)
+        if (patient->vaccine == NULL) {
+            patient->vaccine = vb->vaccine->name;
+            patient->vaccineId = vb->vaccine->id;
+        } else {
+            // si viniera con string previa, no debería ocurrir en 1ª dosis, pero por seguridad:
+            if (patient->vaccineId != vb->vaccine->id) {
+                // Mantener la primera vacuna que se le asigna en PR2; pero si quieres
+                // forzar a la del lote actual, libera y asigna. Aquí no tocamos.
+            }
+        }
+        patient->lotID = vb->lotID;
+        patient->number_doses += 1;
+        vb->quantity -= 1;
+    }
+    return vb;
+}
+
+// Measured entry point of vaccineBatchList_inoculate_first_vaccine
+tVaccineBatch* vaccineBatchList_inoculate_first_vaccine(tVaccinationBatchList* vbList, tPatient* patient) {
+    tVaccineBatch* result;
+
+    INSTRUMENT_START(start);
+    result = vaccineBatchList_inoculate_first_vaccineImpl(vbList, patient);
+    INSTRUMENT_STOP(INSTRUMENT_BATCH_INOCULATE_FIRST, start);
+
+    return result;
+}
+
+// inoculate second vaccine to a patient from a batch list. Returns the batch of the dose, or NULL if there is no dose
+static tVaccineBatch* vaccineBatchList_inoculate_second_vaccineImpl(tVaccinationBatchList* vbList, tPatient* patient) {
+
+    if (vbList == NULL || patient == NULL) return NULL;
+    if (patient->number_doses != 1) return NULL; // no corresponde segunda
+    if (patient->vaccine == NULL) return NULL;   // no sabemos cuál fue la primera
+    if (eligibility_dosesRequired(patient->vaccineId) < 2) {
+        // monodosis (Janssen): no aplicar segunda
+        return NULL;
+    }
+
+    tVaccineBatch *vb = vaccineBatchList_findSecondDose(vbList, patient);
+    if (vb != NULL) {
+        patient->number_doses += 1;
+        vb->quantity -= 1;
+    }
+    return vb;
+}
+
+// Measured entry point of vaccineBatchList_inoculate_second_vaccine
+tVaccineBatch* vaccineBatchList_inoculate_second_vaccine(tVaccinationBatchList* vbList, tPatient* patient) {
+    tVaccineBatch* result;
+
+    INSTRUMENT_START(start);
+    result = vaccineBatchList_inoculate_second_vaccineImpl(vbList, patient);
+    INSTRUMENT_STOP(INSTRUMENT_BATCH_INOCULATE_SECOND, start);
+
+    return result;
 }
 
 // function to explore all batches to inoculate to a patient
@@ -263,63 +428,208 @@ void vaccineBatchList_inoculate(tVaccinationBatchList* vbList, tPatient* patient
     if (patient->number_doses == 0) {
         vaccineBatchList_inoculate_first_vaccine(vbList, patient);
     } else if (patient->number_doses == 1) {
-        // si fue Janssen, no hay segunda
-        if (patient->vaccine != NULL && strcmp(patient->vaccine, JANSSEN_VAC) == 0) return;
+        // si fue monodosis (Janssen), no hay segunda
+        if (patient->vaccine != NULL && eligibility_dosesRequired(patient->vaccineId) < 2) return;
         vaccineBatchList_inoculate_second_vaccine(vbList, patient);
     }
 }
 
-// Sorts input list using quickSort algorithm
-void vaccineBatchList_quickSortRecursive(tVaccinationBatchList *list, int low, int high) {
-    if (list == NULL) return;
-    if (low < high) {
-        int pivot = high;
-        int i = low - 1;
-
-        for (int j = low; j < high; ++j) {
-            /* Comparador inline:
-               1) lotID ascendente
-               2) si empatan, nombre de vacuna en DESCENDENTE
-            */
-            int lj = vaccineBatchList_getlotID(*list, j);
-            int lp = vaccineBatchList_getlotID(*list, pivot);
-
-            int cmp;
-            if (lj < lp) cmp = -1;
-            else if (lj > lp) cmp = 1;
-            else {
-                tVaccinationBatchListNode *nj = vaccineBatchList_get(*list, j);
-                tVaccinationBatchListNode *np = vaccineBatchList_get(*list, pivot);
-                const char *aj = (nj && nj->e.vaccine && nj->e.vaccine->name) ? nj->e.vaccine->name : "";
-                const char *ap = (np && np->e.vaccine && np->e.vaccine->name) ? np->e.vaccine->name : "";
-                int s = strcmp(aj, ap);
-                // nombre descendente: si aj > ap, va antes (consideramos "menor")
-                cmp = (s == 0) ? 0 : (s > 0 ? -1 : 1);
-            }
+// Key of a node for the sort of a list. The lot is copied to compare without reading the node
+typedef struct {
+    int lotID;
+    tVaccinationBatchListNode *node;
+} tVaccinationBatchSortKey;
+
+// Compare two batches with the order of the sorted lists: lotID ascending and,
+// for the same lotID, vaccine name descending
+static int vaccineBatchList_compare(tVaccineBatch* vb1, tVaccineBatch* vb2) {
+    const char *name1, *name2;
+    int s;
+
+    if (vb1->lotID != vb2->lotID) return vb1->lotID < vb2->lotID ? -1 : 1;
+
+    // Batches of the same vaccine share the catalogue entry
+    if (vb1->vaccine == vb2->vaccine) return 0;
+
+    name1 = (vb1->vaccine && vb1->vaccine->name) ? vb1->vaccine->name : "";
+    name2 = (vb2->vaccine && vb2->vaccine->name) ? vb2->vaccine->name : "";
+    s = strcmp(name1, name2);
+    // nombre descendente: si name1 > name2, va antes (consideramos "menor")
+    return (s == 0) ? 0 : (s > 0 ? -1 : 1);
+}
+
+// Merge two sorted chains of nodes ended with NULL. Taking the left node on ties keeps the sort stable
+static tVaccinationBatchListNode* vaccineBatchList_mergeNodes(tVaccinationBatchListNode *left, tVaccinationBatchListNode *right) {
+    tVaccinationBatchListNode head, *tail;
+
+    tail = &head;
+    while (left != NULL && right != NULL) {
+        if (vaccineBatchList_compare(&right->e, &left->e) < 0) {
+            tail->next = right;
+            right = right->next;
+        } else {
+            tail->next = left;
+            left = left->next;
+        }
+        tail = tail->next;
+    }
+    tail->next = (left != NULL) ? left : right;
+
+    return head.next;
+}
+
+// Sort a chain of nodes ended with NULL merging runs of nodes. Used when there is no memory for the sort keys
+static tVaccinationBatchListNode* vaccineBatchList_mergeSortChain(tVaccinationBatchListNode *first) {
+    // Bin i holds a sorted run of 2^i nodes, or NULL. 64 bins are enough for any list
+    tVaccinationBatchListNode *bins[64];
+    tVaccinationBatchListNode *carry, *node, *result;
+    unsigned int i, used;
+
+    // Each node is merged with the runs of the same size already in the bins, as in a binary
+    // counter. The nodes are merged soon after being read, while they are still in the cache,
+    // and there is no recursion and no node is copied or allocated.
+    used = 0;
+    node = first;
+    while (node != NULL) {
+        carry = node;
+        node = node->next;
+        carry->next = NULL;
+
+        // The runs of the bins hold older nodes than carry, so they go on the left
+        for (i = 0; i < used && bins[i] != NULL; i++) {
+            carry = vaccineBatchList_mergeNodes(bins[i], carry);
+            bins[i] = NULL;
+        }
+        if (i == used) used++;
+        bins[i] = carry;
+    }
+
+    // Higher bins hold older nodes
+    result = NULL;
+    for (i = 0; i < used; i++) {
+        if (bins[i] != NULL) {
+            result = vaccineBatchList_mergeNodes(bins[i], result);
+        }
+    }
+
+    return result;
+}
+
+// Compare two sort keys with the order of vaccineBatchList_compare. The nodes are only read on equal lots
+static int vaccineBatchList_compareKeys(const tVaccinationBatchSortKey *k1, const tVaccinationBatchSortKey *k2) {
+    if (k1->lotID != k2->lotID) return k1->lotID < k2->lotID ? -1 : 1;
+    return vaccineBatchList_compare(&k1->node->e, &k2->node->e);
+}
+
+// Sort a chain of size nodes ended with NULL, relinking the nodes. Returns the new first node and sets the last one
+static tVaccinationBatchListNode* vaccineBatchList_mergeSortNodes(tVaccinationBatchListNode *first, unsigned int size, tVaccinationBatchListNode **last) {
+    tVaccinationBatchSortKey *keys, *aux, *src, *dst, *tmp;
+    tVaccinationBatchListNode *node;
+    unsigned int width, low, mid, high, i, j, k;
+
+    *last = NULL;
+    if (first == NULL) return NULL;
 
-            if (cmp <= 0) { // <= mantiene estabilidad relativa respecto al pivot
-                i++;
-                vaccineBatchList_swap(list, i, j);
+    keys = (tVaccinationBatchSortKey*)uoc_malloc(2 * size * sizeof(tVaccinationBatchSortKey));
+    if (keys == NULL) {
+        first = vaccineBatchList_mergeSortChain(first);
+        for (*last = first; (*last)->next != NULL; *last = (*last)->next);
+        return first;
+    }
+    aux = keys + size;
+
+    // The keys are sorted in two contiguous arrays, so the nodes, spread over the heap,
+    // are only visited to read the keys and to link them again in order
+    for (i = 0, node = first; i < size; i++, node = node->next) {
+        assert(node != NULL);
+        keys[i].lotID = node->e.lotID;
+        keys[i].node = node;
+    }
+
+    // Bottom-up merge sort of the keys. Taking the left key on ties keeps the sort stable
+    src = keys;
+    dst = aux;
+    for (width = 1; width < size; width *= 2) {
+        for (low = 0; low < size; low += 2 * width) {
+            mid = (low + width < size) ? low + width : size;
+            high = (mid + width < size) ? mid + width : size;
+            i = low;
+            j = mid;
+            k = low;
+            while (i < mid && j < high) {
+                if (vaccineBatchList_compareKeys(&src[j], &src[i]) < 0) dst[k++] = src[j++];
+                else dst[k++] = src[i++];
             }
+            while (i < mid) dst[k++] = src[i++];
+            while (j < high) dst[k++] = src[j++];
         }
-        vaccineBatchList_swap(list, i + 1, high);
-        int pi = i + 1;
+        tmp = src;
+        src = dst;
+        dst = tmp;
+    }
 
-        vaccineBatchList_quickSortRecursive(list, low, pi - 1);
-        vaccineBatchList_quickSortRecursive(list, pi + 1, high);
+    for (i = 0; i + 1 < size; i++) {
+        src[i].node->next = src[i + 1].node;
     }
+    src[size - 1].node->next = NULL;
+    first = src[0].node;
+    *last = src[size - 1].node;
+
+    uoc_free(keys);
+    return first;
 }
 
-// Entry point that calls the recursive quicksort
-tError vaccineBatchList_quicksort(tVaccinationBatchList *queue) {
-    if (queue == NULL) return ERR_INVALID;
-    if (queue->size < 2) return OK;
-    vaccineBatchList_quickSortRecursive(queue, 0, (int)queue->size - 1);
+// Sorts the batches from position low to position high (both included)
+void vaccineBatchList_quickSortRecursive(tVaccinationBatchList *list, int low, int high) {
+    tVaccinationBatchListNode *prev, *first, *end, *after, *last;
+    int i;
+
+    if (list == NULL) return;
+    if (low < 0) low = 0;
+    if (high >= (int)list->size) high = (int)list->size - 1;
+    if (low >= high) return;
+
+    // Cut the nodes of the range, sort them and link them again in the same place
+    prev = NULL;
+    first = list->first;
+    for (i = 0; i < low; i++) {
+        prev = first;
+        first = first->next;
+    }
+    end = first;
+    for (i = low; i < high; i++) end = end->next;
+    after = end->next;
+    end->next = NULL;
+
+    first = vaccineBatchList_mergeSortNodes(first, high - low + 1, &last);
+
+    if (prev == NULL) list->first = first;
+    else prev->next = first;
+    last->next = after;
+    if (after == NULL) list->last = last;
+    list->index.dirty = true;
+}
+
+// Sorts input list using a merge sort that relinks the nodes
+tError vaccineBatchList_mergesort(tVaccinationBatchList *list) {
+    tVaccinationBatchListNode *last;
+
+    if (list == NULL) return ERR_INVALID;
+    if (list->size < 2) return OK;
+
+    list->first = vaccineBatchList_mergeSortNodes(list->first, list->size, &last);
+    list->last = last;
+    list->index.dirty = true;
     return OK;
 }
 
+// Entry point of the sort. Keeps the order of the quickSort algorithm, using the merge sort
+tError vaccineBatchList_quicksort(tVaccinationBatchList *queue) {
+    return vaccineBatchList_mergesort(queue);
+}
+
 // Swap two elements in the list
-tError vaccineBatchList_swap(tVaccinationBatchList* list, int index_dst, int index_src) {
+static tError vaccineBatchList_swapImpl(tVaccinationBatchList* list, int index_dst, int index_src) {
 
     assert(list != NULL);
     assert(index_dst >= 0);
@@ -327,7 +637,6 @@ tError vaccineBatchList_swap(tVaccinationBatchList* list, int index_dst, int ind
     assert(index_dst < list->size);
     assert(index_src < list->size);
 
-    tError err;
     tVaccinationBatchListNode * node_src, *node_dst;
     tVaccineBatch tmp;
 
@@ -335,26 +644,27 @@ tError vaccineBatchList_swap(tVaccinationBatchList* list, int index_dst, int ind
         return ERR_INVALID_INDEX;
     }
 
-    tmp.vaccine =  NULL;
-    tmp.lotID = 0;
-    tmp.quantity = 0;
-
     node_src = vaccineBatchList_get(*list, index_src);
     node_dst = vaccineBatchList_get(*list, index_dst);
 
-    err = vaccinationBatch_cpy(&tmp, &node_src->e);
-    if(err == OK) {
-        vaccinationBatch_free(&node_src->e);
-        err = vaccinationBatch_cpy(&node_src->e, &node_dst->e);
-        if(err == OK) {
-            vaccinationBatch_free(&node_dst->e);
-            vaccinationBatch_cpy(&node_dst->e, &tmp);
-        }
-    }
+    // The batches only point to the vaccines of the catalogue, so they are exchanged by value
+    tmp = node_src->e;
+    node_src->e = node_dst->e;
+    node_dst->e = tmp;
+    list->index.dirty = true;
 
-    vaccinationBatch_free(&tmp);
+    return OK;
+}
 
-    return err;
+// Measured entry point of vaccineBatchList_swap
+tError vaccineBatchList_swap(tVaccinationBatchList* list, int index_dst, int index_src) {
+    tError error;
+
+    INSTRUMENT_START(start);
+    error = vaccineBatchList_swapImpl(list, index_dst, index_src);
+    INSTRUMENT_STOP(INSTRUMENT_BATCH_LIST_SWAP, start);
+
+    return error;
 }
 
 // Gets lotID from given position, -1 if out of bounds
@@ -4,10 +4,13 @@
 #include <assert.h>
 #include "patient.h"
 #include "vaccine.h"
+#include "vaccineCatalog.h"
 #include "country.h"
+#include "allocator.h"
 
 // Initialize a vaccine
 tError vaccine_init(tVaccine* vac, const char* name, tVaccineTec tec, tVaccinePhase phase) {
+    tError error;
 
     // Verify pre conditions
     assert(vac != NULL);
@@ -16,7 +19,7 @@ tError vaccine_init(tVaccine* vac, const char* name, tVaccineTec tec, tVaccinePh
     // Allocate the memory for the name string field, using the length of the provided
     // text plus 1 space for the "end of string" char '\0'.
     // To allocate memory we use the malloc command.
-    vac->name = (char*)malloc((strlen(name) + 1) * sizeof(char));
+    vac->name = (char*)uoc_malloc((strlen(name) + 1) * sizeof(char));
 
     // Check that memory has been allocated.
     // Pointer must be different from NULL.
@@ -31,6 +34,13 @@ tError vaccine_init(tVaccine* vac, const char* name, tVaccineTec tec, tVaccinePh
     // As the fields are strings, we need to use the string copy function strcpy.
     strcpy(vac->name, name);
 
+    // Get the id of the name from the catalogue, registering it if it is new
+    error = vaccineCatalog_intern(name, tec, phase, &vac->id);
+    if(error != OK) {
+        uoc_free(vac->name);
+        vac->name = NULL;
+        return error;
+    }
 
     return OK;
 }
@@ -44,10 +54,12 @@ void vaccine_free(tVaccine* vac) {
     // All memory allocated with malloc and realloc needs to be freed using the free command.
     // In this case, as we use malloc to allocate the fields, we have to free them
     if(vac->name != NULL) {
-        free(vac->name);
+        uoc_free(vac->name);
         vac->name = NULL;
     }
 
+    vac->id = NO_VACCINE_ID;
+
     vac->vaccineTec = NONE;
 
     vac->vaccinePhase = PRECLINICAL;
@@ -65,6 +77,11 @@ bool vaccine_equals(tVaccine* vac1, tVaccine* vac2) {
     assert(vac2 != NULL);
 
     result = true;
+    // Names are interned in the vaccine catalogue, so equal names have the same id
+    if(vac1->id != NO_VACCINE_ID && vac2->id != NO_VACCINE_ID) {
+        return vac1->id == vac2->id;
+    }
+
     // To see if two vaccines are equals, we need to see if the names are equals.
     // Strings are pointers to a table of chars, therefore, cannot be compared  as
     // vac1->name == vac2->name ". We need to use a string comparison function
@@ -175,7 +192,7 @@ void vaccineTable_free(tVaccineTable* table) {
         for(i = 0; i < table->size; i++) {
             vaccine_free(&table->elements[i]);
         }
-        free(table->elements);
+        uoc_free(table->elements);
         table->elements = NULL;
         // As the table is now empty, assign the size to 0.
         table->size = 0;
@@ -203,7 +220,7 @@ tError vaccineTable_add(tVaccineTable* table, tVaccine vaccine) {
         // we have to use malloc. The amount of memory we need is the number of
         // elements (will be 1) times the size of one element, which is computed
         // by sizeof(type). In this case the type is tVaccine.
-        elementsAux = (tVaccine*)malloc((table->size + 1) * sizeof(tVaccine));
+        elementsAux = (tVaccine*)uoc_malloc((table->size + 1) * sizeof(tVaccine));
 
         // Check that the memory has been allocated
         if(elementsAux == NULL) {
@@ -220,7 +237,7 @@ tError vaccineTable_add(tVaccineTable* table, tVaccine vaccine) {
         // The amount of memory we need is the number of elements times
         // the size of one element, which is computed by sizeof(type).
         // In this case the type is tVaccine. We provide the previous block of memory.
-        elementsAux = (tVaccine*)realloc(table->elements, (table->size + 1) * sizeof(tVaccine));
+        elementsAux = (tVaccine*)uoc_realloc(table->elements, (table->size + 1) * sizeof(tVaccine));
         // Check that the memory has been allocated
         if(elementsAux == NULL) {
             // Error allocating or reallocating the memory
@@ -281,7 +298,7 @@ tError vaccineTable_remove(tVaccineTable* table, tVaccine* vaccine) {
             vaccine_free(&table->elements[table->size - 1]);
             // Modify the used memory. As we are modifying a previously
             // allocated block, we need to use the realloc command.
-            elementsAux = (tVaccine*)realloc(table->elements, (table->size - 1) * sizeof(tVaccine));
+            elementsAux = (tVaccine*)uoc_realloc(table->elements, (table->size - 1) * sizeof(tVaccine));
 
             // Check that the memory has been allocated
             if(elementsAux == NULL) {
@@ -303,15 +320,29 @@ tError vaccineTable_remove(tVaccineTable* table, tVaccine* vaccine) {
 
 // Get vaccine by name
 tVaccine* vaccineTable_find(tVaccineTable* table, const char* name) {
+    // Verify pre conditions
+    assert(table != NULL);
+    assert(name != NULL);
+
+    // All the vaccines of the table are in the catalogue. A name that is not there
+    // cannot be in the table.
+    return vaccineTable_findById(table, vaccineCatalog_find(name));
+}
+
+// Get vaccine by catalogue id
+tVaccine* vaccineTable_findById(tVaccineTable* table, tVaccineId id) {
     int i;
 
     // Verify pre conditions
     assert(table != NULL);
-    assert(name != NULL);
+
+    if(id == NO_VACCINE_ID) {
+        return NULL;
+    }
 
     // Search over the table and return once we found the element.
     for(i = 0; i < table->size; i++) {
-        if(strcmp(table->elements[i].name, name) == 0) {
+        if(table->elements[i].id == id) {
             // We return the ADDRESS (&) of the element, which is a pointer to the element
             return &(table->elements[i]);
         }
@@ -0,0 +1,244 @@
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include "commons.h"
+#include "vaccine.h"
+#include "vaccineCatalog.h"
+#include "eligibility.h"
+#include "allocator.h"
+
+// The catalogue is shared by all the objects of the library
+static tVaccineCatalog catalog = { 0, 0, NULL, 0, NULL };
+
+// Change the number of slots of the name index, placing again all the registered ids
+static tError vaccineCatalog_resize(unsigned int capacity) {
+    tVaccineId* slots;
+    unsigned int i, slot;
+
+    // The capacity must be a power of two, to compute the slot with a mask
+    assert((capacity & (capacity - 1)) == 0);
+    assert(capacity >= 2 * catalog.size);
+
+    slots = (tVaccineId*)uoc_malloc(capacity * sizeof(tVaccineId));
+    if(slots == NULL) {
+        return ERR_MEMORY_ERROR;
+    }
+
+    for(i = 0; i < capacity; i++) {
+        slots[i] = NO_VACCINE_ID;
+    }
+
+    // Linear probing: use the first free slot starting at the one given by the hash
+    for(i = 0; i < catalog.size; i++) {
+        slot = string_hash(catalog.elements[i]->name) & (capacity - 1);
+        while(slots[slot] != NO_VACCINE_ID) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        slots[slot] = i;
+    }
+
+    uoc_free(catalog.slots);
+    catalog.slots = slots;
+    catalog.capacity = capacity;
+
+    return OK;
+}
+
+// Get the slot of the name index where the name is stored, or the empty slot where it has to be stored
+static unsigned int vaccineCatalog_slot(const char* name) {
+    unsigned int slot;
+
+    slot = string_hash(name) & (catalog.capacity - 1);
+    while(catalog.slots[slot] != NO_VACCINE_ID && strcmp(catalog.elements[catalog.slots[slot]]->name, name) != 0) {
+        slot = (slot + 1) & (catalog.capacity - 1);
+    }
+
+    return slot;
+}
+
+// Register a new vaccine at the end of the catalogue
+static tError vaccineCatalog_add(const char* name, tVaccineTec tec, tVaccinePhase phase, tVaccineId* id) {
+    tVaccine** elementsAux;
+    tVaccine* vac;
+    tError error;
+
+    // Keep the name index at most half full, so that probe sequences stay short
+    if(2 * (catalog.size + 1) > catalog.capacity) {
+        error = vaccineCatalog_resize(catalog.capacity == 0 ? 16 : 2 * catalog.capacity);
+        if(error != OK)
+            return error;
+    }
+
+    // Double the array of elements when it is full
+    if(catalog.size == catalog.allocated) {
+        elementsAux = (tVaccine**)uoc_realloc(catalog.elements, (catalog.allocated == 0 ? 8 : 2 * catalog.allocated) * sizeof(tVaccine*));
+        if(elementsAux == NULL) {
+            return ERR_MEMORY_ERROR;
+        }
+        catalog.elements = elementsAux;
+        catalog.allocated = catalog.allocated == 0 ? 8 : 2 * catalog.allocated;
+    }
+
+    vac = (tVaccine*)uoc_malloc(sizeof(tVaccine));
+    if(vac == NULL) {
+        return ERR_MEMORY_ERROR;
+    }
+
+    vac->name = (char*)uoc_malloc((strlen(name) + 1) * sizeof(char));
+    if(vac->name == NULL) {
+        uoc_free(vac);
+        return ERR_MEMORY_ERROR;
+    }
+
+    strcpy(vac->name, name);
+    vac->id = catalog.size;
+    vac->vaccineTec = tec;
+    vac->vaccinePhase = phase;
+
+    catalog.slots[vaccineCatalog_slot(name)] = vac->id;
+    catalog.elements[catalog.size] = vac;
+    catalog.size++;
+
+    *id = vac->id;
+
+    return OK;
+}
+
+// Register the known vaccines in an empty catalogue
+static tError vaccineCatalog_initImpl(void) {
+    tVaccineId id;
+    tError error;
+
+    // The known vaccines are registered in the order of their *_VAC_ID constants
+    error = vaccineCatalog_add(ASTRAZENECA_VAC, ADENOVIRUSES, PHASE3, &id);
+    if(error == OK)
+        error = vaccineCatalog_add(JANSSEN_VAC, ADENOVIRUSES, PHASE3, &id);
+    if(error == OK)
+        error = vaccineCatalog_add(MODERNA_VAC, RNA, PHASE3, &id);
+    if(error == OK)
+        error = vaccineCatalog_add(PFIZER_VAC, RNA, PHASE3, &id);
+
+    if(error != OK) {
+        vaccineCatalog_free();
+        return error;
+    }
+
+    assert(vaccineCatalog_find(PFIZER_VAC) == PFIZER_VAC_ID);
+
+    return OK;
+}
+
+// Initialize the catalogue with the known vaccines. Does nothing if it is already initialized
+tError vaccineCatalog_init(void) {
+    const tAllocator* previous;
+    tError error;
+
+    if(catalog.size > 0) {
+        return OK;
+    }
+
+    // The catalogue is shared by all the tables, so it is kept in the global allocator
+    previous = allocator_enterGlobal();
+    error = vaccineCatalog_initImpl();
+    allocator_leave(previous);
+
+    return error;
+}
+
+// Release the memory used by the catalogue. Names and vaccines returned before become invalid
+void vaccineCatalog_free(void) {
+    const tAllocator* previous;
+    unsigned int i;
+
+    // The eligibility rules are indexed by the ids of this catalogue
+    eligibility_free();
+
+    previous = allocator_enterGlobal();
+
+    for(i = 0; i < catalog.size; i++) {
+        uoc_free(catalog.elements[i]->name);
+        uoc_free(catalog.elements[i]);
+    }
+
+    uoc_free(catalog.elements);
+    uoc_free(catalog.slots);
+
+    catalog.elements = NULL;
+    catalog.slots = NULL;
+    catalog.size = 0;
+    catalog.allocated = 0;
+    catalog.capacity = 0;
+
+    allocator_leave(previous);
+}
+
+// Get the id of a vaccine name, registering it if it is not in the catalogue yet
+tError vaccineCatalog_intern(const char* name, tVaccineTec tec, tVaccinePhase phase, tVaccineId* id) {
+    const tAllocator* previous;
+    tVaccine* vac;
+    tError error;
+    unsigned int slot;
+
+    // Verify pre conditions
+    assert(name != NULL);
+    assert(id != NULL);
+
+    error = vaccineCatalog_init();
+    if(error != OK)
+        return error;
+
+    slot = vaccineCatalog_slot(name);
+    if(catalog.slots[slot] == NO_VACCINE_ID) {
+        previous = allocator_enterGlobal();
+        error = vaccineCatalog_add(name, tec, phase, id);
+        allocator_leave(previous);
+        return error;
+    }
+
+    // Vaccines registered only by name (for instance, from a patient) have no technology.
+    // Complete them with the data of the first full registration.
+    vac = catalog.elements[catalog.slots[slot]];
+    if(vac->vaccineTec == NONE && tec != NONE) {
+        vac->vaccineTec = tec;
+        vac->vaccinePhase = phase;
+    }
+
+    *id = vac->id;
+
+    return OK;
+}
+
+// Get the id of a vaccine name, or NO_VACCINE_ID if it is not in the catalogue
+tVaccineId vaccineCatalog_find(const char* name) {
+    // Verify pre conditions
+    assert(name != NULL);
+
+    if(catalog.size == 0) {
+        return NO_VACCINE_ID;
+    }
+
+    return catalog.slots[vaccineCatalog_slot(name)];
+}
+
+// Get the vaccine registered with the given id, or NULL if the id is not valid
+tVaccine* vaccineCatalog_get(tVaccineId id) {
+    if(id < 0 || id >= (tVaccineId)catalog.size) {
+        return NULL;
+    }
+
+    return catalog.elements[id];
+}
+
+// Get the name of the vaccine registered with the given id, or NULL if the id is not valid
+const char* vaccineCatalog_name(tVaccineId id) {
+    if(id < 0 || id >= (tVaccineId)catalog.size) {
+        return NULL;
+    }
+
+    return catalog.elements[id]->name;
+}
+
+// Get the number of registered vaccines
+unsigned int vaccineCatalog_size(void) {
+    return catalog.size;
+}
@@ -3,6 +3,8 @@
 #include <string.h>
 #include <assert.h>
 #include "test_suit.h"
+#include "allocator.h"
+#include "vaccineCatalog.h"
 
 void waitKey() {
     printf("Press enter to end...");
@@ -13,12 +15,36 @@ void help(const char* name) {
     printf("%s\t =>\t Run all tests and show results on screen\n", name);
     printf("%s -h\t =>\t Show this help\n", name);
     printf("%s -e [<file_path>]\t =>\t Run all tests and save results on file (default test_result.json)\n", name);
+    printf("%s -a <counting|bump> [...]\t =>\t Run the tests with the memory of the library given by another allocator\n", name);
 }
 
 int main(int argc, char **argv) {
     char output_filename[512];
     tTestSuite test_suite;
     FILE* fout = NULL;
+    tCountingAllocator counting;
+    tBumpAllocator bump;
+    tAllocator allocator;
+    bool useBump = false;
+
+    // The allocator is set before the library allocates anything, and the other options follow it
+    if(argc > 2 && strcmp(argv[1], "-a") == 0) {
+        if(strcmp(argv[2], "counting") == 0) {
+            countingAllocator_init(&counting, NULL);
+            countingAllocator_allocator(&counting, &allocator);
+        } else if(strcmp(argv[2], "bump") == 0 && bumpAllocator_init(&bump, 0) == OK) {
+            bumpAllocator_allocator(&bump, &allocator);
+            useBump = true;
+        } else {
+            printf("Invalid allocator\n");
+            help(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+        allocator_setGlobal(&allocator);
+        argv[2] = argv[0];
+        argv += 2;
+        argc -= 2;
+    }
 
     if(argc == 1) {
         // Run tests and show results on screen
@@ -55,5 +81,13 @@ int main(int argc, char **argv) {
                     exit(EXIT_FAILURE);
                 }
         }
+
+    // The memory of the bump allocator is released at once, after the data shared by the tests
+    if(useBump) {
+        vaccineCatalog_free();
+        allocator_setGlobal(NULL);
+        bumpAllocator_free(&bump);
+    }
+
     exit(EXIT_SUCCESS);
 }
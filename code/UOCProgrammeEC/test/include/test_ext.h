@@ -0,0 +1,80 @@
+#ifndef __TEST_EXT_H__
+#define __TEST_EXT_H__
+
+#include <stdbool.h>
+#include "utils.h"
+
+// Run all tests for the library extensions
+bool run_ext(tTestSuite* test_suite);
+
+// Run tests for the hash index of the table of countries
+bool run_ext_countryIndex(tTestSection* test_section);
+
+// Run tests for the vaccine catalogue
+bool run_ext_vaccineCatalog(tTestSection* test_section);
+
+// Run tests for the chunked storage of patient queues
+bool run_ext_chunkedQueue(tTestSection* test_section);
+
+// Run tests for the cursor of patient queues
+bool run_ext_queueCursor(tTestSection* test_section);
+
+// Run tests for the statistics of patient queues and countries
+bool run_ext_queueStats(tTestSection* test_section);
+
+// Run tests for the sort of vaccination batch lists
+bool run_ext_batchSort(tTestSection* test_section);
+
+// Run tests for the availability index of vaccination batch lists
+bool run_ext_batchIndex(tTestSection* test_section);
+
+// Run tests for the eligibility rules of the vaccines
+bool run_ext_eligibility(tTestSection* test_section);
+
+// Run tests for the aggregations over patient queues
+bool run_ext_aggregation(tTestSection* test_section);
+
+// Run tests for the fingerprints of patient queues
+bool run_ext_fingerprint(tTestSection* test_section);
+
+// Run tests for the arenas of patients
+bool run_ext_arena(tTestSection* test_section);
+
+// Run tests for the compact records of patients
+bool run_ext_patientRecord(tTestSection* test_section);
+
+// Run tests for the id index of patient queues
+bool run_ext_idIndex(tTestSection* test_section);
+
+// Run tests for the priority queues of patients
+bool run_ext_priorityQueue(tTestSection* test_section);
+
+// Run tests for the CSV bulk loader
+bool run_ext_csvLoader(tTestSection* test_section);
+
+// Run tests for the binary snapshots
+bool run_ext_snapshot(tTestSection* test_section);
+
+// Run tests for the inoculation journal
+bool run_ext_journal(tTestSection* test_section);
+
+// Run tests for the thread pool and the parallel inoculation rounds
+bool run_ext_threadPool(tTestSection* test_section);
+
+// Run tests for the statistics of a table of countries
+bool run_ext_tableStats(tTestSection* test_section);
+
+// Run tests for the intake of patients from many threads
+bool run_ext_patientIntake(tTestSection* test_section);
+
+// Run tests for the synthetic population generator
+bool run_ext_generator(tTestSection* test_section);
+
+// Run tests for the instrumentation counters
+bool run_ext_instrument(tTestSection* test_section);
+
+// Run tests for the allocators of the library
+bool run_ext_allocator(tTestSection* test_section);
+
+
+#endif // __TEST_EXT_H__
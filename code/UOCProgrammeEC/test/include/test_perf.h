@@ -0,0 +1,20 @@
+#ifndef __TEST_PERF_H__
+#define __TEST_PERF_H__
+
+#include <stdbool.h>
+#include "utils.h"
+
+// Run all the performance tests
+bool run_perf(tTestSuite* test_suite);
+
+// Run the performance tests of the table of countries of PR1
+bool run_perf_countryTable(tTestSection* test_section);
+
+// Run the performance tests of the queue of patients of PR2
+bool run_perf_patientQueue(tTestSection* test_section);
+
+// Run the performance tests of the inoculation of PR3
+bool run_perf_inoculate(tTestSection* test_section);
+
+
+#endif // __TEST_PERF_H__
\ No newline at end of file
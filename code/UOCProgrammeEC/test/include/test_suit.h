@@ -4,6 +4,8 @@
 #include "test_pr1.h"
 #include "test_pr2.h"
 #include "test_pr3.h"
+#include "test_ext.h"
+#include "test_perf.h"
 
 // Run all available tests
 void run_all(tTestSuite* test_suite);
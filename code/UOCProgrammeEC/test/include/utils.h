@@ -2,6 +2,8 @@
 #define __UTILS_H__
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdint.h>
+#include <time.h>
 
 // #define PRINT_TEST_PROGRESS
 
@@ -21,14 +23,44 @@ typedef struct {
     char* description;
     // Result of the test
     tTestResult result;
+    // Wall-clock and CPU time of the test, in seconds
+    double seconds;
+    double cpuSeconds;
+    // Memory blocks asked to the library. They are only counted when it is built with UOC_INSTRUMENT
+    unsigned long long allocations;
+    // Memory blocks asked in the phases of the test measured with start_phase and end_phase
+    unsigned long long phaseAllocations;
+    bool phased;
+    // The test went over the budget of its performance section
+    bool overBudget;
+    // Values when the test started
+    uint64_t startTime;
+    clock_t startClock;
+    unsigned long long startAllocations;
+    unsigned long long phaseStartAllocations;
 } tTest;
 
+// Type of a section
+typedef enum {
+    // The tests check the results
+    TEST_SECTION_FUNCTIONAL,
+    // The tests also fail when they go over the time or allocation budget of the section
+    TEST_SECTION_PERFORMANCE
+} tTestSectionType;
+
 // Grup of tests
 typedef struct {
     // Code of the test section
     char* code;
     // Title of the section
     char* title;
+    // Type of the section
+    tTestSectionType type;
+    // Budget of each test of a performance section. 0 means no budget
+    double maxSeconds;
+    unsigned long long maxAllocations;
+    // Budget of the measured phases of each test of a performance section, checked even when it is 0
+    unsigned long long maxPhaseAllocations;
     // Number of tests
     int numTests;    
     // Array of tests
@@ -52,6 +84,9 @@ void testSuite_free(tTestSuite* object);
 // Add a test Section
 void testSuite_addSection(tTestSuite* object, const char* code, const char* title);
 
+// Add a performance test Section, with the budget of each test. 0 means no budget
+void testSuite_addPerformanceSection(tTestSuite* object, const char* code, const char* title, double maxSeconds, unsigned long long maxAllocations);
+
 // Add a test
 void testSuite_addTest(tTestSuite* object, const char* section_code, const char* code, const char* description, tTestResult result);
 
@@ -67,6 +102,9 @@ tTest* testSuite_getTest(tTestSuite* object, const char* section_code, const cha
 // Get test statistics
 void testSuite_getStats(tTestSuite* object, int* total, int* passed, int* failed, int* not_implemented);
 
+// Get the wall-clock time of all the tests of the suite, in seconds
+double testSuite_getSeconds(tTestSuite* object);
+
 // Print test suite
 void testSuite_print(tTestSuite* object);
 
@@ -81,6 +119,12 @@ void testSection_init(tTestSection* object, const char* code, const char* title)
 // Remove a test Section
 void testSection_free(tTestSection* object);
 
+// Make a performance section, with the budget of each test. 0 means no budget
+void testSection_setBudget(tTestSection* object, double maxSeconds, unsigned long long maxAllocations);
+
+// Set the allocations allowed in the measured phases of each test of a performance section
+void testSection_setPhaseBudget(tTestSection* object, unsigned long long maxPhaseAllocations);
+
 // Add a test to the Section
 void testSection_addTest(tTestSection* object, const char* code, const char* description, tTestResult result);
 
@@ -93,6 +137,9 @@ tTest* testSection_getTest(tTestSection* object, const char* test_code);
 // Get test statistics
 void testSection_getStats(tTestSection* object, int* total, int* passed, int* failed, int* not_implemented);
 
+// Get the wall-clock time of all the tests of the section, in seconds
+double testSection_getSeconds(tTestSection* object);
+
 // Print test section
 void testSection_print(tTestSection* object);
 
@@ -123,5 +170,11 @@ void start_test(tTestSection* section, const char* code, const char* description
 // Finish a test
 void end_test(tTestSection* section, const char* code, bool passed);
 
+// Start a phase of a test whose allocations are checked against the phase budget of the section
+void start_phase(tTestSection* section, const char* code);
+
+// Finish a measured phase of a test
+void end_phase(tTestSection* section, const char* code);
+
 
 #endif // __UTILS_H__
\ No newline at end of file
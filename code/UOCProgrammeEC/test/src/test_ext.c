@@ -0,0 +1,3599 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "test_ext.h"
+#include "country.h"
+#include "vaccine.h"
+#include "patient.h"
+#include "vaccinationBatch.h"
+#include "vaccineCatalog.h"
+#include "eligibility.h"
+#include "patientRecord.h"
+#include "csvLoader.h"
+#include "snapshot.h"
+#include "journal.h"
+#include "threadPool.h"
+#include "patientIntake.h"
+#include "generator.h"
+#include "instrument.h"
+#include "allocator.h"
+
+#define NUMBER_COUNTRIES 1000
+#define NUMBER_QUEUE_PATIENTS (3 * PATIENT_QUEUE_CHUNK_SIZE + 10)
+#define NUMBER_SORT_BATCHES 2000
+#define NUMBER_EMPTY_BATCHES 100
+#define RULES_FILENAME "test_eligibility_rules.txt"
+#define CSV_FILENAME "test_bulk_load.csv"
+#define SNAPSHOT_FILENAME "test_snapshot.bin"
+#define JOURNAL_FILENAME "test_journal.bin"
+#define NUMBER_POOL_JOBS 1000
+#define NUMBER_POOL_COUNTRIES 12
+#define NUMBER_STATS_PATIENTS 20
+#define NUMBER_INTAKE_PRODUCERS 4
+#define NUMBER_INTAKE_PATIENTS 2000
+#define GENERATOR_FILENAME "test_generator.csv"
+#define NUMBER_GEN_PATIENTS 10000
+#define NUMBER_GEN_BATCHES 200
+#define NUMBER_GEN_COUNTRIES 8
+#define NUMBER_INSTRUMENT_PATIENTS 50
+#define NUMBER_ALLOC_PATIENTS 2000
+#define NUMBER_ALLOC_BATCHES 40
+#define NUMBER_ALLOC_THREADS 4
+
+// Run all tests for the library extensions
+bool run_ext(tTestSuite* test_suite) {
+    bool ok = true;
+    tTestSection* section = NULL;
+
+    assert(test_suite != NULL);
+
+    testSuite_addSection(test_suite, "EXT", "Tests for library extensions");
+
+    section = testSuite_getSection(test_suite, "EXT");
+    assert(section != NULL);
+
+    ok = run_ext_countryIndex(section) && ok;
+    ok = run_ext_vaccineCatalog(section) && ok;
+    ok = run_ext_chunkedQueue(section) && ok;
+    ok = run_ext_queueCursor(section) && ok;
+    ok = run_ext_queueStats(section) && ok;
+    ok = run_ext_batchSort(section) && ok;
+    ok = run_ext_batchIndex(section) && ok;
+    ok = run_ext_eligibility(section) && ok;
+    ok = run_ext_aggregation(section) && ok;
+    ok = run_ext_fingerprint(section) && ok;
+    ok = run_ext_arena(section) && ok;
+    ok = run_ext_patientRecord(section) && ok;
+    ok = run_ext_idIndex(section) && ok;
+    ok = run_ext_priorityQueue(section) && ok;
+    ok = run_ext_csvLoader(section) && ok;
+    ok = run_ext_snapshot(section) && ok;
+    ok = run_ext_journal(section) && ok;
+    ok = run_ext_threadPool(section) && ok;
+    ok = run_ext_tableStats(section) && ok;
+    ok = run_ext_patientIntake(section) && ok;
+    ok = run_ext_generator(section) && ok;
+    ok = run_ext_instrument(section) && ok;
+    ok = run_ext_allocator(section) && ok;
+
+    return ok;
+}
+
+// Run tests for the hash index of the table of countries
+bool run_ext_countryIndex(tTestSection* test_section) {
+    bool passed = true, failed = false;
+    tError err;
+    tCountryTable countries, countries_copy;
+    tCountry country;
+    tCountry* countryAux;
+    char name[20];
+
+    countryTable_init(&countries);
+    countryTable_init(&countries_copy);
+
+    // TEST 1: Find countries in a large table
+    failed = false;
+    start_test(test_section, "EXT_IDX_1", "Find countries in a large table");
+
+    for(int i = 0; i < NUMBER_COUNTRIES; i++) {
+        snprintf(name, 20, "%s_%04d", "Country", i);
+        country_init(&country, name, i % 2 == 0);
+        err = countryTable_add(&countries, &country);
+        if(err != OK) {
+            failed = true;
+        }
+        country_free(&country);
+    }
+
+    if(countryTable_size(&countries) != NUMBER_COUNTRIES) {
+        failed = true;
+    }
+
+    for(int i = 0; i < NUMBER_COUNTRIES; i++) {
+        snprintf(name, 20, "%s_%04d", "Country", i);
+        countryAux = countryTable_find(&countries, name);
+        if(countryAux == NULL || strcmp(countryAux->name, name) != 0 || countryAux->isEU != (i % 2 == 0)) {
+            failed = true;
+        }
+    }
+
+    if(countryTable_find(&countries, "Country_9999") != NULL) {
+        failed = true;
+    }
+
+    country_init(&country, "Country_0500", false);
+    if(countryTable_add(&countries, &country) != ERR_DUPLICATED) {
+        failed = true;
+    }
+    country_free(&country);
+
+    if(failed) {
+        end_test(test_section, "EXT_IDX_1", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_IDX_1", true);
+    }
+
+    // TEST 2: Find countries after removing elements
+    failed = false;
+    start_test(test_section, "EXT_IDX_2", "Find countries after removing elements");
+
+    country_init(&country, "Country_0000", true);
+    if(countryTable_remove(&countries, &country) != OK) {
+        failed = true;
+    }
+    country_free(&country);
+
+    country_init(&country, "Country_0500", true);
+    if(countryTable_remove(&countries, &country) != OK) {
+        failed = true;
+    }
+    country_free(&country);
+
+    if(countryTable_find(&countries, "Country_0000") != NULL || countryTable_find(&countries, "Country_0500") != NULL) {
+        failed = true;
+    }
+
+    for(int i = 1; i < NUMBER_COUNTRIES; i++) {
+        snprintf(name, 20, "%s_%04d", "Country", i);
+        countryAux = countryTable_find(&countries, name);
+        if(i != 500 && (countryAux == NULL || strcmp(countryAux->name, name) != 0)) {
+            failed = true;
+        }
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_IDX_2", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_IDX_2", true);
+    }
+
+    // TEST 3: Find countries in a copy of the table
+    failed = false;
+    start_test(test_section, "EXT_IDX_3", "Find countries in a copy of the table");
+
+    err = countryTable_cpy(&countries_copy, &countries);
+    if(err != OK || countryTable_size(&countries_copy) != NUMBER_COUNTRIES - 2) {
+        failed = true;
+    } else {
+        for(int i = 1; i < NUMBER_COUNTRIES; i++) {
+            snprintf(name, 20, "%s_%04d", "Country", i);
+            countryAux = countryTable_find(&countries_copy, name);
+            if((i == 500) != (countryAux == NULL)) {
+                failed = true;
+            }
+        }
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_IDX_3", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_IDX_3", true);
+    }
+
+    // Remove used memory
+    countryTable_free(&countries);
+    countryTable_free(&countries_copy);
+
+    return passed;
+}
+
+// Run tests for the vaccine catalogue
+bool run_ext_vaccineCatalog(tTestSection* test_section) {
+    bool passed = true, failed = false;
+    tError err;
+    tVaccine pfizer_vaccine, other_pfizer_vaccine, new_vaccine;
+    tVaccineBatch pfizer_batch, other_pfizer_batch;
+    tPatient patient1, patient2, patient3;
+    tVaccineId vaccineId;
+
+    vaccine_init(&pfizer_vaccine, PFIZER_VAC, RNA, PHASE3);
+    vaccine_init(&other_pfizer_vaccine, PFIZER_VAC, RNA, PHASE3);
+
+    // TEST 1: Known vaccines have fixed ids
+    failed = false;
+    start_test(test_section, "EXT_CAT_1", "Known vaccines have fixed ids");
+
+    if(vaccineCatalog_find(ASTRAZENECA_VAC) != ASTRAZENECA_VAC_ID || vaccineCatalog_find(JANSSEN_VAC) != JANSSEN_VAC_ID ||
+            vaccineCatalog_find(MODERNA_VAC) != MODERNA_VAC_ID || vaccineCatalog_find(PFIZER_VAC) != PFIZER_VAC_ID) {
+        failed = true;
+    }
+
+    if(pfizer_vaccine.id != PFIZER_VAC_ID || other_pfizer_vaccine.id != PFIZER_VAC_ID) {
+        failed = true;
+    }
+
+    if(strcmp(vaccineCatalog_name(JANSSEN_VAC_ID), JANSSEN_VAC) != 0 || vaccineCatalog_get(MODERNA_VAC_ID)->vaccineTec != RNA) {
+        failed = true;
+    }
+
+    if(vaccineCatalog_find("EXT_CAT_Unknown") != NO_VACCINE_ID || vaccineCatalog_get(NO_VACCINE_ID) != NULL ||
+            vaccineCatalog_name(vaccineCatalog_size()) != NULL) {
+        failed = true;
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_CAT_1", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_CAT_1", true);
+    }
+
+    // TEST 2: New names get a new id once
+    failed = false;
+    start_test(test_section, "EXT_CAT_2", "New names get a new id once");
+
+    // A name registered by a patient has no technology until a vaccine is registered
+    err = patient_init(&patient1, "EXT_CAT_Patient1", 1, "EXT_CAT_Vaccine", 7, 1, ANYONE_ELSE);
+    if(err != OK || patient1.vaccineId == NO_VACCINE_ID || vaccineCatalog_get(patient1.vaccineId)->vaccineTec != NONE) {
+        failed = true;
+    }
+
+    err = vaccine_init(&new_vaccine, "EXT_CAT_Vaccine", PEPTIDE, PHASE2);
+    if(err != OK || new_vaccine.id != patient1.vaccineId || vaccineCatalog_get(new_vaccine.id)->vaccineTec != PEPTIDE) {
+        failed = true;
+    }
+
+    err = vaccineCatalog_intern("EXT_CAT_Vaccine", RNA, PHASE3, &vaccineId);
+    if(err != OK || vaccineId != new_vaccine.id || vaccineCatalog_get(vaccineId)->vaccineTec != PEPTIDE) {
+        failed = true;
+    }
+
+    if(!vaccine_equals(&pfizer_vaccine, &other_pfizer_vaccine) || vaccine_equals(&pfizer_vaccine, &new_vaccine)) {
+        failed = true;
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_CAT_2", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_CAT_2", true);
+    }
+
+    // TEST 3: Patients and batches share the catalogue data
+    failed = false;
+    start_test(test_section, "EXT_CAT_3", "Patients and batches share the catalogue data");
+
+    patient_init(&patient2, "EXT_CAT_Patient2", 2, PFIZER_VAC, 1, 1, ANYONE_ELSE);
+    patient_duplicate(&patient3, patient2);
+
+    if(patient2.vaccineId != PFIZER_VAC_ID || patient2.vaccine != vaccineCatalog_name(PFIZER_VAC_ID) || patient3.vaccine != patient2.vaccine) {
+        failed = true;
+    }
+
+    vaccinationBatch_init(&pfizer_batch, 1, &pfizer_vaccine, 10);
+    vaccinationBatch_init(&other_pfizer_batch, 2, &other_pfizer_vaccine, 10);
+
+    if(pfizer_batch.vaccine != vaccineCatalog_get(PFIZER_VAC_ID) || other_pfizer_batch.vaccine != pfizer_batch.vaccine) {
+        failed = true;
+    }
+
+    // The vaccine of the batch is not released with the batch
+    vaccinationBatch_free(&pfizer_batch);
+    if(vaccineCatalog_get(PFIZER_VAC_ID) == NULL || strcmp(other_pfizer_batch.vaccine->name, PFIZER_VAC) != 0) {
+        failed = true;
+    }
+
+    if(patient_inoculate_vaccine(&patient2, MODERNA_VAC, 1) != ERR_INVALID_VACCINE ||
+            patient_inoculate_vaccineId(&patient2, PFIZER_VAC_ID, 1) != OK || patient2.number_doses != 2) {
+        failed = true;
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_CAT_3", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_CAT_3", true);
+    }
+
+    // Remove used memory
+    vaccinationBatch_free(&other_pfizer_batch);
+    patient_free(&patient1);
+    patient_free(&patient2);
+    patient_free(&patient3);
+    vaccine_free(&pfizer_vaccine);
+    vaccine_free(&other_pfizer_vaccine);
+    vaccine_free(&new_vaccine);
+
+    return passed;
+}
+
+// Run tests for the chunked storage of patient queues
+bool run_ext_chunkedQueue(tTestSection* test_section) {
+    bool passed = true, failed = false;
+    tError err;
+    tPatientQueue chunked, linked, copy;
+    tPatientQueueIterator it;
+    const tPatient* patientAux;
+    tPatient* patient;
+    tPatient patients[NUMBER_QUEUE_PATIENTS];
+    tPatient moved;
+    char name[20];
+    int i;
+
+    patientQueue_createChunked(&chunked);
+    patientQueue_create(&linked);
+
+    for(i = 0; i < NUMBER_QUEUE_PATIENTS; i++) {
+        snprintf(name, 20, "%s_%04d", "Patient", i + 1);
+        patient_init(&patients[i], name, i + 1, i % 3 == 0 ? MODERNA_VAC : NULL, i % 5, i % 3 == 0 ? 1 : 0, i % (ANYONE_ELSE + 1));
+    }
+
+    // TEST 1: Enqueue and read patients over several chunks
+    failed = false;
+    start_test(test_section, "EXT_QUE_1", "Enqueue and read patients over several chunks");
+
+    if(!patientQueue_empty(chunked) || patientQueue_head(chunked) != NULL) {
+        failed = true;
+    }
+
+    for(i = 0; i < NUMBER_QUEUE_PATIENTS; i++) {
+        err = patientQueue_enqueue(&chunked, patients[i]);
+        if(err != OK) {
+            failed = true;
+        }
+        patientQueue_enqueue(&linked, patients[i]);
+    }
+
+    if(patientQueue_empty(chunked) || patientQueue_size(chunked) != NUMBER_QUEUE_PATIENTS || patientQueue_size(linked) != NUMBER_QUEUE_PATIENTS) {
+        failed = true;
+    }
+
+    if(patientQueue_head(chunked) == NULL || !patient_compare(*patientQueue_head(chunked), patients[0])) {
+        failed = true;
+    }
+
+    i = 0;
+    patientQueue_iterator(&chunked, &it);
+    while((patientAux = patientQueue_next(&it)) != NULL) {
+        if(i >= NUMBER_QUEUE_PATIENTS || !patient_compare(*patientAux, patients[i]) || patientAux->vaccine != patients[i].vaccine) {
+            failed = true;
+        }
+        i++;
+    }
+    if(i != NUMBER_QUEUE_PATIENTS) {
+        failed = true;
+    }
+
+    if(!patientQueue_compare(&chunked, &linked) || !patientQueue_compareIterative(&linked, &chunked)) {
+        failed = true;
+    }
+
+    if(patientQueue_countPatients_vaccinationBatch(chunked, MODERNA_VAC, 0) != patientQueue_countPatients_vaccinationBatch(linked, MODERNA_VAC, 0)) {
+        failed = true;
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_QUE_1", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_QUE_1", true);
+    }
+
+    // TEST 2: Dequeue patients in FIFO order
+    failed = false;
+    start_test(test_section, "EXT_QUE_2", "Dequeue patients in FIFO order");
+
+    // Move the first patients to the tail, so the queue wraps over the chunks
+    for(i = 0; i < PATIENT_QUEUE_CHUNK_SIZE + 5; i++) {
+        patient = patientQueue_dequeue(&chunked);
+        if(patient == NULL || !patient_compare(*patient, patients[i])) {
+            failed = true;
+        } else {
+            patientQueue_enqueue(&chunked, *patient);
+            patientQueue_release(&chunked, patient);
+        }
+    }
+
+    if(patientQueue_size(chunked) != NUMBER_QUEUE_PATIENTS) {
+        failed = true;
+    }
+
+    for(i = 0; i < NUMBER_QUEUE_PATIENTS && !failed; i++) {
+        patient = patientQueue_dequeue(&chunked);
+        if(patient == NULL || !patient_compare(*patient, patients[(i + PATIENT_QUEUE_CHUNK_SIZE + 5) % NUMBER_QUEUE_PATIENTS])) {
+            failed = true;
+        }
+        patientQueue_release(&chunked, patient);
+    }
+
+    if(!patientQueue_empty(chunked) || patientQueue_dequeue(&chunked) != NULL) {
+        failed = true;
+    }
+
+    // An emptied queue can be used again
+    patientQueue_enqueue(&chunked, patients[1]);
+    if(patientQueue_size(chunked) != 1 || !patient_compare(*patientQueue_head(chunked), patients[1])) {
+        failed = true;
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_QUE_2", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_QUE_2", true);
+    }
+
+    // TEST 3: Duplicate a chunked queue
+    failed = false;
+    start_test(test_section, "EXT_QUE_3", "Duplicate a chunked queue");
+
+    for(i = 2; i < NUMBER_QUEUE_PATIENTS; i++) {
+        patientQueue_enqueue(&chunked, patients[i]);
+    }
+
+    err = patientQueue_duplicate(&copy, chunked);
+    if(err != OK || copy.backend != PATIENT_QUEUE_CHUNKED || patientQueue_size(copy) != NUMBER_QUEUE_PATIENTS - 1) {
+        failed = true;
+    } else {
+        if(!patientQueue_compare(&copy, &chunked) || patientQueue_compare(&copy, &linked)) {
+            failed = true;
+        }
+        patientQueue_free(&copy);
+        if(!patientQueue_empty(copy) || patientQueue_size(copy) != 0) {
+            failed = true;
+        }
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_QUE_3", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_QUE_3", true);
+    }
+
+    // TEST 4: Move the patients out of the queues
+    failed = false;
+    start_test(test_section, "EXT_QUE_4", "Move the patients out of the queues");
+
+    // The chunked queue starts at the second patient. The moved patients own their names
+    for(i = 1; i < NUMBER_QUEUE_PATIENTS; i++) {
+        if(patientQueue_dequeueInto(&chunked, &moved) != OK || !patient_compare(moved, patients[i]) ||
+                moved.vaccine != patients[i].vaccine || moved.name == patients[i].name) {
+            failed = true;
+        }
+        patient_free(&moved);
+    }
+    for(i = 0; i < NUMBER_QUEUE_PATIENTS; i++) {
+        if(patientQueue_dequeueInto(&linked, &moved) != OK || !patient_compare(moved, patients[i])) {
+            failed = true;
+        }
+        patient_free(&moved);
+    }
+    if(patientQueue_dequeueInto(&chunked, &moved) != ERR_EMPTY || patientQueue_dequeueInto(&linked, &moved) != ERR_EMPTY ||
+            !patientQueue_empty(chunked) || !patientQueue_empty(linked)) {
+        failed = true;
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_QUE_4", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_QUE_4", true);
+    }
+
+    // Remove used memory
+    patientQueue_free(&chunked);
+    patientQueue_free(&linked);
+    for(i = 0; i < NUMBER_QUEUE_PATIENTS; i++) {
+        patient_free(&patients[i]);
+    }
+
+    return passed;
+}
+
+// Run tests for the cursor of patient queues
+bool run_ext_queueCursor(tTestSection* test_section) {
+    bool passed = true, failed = false;
+    tCountry linked_country, chunked_country;
+    tPatientQueueCursor cursor;
+    tPatientQueueIterator it1, it2;
+    const tPatient *patient1, *patient2;
+    tPatient* patientAux;
+    tPatient patient;
+    tVaccine oxford_vaccine, pfizer_vaccine, janssen_vaccine;
+    tVaccineBatch batch;
+    char name[20];
+    int i;
+
+    vaccine_init(&oxford_vaccine, ASTRAZENECA_VAC, ADENOVIRUSES, PHASE3);
+    vaccine_init(&pfizer_vaccine, PFIZER_VAC, RNA, PHASE3);
+    vaccine_init(&janssen_vaccine, JANSSEN_VAC, ADENOVIRUSES, PHASE3);
+
+    // Same data on a country with a linked queue and on a country with a chunked queue
+    country_init(&linked_country, "Linked", true);
+    country_init(&chunked_country, "Chunked", true);
+    country_useChunks(&chunked_country);
+
+    for(i = 0; i < NUMBER_QUEUE_PATIENTS; i++) {
+        snprintf(name, 20, "%s_%04d", "Patient", i + 1);
+        patient_init(&patient, name, i + 1, NULL, 0, 0, i % (ANYONE_ELSE + 1));
+        country_addPatient(&linked_country, patient);
+        country_addPatient(&chunked_country, patient);
+        patient_free(&patient);
+    }
+
+    vaccinationBatch_init(&batch, 1, &oxford_vaccine, NUMBER_QUEUE_PATIENTS / 4);
+    vaccineBatchList_insert(linked_country.vbList, batch, 0);
+    vaccineBatchList_insert(chunked_country.vbList, batch, 0);
+    vaccinationBatch_init(&batch, 2, &janssen_vaccine, NUMBER_QUEUE_PATIENTS / 4);
+    vaccineBatchList_insert(linked_country.vbList, batch, 1);
+    vaccineBatchList_insert(chunked_country.vbList, batch, 1);
+    vaccinationBatch_init(&batch, 3, &pfizer_vaccine, NUMBER_QUEUE_PATIENTS / 2);
+    vaccineBatchList_insert(linked_country.vbList, batch, 2);
+    vaccineBatchList_insert(chunked_country.vbList, batch, 2);
+
+    // TEST 1: Modify patients in place with a cursor
+    failed = false;
+    start_test(test_section, "EXT_CUR_1", "Modify patients in place with a cursor");
+
+    patientQueue_cursor(chunked_country.patients, &cursor);
+    i = 0;
+    while((patientAux = patientQueue_cursorNext(&cursor)) != NULL) {
+        patientAux->lotID = i;
+        i++;
+    }
+    if(i != NUMBER_QUEUE_PATIENTS) {
+        failed = true;
+    }
+
+    patientQueue_cursor(linked_country.patients, &cursor);
+    patientAux = patientQueue_cursorNext(&cursor);
+    if(patientAux != &linked_country.patients->first->e || patientQueue_cursorClose(&cursor) != OK) {
+        failed = true;
+    }
+
+    patientQueue_iterator(chunked_country.patients, &it1);
+    i = 0;
+    while((patient1 = patientQueue_next(&it1)) != NULL) {
+        if(patient1->lotID != i) {
+            failed = true;
+        }
+        i++;
+    }
+
+    patientQueue_cursor(chunked_country.patients, &cursor);
+    while((patientAux = patientQueue_cursorNext(&cursor)) != NULL) {
+        patientAux->lotID = 0;
+    }
+    patientQueue_cursorClose(&cursor);
+
+    if(failed) {
+        end_test(test_section, "EXT_CUR_1", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_CUR_1", true);
+    }
+
+    // TEST 2: Inoculate patients keeping the order of the queue
+    failed = false;
+    start_test(test_section, "EXT_CUR_2", "Inoculate patients keeping the order of the queue");
+
+    for(i = 0; i < 2; i++) {
+        country_inoculate_first_vaccine(&linked_country);
+        country_inoculate_second_vaccine(&linked_country);
+        country_inoculate_first_vaccine(&chunked_country);
+        country_inoculate_second_vaccine(&chunked_country);
+    }
+
+    patientQueue_iterator(linked_country.patients, &it1);
+    patientQueue_iterator(chunked_country.patients, &it2);
+    i = 0;
+    while((patient1 = patientQueue_next(&it1)) != NULL) {
+        patient2 = patientQueue_next(&it2);
+        if(patient2 == NULL || patient1->id != i + 1 || patient2->id != i + 1 || patient1->number_doses != patient2->number_doses ||
+                patient1->vaccineId != patient2->vaccineId || patient1->lotID != patient2->lotID) {
+            failed = true;
+        }
+        // AstraZeneca is not suitable for these groups
+        if(patient1->vaccineId == ASTRAZENECA_VAC_ID && (patient1->group == ADULT_OVER_65 || patient1->group == COMORBID)) {
+            failed = true;
+        }
+        i++;
+    }
+    if(i != NUMBER_QUEUE_PATIENTS || patientQueue_next(&it2) != NULL) {
+        failed = true;
+    }
+
+    if(country_percentage_vaccinated(&linked_country) != country_percentage_vaccinated(&chunked_country) ||
+            country_percentage_vaccinated(&linked_country) <= 0.0) {
+        failed = true;
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_CUR_2", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_CUR_2", true);
+    }
+
+    // Remove used memory
+    country_free(&linked_country);
+    country_free(&chunked_country);
+    vaccine_free(&oxford_vaccine);
+    vaccine_free(&pfizer_vaccine);
+    vaccine_free(&janssen_vaccine);
+
+    return passed;
+}
+
+// Check the statistics of a queue counting again all its patients
+static bool check_queueStats(tPatientQueue* queue) {
+    tPatientQueueIterator it;
+    const tPatient* patient;
+    const tPatientQueueStats* stats;
+    unsigned int doses[PATIENT_QUEUE_DOSE_COUNTERS] = { 0 };
+    unsigned int groups[PATIENT_GROUPS] = { 0 };
+    unsigned int vaccinated = 0, size = 0;
+    unsigned int i;
+
+    stats = patientQueue_stats(queue);
+
+    patientQueue_iterator(queue, &it);
+    while((patient = patientQueue_next(&it)) != NULL) {
+        doses[patient->number_doses < PATIENT_QUEUE_DOSE_COUNTERS ? patient->number_doses : PATIENT_QUEUE_DOSE_COUNTERS - 1]++;
+        groups[patient->group]++;
+        if(patient_isVaccinated(patient)) {
+            vaccinated++;
+        }
+        size++;
+    }
+
+    if(size != patientQueue_size(*queue) || vaccinated != stats->vaccinated) {
+        return false;
+    }
+    for(i = 0; i < PATIENT_QUEUE_DOSE_COUNTERS; i++) {
+        if(doses[i] != stats->doses[i] || doses[i] != patientQueue_countDoses(queue, i)) {
+            return false;
+        }
+    }
+    for(i = 0; i < PATIENT_GROUPS; i++) {
+        if(groups[i] != stats->groups[i]) {
+            return false;
+        }
+    }
+    for(i = 0; i < vaccineCatalog_size(); i++) {
+        if(patientQueue_countVaccine(queue, i) != (unsigned int)patientQueue_countPatients_vaccinationBatch(*queue, vaccineCatalog_name(i), 0) +
+                (unsigned int)patientQueue_countPatients_vaccinationBatch(*queue, vaccineCatalog_name(i), 1)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Run tests for the statistics of patient queues and countries
+bool run_ext_queueStats(tTestSection* test_section) {
+    bool passed = true, failed = false;
+    tCountry country;
+    tVaccine oxford_vaccine, pfizer_vaccine, janssen_vaccine;
+    tVaccineBatch batch;
+    tPatient patient;
+    tPatient* patientAux;
+    char name[20];
+    int i;
+
+    vaccine_init(&oxford_vaccine, ASTRAZENECA_VAC, ADENOVIRUSES, PHASE3);
+    vaccine_init(&pfizer_vaccine, PFIZER_VAC, RNA, PHASE3);
+    vaccine_init(&janssen_vaccine, JANSSEN_VAC, ADENOVIRUSES, PHASE3);
+
+    country_init(&country, "Stats", true);
+
+    // TEST 1: Counters follow the changes of the queue
+    failed = false;
+    start_test(test_section, "EXT_STA_1", "Counters follow the changes of the queue");
+
+    // Patients with several vaccines, all with lot 0 or 1
+    for(i = 0; i < NUMBER_QUEUE_PATIENTS; i++) {
+        snprintf(name, 20, "%s_%04d", "Patient", i + 1);
+        patient_init(&patient, name, i + 1, i % 4 == 0 ? PFIZER_VAC : (i % 4 == 1 ? JANSSEN_VAC : NULL), i % 2, i % 4 < 2 ? 1 : 0, i % PATIENT_GROUPS);
+        country_addPatient(&country, patient);
+        patient_free(&patient);
+    }
+    if(!check_queueStats(country.patients)) {
+        failed = true;
+    }
+
+    vaccinationBatch_init(&batch, 0, &oxford_vaccine, NUMBER_QUEUE_PATIENTS / 8);
+    vaccineBatchList_insert(country.vbList, batch, 0);
+    vaccinationBatch_init(&batch, 1, &pfizer_vaccine, NUMBER_QUEUE_PATIENTS / 2);
+    vaccineBatchList_insert(country.vbList, batch, 1);
+
+    country_inoculate_first_vaccine(&country);
+    if(!check_queueStats(country.patients)) {
+        failed = true;
+    }
+
+    country_inoculate_second_vaccine(&country);
+    if(!check_queueStats(country.patients) || country_getPatientsPerDoses(country, 2) == 0) {
+        failed = true;
+    }
+
+    for(i = 0; i < NUMBER_QUEUE_PATIENTS / 3; i++) {
+        patientAux = patientQueue_dequeue(country.patients);
+        patientQueue_release(country.patients, patientAux);
+    }
+    if(!check_queueStats(country.patients)) {
+        failed = true;
+    }
+
+    if((unsigned int)country_getPatientsPerGroup(country, COMORBID) != patientQueue_stats(country.patients)->groups[COMORBID] ||
+            country_percentage_vaccinated(&country) != 100.0 * patientQueue_stats(country.patients)->vaccinated / patientQueue_size(*country.patients)) {
+        failed = true;
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_STA_1", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_STA_1", true);
+    }
+
+    // TEST 2: Most used technology compares numbers of patients
+    failed = false;
+    start_test(test_section, "EXT_STA_2", "Most used technology compares numbers of patients");
+
+    patientQueue_free(country.patients);
+    country_addVaccine(&country, pfizer_vaccine);
+    country_addVaccine(&country, oxford_vaccine);
+    country_addVaccine(&country, janssen_vaccine);
+
+    // One RNA patient first, and then three with adenoviruses
+    patient_init(&patient, "Patient_RNA", 1, PFIZER_VAC, 1, 1, ANYONE_ELSE);
+    country_addPatient(&country, patient);
+    patient_free(&patient);
+    for(i = 0; i < 3; i++) {
+        snprintf(name, 20, "%s_%04d", "Patient_ADV", i + 1);
+        patient_init(&patient, name, i + 2, i == 0 ? JANSSEN_VAC : ASTRAZENECA_VAC, 1, 1, ANYONE_ELSE);
+        country_addPatient(&country, patient);
+        patient_free(&patient);
+    }
+
+    if(country_getMostUsedVaccineTechnology(country) != ADENOVIRUSES) {
+        failed = true;
+    }
+    if(country_getPatientsPerVaccineTechnology(country, ADENOVIRUSES) != 3 || country_getPatientsPerVaccineTechnology(country, RNA) != 1 ||
+            country_getPatientsPerVaccine(country, oxford_vaccine) != 2 || country_getPatientsPerVaccine(country, janssen_vaccine) != 1) {
+        failed = true;
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_STA_2", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_STA_2", true);
+    }
+
+    // Remove used memory
+    country_free(&country);
+    vaccine_free(&oxford_vaccine);
+    vaccine_free(&pfizer_vaccine);
+    vaccine_free(&janssen_vaccine);
+
+    return passed;
+}
+
+// Check that a batch list is sorted by lotID ascending and vaccine name descending, and that last is its last node
+static bool check_batchListSorted(tVaccinationBatchList* list) {
+    tVaccinationBatchListNode *node, *prev;
+    int size = 0;
+
+    prev = NULL;
+    for(node = list->first; node != NULL; node = node->next) {
+        if(prev != NULL && (prev->e.lotID > node->e.lotID ||
+                (prev->e.lotID == node->e.lotID && strcmp(prev->e.vaccine->name, node->e.vaccine->name) < 0))) {
+            return false;
+        }
+        prev = node;
+        size++;
+    }
+
+    return size == list->size && prev == list->last;
+}
+
+// Run tests for the sort of vaccination batch lists
+bool run_ext_batchSort(tTestSection* test_section) {
+    bool passed = true, failed = false;
+    tError err;
+    tVaccinationBatchList list, copy;
+    tVaccinationBatchListNode *node, *nodeCopy;
+    tVaccine vaccines[3];
+    tVaccineBatch batch;
+    int i;
+
+    vaccine_init(&vaccines[0], ASTRAZENECA_VAC, ADENOVIRUSES, PHASE3);
+    vaccine_init(&vaccines[1], PFIZER_VAC, RNA, PHASE3);
+    vaccine_init(&vaccines[2], MODERNA_VAC, RNA, PHASE3);
+
+    vaccinationBatchList_create(&list);
+    vaccinationBatchList_create(&copy);
+
+    // TEST 1: Sort a large list with repeated lots
+    failed = false;
+    start_test(test_section, "EXT_SRT_1", "Sort a large list with repeated lots");
+
+    // The quantity keeps the insertion order, to check that equal batches keep their order
+    for(i = 0; i < NUMBER_SORT_BATCHES; i++) {
+        vaccinationBatch_init(&batch, (i * 7919) % (NUMBER_SORT_BATCHES / 4), &vaccines[i % 3], i);
+        err = vaccineBatchList_append(&list, batch);
+        if(err != OK) {
+            failed = true;
+        }
+    }
+    if(list.size != NUMBER_SORT_BATCHES || list.last == NULL || list.last->e.quantity != NUMBER_SORT_BATCHES - 1) {
+        failed = true;
+    }
+
+    err = vaccineBatchList_quicksort(&list);
+    if(err != OK || !check_batchListSorted(&list)) {
+        failed = true;
+    }
+
+    for(node = list.first; node != NULL && node->next != NULL; node = node->next) {
+        if(node->e.lotID == node->next->e.lotID && node->e.vaccine == node->next->e.vaccine && node->e.quantity > node->next->e.quantity) {
+            failed = true;
+        }
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_SRT_1", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_SRT_1", true);
+    }
+
+    // TEST 2: Sort part of a list and copy it
+    failed = false;
+    start_test(test_section, "EXT_SRT_2", "Sort part of a list and copy it");
+
+    // Exchange the first and the last batches, and then sort the second half.
+    // The four batches of the highest lot go to the start, so the second half ends with the lot before it
+    for(i = 0; i < 4; i++) {
+        vaccineBatchList_swap(&list, i, NUMBER_SORT_BATCHES - 1 - i);
+    }
+    vaccineBatchList_quickSortRecursive(&list, NUMBER_SORT_BATCHES / 2, NUMBER_SORT_BATCHES - 1);
+    if(vaccineBatchList_get(list, NUMBER_SORT_BATCHES / 2 - 1)->e.lotID != vaccineBatchList_getlotID(list, NUMBER_SORT_BATCHES / 2 - 1) ||
+            vaccineBatchList_getlotID(list, NUMBER_SORT_BATCHES - 1) != NUMBER_SORT_BATCHES / 4 - 2 || list.last->next != NULL) {
+        failed = true;
+    }
+    if(vaccineBatchList_getlotID(list, 0) != NUMBER_SORT_BATCHES / 4 - 1) {
+        failed = true;
+    }
+
+    vaccineBatchList_quickSortRecursive(&list, 0, NUMBER_SORT_BATCHES - 1);
+    if(!check_batchListSorted(&list)) {
+        failed = true;
+    }
+
+    // The copy keeps the order
+    err = vaccinationBatchList_duplicate(&copy, list);
+    if(err != OK || !check_batchListSorted(&copy)) {
+        failed = true;
+    }
+    for(node = list.first, nodeCopy = copy.first; node != NULL && nodeCopy != NULL; node = node->next, nodeCopy = nodeCopy->next) {
+        if(!vaccinationBatch_equals(node->e, nodeCopy->e) || node->e.quantity != nodeCopy->e.quantity) {
+            failed = true;
+        }
+    }
+
+    // Removing the last node updates the last pointer
+    vaccineBatchList_delete(&copy, copy.size - 1);
+    if(copy.last != vaccineBatchList_get(copy, copy.size - 1)) {
+        failed = true;
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_SRT_2", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_SRT_2", true);
+    }
+
+    // Remove used memory
+    vaccinationBatchList_free(&list);
+    vaccinationBatchList_free(&copy);
+    for(i = 0; i < 3; i++) {
+        vaccine_free(&vaccines[i]);
+    }
+
+    return passed;
+}
+
+// Run tests for the availability index of vaccination batch lists
+bool run_ext_batchIndex(tTestSection* test_section) {
+    bool passed = true, failed = false;
+    tVaccinationBatchList list;
+    tVaccine vaccines[3];
+    tVaccineBatch batch;
+    tPatient patients[5];
+    int i;
+
+    vaccine_init(&vaccines[0], ASTRAZENECA_VAC, ADENOVIRUSES, PHASE3);
+    vaccine_init(&vaccines[1], PFIZER_VAC, RNA, PHASE3);
+    vaccine_init(&vaccines[2], MODERNA_VAC, RNA, PHASE3);
+
+    patient_init(&patients[0], "Patient 1", 1, NULL, 0, 0, ADULT_OVER_65);
+    for(i = 1; i < 5; i++) {
+        patient_init(&patients[i], "Patient", i + 1, NULL, 0, 0, ANYONE_ELSE);
+    }
+
+    // Many exhausted batches before the ones with doses
+    vaccinationBatchList_create(&list);
+    for(i = 0; i < NUMBER_EMPTY_BATCHES; i++) {
+        vaccinationBatch_init(&batch, i, &vaccines[i % 3], 0);
+        vaccineBatchList_append(&list, batch);
+    }
+    vaccinationBatch_init(&batch, 1000, &vaccines[0], 1);
+    vaccineBatchList_append(&list, batch);
+    vaccinationBatch_init(&batch, 2000, &vaccines[1], 2);
+    vaccineBatchList_append(&list, batch);
+    vaccinationBatch_init(&batch, 3000, &vaccines[2], 1);
+    vaccineBatchList_append(&list, batch);
+
+    // TEST 1: Choose the batches of first doses
+    failed = false;
+    start_test(test_section, "EXT_AVA_1", "Choose the batches of first doses");
+
+    // AstraZeneca is not suitable for the first patient
+    for(i = 0; i < 5; i++) {
+        vaccineBatchList_inoculate_first_vaccine(&list, &patients[i]);
+    }
+    if(patients[0].lotID != 2000 || patients[1].lotID != 1000 || patients[2].lotID != 2000 || patients[3].lotID != 3000) {
+        failed = true;
+    }
+    if(patients[0].vaccineId != PFIZER_VAC_ID || patients[1].vaccineId != ASTRAZENECA_VAC_ID || patients[3].vaccineId != MODERNA_VAC_ID) {
+        failed = true;
+    }
+    // There are no doses left for the last patient
+    if(patients[4].number_doses != 0 || patients[4].vaccine != NULL) {
+        failed = true;
+    }
+    if(list.last->e.quantity != 0 || vaccineBatchList_get(list, NUMBER_EMPTY_BATCHES + 1)->e.quantity != 0) {
+        failed = true;
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_AVA_1", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_AVA_1", true);
+    }
+
+    // TEST 2: Choose the batches of second doses after changes in the list
+    failed = false;
+    start_test(test_section, "EXT_AVA_2", "Choose the batches of second doses after changes in the list");
+
+    // A new batch at the start of the list is used first
+    vaccinationBatch_init(&batch, 5, &vaccines[1], 1);
+    vaccineBatchList_insert(&list, batch, 0);
+    vaccineBatchList_inoculate_second_vaccine(&list, &patients[0]);
+    vaccineBatchList_inoculate_second_vaccine(&list, &patients[2]);
+    if(patients[0].number_doses != 2 || patients[2].number_doses != 1 || list.first->e.quantity != 0) {
+        failed = true;
+    }
+
+    // There are no doses of AstraZeneca, until the quantity of a batch is changed
+    vaccineBatchList_delete(&list, 0);
+    vaccineBatchList_inoculate_second_vaccine(&list, &patients[1]);
+    if(patients[1].number_doses != 1) {
+        failed = true;
+    }
+    vaccineBatchList_get(list, NUMBER_EMPTY_BATCHES)->e.quantity = 3;
+    vaccineBatchList_invalidateIndex(&list);
+    vaccineBatchList_inoculate_second_vaccine(&list, &patients[1]);
+    if(patients[1].number_doses != 2 || patients[1].lotID != 1000 || vaccineBatchList_get(list, NUMBER_EMPTY_BATCHES)->e.quantity != 2) {
+        failed = true;
+    }
+
+    // After a sort the batches with the lowest lot are used first
+    vaccinationBatch_init(&batch, 2500, &vaccines[1], 1);
+    vaccineBatchList_append(&list, batch);
+    vaccinationBatch_init(&batch, 1500, &vaccines[1], 1);
+    vaccineBatchList_append(&list, batch);
+    vaccineBatchList_quicksort(&list);
+    vaccineBatchList_inoculate_second_vaccine(&list, &patients[2]);
+    if(patients[2].number_doses != 2 || vaccineBatchList_get(list, NUMBER_EMPTY_BATCHES + 1)->e.lotID != 1500 ||
+            vaccineBatchList_get(list, NUMBER_EMPTY_BATCHES + 1)->e.quantity != 0) {
+        failed = true;
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_AVA_2", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_AVA_2", true);
+    }
+
+    // Remove used memory
+    vaccinationBatchList_free(&list);
+    for(i = 0; i < 5; i++) {
+        patient_free(&patients[i]);
+    }
+    for(i = 0; i < 3; i++) {
+        vaccine_free(&vaccines[i]);
+    }
+
+    return passed;
+}
+
+// Run tests for the eligibility rules of the vaccines
+bool run_ext_eligibility(tTestSection* test_section) {
+    bool passed = true, failed = false;
+    tError err;
+    tCountry country;
+    tPatient patient;
+    tPatient* dequeued;
+    tVaccineId id;
+    FILE* fout;
+    char name[20];
+    int group, i;
+
+    // TEST 1: Default rules
+    failed = false;
+    start_test(test_section, "EXT_ELI_1", "Default rules");
+
+    for(group = 0; group < PATIENT_GROUPS; group++) {
+        if(eligibility_isSuitable(ASTRAZENECA_VAC_ID, group) != (group != ADULT_OVER_65 && group != COMORBID)) {
+            failed = true;
+        }
+        if(!eligibility_isSuitable(PFIZER_VAC_ID, group) || !eligibility_isSuitable(JANSSEN_VAC_ID, group)) {
+            failed = true;
+        }
+    }
+    if(eligibility_dosesRequired(JANSSEN_VAC_ID) != 1 || eligibility_dosesRequired(ASTRAZENECA_VAC_ID) != 2 ||
+            eligibility_dosesRequired(MODERNA_VAC_ID) != ELIGIBILITY_DEFAULT_DOSES || eligibility_dosesRequired(NO_VACCINE_ID) != ELIGIBILITY_DEFAULT_DOSES) {
+        failed = true;
+    }
+
+    patient_init(&patient, "Patient", 1, JANSSEN_VAC, 1, 1, ANYONE_ELSE);
+    if(!patient_isVaccinated(&patient)) {
+        failed = true;
+    }
+    patient_free(&patient);
+    patient_init(&patient, "Patient", 1, MODERNA_VAC, 1, 1, ANYONE_ELSE);
+    if(patient_isVaccinated(&patient)) {
+        failed = true;
+    }
+    patient_free(&patient);
+
+    if(failed) {
+        end_test(test_section, "EXT_ELI_1", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_ELI_1", true);
+    }
+
+    // TEST 2: Rules given by the user
+    failed = false;
+    start_test(test_section, "EXT_ELI_2", "Rules given by the user");
+
+    // Invalid rules are rejected without changes
+    if(eligibility_parseRule("mRNA-1273;2") != ERR_INVALID || eligibility_parseRule(";2;") != ERR_INVALID ||
+            eligibility_parseRule("mRNA-1273;0;") != ERR_INVALID || eligibility_parseRule("mRNA-1273;2;CHILDREN") != ERR_INVALID) {
+        failed = true;
+    }
+    if(!eligibility_isSuitable(MODERNA_VAC_ID, ANYONE_ELSE)) {
+        failed = true;
+    }
+
+    // A rule replaces the default one of the vaccine
+    err = eligibility_parseRule("AZD1222;2;ADULT_OVER_80");
+    if(err != OK || !eligibility_isSuitable(ASTRAZENECA_VAC_ID, COMORBID) || eligibility_isSuitable(ASTRAZENECA_VAC_ID, ADULT_OVER_80)) {
+        failed = true;
+    }
+
+    // Rules of a file, with vaccines that are not in the catalogue yet
+    fout = fopen(RULES_FILENAME, "w");
+    if(fout == NULL) {
+        failed = true;
+    } else {
+        fprintf(fout, "# Test rules\n\nmRNA-1273;3; HEALTH_WORKER , ESSENTIAL_WORKER\r\nTEST-VAC;1;\n");
+        fclose(fout);
+
+        err = eligibility_load(RULES_FILENAME);
+        id = vaccineCatalog_find("TEST-VAC");
+        if(err != OK || id == NO_VACCINE_ID || eligibility_dosesRequired(id) != 1 || eligibility_dosesRequired(MODERNA_VAC_ID) != 3) {
+            failed = true;
+        }
+        if(eligibility_isSuitable(MODERNA_VAC_ID, HEALTH_WORKER) || eligibility_isSuitable(MODERNA_VAC_ID, ESSENTIAL_WORKER) ||
+                !eligibility_isSuitable(MODERNA_VAC_ID, ADULT_OVER_55)) {
+            failed = true;
+        }
+
+        patient_init(&patient, "Patient", 1, MODERNA_VAC, 1, 2, ANYONE_ELSE);
+        if(patient_isVaccinated(&patient)) {
+            failed = true;
+        }
+        patient_free(&patient);
+
+        remove(RULES_FILENAME);
+    }
+    if(eligibility_load(RULES_FILENAME) != ERR_NOT_FOUND) {
+        failed = true;
+    }
+
+    // Go back to the default rules
+    eligibility_free();
+    if(eligibility_dosesRequired(MODERNA_VAC_ID) != ELIGIBILITY_DEFAULT_DOSES || eligibility_isSuitable(ASTRAZENECA_VAC_ID, COMORBID)) {
+        failed = true;
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_ELI_2", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_ELI_2", true);
+    }
+
+    // TEST 3: Count the vaccinated patients again when the rules change
+    failed = false;
+    start_test(test_section, "EXT_ELI_3", "Count the vaccinated patients again when the rules change");
+
+    country_init(&country, "Spain", true);
+    for(i = 0; i < 20; i++) {
+        snprintf(name, 20, "Patient_%04d", i + 1);
+        patient_init(&patient, name, i + 1, i % 2 == 0 ? JANSSEN_VAC : MODERNA_VAC, 1, i % 2 == 0 ? 1 : 2, ANYONE_ELSE);
+        country_addPatient(&country, patient);
+        patient_free(&patient);
+    }
+    if(patientQueue_stats(country.patients)->vaccinated != 20) {
+        failed = true;
+    }
+
+    // The patients with a single dose are not vaccinated with the new rule
+    err = eligibility_parseRule(JANSSEN_VAC ";2;");
+    if(err != OK || patientQueue_stats(country.patients)->vaccinated != 10 || country_percentage_vaccinated(&country) != 50.0) {
+        failed = true;
+    }
+
+    // A patient that leaves is uncounted with the rules it was counted with
+    dequeued = patientQueue_dequeue(country.patients);
+    if(dequeued == NULL || dequeued->id != 1 || patientQueue_stats(country.patients)->vaccinated != 10) {
+        failed = true;
+    }
+    patientQueue_release(country.patients, dequeued);
+
+    // Go back to the default rules
+    eligibility_free();
+    if(patientQueue_stats(country.patients)->vaccinated != 19) {
+        failed = true;
+    }
+    country_free(&country);
+
+    if(failed) {
+        end_test(test_section, "EXT_ELI_3", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_ELI_3", true);
+    }
+
+    return passed;
+}
+
+// Run tests for the aggregations over patient queues
+bool run_ext_aggregation(tTestSection* test_section) {
+    bool passed = true, failed = false;
+    tPatientQueue queue;
+    tPatientAggregation aggregations[4];
+    tPatientVaccineHistogram histogram;
+    tPatientTechnologyFilter filter;
+    tPatientBatchFilter batchFilter;
+    tVaccineTable vaccines;
+    tVaccine vaccine;
+    tVaccineId pfizerId;
+    unsigned int groups[PATIENT_GROUPS];
+    tPatient patient;
+    char name[20];
+    unsigned int i;
+
+    vaccineTable_init(&vaccines);
+    vaccine_init(&vaccine, PFIZER_VAC, RNA, PHASE3);
+    vaccineTable_add(&vaccines, vaccine);
+    vaccine_free(&vaccine);
+    vaccine_init(&vaccine, MODERNA_VAC, RNA, PHASE3);
+    vaccineTable_add(&vaccines, vaccine);
+    vaccine_free(&vaccine);
+
+    patientQueue_createChunked(&queue);
+    for(i = 0; i < NUMBER_QUEUE_PATIENTS; i++) {
+        snprintf(name, 20, "%s_%04d", "Patient", i + 1);
+        patient_init(&patient, name, i + 1, i % 3 == 0 ? PFIZER_VAC : (i % 3 == 1 ? JANSSEN_VAC : NULL), i % 2, i % 3 < 2 ? 1 : 0, i % PATIENT_GROUPS);
+        patientQueue_enqueue(&queue, patient);
+        patient_free(&patient);
+    }
+
+    // TEST 1: Several aggregations in one pass
+    failed = false;
+    start_test(test_section, "EXT_AGG_1", "Several aggregations in one pass");
+
+    histogram.size = vaccineCatalog_size();
+    histogram.counts = (unsigned int*)calloc(histogram.size, sizeof(unsigned int));
+    memset(groups, 0, sizeof(groups));
+    pfizerId = PFIZER_VAC_ID;
+    filter.vaccines = &vaccines;
+    filter.technology = RNA;
+
+    aggregations[0].predicate = NULL;
+    aggregations[0].data = NULL;
+    aggregations[0].accumulator = patient_accumulateGroup;
+    aggregations[0].result = groups;
+    aggregations[1].predicate = NULL;
+    aggregations[1].data = NULL;
+    aggregations[1].accumulator = patient_accumulateVaccine;
+    aggregations[1].result = &histogram;
+    aggregations[2].predicate = patient_matchesVaccine;
+    aggregations[2].data = &pfizerId;
+    aggregations[2].accumulator = NULL;
+    aggregations[2].result = NULL;
+    aggregations[3].predicate = patient_matchesTechnology;
+    aggregations[3].data = &filter;
+    aggregations[3].accumulator = NULL;
+    aggregations[3].result = NULL;
+
+    if(histogram.counts == NULL) {
+        failed = true;
+    } else {
+        patientQueue_aggregate(&queue, aggregations, 4);
+
+        if(aggregations[0].count != NUMBER_QUEUE_PATIENTS || aggregations[1].count != NUMBER_QUEUE_PATIENTS) {
+            failed = true;
+        }
+        for(i = 0; i < PATIENT_GROUPS; i++) {
+            if(groups[i] != patientQueue_stats(&queue)->groups[i]) {
+                failed = true;
+            }
+        }
+        for(i = 0; i < histogram.size; i++) {
+            if(histogram.counts[i] != patientQueue_countVaccine(&queue, i)) {
+                failed = true;
+            }
+        }
+        // Janssen is not in the table of vaccines, so only Pfizer has RNA
+        if(aggregations[2].count != patientQueue_countVaccine(&queue, PFIZER_VAC_ID) || aggregations[3].count != aggregations[2].count) {
+            failed = true;
+        }
+    }
+    free(histogram.counts);
+
+    if(failed) {
+        end_test(test_section, "EXT_AGG_1", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_AGG_1", true);
+    }
+
+    // TEST 2: Counting functions do not modify the queue
+    failed = false;
+    start_test(test_section, "EXT_AGG_2", "Counting functions do not modify the queue");
+
+    if(patientQueue_getPatientsPerVaccineRecursive(&queue, PFIZER_VAC) != (int)patientQueue_countVaccine(&queue, PFIZER_VAC_ID) ||
+            patientQueue_size(queue) != NUMBER_QUEUE_PATIENTS) {
+        failed = true;
+    }
+    if(patientQueue_getPatientsPerVaccineTechnologyRecursive(&queue, vaccines, RNA) != (int)patientQueue_countVaccine(&queue, PFIZER_VAC_ID) ||
+            patientQueue_size(queue) != NUMBER_QUEUE_PATIENTS) {
+        failed = true;
+    }
+    if(patientQueue_getPatientsPerVaccineRecursive(&queue, "Dummy Vaccine") != 0) {
+        failed = true;
+    }
+
+    // Half of the patients of each vaccine have lot 0
+    batchFilter.vaccineId = JANSSEN_VAC_ID;
+    batchFilter.lotID = 1;
+    aggregations[0].predicate = patient_matchesBatch;
+    aggregations[0].data = &batchFilter;
+    aggregations[0].accumulator = NULL;
+    patientQueue_aggregate(&queue, aggregations, 1);
+    if(aggregations[0].count != (unsigned int)patientQueue_countPatients_vaccinationBatch(queue, JANSSEN_VAC, 1) ||
+            aggregations[0].count + patientQueue_countPatients_vaccinationBatch(queue, JANSSEN_VAC, 0) != patientQueue_countVaccine(&queue, JANSSEN_VAC_ID)) {
+        failed = true;
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_AGG_2", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_AGG_2", true);
+    }
+
+    // Remove used memory
+    patientQueue_free(&queue);
+    vaccineTable_free(&vaccines);
+
+    return passed;
+}
+
+// Run tests for the fingerprints of patient queues
+bool run_ext_fingerprint(tTestSection* test_section) {
+    bool passed = true, failed = false;
+    tPatientQueue linked, chunked, other;
+    tPatient patient;
+    tPatient* patientAux;
+    char name[20];
+    int i;
+
+    patientQueue_create(&linked);
+    patientQueue_createChunked(&chunked);
+    patientQueue_create(&other);
+
+    // TEST 1: Equal queues have equal fingerprints
+    failed = false;
+    start_test(test_section, "EXT_FPR_1", "Equal queues have equal fingerprints");
+
+    if(patientQueue_fingerprint(&linked) != patientQueue_fingerprint(&chunked) || !patientQueue_compare(&linked, &chunked)) {
+        failed = true;
+    }
+
+    // The chunked queue has an extra patient at the head, that is dequeued later
+    patient_init(&patient, "Patient_0000", NUMBER_QUEUE_PATIENTS + 1, NULL, 0, 0, ANYONE_ELSE);
+    patientQueue_enqueue(&chunked, patient);
+    patient_free(&patient);
+    for(i = 0; i < NUMBER_QUEUE_PATIENTS; i++) {
+        snprintf(name, 20, "%s_%04d", "Patient", i + 1);
+        patient_init(&patient, name, i + 1, NULL, 0, 0, ANYONE_ELSE);
+        patientQueue_enqueue(&linked, patient);
+        patientQueue_enqueue(&chunked, patient);
+        patient_free(&patient);
+    }
+    if(patientQueue_fingerprint(&linked) == patientQueue_fingerprint(&chunked) || patientQueue_compare(&linked, &chunked)) {
+        failed = true;
+    }
+
+    patientAux = patientQueue_dequeue(&chunked);
+    patientQueue_release(&chunked, patientAux);
+    if(patientQueue_fingerprint(&linked) != patientQueue_fingerprint(&chunked) ||
+            !patientQueue_compare(&linked, &chunked) || !patientQueue_compareIterative(&chunked, &linked)) {
+        failed = true;
+    }
+
+    // The same patients in other order
+    for(i = 0; i < NUMBER_QUEUE_PATIENTS; i++) {
+        snprintf(name, 20, "%s_%04d", "Patient", (i + 1) % NUMBER_QUEUE_PATIENTS + 1);
+        patient_init(&patient, name, (i + 1) % NUMBER_QUEUE_PATIENTS + 1, NULL, 0, 0, ANYONE_ELSE);
+        patientQueue_enqueue(&other, patient);
+        patient_free(&patient);
+    }
+    if(patientQueue_fingerprint(&linked) == patientQueue_fingerprint(&other) || patientQueue_compare(&linked, &other)) {
+        failed = true;
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_FPR_1", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_FPR_1", true);
+    }
+
+    // TEST 2: Fingerprints after changes in place
+    failed = false;
+    start_test(test_section, "EXT_FPR_2", "Fingerprints after changes in place");
+
+    // Rotate the other queue, so that it has the same order
+    for(i = 1; i < NUMBER_QUEUE_PATIENTS; i++) {
+        patientAux = patientQueue_dequeue(&other);
+        patientQueue_enqueue(&other, *patientAux);
+        patientQueue_release(&other, patientAux);
+    }
+    if(!patientQueue_compare(&linked, &other) || patientQueue_fingerprint(&linked) != patientQueue_fingerprint(&other)) {
+        failed = true;
+    }
+
+    // A patient changed in place needs the fingerprint to be computed again
+    patientQueue_head(chunked)->id = NUMBER_QUEUE_PATIENTS + 1;
+    patientQueue_invalidateFingerprint(&chunked);
+    if(patientQueue_compare(&linked, &chunked)) {
+        failed = true;
+    }
+    patientQueue_head(chunked)->id = 1;
+    patientQueue_invalidateFingerprint(&chunked);
+    if(!patientQueue_compare(&linked, &chunked)) {
+        failed = true;
+    }
+
+    // Empty queues go back to the initial fingerprint
+    patientQueue_free(&chunked);
+    patientQueue_createChunked(&chunked);
+    while(!patientQueue_empty(other)) {
+        patientAux = patientQueue_dequeue(&other);
+        patientQueue_release(&other, patientAux);
+    }
+    if(patientQueue_fingerprint(&other) != 0 || patientQueue_fingerprint(&chunked) != 0 || !patientQueue_compare(&other, &chunked)) {
+        failed = true;
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_FPR_2", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_FPR_2", true);
+    }
+
+    // Remove used memory
+    patientQueue_free(&linked);
+    patientQueue_free(&chunked);
+    patientQueue_free(&other);
+
+    return passed;
+}
+
+// Run tests for the arenas of patients
+bool run_ext_arena(tTestSection* test_section) {
+    bool passed = true, failed = false;
+    tCountry arenaCountry, mallocCountry, copyCountry;
+    tPatientQueue queue;
+    tArenaReport report;
+    tArena arena;
+    tPatient patient;
+    tPatient* patientAux;
+    char name[20];
+    int i;
+
+    country_init(&arenaCountry, "Arena", true);
+    country_init(&mallocCountry, "Malloc", true);
+    country_init(&copyCountry, "Copy", true);
+
+    // TEST 1: Patients of a country stored in an arena
+    failed = false;
+    start_test(test_section, "EXT_ARN_1", "Patients of a country stored in an arena");
+
+    if(country_enableArena(&arenaCountry) != OK || arenaCountry.arena == NULL) {
+        failed = true;
+    }
+
+    for(i = 0; i < NUMBER_QUEUE_PATIENTS; i++) {
+        snprintf(name, 20, "%s_%04d", "Patient", i + 1);
+        patient_init(&patient, name, i + 1, i % 2 == 0 ? PFIZER_VAC : NULL, 1, i % 2, (tPatientGroup)(i % PATIENT_GROUPS));
+        country_addPatient(&arenaCountry, patient);
+        country_addPatient(&mallocCountry, patient);
+        patient_free(&patient);
+    }
+
+    // A country with patients can not change its storage
+    if(country_enableArena(&mallocCountry) != ERR_INVALID || mallocCountry.arena != NULL) {
+        failed = true;
+    }
+
+    if(!patientQueue_compare(arenaCountry.patients, mallocCountry.patients) ||
+            country_getPatientsPerGroup(arenaCountry, COMORBID) != country_getPatientsPerGroup(mallocCountry, COMORBID) ||
+            country_getPatientsPerDoses(arenaCountry, 1) != country_getPatientsPerDoses(mallocCountry, 1)) {
+        failed = true;
+    }
+
+    // Each patient takes a node and a name
+    country_memoryReport(&arenaCountry, &report);
+    if(report.allocations != 2 * NUMBER_QUEUE_PATIENTS || report.bytesInUse == 0 ||
+            report.bytesReserved < report.bytesInUse || report.mallocBytes <= report.bytesInUse) {
+        failed = true;
+    }
+    country_memoryReport(&mallocCountry, &report);
+    if(report.allocations != 0 || report.bytesReserved != 0 || report.mallocBytes != 0) {
+        failed = true;
+    }
+
+    // The copy of the country has an arena of its own
+    if(country_cpy(&copyCountry, &arenaCountry) != OK || copyCountry.arena == NULL || copyCountry.arena == arenaCountry.arena ||
+            !patientQueue_compare(copyCountry.patients, mallocCountry.patients)) {
+        failed = true;
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_ARN_1", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_ARN_1", true);
+    }
+
+    // TEST 2: Dequeue from a queue stored in an arena
+    failed = false;
+    start_test(test_section, "EXT_ARN_2", "Dequeue from a queue stored in an arena");
+
+    arena_init(&arena, 0);
+    patientQueue_createChunked(&queue);
+    if(patientQueue_useArena(&queue, &arena) != OK) {
+        failed = true;
+    }
+    patientQueue_enqueueAll(&queue, mallocCountry.patients);
+
+    // The dequeued patients are released with free, as the ones of the other queues
+    for(i = 0; i < NUMBER_QUEUE_PATIENTS / 2; i++) {
+        patientAux = patientQueue_dequeue(&queue);
+        snprintf(name, 20, "%s_%04d", "Patient", i + 1);
+        if(patientAux == NULL || strcmp(patientAux->name, name) != 0 || patientAux->id != i + 1) {
+            failed = true;
+        }
+        patientQueue_release(&queue, patientAux);
+    }
+
+    // The names released by dequeue are reused by the next patients
+    arena_report(&arena, &report);
+    if(report.reused != 0) {
+        failed = true;
+    }
+    for(i = 0; i < NUMBER_QUEUE_PATIENTS / 2; i++) {
+        snprintf(name, 20, "%s_%04d", "Patient", i + 1);
+        patient_init(&patient, name, i + 1, NULL, 0, 0, ANYONE_ELSE);
+        patientQueue_enqueue(&queue, patient);
+        patient_free(&patient);
+    }
+    arena_report(&arena, &report);
+    if(report.reused != NUMBER_QUEUE_PATIENTS / 2 || patientQueue_size(queue) != NUMBER_QUEUE_PATIENTS) {
+        failed = true;
+    }
+
+    // Rotated, the queue has the patients of the country in the same order
+    for(i = 0; i < NUMBER_QUEUE_PATIENTS - NUMBER_QUEUE_PATIENTS / 2; i++) {
+        patientAux = patientQueue_dequeue(&queue);
+        patientQueue_enqueue(&queue, *patientAux);
+        patientQueue_release(&queue, patientAux);
+    }
+    if(!patientQueue_compare(&queue, mallocCountry.patients)) {
+        failed = true;
+    }
+
+    // A queue with patients can not change its storage
+    if(patientQueue_useArena(&queue, NULL) != ERR_INVALID) {
+        failed = true;
+    }
+
+    // The queue releases nothing, all the memory goes back with the arena
+    patientQueue_free(&queue);
+    arena_free(&arena);
+    arena_report(&arena, &report);
+    if(!patientQueue_empty(queue) || report.blocks != 0 || report.bytesReserved != 0) {
+        failed = true;
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_ARN_2", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_ARN_2", true);
+    }
+
+    // Remove used memory
+    country_free(&arenaCountry);
+    country_free(&mallocCountry);
+    country_free(&copyCountry);
+
+    return passed;
+}
+
+// Run tests for the compact records of patients
+bool run_ext_patientRecord(tTestSection* test_section) {
+    bool passed = true, failed = false;
+    tPatientRecordTable table;
+    tPatientQueue queue;
+    tPatientQueueIterator it;
+    const tPatient* patientAux;
+    tPatient patient;
+    char name[20];
+    unsigned int vaccinated;
+    int i;
+
+    patientRecordTable_init(&table);
+    patientQueue_createChunked(&queue);
+
+    for(i = 0; i < NUMBER_QUEUE_PATIENTS; i++) {
+        snprintf(name, 20, "%s_%04d", "Patient", i + 1);
+        patient_init(&patient, name, i + 1, i % 3 == 0 ? NULL : (i % 3 == 1 ? JANSSEN_VAC : MODERNA_VAC), i, i % 3, (tPatientGroup)(i % PATIENT_GROUPS));
+        patientQueue_enqueue(&queue, patient);
+        patient_free(&patient);
+    }
+
+    // TEST 1: Patients copied to compact records and back
+    failed = false;
+    start_test(test_section, "EXT_REC_1", "Patients copied to compact records and back");
+
+    if(sizeof(tPatientRecord) != 16) {
+        failed = true;
+    }
+
+    if(patientRecordTable_addQueue(&table, &queue) != OK || patientRecordTable_size(&table) != NUMBER_QUEUE_PATIENTS) {
+        failed = true;
+    }
+
+    // All the fields of the patients are kept
+    vaccinated = 0;
+    i = 0;
+    patientQueue_iterator(&queue, &it);
+    while(!failed && (patientAux = patientQueue_next(&it)) != NULL) {
+        if(patientRecordTable_get(&table, i, &patient) != OK) {
+            failed = true;
+            break;
+        }
+        if(!patient_compare(patient, *patientAux) || patient.vaccineId != patientAux->vaccineId ||
+                patient.lotID != patientAux->lotID || patient.number_doses != patientAux->number_doses ||
+                patient.group != patientAux->group || strcmp(patientRecord_name(&table.elements[i], &table.names), patientAux->name) != 0 ||
+                (patient.vaccine == NULL) != (patientAux->vaccine == NULL) ||
+                patientRecord_isVaccinated(&table.elements[i]) != patient_isVaccinated(patientAux)) {
+            failed = true;
+        }
+        if(patient_isVaccinated(patientAux)) {
+            vaccinated++;
+        }
+        patient_free(&patient);
+        i++;
+    }
+
+    if(patientRecordTable_countVaccinated(&table) != vaccinated || vaccinated != patientQueue_stats(&queue)->vaccinated) {
+        failed = true;
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_REC_1", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_REC_1", true);
+    }
+
+    // TEST 2: Patients that do not fit in a compact record
+    failed = false;
+    start_test(test_section, "EXT_REC_2", "Patients that do not fit in a compact record");
+
+    patient_init(&patient, "Patient_Doses", NUMBER_QUEUE_PATIENTS + 1, PFIZER_VAC, 1, PATIENT_RECORD_MAX_DOSES + 1, ANYONE_ELSE);
+    if(patientRecordTable_add(&table, &patient) != ERR_INVALID || patientRecordTable_size(&table) != NUMBER_QUEUE_PATIENTS) {
+        failed = true;
+    }
+    patient.number_doses = PATIENT_RECORD_MAX_DOSES;
+    if(patientRecordTable_add(&table, &patient) != OK || patientRecordTable_size(&table) != NUMBER_QUEUE_PATIENTS + 1) {
+        failed = true;
+    }
+    patient_free(&patient);
+
+    if(patientRecordTable_get(&table, NUMBER_QUEUE_PATIENTS + 1, &patient) != ERR_INVALID_INDEX) {
+        failed = true;
+    }
+    if(patientRecordTable_get(&table, NUMBER_QUEUE_PATIENTS, &patient) != OK ||
+            patient.number_doses != PATIENT_RECORD_MAX_DOSES || patient.vaccineId != PFIZER_VAC_ID || strcmp(patient.vaccine, PFIZER_VAC) != 0) {
+        failed = true;
+    }
+    patient_free(&patient);
+
+    if(failed) {
+        end_test(test_section, "EXT_REC_2", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_REC_2", true);
+    }
+
+    // Remove used memory
+    patientRecordTable_free(&table);
+    patientQueue_free(&queue);
+
+    return passed;
+}
+
+// Run tests for the id index of patient queues
+bool run_ext_idIndex(tTestSection* test_section) {
+    bool passed = true, failed = false;
+    tPatientQueue linked, chunked, plain, expected;
+    tPatientQueue* queues[3];
+    tCountry country;
+    tPatient patient;
+    tPatient *patientAux, *expectedPatient;
+    char name[20];
+    int i, j;
+
+    patientQueue_create(&linked);
+    patientQueue_createChunked(&chunked);
+    patientQueue_create(&plain);
+    patientQueue_create(&expected);
+    queues[0] = &linked;
+    queues[1] = &chunked;
+    queues[2] = &plain;
+
+    // The index of the chunked queue is built with the patients already in it
+    patientQueue_enableIdIndex(&linked);
+    for(i = 0; i < NUMBER_QUEUE_PATIENTS; i++) {
+        snprintf(name, 20, "%s_%04d", "Patient", i + 1);
+        patient_init(&patient, name, i + 1, NULL, 0, 0, (tPatientGroup)(i % PATIENT_GROUPS));
+        for(j = 0; j < 3; j++) {
+            patientQueue_enqueue(queues[j], patient);
+        }
+        // Patients with an id multiple of 7, and the first and last ones, are removed later
+        if((i + 1) % 7 != 0 && i != 0 && i != NUMBER_QUEUE_PATIENTS - 1) {
+            patientQueue_enqueue(&expected, patient);
+        }
+        patient_free(&patient);
+    }
+    patientQueue_enableIdIndex(&chunked);
+
+    // TEST 1: Find and update patients by id
+    failed = false;
+    start_test(test_section, "EXT_IDS_1", "Find and update patients by id");
+
+    country_init(&country, "Index", true);
+    if(!country.patients->ids.enabled || !linked.ids.enabled || !chunked.ids.enabled || plain.ids.enabled ||
+            chunked.ids.count != NUMBER_QUEUE_PATIENTS) {
+        failed = true;
+    }
+    country_free(&country);
+
+    for(j = 0; j < 3 && !failed; j++) {
+        for(i = 0; i < NUMBER_QUEUE_PATIENTS; i++) {
+            snprintf(name, 20, "%s_%04d", "Patient", i + 1);
+            patientAux = patientQueue_findById(queues[j], i + 1);
+            if(patientAux == NULL || patientAux->id != i + 1 || strcmp(patientAux->name, name) != 0) {
+                failed = true;
+                break;
+            }
+        }
+        if(patientQueue_findById(queues[j], NUMBER_QUEUE_PATIENTS + 1) != NULL) {
+            failed = true;
+        }
+
+        // Correct the group and doses of a patient, keeping its place
+        snprintf(name, 20, "%s_%04d", "Patient", 10);
+        patient_init(&patient, name, 10, MODERNA_VAC, 1, 2, COMORBID);
+        if(patientQueue_updateById(queues[j], 10, patient) != OK ||
+                patientQueue_updateById(queues[j], NUMBER_QUEUE_PATIENTS + 1, patient) != ERR_NOT_FOUND) {
+            failed = true;
+        }
+        patient_free(&patient);
+        patientAux = patientQueue_findById(queues[j], 10);
+        if(patientAux == NULL || patientAux->group != COMORBID || patientAux->number_doses != 2 ||
+                patientAux->vaccineId != MODERNA_VAC_ID || patientQueue_stats(queues[j])->vaccinated != 1 ||
+                patientQueue_countVaccine(queues[j], MODERNA_VAC_ID) != 1) {
+            failed = true;
+        }
+    }
+
+    // Put back the data of the patient, with the fingerprint of the expected queue
+    snprintf(name, 20, "%s_%04d", "Patient", 10);
+    patient_init(&patient, name, 10, NULL, 0, 0, (tPatientGroup)(9 % PATIENT_GROUPS));
+    for(j = 0; j < 3; j++) {
+        patientQueue_updateById(queues[j], 10, patient);
+    }
+    patient_free(&patient);
+    if(!patientQueue_compare(&linked, &chunked) || !patientQueue_compare(&chunked, &plain) ||
+            patientQueue_stats(&chunked)->vaccinated != 0) {
+        failed = true;
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_IDS_1", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_IDS_1", true);
+    }
+
+    // TEST 2: Remove patients by id
+    failed = false;
+    start_test(test_section, "EXT_IDS_2", "Remove patients by id");
+
+    for(j = 0; j < 3; j++) {
+        if(patientQueue_removeById(queues[j], 1) != OK || patientQueue_removeById(queues[j], NUMBER_QUEUE_PATIENTS) != OK) {
+            failed = true;
+        }
+        for(i = 7; i <= NUMBER_QUEUE_PATIENTS; i += 7) {
+            if(patientQueue_removeById(queues[j], i) != OK) {
+                failed = true;
+            }
+        }
+        if(patientQueue_removeById(queues[j], 7) != ERR_NOT_FOUND || patientQueue_findById(queues[j], 14) != NULL ||
+                patientQueue_size(*queues[j]) != patientQueue_size(expected) || !patientQueue_compare(queues[j], &expected) ||
+                patientQueue_stats(queues[j])->groups[COMORBID] != patientQueue_stats(&expected)->groups[COMORBID]) {
+            failed = true;
+        }
+    }
+
+    // With several patients with the same id, the first one of the queue is found and removed
+    patient_init(&patient, "Duplicate", 5, NULL, 0, 0, ANYONE_ELSE);
+    for(j = 0; j < 3; j++) {
+        patientQueue_enqueue(queues[j], patient);
+        patientAux = patientQueue_findById(queues[j], 5);
+        if(patientAux == NULL || strcmp(patientAux->name, "Patient_0005") != 0) {
+            failed = true;
+        }
+        patientQueue_removeById(queues[j], 5);
+        patientAux = patientQueue_findById(queues[j], 5);
+        if(patientAux == NULL || strcmp(patientAux->name, "Duplicate") != 0) {
+            failed = true;
+        }
+    }
+    patient_free(&patient);
+
+    // The rest of patients leave the queues in order
+    patientQueue_removeById(&expected, 5);
+    patient_init(&patient, "Duplicate", 5, NULL, 0, 0, ANYONE_ELSE);
+    patientQueue_enqueue(&expected, patient);
+    patient_free(&patient);
+    while(!patientQueue_empty(expected)) {
+        expectedPatient = patientQueue_dequeue(&expected);
+        for(j = 0; j < 3; j++) {
+            if(patientQueue_findById(queues[j], expectedPatient->id) != patientQueue_head(*queues[j])) {
+                failed = true;
+            }
+            patientAux = patientQueue_dequeue(queues[j]);
+            if(patientAux == NULL || !patient_compare(*patientAux, *expectedPatient)) {
+                failed = true;
+            }
+            patientQueue_release(queues[j], patientAux);
+        }
+        patientQueue_release(&expected, expectedPatient);
+    }
+    for(j = 0; j < 3; j++) {
+        if(!patientQueue_empty(*queues[j]) || queues[j]->ids.count != 0) {
+            failed = true;
+        }
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_IDS_2", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_IDS_2", true);
+    }
+
+    // Remove used memory
+    for(j = 0; j < 3; j++) {
+        patientQueue_free(queues[j]);
+    }
+    patientQueue_free(&expected);
+
+    return passed;
+}
+
+// Run tests for the priority queues of patients
+bool run_ext_priorityQueue(tTestSection* test_section) {
+    bool passed = true, failed = false;
+    tPatientPriorityQueue queue;
+    tPatientQueueIterator it;
+    const tPatient* patientAux;
+    tCountry country, other;
+    tVaccine pfizer, astrazeneca;
+    tVaccineBatch batch;
+    tPatient patient;
+    unsigned int groups[PATIENT_GROUPS];
+    char name[20];
+    int i, group, id, lastGroup, lastId;
+
+    patientPriorityQueue_create(&queue);
+    country_init(&country, "Priority", true);
+    vaccine_init(&pfizer, PFIZER_VAC, RNA, PHASE3);
+    vaccine_init(&astrazeneca, ASTRAZENECA_VAC, ADENOVIRUSES, PHASE3);
+
+    // The patients with the highest priority arrive last
+    memset(groups, 0, sizeof(groups));
+    for(i = 0; i < NUMBER_QUEUE_PATIENTS; i++) {
+        snprintf(name, 20, "%s_%04d", "Patient", i + 1);
+        patient_init(&patient, name, i + 1, NULL, 0, 0, (tPatientGroup)(PATIENT_GROUPS - 1 - i % PATIENT_GROUPS));
+        patientPriorityQueue_enqueue(&queue, &patient);
+        country_addPatient(&country, patient);
+        groups[patient.group]++;
+        patient_free(&patient);
+    }
+
+    // TEST 1: Patients leave the priority queue by group and then by arrival
+    failed = false;
+    start_test(test_section, "EXT_PRI_1", "Patients leave the priority queue by group and then by arrival");
+
+    if(patientPriorityQueue_size(&queue) != NUMBER_QUEUE_PATIENTS || queue.mask != (1u << PATIENT_GROUPS) - 1 ||
+            patientPriorityQueue_firstGroup(&queue) != HEALTH_WORKER ||
+            patientPriorityQueue_nextGroup(&queue, ADULT_OVER_65 + 1) != COMORBID ||
+            patientPriorityQueue_nextGroup(&queue, PATIENT_GROUPS) != -1) {
+        failed = true;
+    }
+
+    lastGroup = HEALTH_WORKER;
+    lastId = 0;
+    while((group = patientPriorityQueue_firstGroup(&queue)) >= 0) {
+        if(patientPriorityQueue_head(&queue, (tPatientGroup)group) == PATIENT_QUEUE_NO_ID) {
+            failed = true;
+            break;
+        }
+        id = patientPriorityQueue_dequeue(&queue, (tPatientGroup)group);
+        if(group < lastGroup || (group == lastGroup && id <= lastId) ||
+                (PATIENT_GROUPS - 1 - (id - 1) % PATIENT_GROUPS) != group) {
+            failed = true;
+        }
+        lastGroup = group;
+        lastId = id;
+    }
+
+    if(!patientPriorityQueue_empty(&queue) || patientPriorityQueue_size(&queue) != 0 ||
+            patientPriorityQueue_dequeue(&queue, ANYONE_ELSE) != PATIENT_QUEUE_NO_ID) {
+        failed = true;
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_PRI_1", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_PRI_1", true);
+    }
+
+    // TEST 2: Inoculate the first dose by priority
+    failed = false;
+    start_test(test_section, "EXT_PRI_2", "Inoculate the first dose by priority");
+
+    // Doses for the two first groups only. The first health worker leaves the country
+    patientQueue_removeById(country.patients, PATIENT_GROUPS);
+    vaccinationBatch_init(&batch, 1, &pfizer, groups[HEALTH_WORKER] - 1 + groups[ADULT_OVER_80]);
+    vaccineBatchList_insert(country.vbList, batch, 0);
+    vaccinationBatch_free(&batch);
+
+    if(country_inoculate_first_vaccine_ordered(&country) != OK) {
+        failed = true;
+    }
+    patientQueue_iterator(country.patients, &it);
+    while((patientAux = patientQueue_next(&it)) != NULL) {
+        if(patientAux->number_doses != (patientAux->group <= ADULT_OVER_80 ? 1 : 0)) {
+            failed = true;
+        }
+    }
+    if(patientPriorityQueue_firstGroup(country.waiting) != ADULT_OVER_65 ||
+            country_getPatientsPerDoses(country, 1) != (int)(groups[HEALTH_WORKER] - 1 + groups[ADULT_OVER_80])) {
+        failed = true;
+    }
+
+    // AstraZeneca is not suitable for the next two groups, that keep waiting
+    vaccinationBatch_init(&batch, 2, &astrazeneca, NUMBER_QUEUE_PATIENTS);
+    vaccineBatchList_insert(country.vbList, batch, 0);
+    vaccinationBatch_free(&batch);
+
+    if(country_inoculate_first_vaccine_ordered(&country) != OK) {
+        failed = true;
+    }
+    patientQueue_iterator(country.patients, &it);
+    while((patientAux = patientQueue_next(&it)) != NULL) {
+        if(patientAux->number_doses != (patientAux->group == ADULT_OVER_65 || patientAux->group == COMORBID ? 0 : 1)) {
+            failed = true;
+        }
+    }
+    if(patientPriorityQueue_size(country.waiting) != groups[ADULT_OVER_65] + groups[COMORBID] ||
+            country.waiting->mask != ((1u << ADULT_OVER_65) | (1u << COMORBID))) {
+        failed = true;
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_PRI_2", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_PRI_2", true);
+    }
+
+    // TEST 3: Serve the patients that start waiting between ordered rounds
+    failed = false;
+    start_test(test_section, "EXT_PRI_3", "Serve the patients that start waiting between ordered rounds");
+
+    // The first round gets more patients than doses
+    country_init(&other, "Waiting", true);
+    for(i = 0; i < 100; i++) {
+        snprintf(name, 20, "%s_%04d", "Patient", i + 1);
+        patient_init(&patient, name, i + 1, NULL, 0, 0, (tPatientGroup)(i % PATIENT_GROUPS));
+        country_addPatient(&other, patient);
+        patient_free(&patient);
+    }
+    vaccinationBatch_init(&batch, 1, &pfizer, 60);
+    vaccineBatchList_insert(other.vbList, batch, 0);
+    vaccinationBatch_free(&batch);
+    if(country_inoculate_first_vaccine_ordered(&other) != OK || country_getPatientsPerDoses(other, 0) != 40 ||
+            patientPriorityQueue_size(other.waiting) != 40) {
+        failed = true;
+    }
+
+    // Patients enqueued without the country, and a served patient updated back to zero doses
+    for(i = 100; i < 110; i++) {
+        snprintf(name, 20, "%s_%04d", "Patient", i + 1);
+        patient_init(&patient, name, i + 1, NULL, 0, 0, (tPatientGroup)(i % PATIENT_GROUPS));
+        patientQueue_enqueue(other.patients, patient);
+        patient_free(&patient);
+    }
+    patient_init(&patient, "Patient_0001", 1, NULL, 0, 0, HEALTH_WORKER);
+    if(patientQueue_updateById(other.patients, 1, patient) != OK) {
+        failed = true;
+    }
+    patient_free(&patient);
+
+    vaccinationBatch_init(&batch, 2, &pfizer, 51);
+    vaccineBatchList_insert(other.vbList, batch, 0);
+    vaccinationBatch_free(&batch);
+    if(country_inoculate_first_vaccine_ordered(&other) != OK || country_getPatientsPerDoses(other, 0) != 0 ||
+            !patientPriorityQueue_empty(other.waiting)) {
+        failed = true;
+    }
+
+    // The ordered round serves the patients left by a round by arrival
+    for(i = 110; i < 210; i++) {
+        snprintf(name, 20, "%s_%04d", "Patient", i + 1);
+        patient_init(&patient, name, i + 1, NULL, 0, 0, (tPatientGroup)(i % PATIENT_GROUPS));
+        country_addPatient(&other, patient);
+        patient_free(&patient);
+    }
+    vaccinationBatch_init(&batch, 3, &pfizer, 60);
+    vaccineBatchList_insert(other.vbList, batch, 0);
+    vaccinationBatch_free(&batch);
+    if(country_inoculate_first_vaccine(&other) != OK || country_getPatientsPerDoses(other, 0) != 40) {
+        failed = true;
+    }
+    vaccinationBatch_init(&batch, 4, &pfizer, 40);
+    vaccineBatchList_insert(other.vbList, batch, 0);
+    vaccinationBatch_free(&batch);
+    if(country_inoculate_first_vaccine_ordered(&other) != OK || country_getPatientsPerDoses(other, 0) != 0 ||
+            !patientPriorityQueue_empty(other.waiting)) {
+        failed = true;
+    }
+    country_free(&other);
+
+    if(failed) {
+        end_test(test_section, "EXT_PRI_3", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_PRI_3", true);
+    }
+
+    // TEST 4: Serve a repeated id as the first patient with that id
+    failed = false;
+    start_test(test_section, "EXT_PRI_4", "Serve a repeated id as the first patient with that id");
+
+    country_init(&other, "Repeated", true);
+    for(i = 0; i < 2; i++) {
+        snprintf(name, 20, "%s_%04d", "Repeated", i + 1);
+        patient_init(&patient, name, 7, NULL, 0, 0, ANYONE_ELSE);
+        country_addPatient(&other, patient);
+        patient_free(&patient);
+    }
+    vaccinationBatch_init(&batch, 1, &pfizer, 10);
+    vaccineBatchList_insert(other.vbList, batch, 0);
+    vaccinationBatch_free(&batch);
+
+    // The two entries of the id reach the first patient, and the second one finds it with a dose
+    if(country_inoculate_first_vaccine_ordered(&other) != OK || !patientPriorityQueue_empty(other.waiting)) {
+        failed = true;
+    }
+    i = 0;
+    patientQueue_iterator(other.patients, &it);
+    while((patientAux = patientQueue_next(&it)) != NULL) {
+        snprintf(name, 20, "%s_%04d", "Repeated", i + 1);
+        if(strcmp(patientAux->name, name) != 0 || patientAux->number_doses != (i == 0 ? 1 : 0)) {
+            failed = true;
+        }
+        i++;
+    }
+    if(i != 2) {
+        failed = true;
+    }
+    country_free(&other);
+
+    if(failed) {
+        end_test(test_section, "EXT_PRI_4", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_PRI_4", true);
+    }
+
+    // Remove used memory
+    patientPriorityQueue_free(&queue);
+    country_free(&country);
+    vaccine_free(&pfizer);
+    vaccine_free(&astrazeneca);
+
+    return passed;
+}
+
+// Run tests for the CSV bulk loader
+bool run_ext_csvLoader(tTestSection* test_section) {
+    bool passed = true, failed = false;
+    tCountryTable table;
+    tCountry* country;
+    tPatient* patient;
+    tCsvLoadOptions options;
+    tCsvLoadReport report;
+    tVaccineBatch* batch;
+    tArenaReport memory;
+    tError err;
+    FILE* fout;
+    int i;
+
+    countryTable_init(&table);
+
+    // TEST 1: Load all the kinds of rows
+    failed = false;
+    start_test(test_section, "EXT_CSV_1", "Load all the kinds of rows");
+
+    fout = fopen(CSV_FILENAME, "w");
+    if(fout == NULL) {
+        failed = true;
+    } else {
+        fprintf(fout, "# Bulk load test\n\nCOUNTRY,Spain,1\r\nCOUNTRY,\"United Kingdom\",false\n");
+        fprintf(fout, "VACCINE,Spain,%s,%d,%d\n", PFIZER_VAC, RNA, PHASE3);
+        fprintf(fout, "PATIENT,Spain,1,\"Smith, \"\"John\"\"\",HEALTH_WORKER,0,,\n");
+        fprintf(fout, "PATIENT,\"United Kingdom\",2,Anne,%d,1,%s,7\n", ADULT_OVER_80, PFIZER_VAC);
+        fprintf(fout, "BATCH,Spain,7,%s,100", PFIZER_VAC);
+        fclose(fout);
+
+        // A small buffer makes the lines cross the chunks and the buffer grow
+        csvLoader_defaultOptions(&options);
+        options.bufferSize = 16;
+        err = csvLoader_loadFile(&table, CSV_FILENAME, &options, &report);
+        if(err != OK || report.rows[CSV_COUNTRY] != 2 || report.rows[CSV_VACCINE] != 1 || report.rows[CSV_PATIENT] != 2 ||
+                report.rows[CSV_BATCH] != 1 || report.rejected != 0 || report.lines != 8) {
+            failed = true;
+        }
+
+        country = countryTable_find(&table, "Spain");
+        if(country == NULL || !country->isEU || vaccineTable_find(country->authVaccines, PFIZER_VAC) == NULL) {
+            failed = true;
+        } else {
+            patient = patientQueue_findById(country->patients, 1);
+            if(patient == NULL || strcmp(patient->name, "Smith, \"John\"") != 0 || patient->group != HEALTH_WORKER ||
+                    patient->vaccine != NULL || country_getPatientsPerDoses(*country, 0) != 1) {
+                failed = true;
+            }
+            batch = country->vbList->first != NULL ? &country->vbList->first->e : NULL;
+            if(batch == NULL || batch->lotID != 7 || batch->quantity != 100 || batch->vaccine->id != PFIZER_VAC_ID) {
+                failed = true;
+            }
+        }
+
+        country = countryTable_find(&table, "United Kingdom");
+        if(country == NULL || country->isEU) {
+            failed = true;
+        } else {
+            patient = patientQueue_findById(country->patients, 2);
+            if(patient == NULL || patient->group != ADULT_OVER_80 || patient->number_doses != 1 ||
+                    patient->vaccineId != PFIZER_VAC_ID || patient->lotID != 7 || country_getPatientsPerDoses(*country, 0) != 0) {
+                failed = true;
+            }
+        }
+
+        remove(CSV_FILENAME);
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_CSV_1", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_CSV_1", true);
+    }
+
+    // TEST 2: Reject wrong rows and load many patients in arenas
+    failed = false;
+    start_test(test_section, "EXT_CSV_2", "Reject wrong rows and load many patients in arenas");
+
+    if(csvLoader_loadFile(&table, CSV_FILENAME, NULL, &report) != ERR_NOT_FOUND) {
+        failed = true;
+    }
+
+    fout = fopen(CSV_FILENAME, "w");
+    if(fout == NULL) {
+        failed = true;
+    } else {
+        fprintf(fout, "COUNTRY,Spain,1\nCOUNTRY,France,yes\nCOUNTRY,Italy,1\nPATIENT,Italy,0,Zero,1,0,,\n");
+        fprintf(fout, "PATIENT,Italy,1,One,CHILDREN,0,,\nPATIENT,Portugal,1,One,1,0,,\nBATCH,Italy,1,%s\nUNKNOWN,Italy\n", PFIZER_VAC);
+        for(i = 0; i < NUMBER_QUEUE_PATIENTS; i++) {
+            fprintf(fout, "PATIENT,Italy,%d,Patient_%04d,%d,%d,,\n", i + 1, i + 1, i % PATIENT_GROUPS, i % 2);
+        }
+        fclose(fout);
+
+        csvLoader_defaultOptions(&options);
+        options.useArenas = true;
+        err = csvLoader_loadFile(&table, CSV_FILENAME, &options, &report);
+        if(err != OK || report.rows[CSV_COUNTRY] != 1 || report.rows[CSV_PATIENT] != NUMBER_QUEUE_PATIENTS ||
+                report.rejected != 7 || report.firstRejectedLine != 1 || report.firstError != ERR_DUPLICATED ||
+                countryTable_find(&table, "France") != NULL) {
+            failed = true;
+        }
+
+        country = countryTable_find(&table, "Italy");
+        if(country == NULL || country->arena == NULL || patientQueue_size(*country->patients) != NUMBER_QUEUE_PATIENTS ||
+                country_getPatientsPerDoses(*country, 0) != (NUMBER_QUEUE_PATIENTS + 1) / 2 ||
+                country_getPatientsPerGroup(*country, ANYONE_ELSE) != NUMBER_QUEUE_PATIENTS / PATIENT_GROUPS) {
+            failed = true;
+        } else {
+            country_memoryReport(country, &memory);
+            patient = patientQueue_findById(country->patients, NUMBER_QUEUE_PATIENTS);
+            if(memory.allocations == 0 || patient == NULL || strcmp(patient->name, "Patient_0778") != 0) {
+                failed = true;
+            }
+        }
+
+        remove(CSV_FILENAME);
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_CSV_2", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_CSV_2", true);
+    }
+
+    // Remove used memory
+    countryTable_free(&table);
+
+    return passed;
+}
+
+// Run tests for the binary snapshots
+bool run_ext_snapshot(tTestSection* test_section) {
+    bool passed = true, failed = false;
+    tCountryTable table, loaded;
+    tCountry country;
+    tCountry *source, *copy;
+    tVaccine pfizer, vaccine;
+    tVaccineBatch batch;
+    tPatient patient;
+    tError err;
+    char name[20];
+    FILE* file;
+    int i, c;
+
+    countryTable_init(&table);
+    countryTable_init(&loaded);
+    vaccine_init(&pfizer, PFIZER_VAC, RNA, PHASE3);
+
+    // Two countries with vaccines, batches and patients. One of the vaccines is not in the catalogue yet
+    for(c = 0; c < 2; c++) {
+        country_init(&country, c == 0 ? "Spain" : "Norway", c == 0);
+        countryTable_add(&table, &country);
+        country_free(&country);
+    }
+    source = countryTable_find(&table, "Spain");
+    vaccine_init(&vaccine, "SNAPSHOT-VAC", PEPTIDE, PHASE2);
+    country_addVaccine(source, pfizer);
+    country_addVaccine(source, vaccine);
+    vaccinationBatch_init(&batch, 10, &pfizer, 50);
+    vaccineBatchList_append(source->vbList, batch);
+    vaccinationBatch_init(&batch, 11, &vaccine, 5);
+    vaccineBatchList_append(source->vbList, batch);
+    for(i = 0; i < NUMBER_QUEUE_PATIENTS; i++) {
+        snprintf(name, 20, "%s_%04d", "Patient", i + 1);
+        patient_init(&patient, name, i + 1, i % 3 == 0 ? NULL : (i % 3 == 1 ? PFIZER_VAC : "SNAPSHOT-VAC"), 10 + i % 3, i % 3, (tPatientGroup)(i % PATIENT_GROUPS));
+        country_addPatient(source, patient);
+        patient_free(&patient);
+    }
+    vaccine_free(&vaccine);
+
+    // TEST 1: Save a table and load it again
+    failed = false;
+    start_test(test_section, "EXT_SNAP_1", "Save a table and load it again");
+
+    err = snapshot_save(&table, SNAPSHOT_FILENAME);
+    if(err != OK) {
+        failed = true;
+    } else {
+        err = snapshot_load(&loaded, SNAPSHOT_FILENAME);
+        if(err != OK || loaded.size != 2 || countryTable_find(&loaded, "Norway") == NULL || countryTable_find(&loaded, "Norway")->isEU) {
+            failed = true;
+        }
+
+        copy = countryTable_find(&loaded, "Spain");
+        if(copy == NULL || !copy->isEU || copy->arena == NULL) {
+            failed = true;
+        } else {
+            if(!patientQueue_compare(source->patients, copy->patients) ||
+                    patientQueue_fingerprint(source->patients) != patientQueue_fingerprint(copy->patients) ||
+                    country_getPatientsPerDoses(*copy, 0) != country_getPatientsPerDoses(*source, 0) ||
+                    patientQueue_findById(copy->patients, 2) == NULL || patientQueue_findById(copy->patients, 2)->lotID != 11) {
+                failed = true;
+            }
+            if(vaccineTable_size(copy->authVaccines) != 2 || vaccineTable_find(copy->authVaccines, "SNAPSHOT-VAC") == NULL ||
+                    vaccineTable_find(copy->authVaccines, "SNAPSHOT-VAC")->vaccineTec != PEPTIDE) {
+                failed = true;
+            }
+            if(copy->vbList->size != 2 || copy->vbList->first->e.lotID != 10 || copy->vbList->first->e.quantity != 50 ||
+                    copy->vbList->last->e.vaccine->id != vaccineCatalog_find("SNAPSHOT-VAC")) {
+                failed = true;
+            }
+        }
+
+        // The table must be empty
+        if(snapshot_load(&loaded, SNAPSHOT_FILENAME) != ERR_INVALID || loaded.size != 2) {
+            failed = true;
+        }
+    }
+    countryTable_free(&loaded);
+
+    if(failed) {
+        end_test(test_section, "EXT_SNAP_1", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_SNAP_1", true);
+    }
+
+    // TEST 2: Reject damaged snapshots
+    failed = false;
+    start_test(test_section, "EXT_SNAP_2", "Reject damaged snapshots");
+
+    if(snapshot_load(&loaded, "missing_" SNAPSHOT_FILENAME) != ERR_NOT_FOUND) {
+        failed = true;
+    }
+
+    // Change one byte of the patients
+    file = fopen(SNAPSHOT_FILENAME, "r+b");
+    if(file == NULL) {
+        failed = true;
+    } else {
+        fseek(file, 1000, SEEK_SET);
+        c = fgetc(file);
+        fseek(file, 1000, SEEK_SET);
+        fputc(c ^ 1, file);
+        fclose(file);
+
+        if(snapshot_load(&loaded, SNAPSHOT_FILENAME) != ERR_INVALID || loaded.size != 0) {
+            failed = true;
+        }
+    }
+
+    // A snapshot with a byte more at the end
+    if(snapshot_save(&table, SNAPSHOT_FILENAME) != OK) {
+        failed = true;
+    } else {
+        file = fopen(SNAPSHOT_FILENAME, "ab");
+        if(file == NULL) {
+            failed = true;
+        } else {
+            fputc(0, file);
+            fclose(file);
+            if(snapshot_load(&loaded, SNAPSHOT_FILENAME) != ERR_INVALID || loaded.size != 0) {
+                failed = true;
+            }
+        }
+    }
+    remove(SNAPSHOT_FILENAME);
+
+    if(failed) {
+        end_test(test_section, "EXT_SNAP_2", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_SNAP_2", true);
+    }
+
+    // TEST 3: Load a snapshot adding the patients of the countries with several threads
+    failed = false;
+    start_test(test_section, "EXT_SNAP_3", "Load a snapshot with several threads");
+
+    if(snapshot_save(&table, SNAPSHOT_FILENAME) != OK) {
+        failed = true;
+    } else {
+        err = snapshot_loadParallel(&loaded, SNAPSHOT_FILENAME, 4);
+        copy = countryTable_find(&loaded, "Spain");
+        if(err != OK || loaded.size != 2 || copy == NULL || countryTable_find(&loaded, "Norway") == NULL ||
+                patientQueue_size(*countryTable_find(&loaded, "Norway")->patients) != 0) {
+            failed = true;
+        } else if(!patientQueue_compare(source->patients, copy->patients) ||
+                patientQueue_fingerprint(source->patients) != patientQueue_fingerprint(copy->patients) ||
+                patientQueue_findById(copy->patients, 2) == NULL || patientQueue_findById(copy->patients, 2)->lotID != 11 ||
+                copy->vbList->size != 2) {
+            failed = true;
+        }
+    }
+    countryTable_free(&loaded);
+    remove(SNAPSHOT_FILENAME);
+
+    if(failed) {
+        end_test(test_section, "EXT_SNAP_3", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_SNAP_3", true);
+    }
+
+    // Remove used memory
+    countryTable_free(&table);
+    countryTable_free(&loaded);
+    vaccine_free(&pfizer);
+
+    return passed;
+}
+
+// Check that two countries have the same patients and the same doses left in their batches
+static bool test_ext_sameDoses(tCountry* country1, tCountry* country2) {
+    tVaccinationBatchListNode *node1, *node2;
+
+    if(!patientQueue_compare(country1->patients, country2->patients) ||
+            patientQueue_fingerprint(country1->patients) != patientQueue_fingerprint(country2->patients) ||
+            country_getPatientsPerDoses(*country1, 1) != country_getPatientsPerDoses(*country2, 1) ||
+            country_getPatientsPerDoses(*country1, 2) != country_getPatientsPerDoses(*country2, 2)) {
+        return false;
+    }
+
+    node1 = country1->vbList->first;
+    node2 = country2->vbList->first;
+    while(node1 != NULL && node2 != NULL) {
+        if(node1->e.lotID != node2->e.lotID || node1->e.quantity != node2->e.quantity) {
+            return false;
+        }
+        node1 = node1->next;
+        node2 = node2->next;
+    }
+
+    return node1 == NULL && node2 == NULL;
+}
+
+// Run tests for the inoculation journal
+bool run_ext_journal(tTestSection* test_section) {
+    bool passed = true, failed = false;
+    tCountryTable table, loaded, removed;
+    tCountry country;
+    tCountry *source, *copy;
+    tVaccine pfizer, vaccine;
+    tVaccineBatch batch;
+    tPatient patient;
+    tJournal journal;
+    tJournalOptions options;
+    tJournalReport report;
+    tJournalReplayReport replay;
+    tJournalFrameHeader frame;
+    tError err;
+    char name[20];
+    FILE* file;
+    int i, c;
+
+    countryTable_init(&table);
+    countryTable_init(&loaded);
+    vaccine_init(&pfizer, PFIZER_VAC, RNA, PHASE3);
+
+    // Two countries, one of them with patients waiting and batches for their first doses and part of the second ones
+    for(c = 0; c < 2; c++) {
+        country_init(&country, c == 0 ? "Spain" : "Norway", c == 0);
+        countryTable_add(&table, &country);
+        country_free(&country);
+    }
+    source = countryTable_find(&table, "Spain");
+    vaccine_init(&vaccine, "JOURNAL-VAC", PEPTIDE, PHASE3);
+    country_addVaccine(source, pfizer);
+    country_addVaccine(source, vaccine);
+    vaccinationBatch_init(&batch, 10, &pfizer, 3 * NUMBER_QUEUE_PATIENTS / 2);
+    vaccineBatchList_append(source->vbList, batch);
+    vaccinationBatch_init(&batch, 11, &vaccine, NUMBER_QUEUE_PATIENTS / 4);
+    vaccineBatchList_append(source->vbList, batch);
+    for(i = 0; i < NUMBER_QUEUE_PATIENTS; i++) {
+        snprintf(name, 20, "%s_%04d", "Patient", i + 1);
+        patient_init(&patient, name, i + 1, NULL, 0, 0, (tPatientGroup)(i % PATIENT_GROUPS));
+        country_addPatient(source, patient);
+        patient_free(&patient);
+    }
+    vaccine_free(&vaccine);
+
+    // TEST 1: Replay the doses of a journal on the snapshot taken before them
+    failed = false;
+    start_test(test_section, "EXT_JRN_1", "Replay the doses of a journal on a snapshot");
+
+    journal_defaultOptions(&options);
+    options.syncFrames = 2;
+    if(snapshot_save(&table, SNAPSHOT_FILENAME) != OK || journal_open(&journal, JOURNAL_FILENAME, &options) != OK) {
+        failed = true;
+    } else {
+        err = countryTable_setJournal(&table, &journal);
+        if(err == OK)
+            err = country_inoculate_first_vaccine_ordered(source);
+        if(err == OK)
+            err = country_inoculate_second_vaccine(source);
+        journal_report(&journal, &report);
+        if(journal_close(&journal) != OK || err != OK) {
+            failed = true;
+        }
+        countryTable_setJournal(&table, NULL);
+
+        // Each round is one frame
+        if(report.doses == 0 || report.frames != 2 ||
+                report.doses != (unsigned long)(country_getPatientsPerDoses(*source, 1) + 2 * country_getPatientsPerDoses(*source, 2))) {
+            failed = true;
+        }
+
+        err = snapshot_load(&loaded, SNAPSHOT_FILENAME);
+        if(err == OK)
+            err = countryTable_replayJournal(&loaded, JOURNAL_FILENAME, &replay);
+        copy = countryTable_find(&loaded, "Spain");
+        if(err != OK || copy == NULL || replay.applied != report.doses || replay.skipped != 0 || replay.frames != 2 || replay.truncated) {
+            failed = true;
+        } else if(!test_ext_sameDoses(source, copy) || patientQueue_findById(copy->patients, 1)->vaccineId != patientQueue_findById(source->patients, 1)->vaccineId) {
+            failed = true;
+        }
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_JRN_1", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_JRN_1", true);
+    }
+
+    // TEST 2: Replay a journal with a frame left incomplete by a crash
+    failed = false;
+    start_test(test_section, "EXT_JRN_2", "Replay a journal with an incomplete frame");
+
+    if(countryTable_replayJournal(&loaded, "missing_" JOURNAL_FILENAME, &replay) != ERR_NOT_FOUND) {
+        failed = true;
+    }
+
+    // The header of a frame, and only part of its records
+    file = fopen(JOURNAL_FILENAME, "ab");
+    if(file == NULL) {
+        failed = true;
+    } else {
+        frame.magic = JOURNAL_FRAME_MAGIC;
+        frame.size = 10 * sizeof(tJournalDose);
+        frame.checksum = 0;
+        fwrite(&frame, sizeof(frame), 1, file);
+        fwrite(name, sizeof(name), 1, file);
+        fclose(file);
+
+        // The doses are given already
+        copy = countryTable_find(&loaded, "Spain");
+        err = countryTable_replayJournal(&loaded, JOURNAL_FILENAME, &replay);
+        if(err != OK || !replay.truncated || replay.applied != 0 || replay.skipped != report.doses || copy == NULL || !test_ext_sameDoses(source, copy)) {
+            failed = true;
+        }
+
+        // The complete frames are replayed on the snapshot
+        countryTable_free(&loaded);
+        countryTable_init(&loaded);
+        err = snapshot_load(&loaded, SNAPSHOT_FILENAME);
+        if(err == OK)
+            err = countryTable_replayJournal(&loaded, JOURNAL_FILENAME, &replay);
+        copy = countryTable_find(&loaded, "Spain");
+        if(err != OK || !replay.truncated || replay.applied != report.doses || copy == NULL || !test_ext_sameDoses(source, copy)) {
+            failed = true;
+        }
+    }
+    remove(JOURNAL_FILENAME);
+    remove(SNAPSHOT_FILENAME);
+
+    if(failed) {
+        end_test(test_section, "EXT_JRN_2", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_JRN_2", true);
+    }
+
+    // TEST 3: Replay the doses of a country after removing a country before it
+    failed = false;
+    start_test(test_section, "EXT_JRN_3", "Replay the doses of a country moved by a removal");
+
+    countryTable_init(&removed);
+    countryTable_free(&loaded);
+    countryTable_init(&loaded);
+    for(c = 0; c < 3; c++) {
+        country_init(&country, c == 0 ? "Austria" : (c == 1 ? "Belgium" : "Croatia"), true);
+        countryTable_add(&removed, &country);
+        country_free(&country);
+    }
+    source = countryTable_find(&removed, "Croatia");
+    country_addVaccine(source, pfizer);
+    vaccinationBatch_init(&batch, 20, &pfizer, 2 * NUMBER_STATS_PATIENTS);
+    vaccineBatchList_append(source->vbList, batch);
+    for(i = 0; i < NUMBER_STATS_PATIENTS; i++) {
+        snprintf(name, 20, "%s_%04d", "Patient", i + 1);
+        patient_init(&patient, name, i + 1, NULL, 0, 0, ANYONE_ELSE);
+        country_addPatient(source, patient);
+        patient_free(&patient);
+    }
+
+    if(snapshot_save(&removed, SNAPSHOT_FILENAME) != OK || journal_open(&journal, JOURNAL_FILENAME, NULL) != OK) {
+        failed = true;
+    } else {
+        // The countries after the removed one are moved, and keep writing to the journal
+        err = countryTable_setJournal(&removed, &journal);
+        country_init(&country, "Austria", true);
+        if(err == OK)
+            err = countryTable_remove(&removed, &country);
+        country_free(&country);
+        source = countryTable_find(&removed, "Croatia");
+        if(source == NULL || source->journal != &journal) {
+            failed = true;
+        } else {
+            if(err == OK)
+                err = country_inoculate_first_vaccine(source);
+            if(err == OK)
+                err = country_inoculate_second_vaccine(source);
+        }
+        journal_report(&journal, &report);
+        if(journal_close(&journal) != OK || err != OK || report.doses != 2 * NUMBER_STATS_PATIENTS) {
+            failed = true;
+        }
+        countryTable_setJournal(&removed, NULL);
+
+        err = snapshot_load(&loaded, SNAPSHOT_FILENAME);
+        if(err == OK)
+            err = countryTable_replayJournal(&loaded, JOURNAL_FILENAME, &replay);
+        copy = countryTable_find(&loaded, "Croatia");
+        if(err != OK || copy == NULL || source == NULL || replay.applied != report.doses || !test_ext_sameDoses(source, copy)) {
+            failed = true;
+        }
+    }
+    remove(JOURNAL_FILENAME);
+    remove(SNAPSHOT_FILENAME);
+
+    if(failed) {
+        end_test(test_section, "EXT_JRN_3", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_JRN_3", true);
+    }
+
+    // Remove used memory
+    countryTable_free(&table);
+    countryTable_free(&loaded);
+    countryTable_free(&removed);
+    vaccine_free(&pfizer);
+
+    return passed;
+}
+
+// Job of the thread pool tests: mark its slot as done
+static void test_ext_poolJob(void* arg) {
+    (*(int*)arg)++;
+}
+
+// Fill a table with countries of very different sizes, with second doses for only some of their patients
+static void test_ext_poolTable(tCountryTable* table) {
+    tCountry country;
+    tCountry* source;
+    tVaccine vaccines[2];
+    tVaccineBatch batch;
+    tPatient patient;
+    char name[20];
+    int i, c, patients;
+
+    vaccine_init(&vaccines[0], ASTRAZENECA_VAC, ADENOVIRUSES, PHASE3);
+    vaccine_init(&vaccines[1], PFIZER_VAC, RNA, PHASE3);
+    for(c = 0; c < NUMBER_POOL_COUNTRIES; c++) {
+        snprintf(name, 20, "Country_%02d", c);
+        country_init(&country, name, c % 2 == 0);
+        countryTable_add(table, &country);
+        country_free(&country);
+
+        source = countryTable_find(table, name);
+        patients = c == 0 ? NUMBER_QUEUE_PATIENTS : NUMBER_QUEUE_PATIENTS / (c + 2);
+        for(i = 0; i < patients; i++) {
+            snprintf(name, 20, "%s_%04d", "Patient", i + 1);
+            patient_init(&patient, name, i + 1, NULL, 0, 0, (tPatientGroup)((i + c) % PATIENT_GROUPS));
+            country_addPatient(source, patient);
+            patient_free(&patient);
+        }
+        for(i = 0; i < 3; i++) {
+            vaccinationBatch_init(&batch, i + 1, &vaccines[(i + c) % 2], patients / 2);
+            vaccineBatchList_append(source->vbList, batch);
+        }
+    }
+    vaccine_free(&vaccines[0]);
+    vaccine_free(&vaccines[1]);
+}
+
+// Run tests for the thread pool and the parallel inoculation rounds
+bool run_ext_threadPool(tTestSection* test_section) {
+    bool passed = true, failed = false;
+    tCountryTable serial, parallel;
+    tThreadPool pool;
+    tThreadPoolReport report;
+    int* done;
+    int i, c;
+
+    // TEST 1: Run jobs on a thread pool
+    failed = false;
+    start_test(test_section, "EXT_POOL_1", "Run jobs on a thread pool");
+
+    done = (int*)calloc(NUMBER_POOL_JOBS, sizeof(int));
+    if(done == NULL || threadPool_init(&pool, 4) != OK) {
+        failed = true;
+    } else {
+        for(i = 0; i < NUMBER_POOL_JOBS; i++) {
+            if(threadPool_submit(&pool, test_ext_poolJob, &done[i]) != OK) {
+                failed = true;
+            }
+        }
+        threadPool_wait(&pool);
+        threadPool_report(&pool, &report);
+        if(report.jobs != NUMBER_POOL_JOBS) {
+            failed = true;
+        }
+
+        // The pool can be used again after a wait
+        threadPool_submit(&pool, test_ext_poolJob, &done[0]);
+        threadPool_free(&pool);
+
+        for(i = 0; i < NUMBER_POOL_JOBS; i++) {
+            if(done[i] != (i == 0 ? 2 : 1)) {
+                failed = true;
+            }
+        }
+    }
+    free(done);
+
+    if(failed) {
+        end_test(test_section, "EXT_POOL_1", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_POOL_1", true);
+    }
+
+    // TEST 2: Inoculate all the countries of a table with many threads
+    failed = false;
+    start_test(test_section, "EXT_POOL_2", "Inoculate all the countries of a table with many threads");
+
+    countryTable_init(&serial);
+    countryTable_init(&parallel);
+    test_ext_poolTable(&serial);
+    test_ext_poolTable(&parallel);
+
+    if(countryTable_inoculate_all(&serial, 1) != OK || countryTable_inoculate_all(&parallel, 4) != OK) {
+        failed = true;
+    } else {
+        if(country_getPatientsPerDoses(serial.elements[0], 1) == 0 || country_getPatientsPerDoses(serial.elements[0], 2) == 0) {
+            failed = true;
+        }
+        for(c = 0; c < NUMBER_POOL_COUNTRIES; c++) {
+            if(!test_ext_sameDoses(&serial.elements[c], countryTable_find(&parallel, serial.elements[c].name))) {
+                failed = true;
+            }
+        }
+    }
+
+    // More threads than countries
+    if(countryTable_inoculate_all(&parallel, 2 * NUMBER_POOL_COUNTRIES) != OK || countryTable_inoculate_all(&serial, 1) != OK ||
+            !test_ext_sameDoses(&serial.elements[0], countryTable_find(&parallel, serial.elements[0].name))) {
+        failed = true;
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_POOL_2", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_POOL_2", true);
+    }
+
+    // Remove used memory
+    countryTable_free(&serial);
+    countryTable_free(&parallel);
+
+    return passed;
+}
+
+// Run tests for the statistics of a table of countries
+bool run_ext_tableStats(tTestSection* test_section) {
+    bool passed = true, failed = false;
+    tCountryTable table;
+    tCountryTableStats stats, serial;
+    tCountry country;
+    tCountry* added;
+    tVaccine vaccines[2];
+    tVaccineBatch batch;
+    tPatient patient;
+    tVaccineTec technology;
+    unsigned long patients, vaccinated, vaccinatedEU, pfizer;
+    unsigned long technologies[VACCINE_TECHNOLOGIES];
+    char name[20];
+    int i, c;
+
+    // Many countries, with a vaccine authorized in all of them and another one in half of them
+    countryTable_init(&table);
+    vaccine_init(&vaccines[0], ASTRAZENECA_VAC, ADENOVIRUSES, PHASE3);
+    vaccine_init(&vaccines[1], PFIZER_VAC, RNA, PHASE3);
+    for(c = 0; c < NUMBER_COUNTRIES; c++) {
+        snprintf(name, 20, "Country_%04d", c);
+        country_init(&country, name, c % 3 == 0);
+        countryTable_add(&table, &country);
+        country_free(&country);
+
+        added = countryTable_find(&table, name);
+        country_addVaccine(added, vaccines[1]);
+        if(c % 2 == 0) {
+            country_addVaccine(added, vaccines[0]);
+        }
+        for(i = 0; i < NUMBER_STATS_PATIENTS + c % 7; i++) {
+            snprintf(name, 20, "%s_%04d", "Patient", i + 1);
+            patient_init(&patient, name, i + 1, NULL, 0, 0, (tPatientGroup)((i + c) % PATIENT_GROUPS));
+            country_addPatient(added, patient);
+            patient_free(&patient);
+        }
+        for(i = 0; i < 2; i++) {
+            vaccinationBatch_init(&batch, i + 1, &vaccines[(i + c) % 2], c % 5 * NUMBER_STATS_PATIENTS / 4);
+            vaccineBatchList_append(added->vbList, batch);
+        }
+    }
+    countryTable_inoculate_all(&table, 1);
+
+    // TEST 1: Compute the statistics of a table with many threads
+    failed = false;
+    start_test(test_section, "EXT_STATS_1", "Compute the statistics of a table with many threads");
+
+    if(countryTable_stats(&table, 4, &stats) != OK || stats.countries != NUMBER_COUNTRIES) {
+        failed = true;
+    } else {
+        // The same results as the functions of each country
+        patients = vaccinated = vaccinatedEU = pfizer = 0;
+        memset(technologies, 0, sizeof(technologies));
+        for(c = 0; c < NUMBER_COUNTRIES; c++) {
+            added = &table.elements[c];
+            patients += patientQueue_size(*added->patients);
+            vaccinated += country_getPatientsPerDoses(*added, 2);
+            if(added->isEU) {
+                vaccinatedEU += country_getPatientsPerDoses(*added, 2);
+            }
+            pfizer += country_getPatientsPerVaccine(*added, vaccines[1]);
+            for(technology = NONE; technology <= RNA; technology++) {
+                technologies[technology] += country_getPatientsPerVaccineTechnology(*added, technology);
+            }
+            if(stats.coverage[c] != country_percentage_vaccinated(added)) {
+                failed = true;
+            }
+        }
+
+        if(stats.total.patients != patients || stats.total.vaccinated != vaccinated || stats.eu.vaccinated != vaccinatedEU ||
+                stats.eu.patients + stats.nonEU.patients != patients || stats.vaccines[PFIZER_VAC_ID] != pfizer ||
+                memcmp(stats.technologies, technologies, sizeof(technologies)) != 0 || vaccinated == 0 || vaccinated == patients ||
+                countryCoverage_percentage(&stats.total) != 100.0 * vaccinated / patients) {
+            failed = true;
+        }
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_STATS_1", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_STATS_1", true);
+    }
+
+    // TEST 2: Get the same statistics with one thread
+    failed = false;
+    start_test(test_section, "EXT_STATS_2", "Get the same statistics with one thread");
+
+    if(countryTable_stats(&table, 1, &serial) != OK) {
+        failed = true;
+    } else {
+        if(memcmp(&serial.total, &stats.total, sizeof(tCountryCoverage)) != 0 || memcmp(&serial.eu, &stats.eu, sizeof(tCountryCoverage)) != 0 ||
+                memcmp(&serial.nonEU, &stats.nonEU, sizeof(tCountryCoverage)) != 0 || serial.vaccinesCount != stats.vaccinesCount ||
+                memcmp(serial.vaccines, stats.vaccines, serial.vaccinesCount * sizeof(unsigned long)) != 0 ||
+                memcmp(serial.coverage, stats.coverage, serial.countries * sizeof(double)) != 0) {
+            failed = true;
+        }
+        countryTableStats_free(&serial);
+    }
+
+    // An empty table
+    countryTableStats_free(&stats);
+    countryTable_free(&table);
+    if(countryTable_stats(&table, 4, &stats) != OK || stats.total.patients != 0 || countryCoverage_percentage(&stats.total) != 0.0) {
+        failed = true;
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_STATS_2", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_STATS_2", true);
+    }
+
+    // Remove used memory
+    countryTableStats_free(&stats);
+    countryTable_free(&table);
+    vaccine_free(&vaccines[0]);
+    vaccine_free(&vaccines[1]);
+
+    return passed;
+}
+
+// Producer of the intake tests
+typedef struct {
+    tCountry* country;
+    int producer;
+    tError error;
+} tTestIntakeProducer;
+
+// Push NUMBER_INTAKE_PATIENTS patients, with ids that tell the producer and the order
+static void* test_ext_intakeProducer(void* arg) {
+    tTestIntakeProducer* producer = (tTestIntakeProducer*)arg;
+    tPatient patient;
+    char name[20];
+    int i;
+
+    producer->error = OK;
+    for(i = 0; i < NUMBER_INTAKE_PATIENTS && producer->error == OK; i++) {
+        snprintf(name, 20, "Patient_%d_%04d", producer->producer, i);
+        patient_init(&patient, name, producer->producer * NUMBER_INTAKE_PATIENTS + i + 1, NULL, 0, 0, (tPatientGroup)(i % PATIENT_GROUPS));
+        producer->error = patientIntake_push(producer->country->intake, &patient);
+        patient_free(&patient);
+    }
+
+    return NULL;
+}
+
+// Run tests for the intake of patients from many threads
+bool run_ext_patientIntake(tTestSection* test_section) {
+    bool passed = true, failed = false;
+    tCountryTable table;
+    tCountry country;
+    tCountry* moved;
+    tPatientIntake* intake;
+    tTestIntakeProducer producers[NUMBER_INTAKE_PRODUCERS];
+    pthread_t threads[NUMBER_INTAKE_PRODUCERS];
+    tPatientQueueIterator it;
+    const tPatient* p;
+    tPatient patient;
+    unsigned int count, total;
+    int last[NUMBER_INTAKE_PRODUCERS];
+    char name[20];
+    int i, producer;
+
+    // TEST 1: Drain the patients of an intake in the order they were pushed
+    failed = false;
+    start_test(test_section, "EXT_INTAKE_1", "Drain the patients of an intake in order");
+
+    country_init(&country, "Spain", true);
+    if(country_enableIntake(&country) != OK) {
+        failed = true;
+    } else {
+        if(country_drainIntake(&country, 0, &count) != OK || count != 0) {
+            failed = true;
+        }
+        for(i = 0; i < 10; i++) {
+            snprintf(name, 20, "%s_%04d", "Patient", i + 1);
+            patient_init(&patient, name, i + 1, i % 2 == 0 ? NULL : PFIZER_VAC, 7, i % 2, ADULT_OVER_55);
+            patientIntake_push(country.intake, &patient);
+            patient_free(&patient);
+        }
+
+        // Part of them, then the others
+        if(country_drainIntake(&country, 4, &count) != OK || count != 4 || patientQueue_size(*country.patients) != 4) {
+            failed = true;
+        }
+        if(country_drainIntake(&country, 0, &count) != OK || count != 6 || patientQueue_size(*country.patients) != 10 ||
+                country_getPatientsPerDoses(country, 0) != 5) {
+            failed = true;
+        }
+
+        i = 0;
+        patientQueue_iterator(country.patients, &it);
+        while((p = patientQueue_next(&it)) != NULL) {
+            snprintf(name, 20, "%s_%04d", "Patient", i + 1);
+            if(p->id != i + 1 || strcmp(p->name, name) != 0 || p->number_doses != i % 2 || (i % 2 == 1 && p->vaccineId != PFIZER_VAC_ID)) {
+                failed = true;
+            }
+            i++;
+        }
+
+        // Patients that are not drained are released with the country
+        patient_init(&patient, "Patient_left", 100, NULL, 0, 0, ANYONE_ELSE);
+        patientIntake_push(country.intake, &patient);
+        patient_free(&patient);
+    }
+    country_free(&country);
+
+    if(failed) {
+        end_test(test_section, "EXT_INTAKE_1", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_INTAKE_1", true);
+    }
+
+    // TEST 2: Drain an intake while many threads push patients
+    failed = false;
+    start_test(test_section, "EXT_INTAKE_2", "Drain an intake while many threads push patients");
+
+    country_init(&country, "Spain", true);
+    if(country_enableIntake(&country) != OK) {
+        failed = true;
+    } else {
+        for(producer = 0; producer < NUMBER_INTAKE_PRODUCERS; producer++) {
+            producers[producer].country = &country;
+            producers[producer].producer = producer;
+            if(pthread_create(&threads[producer], NULL, test_ext_intakeProducer, &producers[producer]) != 0) {
+                test_ext_intakeProducer(&producers[producer]);
+                threads[producer] = pthread_self();
+            }
+        }
+
+        // Drain in batches while the producers push
+        total = 0;
+        while(total < NUMBER_INTAKE_PRODUCERS * NUMBER_INTAKE_PATIENTS / 2) {
+            if(country_drainIntake(&country, 100, &count) != OK) {
+                failed = true;
+                break;
+            }
+            total += count;
+        }
+
+        for(producer = 0; producer < NUMBER_INTAKE_PRODUCERS; producer++) {
+            if(!pthread_equal(threads[producer], pthread_self())) {
+                pthread_join(threads[producer], NULL);
+            }
+            if(producers[producer].error != OK) {
+                failed = true;
+            }
+        }
+        if(country_drainIntake(&country, 0, &count) != OK || total + count != NUMBER_INTAKE_PRODUCERS * NUMBER_INTAKE_PATIENTS ||
+                patientQueue_size(*country.patients) != NUMBER_INTAKE_PRODUCERS * NUMBER_INTAKE_PATIENTS) {
+            failed = true;
+        }
+
+        // The patients of each producer keep their order
+        for(producer = 0; producer < NUMBER_INTAKE_PRODUCERS; producer++) {
+            last[producer] = -1;
+        }
+        patientQueue_iterator(country.patients, &it);
+        while((p = patientQueue_next(&it)) != NULL) {
+            producer = (p->id - 1) / NUMBER_INTAKE_PATIENTS;
+            i = (p->id - 1) % NUMBER_INTAKE_PATIENTS;
+            if(producer >= NUMBER_INTAKE_PRODUCERS || i != last[producer] + 1) {
+                failed = true;
+                break;
+            }
+            last[producer] = i;
+        }
+        if(patientQueue_findById(country.patients, NUMBER_INTAKE_PRODUCERS * NUMBER_INTAKE_PATIENTS) == NULL) {
+            failed = true;
+        }
+    }
+    country_free(&country);
+
+    if(failed) {
+        end_test(test_section, "EXT_INTAKE_2", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_INTAKE_2", true);
+    }
+
+    // TEST 3: Keep the intake of a country moved by a removal
+    failed = false;
+    start_test(test_section, "EXT_INTAKE_3", "Keep the intake of a country moved by a removal");
+
+    countryTable_init(&table);
+    country_init(&country, "Spain", true);
+    countryTable_add(&table, &country);
+    country_free(&country);
+    country_init(&country, "France", true);
+    countryTable_add(&table, &country);
+    moved = countryTable_find(&table, "France");
+    if(moved == NULL || country_enableIntake(moved) != OK) {
+        failed = true;
+    } else {
+        // The producers keep the intake they got before the removal
+        intake = moved->intake;
+        for(i = 0; i < 10; i++) {
+            if(i == 5 && countryTable_remove(&table, countryTable_find(&table, "Spain")) != OK) {
+                failed = true;
+            }
+            snprintf(name, 20, "%s_%04d", "Patient", i + 1);
+            patient_init(&patient, name, i + 1, NULL, 0, 0, ANYONE_ELSE);
+            patientIntake_push(intake, &patient);
+            patient_free(&patient);
+        }
+        moved = countryTable_find(&table, "France");
+        if(moved == NULL || moved->intake != intake || country_drainIntake(moved, 0, &count) != OK || count != 10 ||
+                patientQueue_size(*moved->patients) != 10) {
+            failed = true;
+        }
+    }
+    country_free(&country);
+    countryTable_free(&table);
+
+    if(failed) {
+        end_test(test_section, "EXT_INTAKE_3", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_INTAKE_3", true);
+    }
+
+    return passed;
+}
+
+// Run tests for the synthetic population generator
+bool run_ext_generator(tTestSection* test_section) {
+    bool passed = true, failed = false;
+    tGeneratorOptions options;
+    tGenerator generator1, generator2;
+    tCountryTable table1, table2;
+    tCountry *country1, *country2;
+    tCsvLoadReport report;
+    tPatient patient1, patient2;
+    tVaccineBatch batch1, batch2;
+    unsigned int countries[64];
+    unsigned int groups[PATIENT_GROUPS];
+    char name[GENERATOR_NAME_LENGTH + 1];
+    char countryName[GENERATOR_COUNTRY_NAME_LENGTH];
+    unsigned int c1, c2, i;
+    size_t length;
+
+    // TEST 1: Generate the same data from the same seed, with the skew of the options
+    failed = false;
+    start_test(test_section, "EXT_GEN_1", "Generate the same data from the same seed, with the skew of the options");
+
+    generator_defaultOptions(&options);
+    if(generator_init(&generator1, &options) != OK) {
+        failed = true;
+    } else if(generator_init(&generator2, &options) != OK) {
+        failed = true;
+        generator_free(&generator1);
+    } else {
+        memset(countries, 0, sizeof(countries));
+        memset(groups, 0, sizeof(groups));
+        for(i = 0; i < NUMBER_GEN_PATIENTS && !failed; i++) {
+            c1 = generator_nextPatient(&generator1, &patient1);
+            strcpy(name, patient1.name);
+            c2 = generator_nextPatient(&generator2, &patient2);
+            length = strlen(name);
+            if(c1 != c2 || c1 >= options.countries || patient1.id != patient2.id || patient1.group != patient2.group ||
+                    strcmp(name, patient2.name) != 0 || length < options.nameLengthMin || length > options.nameLengthMax ||
+                    name[0] < 'A' || name[0] > 'Z' || patient1.number_doses != 0 || patient1.vaccine != NULL) {
+                failed = true;
+            } else {
+                countries[c1]++;
+                groups[patient1.group]++;
+                if(patient1.id != (int)countries[c1]) {
+                    failed = true;
+                }
+            }
+        }
+        for(i = 0; i < NUMBER_GEN_BATCHES && !failed; i++) {
+            c1 = generator_nextBatch(&generator1, &batch1);
+            c2 = generator_nextBatch(&generator2, &batch2);
+            if(c1 != c2 || batch1.lotID != batch2.lotID || batch1.vaccine != batch2.vaccine || batch1.quantity != batch2.quantity ||
+                    batch1.vaccine == NULL || batch1.vaccine->id >= GENERATOR_VACCINES ||
+                    batch1.quantity < (int)options.lotSizeMin || batch1.quantity > (int)options.lotSizeMax) {
+                failed = true;
+            }
+        }
+
+        // The first countries are the largest ones, and the groups follow their weights
+        if(countries[0] <= countries[1] || countries[1] <= countries[options.countries - 1] ||
+                countries[0] < NUMBER_GEN_PATIENTS / 6 || countries[0] > NUMBER_GEN_PATIENTS / 4 ||
+                groups[ANYONE_ELSE] < 40 * NUMBER_GEN_PATIENTS / 100 || groups[ANYONE_ELSE] > 46 * NUMBER_GEN_PATIENTS / 100 ||
+                groups[HEALTH_WORKER] < 4 * NUMBER_GEN_PATIENTS / 100 || groups[HEALTH_WORKER] > 6 * NUMBER_GEN_PATIENTS / 100) {
+            failed = true;
+        }
+        generator_free(&generator1);
+        generator_free(&generator2);
+
+        // Another seed gives other data
+        options.seed++;
+        if(generator_init(&generator1, &options) != OK) {
+            failed = true;
+        } else {
+            generator_defaultOptions(&options);
+            generator_init(&generator2, &options);
+            generator_nextPatient(&generator1, &patient1);
+            strcpy(name, patient1.name);
+            generator_nextPatient(&generator2, &patient2);
+            if(strcmp(name, patient2.name) == 0) {
+                failed = true;
+            }
+            generator_free(&generator1);
+            generator_free(&generator2);
+        }
+    }
+
+    // Wrong options are rejected
+    generator_defaultOptions(&options);
+    options.nameLengthMax = GENERATOR_NAME_LENGTH + 1;
+    if(generator_init(&generator1, &options) != ERR_INVALID) {
+        failed = true;
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_GEN_1", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_GEN_1", true);
+    }
+
+    // TEST 2: Load a generated file as the generated table
+    failed = false;
+    start_test(test_section, "EXT_GEN_2", "Load a generated file as the generated table");
+
+    countryTable_init(&table1);
+    countryTable_init(&table2);
+    generator_defaultOptions(&options);
+    options.countries = NUMBER_GEN_COUNTRIES;
+    if(generator_init(&generator1, &options) != OK || generator_init(&generator2, &options) != OK) {
+        failed = true;
+    } else {
+        if(generator_fillTable(&generator1, &table1, NUMBER_GEN_PATIENTS, NUMBER_GEN_BATCHES) != OK ||
+                generator_writeFile(&generator2, GENERATOR_FILENAME, NUMBER_GEN_PATIENTS, NUMBER_GEN_BATCHES) != OK ||
+                csvLoader_loadFile(&table2, GENERATOR_FILENAME, NULL, &report) != OK) {
+            failed = true;
+        } else if(report.rows[CSV_COUNTRY] != NUMBER_GEN_COUNTRIES || report.rows[CSV_VACCINE] != NUMBER_GEN_COUNTRIES * GENERATOR_VACCINES ||
+                report.rows[CSV_PATIENT] != NUMBER_GEN_PATIENTS || report.rows[CSV_BATCH] != NUMBER_GEN_BATCHES || report.rejected != 0 ||
+                countryTable_size(&table1) != NUMBER_GEN_COUNTRIES || countryTable_size(&table2) != NUMBER_GEN_COUNTRIES) {
+            failed = true;
+        }
+
+        // Both tables get the same doses
+        for(i = 0; i < NUMBER_GEN_COUNTRIES && !failed; i++) {
+            generator_countryName(i, countryName);
+            country1 = countryTable_find(&table1, countryName);
+            country2 = countryTable_find(&table2, countryName);
+            if(country1 == NULL || country2 == NULL || country1->isEU != country2->isEU ||
+                    country1->isEU != generator_isEU(&generator1, i) || vaccineTable_size(country1->authVaccines) != GENERATOR_VACCINES ||
+                    !test_ext_sameDoses(country1, country2)) {
+                failed = true;
+            } else {
+                country_inoculate_first_vaccine(country1);
+                country_inoculate_first_vaccine(country2);
+                if(country_getPatientsPerDoses(*country1, 1) == 0 || !test_ext_sameDoses(country1, country2)) {
+                    failed = true;
+                }
+            }
+        }
+
+        generator_free(&generator1);
+        generator_free(&generator2);
+        remove(GENERATOR_FILENAME);
+    }
+    countryTable_free(&table1);
+    countryTable_free(&table2);
+
+    if(failed) {
+        end_test(test_section, "EXT_GEN_2", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_GEN_2", true);
+    }
+
+    return passed;
+}
+
+// Run tests for the instrumentation counters
+bool run_ext_instrument(tTestSection* test_section) {
+    bool passed = true, failed = false;
+    tInstrumentSnapshot before, after, diff;
+    tCountry country;
+    tVaccine vaccine;
+    tVaccineBatch batch;
+    tPatient patient;
+    tPatient* dequeued;
+    char name[20];
+    char text[4096];
+    size_t length;
+    FILE* fout;
+    int i;
+
+    // TEST 1: Count the calls and the memory of a round
+    failed = false;
+    start_test(test_section, "EXT_INSTR_1", "Count the calls and the memory of a round");
+
+    instrument_snapshot(&before);
+    country_init(&country, "Spain", true);
+    vaccine_init(&vaccine, PFIZER_VAC, RNA, PHASE3);
+    country_addVaccine(&country, vaccine);
+    vaccinationBatch_init(&batch, 1, &vaccine, NUMBER_INSTRUMENT_PATIENTS);
+    vaccineBatchList_append(country.vbList, batch);
+    for(i = 0; i < NUMBER_INSTRUMENT_PATIENTS; i++) {
+        snprintf(name, 20, "Patient_%04d", i + 1);
+        patient_init(&patient, name, i + 1, NULL, 0, 0, ADULT_OVER_55);
+        country_addPatient(&country, patient);
+        patient_free(&patient);
+    }
+    if(country_inoculate_first_vaccine(&country) != OK ||
+            country_getPatientsPerDoses(country, 1) != NUMBER_INSTRUMENT_PATIENTS) {
+        failed = true;
+    }
+    dequeued = patientQueue_dequeue(country.patients);
+    if(dequeued == NULL) {
+        failed = true;
+    } else {
+        patientQueue_release(country.patients, dequeued);
+    }
+    country_free(&country);
+    vaccine_free(&vaccine);
+    instrument_snapshot(&after);
+    instrument_diff(&before, &after, &diff);
+
+    // The queue is emptied with patientQueue_dequeue when the country is released
+    if(instrument_enabled()) {
+        if(diff.calls[INSTRUMENT_QUEUE_ENQUEUE] != NUMBER_INSTRUMENT_PATIENTS || diff.calls[INSTRUMENT_QUEUE_DEQUEUE] != NUMBER_INSTRUMENT_PATIENTS ||
+                diff.calls[INSTRUMENT_COUNTRY_INOCULATE_FIRST] != 1 || diff.calls[INSTRUMENT_COUNTRY_INOCULATE_SECOND] != 0 ||
+                diff.calls[INSTRUMENT_BATCH_INOCULATE_FIRST] != NUMBER_INSTRUMENT_PATIENTS ||
+                diff.calls[INSTRUMENT_FREE] == 0 || instrumentSnapshot_allocations(&diff) == 0 || diff.bytes == 0) {
+            failed = true;
+        }
+    } else {
+        // Without UOC_INSTRUMENT nothing is counted
+        if(instrumentSnapshot_allocations(&after) != 0 || after.calls[INSTRUMENT_QUEUE_ENQUEUE] != 0 || after.bytes != 0) {
+            failed = true;
+        }
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_INSTR_1", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_INSTR_1", true);
+    }
+
+    // TEST 2: Reset the counters and export them
+    failed = false;
+    start_test(test_section, "EXT_INSTR_2", "Reset the counters and export them");
+
+    instrument_reset();
+    instrument_snapshot(&after);
+    for(i = 0; i < INSTRUMENT_COUNTERS; i++) {
+        if(after.calls[i] != 0 || after.nanoseconds[i] != 0) {
+            failed = true;
+        }
+    }
+    if(after.bytes != 0 || strcmp(instrument_name(INSTRUMENT_QUEUE_DEQUEUE), "patientQueue_dequeue") != 0) {
+        failed = true;
+    }
+
+    fout = tmpfile();
+    if(fout == NULL) {
+        failed = true;
+    } else {
+        instrumentSnapshot_export(&after, fout);
+        rewind(fout);
+        length = fread(text, 1, sizeof(text) - 1, fout);
+        text[length] = '\0';
+        if(strstr(text, instrument_enabled() ? "\"enabled\": true" : "\"enabled\": false") == NULL ||
+                strstr(text, "{ \"function\": \"malloc\", \"calls\": 0, \"nanoseconds\": 0 }") == NULL ||
+                strstr(text, "\"function\": \"vaccineBatchList_swap\"") == NULL) {
+            failed = true;
+        }
+        fclose(fout);
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_INSTR_2", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_INSTR_2", true);
+    }
+
+    return passed;
+}
+
+// Fill a table of countries with the generator and give a round of doses to it
+static tError test_ext_fillAllocatorTable(tCountryTable* table) {
+    tGeneratorOptions options;
+    tGenerator generator;
+    tError error;
+
+    generator_defaultOptions(&options);
+    options.countries = NUMBER_GEN_COUNTRIES;
+    error = generator_init(&generator, &options);
+    if(error != OK)
+        return error;
+
+    error = generator_fillTable(&generator, table, NUMBER_ALLOC_PATIENTS, NUMBER_ALLOC_BATCHES);
+    if(error == OK)
+        error = countryTable_inoculate_all(table, NUMBER_ALLOC_THREADS);
+    generator_free(&generator);
+
+    return error;
+}
+
+// Tell if two tables filled with test_ext_fillAllocatorTable got the same doses
+static bool test_ext_sameTables(tCountryTable* table1, tCountryTable* table2) {
+    unsigned int i;
+
+    if(countryTable_size(table1) != countryTable_size(table2)) {
+        return false;
+    }
+    for(i = 0; i < countryTable_size(table1); i++) {
+        if(!test_ext_sameDoses(&table1->elements[i], &table2->elements[i])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Call the functions of a country of a table without the allocator of the table entered
+static tError test_ext_useCountry(tCountry* country) {
+    tVaccine vaccine;
+    tPatient patient;
+    tPatient* dequeued;
+    unsigned int count;
+    char name[20];
+    tError error;
+    int i;
+
+    vaccine_init(&vaccine, PFIZER_VAC, RNA, PHASE3);
+    error = country_addVaccine(country, vaccine);
+    vaccine_free(&vaccine);
+
+    for(i = 0; error == OK && i < NUMBER_ALLOC_PATIENTS; i++) {
+        snprintf(name, 20, "Patient_%04d", i + 1);
+        patient_init(&patient, name, i + 1, NULL, 0, 0, (tPatientGroup)(i % PATIENT_GROUPS));
+        error = country_addPatient(country, patient);
+        patient_free(&patient);
+    }
+
+    // The nodes of the intake are released by the thread that drains it
+    if(error == OK)
+        error = country_enableIntake(country);
+    for(i = 0; error == OK && i < 10; i++) {
+        snprintf(name, 20, "Intake_%04d", i + 1);
+        patient_init(&patient, name, NUMBER_ALLOC_PATIENTS + i + 1, NULL, 0, 0, ANYONE_ELSE);
+        error = patientIntake_push(country->intake, &patient);
+        patient_free(&patient);
+    }
+    if(error == OK)
+        error = country_drainIntake(country, 5, &count);
+
+    if(error == OK)
+        error = country_inoculate_first_vaccine_ordered(country);
+    if(error == OK) {
+        dequeued = patientQueue_dequeue(country->patients);
+        if(dequeued == NULL)
+            error = ERR_NOT_FOUND;
+        patientQueue_release(country->patients, dequeued);
+    }
+
+    return error;
+}
+
+// Run tests for the allocators of the library
+bool run_ext_allocator(tTestSection* test_section) {
+    bool passed = true, failed = false;
+    tCountingAllocator counting;
+    tBumpAllocator bump;
+    tAllocator allocator;
+    tCountryTable reference, table;
+    tCountry country;
+    char *block1, *block2, *block3;
+    unsigned long allocations;
+    int i;
+
+    // The tables of the allocators get the same doses as a table with the allocator of the thread
+    countryTable_init(&reference);
+    if(test_ext_fillAllocatorTable(&reference) != OK) {
+        passed = false;
+    }
+
+    // TEST 1: Give the memory of a table with a counting allocator
+    failed = false;
+    start_test(test_section, "EXT_ALLOC_1", "Give the memory of a table with a counting allocator");
+
+    countingAllocator_init(&counting, NULL);
+    countingAllocator_allocator(&counting, &allocator);
+    countryTable_init(&table);
+    if(countryTable_setAllocator(&table, &allocator) != OK || test_ext_fillAllocatorTable(&table) != OK ||
+            !test_ext_sameTables(&reference, &table) || countingAllocator_live(&counting) == 0 ||
+            counting.bytes < NUMBER_ALLOC_PATIENTS * sizeof(tPatient)) {
+        failed = true;
+    }
+
+    // The allocator of a table with countries can not change
+    if(countryTable_setAllocator(&table, NULL) != ERR_INVALID) {
+        failed = true;
+    }
+
+    // All the blocks of the table go back to its allocator, from any thread
+    countryTable_free(&table);
+    if(countingAllocator_live(&counting) != 0) {
+        failed = true;
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_ALLOC_1", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_ALLOC_1", true);
+    }
+
+    // TEST 2: Give the memory of a table with a bump allocator
+    failed = false;
+    start_test(test_section, "EXT_ALLOC_2", "Give the memory of a table with a bump allocator");
+
+    if(bumpAllocator_init(&bump, 4096) != OK) {
+        failed = true;
+    } else {
+        bumpAllocator_allocator(&bump, &allocator);
+
+        // The last block grows in place, the others are copied
+        block1 = (char*)allocator.alloc(allocator.context, 24);
+        for(i = 0; i < 24; i++) {
+            block1[i] = (char)i;
+        }
+        if(allocator.realloc(allocator.context, block1, 100) != block1) {
+            failed = true;
+        }
+        block2 = (char*)allocator.alloc(allocator.context, 16);
+        block3 = (char*)allocator.realloc(allocator.context, block1, 200);
+        if(block2 == NULL || block3 == NULL || block3 == block1 || ((uintptr_t)block3 & 15) != 0) {
+            failed = true;
+        } else {
+            for(i = 0; i < 24; i++) {
+                if(block3[i] != (char)i) {
+                    failed = true;
+                }
+            }
+
+            // Only the last block is given back
+            allocator.free(allocator.context, block3);
+            if(allocator.alloc(allocator.context, 8) != block3) {
+                failed = true;
+            }
+        }
+
+        // Blocks larger than a chunk get a chunk of their own
+        block1 = (char*)allocator.alloc(allocator.context, 10000);
+        if(block1 == NULL) {
+            failed = true;
+        } else {
+            memset(block1, 0, 10000);
+        }
+
+        countryTable_init(&table);
+        if(countryTable_setAllocator(&table, &allocator) != OK || test_ext_fillAllocatorTable(&table) != OK ||
+                !test_ext_sameTables(&reference, &table)) {
+            failed = true;
+        }
+        countryTable_free(&table);
+        bumpAllocator_free(&bump);
+    }
+
+    if(failed) {
+        end_test(test_section, "EXT_ALLOC_2", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_ALLOC_2", true);
+    }
+
+    // TEST 3: Keep the allocator of the table in the functions of its countries
+    failed = false;
+    start_test(test_section, "EXT_ALLOC_3", "Keep the allocator of the table in the functions of its countries");
+
+    countingAllocator_init(&counting, NULL);
+    countingAllocator_allocator(&counting, &allocator);
+    countryTable_init(&table);
+    country_init(&country, "Spain", true);
+    if(countryTable_setAllocator(&table, &allocator) != OK || countryTable_add(&table, &country) != OK) {
+        failed = true;
+    } else {
+        allocations = counting.allocations;
+        if(test_ext_useCountry(countryTable_find(&table, "Spain")) != OK ||
+                counting.allocations < allocations + NUMBER_ALLOC_PATIENTS ||
+                patientQueue_size(*countryTable_find(&table, "Spain")->patients) != NUMBER_ALLOC_PATIENTS + 4) {
+            failed = true;
+        }
+    }
+    countryTable_free(&table);
+    if(countingAllocator_live(&counting) != 0) {
+        failed = true;
+    }
+
+    // The blocks of a bump allocator can not go back to malloc
+    if(bumpAllocator_init(&bump, 0) != OK) {
+        failed = true;
+    } else {
+        bumpAllocator_allocator(&bump, &allocator);
+        countryTable_init(&table);
+        if(countryTable_setAllocator(&table, &allocator) != OK || countryTable_add(&table, &country) != OK ||
+                test_ext_useCountry(countryTable_find(&table, "Spain")) != OK) {
+            failed = true;
+        }
+        countryTable_free(&table);
+        bumpAllocator_free(&bump);
+    }
+    country_free(&country);
+
+    if(failed) {
+        end_test(test_section, "EXT_ALLOC_3", false);
+        passed = false;
+    } else {
+        end_test(test_section, "EXT_ALLOC_3", true);
+    }
+
+    countryTable_free(&reference);
+
+    return passed;
+}
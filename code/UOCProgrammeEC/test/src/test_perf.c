@@ -0,0 +1,239 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include "test_perf.h"
+#include "country.h"
+#include "vaccine.h"
+#include "patient.h"
+#include "vaccinationBatch.h"
+
+// Budget of each performance test. The time leaves room for the builds with sanitizers and the
+// other allocators. The table of countries grows one element at a time, so it has fewer elements.
+// The rounds of inoculation are measured apart: they only count the first vaccine given and size
+// the priority queue of the ordered rounds once per group
+#define PERF_MAX_SECONDS 5.0
+#define PERF_MAX_ALLOCATIONS 400000
+#define PERF_MAX_PHASE_ALLOCATIONS (PATIENT_GROUPS + 1)
+#define NUMBER_PERF_COUNTRIES 2000
+#define NUMBER_PERF_PATIENTS 100000
+#define NUMBER_PERF_BATCHES 100
+
+// Run all the performance tests
+bool run_perf(tTestSuite* test_suite) {
+    bool ok = true;
+    tTestSection* section = NULL;
+
+    assert(test_suite != NULL);
+
+    testSuite_addPerformanceSection(test_suite, "PERF", "Performance tests for PR1, PR2 and PR3 paths", PERF_MAX_SECONDS, PERF_MAX_ALLOCATIONS);
+
+    section = testSuite_getSection(test_suite, "PERF");
+    assert(section != NULL);
+    testSection_setPhaseBudget(section, PERF_MAX_PHASE_ALLOCATIONS);
+
+    ok = run_perf_countryTable(section) && ok;
+    ok = run_perf_patientQueue(section) && ok;
+    ok = run_perf_inoculate(section) && ok;
+
+    return ok;
+}
+
+// Run the performance tests of the table of countries of PR1
+bool run_perf_countryTable(tTestSection* test_section) {
+    bool passed = true, failed = false;
+    tCountryTable table;
+    tCountry country;
+    tVaccine vaccine;
+    char name[20];
+    int i;
+
+    // TEST 1: Add, find and authorize many countries in a table
+    failed = false;
+    start_test(test_section, "PERF_1", "Add, find and authorize many countries in a table");
+
+    countryTable_init(&table);
+    vaccine_init(&vaccine, PFIZER_VAC, RNA, PHASE3);
+    for(i = 0; i < NUMBER_PERF_COUNTRIES && !failed; i++) {
+        snprintf(name, 20, "Country_%05d", i);
+        country.name = name;
+        country.isEU = (i % 2) == 0;
+        if(countryTable_add(&table, &country) != OK) {
+            failed = true;
+        }
+    }
+    for(i = 0; i < NUMBER_PERF_COUNTRIES && !failed; i++) {
+        snprintf(name, 20, "Country_%05d", i);
+        if(countryTable_find(&table, name) == NULL || countryTable_addVaccine(&table, name, vaccine) != OK) {
+            failed = true;
+        }
+    }
+    if(countryTable_size(&table) != NUMBER_PERF_COUNTRIES || countryTable_num_authorized(&table) != NUMBER_PERF_COUNTRIES) {
+        failed = true;
+    }
+    countryTable_free(&table);
+    vaccine_free(&vaccine);
+
+    if(failed) {
+        end_test(test_section, "PERF_1", false);
+        passed = false;
+    } else {
+        end_test(test_section, "PERF_1", true);
+    }
+
+    return passed;
+}
+
+// Run the performance tests of the queue of patients of PR2
+bool run_perf_patientQueue(tTestSection* test_section) {
+    bool passed = true, failed = false;
+    tPatientQueue queue;
+    tPatient patient;
+    tPatient* dequeued;
+    char name[20];
+    int i;
+
+    // TEST 2: Enqueue, find and dequeue many patients
+    failed = false;
+    start_test(test_section, "PERF_2", "Enqueue, find and dequeue many patients");
+
+    // The queues of the countries find their patients with the index of ids
+    if(patientQueue_create(&queue) != OK || patientQueue_enableIdIndex(&queue) != OK) {
+        failed = true;
+    }
+    for(i = 0; i < NUMBER_PERF_PATIENTS && !failed; i++) {
+        snprintf(name, 20, "Patient_%06d", i + 1);
+        patient_init(&patient, name, i + 1, NULL, 0, 0, ANYONE_ELSE);
+        if(patientQueue_enqueue(&queue, patient) != OK) {
+            failed = true;
+        }
+        patient_free(&patient);
+    }
+    for(i = 0; i < NUMBER_PERF_PATIENTS && !failed; i += 97) {
+        if(patientQueue_findById(&queue, i + 1) == NULL) {
+            failed = true;
+        }
+    }
+    for(i = 0; i < NUMBER_PERF_PATIENTS && !failed; i++) {
+        dequeued = patientQueue_dequeue(&queue);
+        if(dequeued == NULL) {
+            failed = true;
+        } else {
+            if(dequeued->id != i + 1) {
+                failed = true;
+            }
+            patientQueue_release(&queue, dequeued);
+        }
+    }
+    if(!failed && !patientQueue_empty(queue)) {
+        failed = true;
+    }
+    patientQueue_free(&queue);
+
+    if(failed) {
+        end_test(test_section, "PERF_2", false);
+        passed = false;
+    } else {
+        end_test(test_section, "PERF_2", true);
+    }
+
+    return passed;
+}
+
+// Run the performance tests of the inoculation of PR3
+bool run_perf_inoculate(tTestSection* test_section) {
+    bool passed = true, failed = false;
+    tCountry country;
+    tVaccine vaccine;
+    tVaccineBatch batch;
+    tPatient patient;
+    char name[20];
+    int i;
+
+    // TEST 3: Give the two doses to many patients of a country
+    failed = false;
+    start_test(test_section, "PERF_3", "Give the two doses to many patients of a country");
+
+    country_init(&country, "Spain", true);
+    vaccine_init(&vaccine, PFIZER_VAC, RNA, PHASE3);
+    country_addVaccine(&country, vaccine);
+    for(i = 0; i < NUMBER_PERF_BATCHES && !failed; i++) {
+        vaccinationBatch_init(&batch, i + 1, &vaccine, 2 * NUMBER_PERF_PATIENTS / NUMBER_PERF_BATCHES);
+        if(vaccineBatchList_append(country.vbList, batch) != OK) {
+            failed = true;
+        }
+    }
+    for(i = 0; i < NUMBER_PERF_PATIENTS && !failed; i++) {
+        snprintf(name, 20, "Patient_%06d", i + 1);
+        patient_init(&patient, name, i + 1, NULL, 0, 0, ADULT_OVER_55);
+        if(country_addPatient(&country, patient) != OK) {
+            failed = true;
+        }
+        patient_free(&patient);
+    }
+    start_phase(test_section, "PERF_3");
+    if(failed || country_inoculate_first_vaccine(&country) != OK ||
+            country_getPatientsPerDoses(country, 1) != NUMBER_PERF_PATIENTS ||
+            country_inoculate_second_vaccine(&country) != OK ||
+            country_getPatientsPerDoses(country, 2) != NUMBER_PERF_PATIENTS) {
+        failed = true;
+    }
+    end_phase(test_section, "PERF_3");
+    country_free(&country);
+    vaccine_free(&vaccine);
+
+    if(failed) {
+        end_test(test_section, "PERF_3", false);
+        passed = false;
+    } else {
+        end_test(test_section, "PERF_3", true);
+    }
+
+    // TEST 4: Give the first dose by priority and by arrival to many patients of a chunked country
+    failed = false;
+    start_test(test_section, "PERF_4", "Give the first dose by priority and by arrival to a chunked country");
+
+    // The chunked queue keeps the index of ids of the country
+    country_init(&country, "Spain", true);
+    vaccine_init(&vaccine, PFIZER_VAC, RNA, PHASE3);
+    country_addVaccine(&country, vaccine);
+    if(country_useChunks(&country) != OK || !country.patients->ids.enabled) {
+        failed = true;
+    }
+    for(i = 0; i < NUMBER_PERF_PATIENTS && !failed; i++) {
+        snprintf(name, 20, "Patient_%06d", i + 1);
+        patient_init(&patient, name, i + 1, NULL, 0, 0, (tPatientGroup)(i % PATIENT_GROUPS));
+        if(country_addPatient(&country, patient) != OK) {
+            failed = true;
+        }
+        patient_free(&patient);
+    }
+
+    // A quarter of the patients by priority, another quarter by arrival and the rest by priority
+    for(i = 0; i < 3 && !failed; i++) {
+        vaccinationBatch_init(&batch, i + 1, &vaccine, (i == 2 ? 2 : 1) * NUMBER_PERF_PATIENTS / 4);
+        if(vaccineBatchList_append(country.vbList, batch) != OK) {
+            failed = true;
+        }
+        start_phase(test_section, "PERF_4");
+        if(failed || (i == 1 ? country_inoculate_first_vaccine(&country) : country_inoculate_first_vaccine_ordered(&country)) != OK ||
+                country_getPatientsPerDoses(country, 1) != (i == 2 ? 4 : i + 1) * NUMBER_PERF_PATIENTS / 4) {
+            failed = true;
+        }
+        end_phase(test_section, "PERF_4");
+    }
+    if(!failed && !patientPriorityQueue_empty(country.waiting)) {
+        failed = true;
+    }
+    country_free(&country);
+    vaccine_free(&vaccine);
+
+    if(failed) {
+        end_test(test_section, "PERF_4", false);
+        passed = false;
+    } else {
+        end_test(test_section, "PERF_4", true);
+    }
+
+    return passed;
+}
@@ -16,4 +16,10 @@ void run_all(tTestSuite* test_suite) {
     
     // Run tests for PR3
     run_pr3(test_suite);
+
+    // Run tests for the library extensions
+    run_ext(test_suite);
+
+    // Run the performance tests
+    run_perf(test_suite);
 }
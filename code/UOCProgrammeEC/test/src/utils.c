@@ -2,6 +2,7 @@
 #include <assert.h>
 #include <string.h>
 #include "utils.h"
+#include "instrument.h"
 
 // Initialize a test Suite
 void testSuite_init(tTestSuite* object) {
@@ -35,6 +36,13 @@ void testSuite_addSection(tTestSuite* object, const char* code, const char* titl
     testSection_init(&(object->sections[object->numSections - 1]), code, title);
 }
 
+// Add a performance test Section, with the budget of each test. 0 means no budget
+void testSuite_addPerformanceSection(tTestSuite* object, const char* code, const char* title, double maxSeconds, unsigned long long maxAllocations) {
+    assert(object != NULL);
+    testSuite_addSection(object, code, title);
+    testSection_setBudget(&(object->sections[object->numSections - 1]), maxSeconds, maxAllocations);
+}
+
 // Add a test
 void testSuite_addTest(tTestSuite* object, const char* section_code, const char* code, const char* description, tTestResult result) {
     tTestSection* section = NULL;
@@ -117,6 +125,20 @@ void testSuite_getStats(tTestSuite* object, int* total, int* passed, int* failed
     }
 }
 
+// Get the wall-clock time of all the tests of the suite, in seconds
+double testSuite_getSeconds(tTestSuite* object) {
+    int i;
+    double seconds;
+
+    assert(object != NULL);
+
+    seconds = 0.0;
+    for(i = 0; i < object->numSections; i++) {
+        seconds += testSection_getSeconds(&(object->sections[i]));
+    }
+    return seconds;
+}
+
 // Print test suite
 void testSuite_print(tTestSuite* object) {
     int i;
@@ -142,6 +164,7 @@ void testSuite_print(tTestSuite* object) {
         printf("Passed Tests: %d ( %2.02f %% )\n", passed, ((float)passed / (float)total) * 100.0);
         printf("Failed Tests: %d ( %2.02f %% )\n", failed, ((float)failed / (float)total) * 100.0);
         //printf("Not Implemented: %d ( %2.02f %% )\n", not_implemented, ((float)not_implemented/(float)total)*100.0);
+        printf("Total Time: %.3f ms\n", testSuite_getSeconds(object) * 1000.0);
         printf("=========================================================================\n");
     }
 }
@@ -156,7 +179,7 @@ void testSuite_export(tTestSuite* object, FILE* fout) {
 
     testSuite_getStats(object, &total, &passed, &failed, &not_implemented);
 
-    fprintf(fout, "{ \"total\": %d, \"passed\": %d, \"failed\": %d, \"not_implemented\": %d, \"sections\": [", total, passed, failed, not_implemented);
+    fprintf(fout, "{ \"total\": %d, \"passed\": %d, \"failed\": %d, \"not_implemented\": %d, \"seconds\": %.6f, \"sections\": [", total, passed, failed, not_implemented, testSuite_getSeconds(object));
 
     for(i = 0; i < object->numSections; i++) {
         if(i > 0) {
@@ -180,6 +203,10 @@ void testSection_init(tTestSection* object, const char* code, const char* title)
     strcpy(object->title, title);
     object->numTests = 0;
     object->tests = NULL;
+    object->type = TEST_SECTION_FUNCTIONAL;
+    object->maxSeconds = 0.0;
+    object->maxAllocations = 0;
+    object->maxPhaseAllocations = 0;
 }
 
 // Remove a test Section
@@ -199,6 +226,22 @@ void testSection_free(tTestSection* object) {
 
 }
 
+// Make a performance section, with the budget of each test. 0 means no budget
+void testSection_setBudget(tTestSection* object, double maxSeconds, unsigned long long maxAllocations) {
+    assert(object != NULL);
+    assert(maxSeconds >= 0.0);
+    object->type = TEST_SECTION_PERFORMANCE;
+    object->maxSeconds = maxSeconds;
+    object->maxAllocations = maxAllocations;
+}
+
+// Set the allocations allowed in the measured phases of each test of a performance section
+void testSection_setPhaseBudget(tTestSection* object, unsigned long long maxPhaseAllocations) {
+    assert(object != NULL);
+    assert(object->type == TEST_SECTION_PERFORMANCE);
+    object->maxPhaseAllocations = maxPhaseAllocations;
+}
+
 // Add a test to the Section
 void testSection_addTest(tTestSection* object, const char* code, const char* description, tTestResult result) {
     assert(object != NULL);
@@ -206,7 +249,7 @@ void testSection_addTest(tTestSection* object, const char* code, const char* des
     if(object->tests == NULL) {
         object->tests = (tTest*)malloc(object->numTests * sizeof(tTest));
     } else {
-        object->tests = (tTest*)realloc(object->tests, object->numTests * sizeof(tTestSection));
+        object->tests = (tTest*)realloc(object->tests, object->numTests * sizeof(tTest));
     }
     assert(object->tests != NULL);
     test_init(&(object->tests[object->numTests - 1]), code, description, result);
@@ -262,6 +305,20 @@ void testSection_getStats(tTestSection* object, int* total, int* passed, int* fa
     }
 }
 
+// Get the wall-clock time of all the tests of the section, in seconds
+double testSection_getSeconds(tTestSection* object) {
+    int i;
+    double seconds;
+
+    assert(object != NULL);
+
+    seconds = 0.0;
+    for(i = 0; i < object->numTests; i++) {
+        seconds += object->tests[i].seconds;
+    }
+    return seconds;
+}
+
 // Print test section
 void testSection_print(tTestSection* object) {
     int i;
@@ -273,6 +330,10 @@ void testSection_print(tTestSection* object) {
 
     printf("\n\t=================================================================\n");
     printf("\t%s\n", object->title);
+    if(object->type == TEST_SECTION_PERFORMANCE) {
+        printf("\tBudget per test: %.3f ms, %llu allocations, %llu in the measured phases%s\n", object->maxSeconds * 1000.0,
+               object->maxAllocations, object->maxPhaseAllocations, instrument_enabled() ? "" : " (not counted without UOC_INSTRUMENT)");
+    }
     printf("\t=================================================================\n");
     if(object->numTests == 0) {
         printf("\tNO TEST DEFINED\n");
@@ -287,6 +348,7 @@ void testSection_print(tTestSection* object) {
         printf("\tPassed Tests: %d ( %2.2f %% )\n", passed, ((float)passed / (float)total) * 100.0);
         printf("\tFailed Tests: %d ( %2.2f %%)\n", failed, ((float)failed / (float)total) * 100.0);
         //printf("\tNot Implemented: %d ( %2.2f %%)\n", not_implemented, ((float)not_implemented/(float)total)*100.0);
+        printf("\tTotal Time: %.3f ms\n", testSection_getSeconds(object) * 1000.0);
         printf("\t=================================================================\n");
     }
 }
@@ -301,7 +363,14 @@ void testSection_export(tTestSection* object, FILE* fout) {
 
     testSection_getStats(object, &total, &passed, &failed, &not_implemented);
 
-    fprintf(fout, "{ \"code\": \"%s\", \"title\": \"%s\", \"total\": %d, \"passed\": %d, \"failed\": %d, \"not_implemented\": %d, \"tests\": [", object->code, object->title, total, passed, failed, not_implemented);
+    fprintf(fout, "{ \"code\": \"%s\", \"title\": \"%s\", \"type\": \"%s\", \"total\": %d, \"passed\": %d, \"failed\": %d, \"not_implemented\": %d, \"seconds\": %.6f, ",
+            object->code, object->title, object->type == TEST_SECTION_PERFORMANCE ? "performance" : "functional", total, passed, failed, not_implemented,
+            testSection_getSeconds(object));
+    if(object->type == TEST_SECTION_PERFORMANCE) {
+        fprintf(fout, "\"max_seconds\": %.6f, \"max_allocations\": %llu, \"max_phase_allocations\": %llu, ", object->maxSeconds,
+                object->maxAllocations, object->maxPhaseAllocations);
+    }
+    fprintf(fout, "\"tests\": [");
 
     for(i = 0; i < object->numTests; i++) {
         if(i > 0) {
@@ -324,6 +393,16 @@ void test_init(tTest* object, const char* code, const char* description, tTestRe
     strcpy(object->code, code);
     strcpy(object->description, description);
     object->result = TEST_RUNNING;
+    object->seconds = 0.0;
+    object->cpuSeconds = 0.0;
+    object->allocations = 0;
+    object->phaseAllocations = 0;
+    object->phased = false;
+    object->overBudget = false;
+    object->startTime = 0;
+    object->startClock = 0;
+    object->startAllocations = 0;
+    object->phaseStartAllocations = 0;
 }
 
 // Remove a test
@@ -357,7 +436,14 @@ void test_print(tTest* object) {
                 if(object->result == TEST_FAILED) {
                     printf("[%s]", "FAIL");
                 }
-    printf(":\t [%s] %s\n", object->code, object->description);
+    printf(":\t [%s] %s (%.3f ms, cpu %.3f ms", object->code, object->description, object->seconds * 1000.0, object->cpuSeconds * 1000.0);
+    if(instrument_enabled()) {
+        printf(", %llu allocations", object->allocations);
+        if(object->phased) {
+            printf(", %llu measured", object->phaseAllocations);
+        }
+    }
+    printf(")%s\n", object->overBudget ? " OVER BUDGET" : "");
 }
 
 // Export a test
@@ -367,20 +453,42 @@ void test_export(tTest* object, FILE* fout) {
 
     fprintf(fout, "{ \"code\": \"%s\", \"description\": \"%s\", \"result\": ", object->code, object->description);
     if(object->result == TEST_RUNNING) {
-        fprintf(fout, "\"%s\"}", "RUNNING");
+        fprintf(fout, "\"%s\"", "RUNNING");
     } else
         if(object->result == TEST_NOT_IMPLEMENTED) {
-            fprintf(fout, "\"%s\"}", "NOT IMPLEMENTED");
+            fprintf(fout, "\"%s\"", "NOT IMPLEMENTED");
         } else
             if(object->result == TEST_PASSED) {
-                fprintf(fout, "\"%s\"}", "OK");
+                fprintf(fout, "\"%s\"", "OK");
             } else
                 if(object->result == TEST_FAILED) {
-                    fprintf(fout, "\"%s\"}", "FAIL");
+                    fprintf(fout, "\"%s\"", "FAIL");
                 }
+    // The allocations are null when they are not counted
+    fprintf(fout, ", \"seconds\": %.6f, \"cpu_seconds\": %.6f, \"allocations\": ", object->seconds, object->cpuSeconds);
+    if(instrument_enabled()) {
+        fprintf(fout, "%llu", object->allocations);
+    } else {
+        fprintf(fout, "null");
+    }
+    fprintf(fout, ", \"phase_allocations\": ");
+    if(instrument_enabled() && object->phased) {
+        fprintf(fout, "%llu", object->phaseAllocations);
+    } else {
+        fprintf(fout, "null");
+    }
+    fprintf(fout, ", \"over_budget\": %s}", object->overBudget ? "true" : "false");
 }
 
 
+// Get the memory blocks asked to the library until now, or 0 without UOC_INSTRUMENT
+static unsigned long long test_allocations(void) {
+    tInstrumentSnapshot snapshot;
+
+    instrument_snapshot(&snapshot);
+    return instrumentSnapshot_allocations(&snapshot);
+}
+
 // Start a test
 void start_test(tTestSection* section, const char* code, const char* description) {
     tTest* test = NULL;
@@ -395,17 +503,43 @@ void start_test(tTestSection* section, const char* code, const char* description
 
     test = testSection_getTest(section, code);
     assert(test != NULL);
+
+    // The counters start after the test is added, so that the framework is not measured
+    test->startAllocations = test_allocations();
+    test->startClock = clock();
+    test->startTime = instrument_now();
 }
 
 // Finish a test
 void end_test(tTestSection* section, const char* code, bool passed) {
     tTest* test = NULL;
+    uint64_t endTime;
+    clock_t endClock;
+    unsigned long long endAllocations;
+
+    endTime = instrument_now();
+    endClock = clock();
+    endAllocations = test_allocations();
+
     assert(section != NULL);
     assert(code != NULL);
 
     test = testSection_getTest(section, code);
     assert(test != NULL);
 
+    test->seconds = (double)(endTime - test->startTime) / 1e9;
+    test->cpuSeconds = (double)(endClock - test->startClock) / CLOCKS_PER_SEC;
+    // The counters may have been reset by the test
+    test->allocations = endAllocations >= test->startAllocations ? endAllocations - test->startAllocations : endAllocations;
+
+    // A performance test that goes over the budget fails, even if its results are right
+    if(section->type == TEST_SECTION_PERFORMANCE) {
+        test->overBudget = (section->maxSeconds > 0.0 && test->seconds > section->maxSeconds) ||
+                           (section->maxAllocations > 0 && test->allocations > section->maxAllocations) ||
+                           (test->phased && test->phaseAllocations > section->maxPhaseAllocations);
+        passed = passed && !test->overBudget;
+    }
+
     if(passed) {
 #ifdef PRINT_TEST_PROGRESS
         printf("\n[OK] ==> Finished test [%s] - %s\n", test->code, test->description);
@@ -418,3 +552,35 @@ void end_test(tTestSection* section, const char* code, bool passed) {
         test_updateTest(test, TEST_FAILED);
     }
 }
+
+// Start a phase of a test whose allocations are checked against the phase budget of the section
+void start_phase(tTestSection* section, const char* code) {
+    tTest* test = NULL;
+
+    assert(section != NULL);
+    assert(code != NULL);
+
+    test = testSection_getTest(section, code);
+    assert(test != NULL);
+
+    test->phased = true;
+    test->phaseStartAllocations = test_allocations();
+}
+
+// Finish a measured phase of a test
+void end_phase(tTestSection* section, const char* code) {
+    tTest* test = NULL;
+    unsigned long long endAllocations;
+
+    endAllocations = test_allocations();
+
+    assert(section != NULL);
+    assert(code != NULL);
+
+    test = testSection_getTest(section, code);
+    assert(test != NULL);
+    assert(test->phased);
+
+    // The counters may have been reset by the test
+    test->phaseAllocations += endAllocations >= test->phaseStartAllocations ? endAllocations - test->phaseStartAllocations : endAllocations;
+}